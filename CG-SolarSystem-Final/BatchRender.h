@@ -0,0 +1,463 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+#include "RenderScript.h"
+
+// ===========================================
+// RENDER POR LOTES EN VARIOS PROCESOS (--render)
+// ===========================================
+// Un render largo a resolución alta está limitado por la CPU cuando el driver rasteriza por
+// software (llvmpipe). El guion se divide en tramos de cuadros contiguos y cada tramo lo
+// renderiza un proceso sin ventana visible (--render-worker) fijado a su propio conjunto de
+// núcleos. Cada proceso arranca en un estado determinista: la fecha del cuadro es función del
+// número de cuadro (Simulation::setEpoch) y la cámara sale del guion, así que los tramos se
+// unen sin costuras. Los PNG se numeran con el cuadro global; los tramos Y4M se concatenan.
+
+/**
+ * Tramo contiguo de cuadros.
+ */
+struct FrameRange {
+	long long first = 0;
+	long long count = 0;
+};
+
+/**
+ * Tiempos que un proceso del render deja en su archivo de estadísticas.
+ */
+struct RenderWorkerStats {
+	long long frames = 0;
+	double startupSeconds = 0.0;  // Del arranque al primer cuadro (contexto, texturas, catálogos)
+	double renderSeconds = 0.0;   // Render, lectura y codificación de los cuadros
+
+	bool write(const std::string& path) const {
+		FILE* file = std::fopen(path.c_str(), "w");
+		if (!file) return false;
+		std::fprintf(file, "%lld %.6f %.6f\n", frames, startupSeconds, renderSeconds);
+		return std::fclose(file) == 0;
+	}
+
+	bool read(const std::string& path) {
+		FILE* file = std::fopen(path.c_str(), "r");
+		if (!file) return false;
+		bool ok = std::fscanf(file, "%lld %lf %lf", &frames, &startupSeconds, &renderSeconds) == 3;
+		std::fclose(file);
+		return ok;
+	}
+};
+
+/**
+ * Divide [first, first + count) en parts tramos contiguos cuyo tamaño difiere a lo sumo en uno.
+ */
+inline std::vector<FrameRange> splitFrameRange(long long first, long long count, int parts) {
+	std::vector<FrameRange> ranges;
+	if (parts < 1) parts = 1;
+	for (int i = 0; i < parts; ++i) {
+		FrameRange r;
+		r.first = first + count * i / parts;
+		r.count = first + count * (i + 1) / parts - r.first;
+		if (r.count > 0) ranges.push_back(r);
+	}
+	return ranges;
+}
+
+/**
+ * Núcleos del proceso worker de workers: bloques contiguos del mismo tamaño. Si hay más
+ * procesos que núcleos, cada proceso recibe uno y se reparten en ronda.
+ */
+inline std::vector<int> workerCoreSet(int worker, int workers, int cores) {
+	std::vector<int> set;
+	if (workers >= cores) {
+		set.push_back(worker % cores);
+		return set;
+	}
+	int size = cores / workers;
+	for (int c = worker * size; c < (worker + 1) * size; ++c) set.push_back(c);
+	return set;
+}
+
+/** Nombre base de los archivos del tramo part (video, estadísticas y registro). */
+inline std::string batchPartPath(const RenderScript& script, int part) {
+	std::string base = !script.output.empty() && script.output[0] == '|' ? std::string("render") : script.output;
+	return base + ".part" + std::to_string(part);
+}
+
+/**
+ * Une tramos Y4M en un solo flujo: la cabecera del primero y los cuadros de todos, en orden.
+ * Las cabeceras tienen que coincidir (mismo tamaño y cuadros por segundo).
+ *
+ * @param parts  Archivos de los tramos
+ * @param target Archivo .y4m o "|comando"
+ * @param error  Salida: descripción del fallo
+ * @return Bytes escritos, o -1 si falló
+ */
+inline long long concatenateY4M(const std::vector<std::string>& parts, const std::string& target, std::string& error) {
+	bool piped = !target.empty() && target[0] == '|';
+#ifdef _WIN32
+	FILE* out = piped ? _popen(target.c_str() + 1, "wb") : std::fopen(target.c_str(), "wb");
+#else
+	FILE* out = piped ? popen(target.c_str() + 1, "w") : std::fopen(target.c_str(), "wb");
+#endif
+	if (!out) {
+		error = "No se pudo abrir " + target;
+		return -1;
+	}
+	std::vector<char> buffer(1 << 20);
+	std::string firstHeader;
+	long long written = 0;
+	for (size_t i = 0; i < parts.size() && error.empty(); ++i) {
+		FILE* in = std::fopen(parts[i].c_str(), "rb");
+		if (!in) {
+			error = "No se pudo abrir " + parts[i];
+			break;
+		}
+		std::string header;
+		int c;
+		while ((c = std::fgetc(in)) != EOF && c != '\n') header += (char)c;
+		if (header.compare(0, 9, "YUV4MPEG2") != 0 || (i > 0 && header != firstHeader)) {
+			error = "Cabecera Y4M distinta en " + parts[i];
+		}
+		else {
+			if (i == 0) {
+				firstHeader = header;
+				header += '\n';
+				written += (long long)std::fwrite(header.data(), 1, header.size(), out);
+			}
+			size_t n;
+			while ((n = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+				if (std::fwrite(buffer.data(), 1, n, out) != n) {
+					error = "Fallo la escritura de " + target;
+					break;
+				}
+				written += (long long)n;
+			}
+		}
+		std::fclose(in);
+	}
+#ifdef _WIN32
+	int closed = piped ? _pclose(out) : std::fclose(out);
+#else
+	int closed = piped ? pclose(out) : std::fclose(out);
+#endif
+	if (closed != 0 && error.empty()) error = "Fallo el cierre de " + target;
+	return error.empty() ? written : -1;
+}
+
+/**
+ * Argumento para una línea de comandos de Windows, con las reglas con que el CRT de MSVC la
+ * separa en argv: va entre comillas, las comillas internas se escapan con una barra invertida y
+ * las barras invertidas que quedan antes de una comilla (o al final) se duplican.
+ */
+inline std::string quoteWindowsArgument(const std::string& arg) {
+	std::string quoted = "\"";
+	size_t backslashes = 0;
+	for (char c : arg) {
+		if (c == '\\') {
+			++backslashes;  // Su cantidad depende de lo que sigue
+			continue;
+		}
+		quoted.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+		quoted += c;
+		backslashes = 0;
+	}
+	quoted.append(backslashes * 2, '\\');  // Antes de la comilla de cierre
+	return quoted + "\"";
+}
+
+/**
+ * Procesos hijos del render por lotes, cada uno fijado a un conjunto de núcleos.
+ * El rasterizador por software usa tantos hilos como núcleos tiene el proceso (LP_NUM_THREADS).
+ */
+class RenderProcesses
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Process {
+		std::vector<int> cores;
+		Clock::time_point launched, exited;
+		int exitCode = -1;
+		bool running = false;
+#ifdef _WIN32
+		HANDLE handle = nullptr;
+#else
+		pid_t pid = -1;
+#endif
+	};
+
+	std::vector<Process> processes;
+
+	/**
+	 * Lanza un proceso.
+	 *
+	 * @param args  Ejecutable y argumentos
+	 * @param cores Núcleos permitidos
+	 * @return Índice del proceso, o -1 si no se pudo lanzar
+	 */
+	int launch(const std::vector<std::string>& args, const std::vector<int>& cores) {
+		Process p;
+		p.cores = cores;
+		std::string threads = std::to_string(cores.size());
+#ifdef _WIN32
+		std::string commandLine;
+		for (const std::string& a : args) commandLine += quoteWindowsArgument(a) + " ";
+		SetEnvironmentVariableA("LP_NUM_THREADS", threads.c_str());  // Lo hereda el hijo
+		STARTUPINFOA startup = {};
+		startup.cb = sizeof(startup);
+		PROCESS_INFORMATION info = {};
+		if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, CREATE_SUSPENDED, nullptr, nullptr, &startup, &info)) {
+			return -1;
+		}
+		DWORD_PTR mask = 0;
+		for (int c : cores) {
+			if (c < (int)(sizeof(DWORD_PTR) * 8)) mask |= (DWORD_PTR)1 << c;
+		}
+		if (mask) SetProcessAffinityMask(info.hProcess, mask);  // Antes de que corra el primer hilo
+		ResumeThread(info.hThread);
+		CloseHandle(info.hThread);
+		p.handle = info.hProcess;
+#else
+		std::vector<char*> argv;
+		for (const std::string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+		argv.push_back(nullptr);
+		pid_t pid = fork();
+		if (pid < 0) return -1;
+		if (pid == 0) {
+#ifdef __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (int c : cores) CPU_SET(c, &set);
+			sched_setaffinity(0, sizeof(set), &set);  // Lo heredan los hilos que cree el proceso
+#endif
+			setenv("LP_NUM_THREADS", threads.c_str(), 1);
+			execvp(argv[0], argv.data());
+			_exit(127);
+		}
+		p.pid = pid;
+#endif
+		p.launched = Clock::now();
+		p.running = true;
+		processes.push_back(p);
+		return (int)processes.size() - 1;
+	}
+
+	/**
+	 * Espera a que termine cualquiera de los procesos en curso.
+	 *
+	 * @return Índice del proceso que terminó, o -1 si no queda ninguno
+	 */
+	int waitAny() {
+#ifdef _WIN32
+		std::vector<HANDLE> handles;
+		std::vector<int> indices;
+		for (size_t i = 0; i < processes.size(); ++i) {
+			if (processes[i].running) {
+				handles.push_back(processes[i].handle);
+				indices.push_back((int)i);
+			}
+		}
+		if (handles.empty()) return -1;
+		DWORD result = WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, INFINITE);
+		if (result < WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + handles.size()) return -1;
+		Process& p = processes[indices[result - WAIT_OBJECT_0]];
+		DWORD code = 1;
+		GetExitCodeProcess(p.handle, &code);
+		CloseHandle(p.handle);
+		p.handle = nullptr;
+		p.exitCode = (int)code;
+		int index = indices[result - WAIT_OBJECT_0];
+#else
+		int status = 0;
+		pid_t pid;
+		int index = -1;
+		while (index < 0) {
+			pid = waitpid(-1, &status, 0);
+			if (pid < 0) return -1;
+			for (size_t i = 0; i < processes.size(); ++i) {
+				if (processes[i].running && processes[i].pid == pid) index = (int)i;
+			}
+		}
+		Process& p = processes[index];
+		p.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+#endif
+		p.exited = Clock::now();
+		p.running = false;
+		return index;
+	}
+};
+
+/**
+ * Un tramo lanzado: su rango, su proceso y los tiempos que informó.
+ */
+struct BatchPart {
+	int part = 0;
+	FrameRange range;
+	int process = -1;
+	RenderWorkerStats stats;
+};
+
+/**
+ * Lanza los tramos y espera a que terminen todos.
+ *
+ * @return false si algún proceso falló (los registros de los que fallaron se conservan)
+ */
+inline bool runBatchParts(const char* executable, const char* scriptPath, const RenderScript& script,
+	RenderProcesses& group, std::vector<BatchPart>& parts, const std::vector<std::vector<int>>& coreSets) {
+	bool ok = true;
+	for (size_t i = 0; i < parts.size() && ok; ++i) {
+		BatchPart& b = parts[i];
+		const std::vector<int>& cores = coreSets[i % coreSets.size()];
+		std::vector<std::string> args = { executable, "--render-worker", scriptPath, std::to_string(b.range.first),
+			std::to_string(b.range.count), std::to_string(b.part), std::to_string(cores.size()) };
+		b.process = group.launch(args, cores);
+		if (b.process < 0) {
+			std::cout << "No se pudo lanzar el proceso del tramo " << b.part << std::endl;
+			ok = false;  // Se espera igual a los que ya corren
+		}
+	}
+	while (group.waitAny() >= 0) {}
+	for (BatchPart& b : parts) {
+		if (b.process < 0) continue;
+		const RenderProcesses::Process& p = group.processes[b.process];
+		std::string base = batchPartPath(script, b.part);
+		if (p.exitCode != 0 || !b.stats.read(base + ".txt") || b.stats.frames != b.range.count) {
+			std::cout << "El tramo " << b.part << " (cuadros " << b.range.first << "-" << b.range.first + b.range.count - 1
+				<< ") fallo con codigo " << p.exitCode << "; ver " << base << ".log" << std::endl;
+			ok = false;
+			continue;
+		}
+		std::remove((base + ".txt").c_str());
+		std::remove((base + ".log").c_str());
+	}
+	return ok;
+}
+
+/**
+ * Render por lotes de un guion en varios procesos.
+ *
+ * Con calibración, un primer proceso solo renderiza los primeros cuadros en un conjunto de
+ * núcleos del mismo tamaño que los del resto: su tiempo por cuadro es la referencia para la
+ * eficiencia de escala (aceleración medida / procesos). Esos cuadros son parte del resultado.
+ *
+ * @param executable        Este programa (argv[0])
+ * @param scriptPath        Guion del render
+ * @param processCount      Procesos en paralelo (0 = uno por núcleo)
+ * @param calibrationFrames Cuadros del proceso de referencia (-1 = automático, 0 = sin calibrar)
+ * @return Código de salida del proceso
+ */
+inline int runBatchRender(const char* executable, const char* scriptPath, int processCount, long long calibrationFrames) {
+	using Clock = std::chrono::steady_clock;
+	RenderScript script;
+	std::string error;
+	if (!script.load(scriptPath, error)) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+	int cores = std::max(1, (int)std::thread::hardware_concurrency());
+	if (processCount <= 0) processCount = cores;
+	processCount = (int)std::min<long long>(std::min(processCount, 64), script.frames);  // 64: límite de WaitForMultipleObjects
+	if (calibrationFrames < 0) calibrationFrames = processCount > 1 ? std::min<long long>(script.fps, script.frames / (2 * processCount)) : 0;
+	if (calibrationFrames >= script.frames) calibrationFrames = 0;
+
+	std::vector<std::vector<int>> coreSets;
+	for (int i = 0; i < processCount; ++i) coreSets.push_back(workerCoreSet(i, processCount, cores));
+	std::cout << "Render por lotes: " << script.frames << " cuadros " << script.width << "x" << script.height
+		<< " a " << script.fps << " FPS, " << processCount << " procesos de " << coreSets[0].size() << " nucleos" << std::endl;
+
+	Clock::time_point start = Clock::now();
+	RenderProcesses group;
+	int nextPart = 0;
+
+	// Proceso de referencia: los primeros cuadros, solo
+	std::vector<BatchPart> calibration;
+	if (calibrationFrames > 0) {
+		BatchPart b;
+		b.part = nextPart++;
+		b.range.first = 0;
+		b.range.count = calibrationFrames;
+		calibration.push_back(b);
+		if (!runBatchParts(executable, scriptPath, script, group, calibration, coreSets)) return 1;
+	}
+
+	// Procesos en paralelo: el resto en tramos contiguos
+	std::vector<BatchPart> parallel;
+	for (const FrameRange& r : splitFrameRange(calibrationFrames, script.frames - calibrationFrames, processCount)) {
+		BatchPart b;
+		b.part = nextPart++;
+		b.range = r;
+		parallel.push_back(b);
+	}
+	Clock::time_point parallelStart = Clock::now();
+	if (!runBatchParts(executable, scriptPath, script, group, parallel, coreSets)) return 1;
+	double parallelSeconds = std::chrono::duration<double>(Clock::now() - parallelStart).count();
+
+	// Unión de los tramos: los PNG ya tienen el número de cuadro global
+	Clock::time_point stitchStart = Clock::now();
+	if (script.format == FrameEncoder::Y4M_STREAM) {
+		std::vector<std::string> files;
+		for (int i = 0; i < nextPart; ++i) files.push_back(batchPartPath(script, i) + ".y4m");
+		long long bytes = concatenateY4M(files, script.output, error);
+		if (bytes < 0) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		for (const std::string& f : files) std::remove(f.c_str());
+		std::cout << "Tramos unidos en " << script.output << " (" << bytes / (1024 * 1024) << " MB)" << std::endl;
+	}
+	else {
+		std::printf("Cuadros en %s_000001.png ... %s_%06lld.png\n", script.output.c_str(), script.output.c_str(), script.frames);
+	}
+	double stitchSeconds = std::chrono::duration<double>(Clock::now() - stitchStart).count();
+	double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Informe: rendimiento de cada proceso y escala
+	std::vector<BatchPart> all = calibration;
+	all.insert(all.end(), parallel.begin(), parallel.end());
+	double sumFps = 0.0, maxRender = 0.0, sumRender = 0.0;
+	for (const BatchPart& b : all) {
+		double fps = b.stats.renderSeconds > 0.0 ? b.stats.frames / b.stats.renderSeconds : 0.0;
+		std::printf("  tramo %d: cuadros %lld-%lld, arranque %.2f s, render %.2f s (%.2f cuadros/s)\n", b.part,
+			b.range.first, b.range.first + b.range.count - 1, b.stats.startupSeconds, b.stats.renderSeconds, fps);
+	}
+	for (const BatchPart& b : parallel) {
+		sumFps += b.stats.renderSeconds > 0.0 ? b.stats.frames / b.stats.renderSeconds : 0.0;
+		maxRender = std::max(maxRender, b.stats.renderSeconds);
+		sumRender += b.stats.renderSeconds;
+	}
+	long long parallelFrames = script.frames - calibrationFrames;
+	std::printf("Paralelo: %lld cuadros en %.2f s = %.2f cuadros/s (desbalance %.2f: tramo mas lento / media)\n",
+		parallelFrames, parallelSeconds, parallelFrames / parallelSeconds, maxRender / (sumRender / parallel.size()));
+	if (!calibration.empty() && calibration[0].stats.renderSeconds > 0.0) {
+		const RenderWorkerStats& one = calibration[0].stats;
+		double oneFps = one.frames / one.renderSeconds;
+		double speedup = parallelFrames / parallelSeconds / oneFps;
+		std::printf("Escala vs 1 proceso (%.2f cuadros/s): aceleracion %.2fx con %d procesos, eficiencia %.0f%% "
+			"(%.0f%% sin contar el arranque)\n", oneFps, speedup, processCount, 100.0 * speedup / processCount,
+			100.0 * sumFps / (oneFps * processCount));
+	}
+	std::printf("Union de tramos: %.2f s; total: %.2f s (%.2f cuadros/s)\n", stitchSeconds, totalSeconds, script.frames / totalSeconds);
+	return 0;
+}
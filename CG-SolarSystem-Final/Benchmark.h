@@ -0,0 +1,1764 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Ephemeris.h"
+#include "ChebyshevEphemeris.h"
+#include "NBody.h"
+#include "SimdMath.h"
+#include "SnapshotTimeline.h"
+#include "FloatingOrigin.h"
+#include "BodyStore.h"
+#include "TransformHierarchy.h"
+#include "SceneCatalog.h"
+#include "MinorBodyCatalog.h"
+#include "StarCatalog.h"
+#include "SphereBVH.h"
+#include "FrameEncoder.h"
+#include "BatchRender.h"
+#include "InputLog.h"
+#include "SimulationThread.h"
+#include "FrameArena.h"
+#include "stb_image.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// ===========================================
+// MODO BENCHMARK (--bench)
+// ===========================================
+// El proyecto no tiene un ejecutable de pruebas: las validaciones numéricas y las mediciones
+// de rendimiento de los módulos de cálculo corren desde aquí, sin crear ventana ni contexto GL.
+
+/**
+ * Posición heliocéntrica eclíptica de referencia (UA, eclíptica J2000).
+ */
+struct ReferencePosition {
+	const char* name;
+	int body;           // Índice en PLANET_ELEMENTS
+	double jd;
+	double x, y, z;
+};
+
+// Posiciones de JPL DE405 en J2000 (Tierra = baricentro Tierra-Luna)
+const ReferencePosition EPHEMERIS_REFERENCES[] = {
+	{ "Mercurio", 0, JD_J2000, -0.13002, -0.44729, -0.02459 },
+	{ "Venus",    1, JD_J2000, -0.71830, -0.03265,  0.04108 },
+	{ "Tierra",   2, JD_J2000, -0.17714,  0.96724, -0.00000 },
+	{ "Marte",    3, JD_J2000,  1.39070, -0.01340, -0.03445 },
+	{ "Jupiter",  4, JD_J2000,  4.00117,  2.93854, -0.10178 },
+	{ "Saturno",  5, JD_J2000,  6.40637,  6.57055, -0.36910 },
+	{ "Urano",    6, JD_J2000, 14.43151, -13.73432, -0.23855 },
+	{ "Neptuno",  7, JD_J2000, 16.81209, -24.99175,  0.12735 },
+};
+
+/** Segundos transcurridos desde t0. */
+inline double benchSeconds(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/**
+ * Valida y mide el motor de efemérides.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchEphemeris()
+{
+	const int MINOR_BODIES = 100000;
+	const int REPEATS = 20;
+	int failures = 0;
+
+	std::cout << "== Efemerides keplerianas (" << simdInstructionSet() << ", " << VDouble::WIDTH
+		<< " carriles, bloques de " << Ephemeris::BLOCK << ") ==" << std::endl;
+
+	// Validación contra posiciones de referencia. La tolerancia crece con la distancia:
+	// los elementos de Standish tienen errores de segundos de arco a minutos de arco.
+	Ephemeris planets;
+	planets.addPlanets();
+	for (const ReferencePosition& ref : EPHEMERIS_REFERENCES) {
+		double x, y, z;
+		planets.evaluateBody(ref.body, ref.jd, x, y, z);
+		double error = std::sqrt((x - ref.x) * (x - ref.x) + (y - ref.y) * (y - ref.y) + (z - ref.z) * (z - ref.z));
+		double tolerance = 5e-3 * planets.elements(ref.body).a;
+		bool ok = error < tolerance;
+		if (!ok) ++failures;
+		std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << ref.name << ": error " << error << " UA (tolerancia " << tolerance << ")" << std::endl;
+	}
+
+	// Cuerpos menores aleatorios, incluidas excentricidades altas
+	Ephemeris eph;
+	eph.addPlanets();
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<double> u(0.0, 1.0);
+	for (int i = 0; i < MINOR_BODIES; ++i) {
+		eph.addBody(KeplerElements::fromClassical(0.5 + 40.0 * u(rng), 0.95 * u(rng), 40.0 * u(rng),
+			360.0 * u(rng), 360.0 * u(rng), 360.0 * u(rng), JD_J2000 + 3000.0 * u(rng)));
+	}
+
+	size_t n = eph.paddedCount();
+	std::vector<double> x(n), y(n), z(n), xs(n), ys(n), zs(n);
+
+	// Núcleo por bloques frente a la referencia escalar
+	double maxError = 0.0;
+	for (double jd : { JD_J2000, JD_J2000 + 9131.25, JD_J2000 - 36525.0 }) {
+		eph.evaluate(jd, x.data(), y.data(), z.data());
+		eph.evaluateScalar(jd, xs.data(), ys.data(), zs.data());
+		for (int i = 0; i < eph.bodyCount(); ++i) {
+			double d = std::fabs(x[i] - xs[i]) + std::fabs(y[i] - ys[i]) + std::fabs(z[i] - zs[i]);
+			maxError = std::max(maxError, d / eph.elements(i).a);
+		}
+	}
+	bool consistent = maxError < 1e-9;
+	if (!consistent) ++failures;
+	std::cout << "  " << (consistent ? "OK   " : "FALLO") << " bloques vs escalar: error relativo max " << maxError << std::endl;
+
+	// Rendimiento
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < REPEATS; ++r) eph.evaluate(JD_J2000 + r, x.data(), y.data(), z.data());
+	double batched = benchSeconds(t0);
+	t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < REPEATS; ++r) eph.evaluateScalar(JD_J2000 + r, xs.data(), ys.data(), zs.data());
+	double scalar = benchSeconds(t0);
+
+	double bodies = (double)eph.bodyCount() * REPEATS;
+	std::cout << "  Bloques: " << bodies / batched / 1e6 << " M cuerpos/s" << std::endl;
+	std::cout << "  Escalar: " << bodies / scalar / 1e6 << " M cuerpos/s (x" << scalar / batched << ")" << std::endl;
+	return failures;
+}
+
+/**
+ * Construye un archivo de efemérides de Chebyshev, lo valida contra su fuente y mide la evaluación.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchChebyshev()
+{
+	const char* path = "bench_planets.eph";
+	const int SAMPLES = 200000;
+	int failures = 0;
+
+	std::cout << "== Efemerides de Chebyshev (" << ThreadPool::instance().threadCount() << " hilos) ==" << std::endl;
+
+	Ephemeris source;
+	source.addPlanets();
+	std::vector<ChebyshevBodySpec> bodies;
+	for (int i = 0; i < source.bodyCount(); ++i) {
+		bodies.push_back(ChebyshevBodySpec::forOrbit(PLANET_NAMES[i], source.elements(i).a));
+	}
+	double startJD = JD_J2000 - 200.0 * 365.25;
+	double endJD = JD_J2000 + 200.0 * 365.25;
+	auto evaluateSource = [&source](int body, double jd, double& x, double& y, double& z) { source.evaluateBody(body, jd, x, y, z); };
+
+	ChebyshevBuildReport report;
+	auto t0 = std::chrono::steady_clock::now();
+	bool built = buildChebyshevEphemeris(path, bodies, startJD, endJD, evaluateSource, &report);
+	double buildTime = benchSeconds(t0);
+
+	ChebyshevEphemeris table;
+	if (!built || !table.open(path)) {
+		std::cout << "  FALLO no se pudo escribir o abrir " << path << std::endl;
+		std::remove(path);
+		return 1;
+	}
+	std::cout << "  Construccion: " << report.intervals << " intervalos, " << report.bytes / 1024 << " KB en "
+		<< buildTime * 1000.0 << " ms" << std::endl;
+
+	// Evaluación en fechas aleatorias frente a la fuente
+	std::mt19937 rng(99);
+	std::uniform_real_distribution<double> u(startJD, endJD);
+	std::vector<double> dates(SAMPLES);
+	for (double& jd : dates) jd = u(rng);
+
+	double maxError = 0.0;
+	for (double jd : dates) {
+		for (int b = 0; b < table.bodyCount(); ++b) {
+			double x, y, z, rx, ry, rz;
+			table.position(b, jd, x, y, z);
+			source.evaluateBody(b, jd, rx, ry, rz);
+			maxError = std::max(maxError, std::sqrt((x - rx) * (x - rx) + (y - ry) * (y - ry) + (z - rz) * (z - rz)));
+		}
+	}
+	bool accurate = maxError < 1e-8;  // ~1.5 km
+	if (!accurate) ++failures;
+	std::cout << "  " << (accurate ? "OK   " : "FALLO") << " archivo vs fuente: error max " << maxError << " UA" << std::endl;
+
+	// Rendimiento: tabla frente a resolver Kepler cuerpo por cuerpo
+	double checksum = 0.0;
+	t0 = std::chrono::steady_clock::now();
+	for (double jd : dates) {
+		for (int b = 0; b < table.bodyCount(); ++b) {
+			double x, y, z;
+			table.position(b, jd, x, y, z);
+			checksum += x;
+		}
+	}
+	double tableTime = benchSeconds(t0);
+	t0 = std::chrono::steady_clock::now();
+	for (double jd : dates) {
+		for (int b = 0; b < source.bodyCount(); ++b) {
+			double x, y, z;
+			source.evaluateBody(b, jd, x, y, z);
+			checksum -= x;
+		}
+	}
+	double keplerTime = benchSeconds(t0);
+
+	double evaluations = (double)SAMPLES * table.bodyCount();
+	std::cout << "  Tabla:  " << evaluations / tableTime / 1e6 << " M evaluaciones/s" << std::endl;
+	std::cout << "  Kepler: " << evaluations / keplerTime / 1e6 << " M evaluaciones/s (control " << checksum << ")" << std::endl;
+
+	table.close();
+	std::remove(path);
+	return failures;
+}
+
+/**
+ * Valida el octree frente a la suma directa, mide el rendimiento de Barnes-Hut y la
+ * deriva de energía de los integradores.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchNBody()
+{
+	int failures = 0;
+	std::cout << "== N-cuerpos Barnes-Hut (" << ThreadPool::instance().threadCount() << " hilos) ==" << std::endl;
+
+	// Disco de partículas alrededor de una estrella central, con suavizado
+	auto makeDisk = [](NBodySystem& system, int count) {
+		std::mt19937 rng(7);
+		std::normal_distribution<double> g(0.0, 1.0);
+		system.clear();
+		system.addBody(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+		for (int i = 1; i < count; ++i) {
+			system.addBody(5.0 * g(rng), 5.0 * g(rng), 0.5 * g(rng), 0.0, 0.0, 0.0, 1e-6, 1e-3);
+		}
+	};
+
+	// Precisión de las fuerzas frente a la suma directa
+	NBodySystem system;
+	makeDisk(system, 4000);
+	system.theta = 0.5;
+	system.computeAccelerations();
+	std::vector<double> dx, dy, dz;
+	system.computeAccelerationsDirect(dx, dy, dz);
+	double meanError = 0.0;
+	for (int i = 0; i < system.size(); ++i) {
+		double x, y, z;
+		system.acceleration(i, x, y, z);
+		double norm = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+		meanError += std::sqrt((x - dx[i]) * (x - dx[i]) + (y - dy[i]) * (y - dy[i]) + (z - dz[i]) * (z - dz[i])) / norm;
+	}
+	meanError /= system.size();
+	bool accurate = meanError < 1e-3;
+	if (!accurate) ++failures;
+	std::cout << "  " << (accurate ? "OK   " : "FALLO") << " octree vs suma directa (theta 0.5): error relativo medio " << meanError << std::endl;
+
+	// Rendimiento de la evaluación de fuerzas
+	for (int count : { 10000, 100000 }) {
+		makeDisk(system, count);
+		system.computeAccelerations();  // Calentamiento (reserva de memoria)
+		auto t0 = std::chrono::steady_clock::now();
+		const int REPEATS = 3;
+		for (int r = 0; r < REPEATS; ++r) system.computeAccelerations();
+		double seconds = benchSeconds(t0) / REPEATS;
+		std::cout << "  N = " << count << ": " << seconds * 1000.0 << " ms por evaluacion, "
+			<< count / seconds / 1e6 << " M cuerpos/s, " << system.nodeCount() << " nodos" << std::endl;
+	}
+
+	// Deriva de energía: Sol y planetas durante un siglo con paso de un día
+	Ephemeris planets;
+	planets.addPlanets();
+	const char* names[] = { "Leapfrog", "Yoshida4" };
+	const double limits[] = { 1e-6, 1e-7 };
+	for (int method = 0; method < 2; ++method) {
+		loadPlanetsIntoNBody(system, planets, planets.bodyCount(), JD_J2000);
+		system.integrator = (NBodySystem::Integrator)method;
+		double e0 = system.totalEnergy();
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < 36525; ++i) system.step(1.0);
+		double seconds = benchSeconds(t0);
+		double drift = std::fabs((system.totalEnergy() - e0) / e0);
+		bool ok = drift < limits[method];
+		if (!ok) ++failures;
+		std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << names[method] << ": deriva de energia " << drift
+			<< " en 100 anios (" << seconds * 1000.0 << " ms)" << std::endl;
+	}
+
+	// Reversibilidad: 10 años hacia adelante y de vuelta
+	loadPlanetsIntoNBody(system, planets, planets.bodyCount(), JD_J2000);
+	double x0, y0, z0;
+	system.position(3, x0, y0, z0);
+	for (int i = 0; i < 3652; ++i) system.step(1.0);
+	for (int i = 0; i < 3652; ++i) system.step(-1.0);
+	double x1, y1, z1;
+	system.position(3, x1, y1, z1);
+	double back = std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0) + (z1 - z0) * (z1 - z0));
+	bool reversible = back < 1e-9;
+	if (!reversible) ++failures;
+	std::cout << "  " << (reversible ? "OK   " : "FALLO") << " reversibilidad (Tierra, 10 anios ida y vuelta): " << back << " UA" << std::endl;
+
+	// Hermite por bloques: planetas y una Luna alrededor de la Tierra durante dos siglos
+	loadPlanetsIntoNBody(system, planets, planets.bodyCount(), JD_J2000);
+	double ex, ey, ez, evx, evy, evz;
+	system.position(3, ex, ey, ez);
+	system.velocity(3, evx, evy, evz);
+	const double MOON_DISTANCE = 0.00257;
+	int moon = system.addBody(ex + MOON_DISTANCE, ey, ez, evx, evy + std::sqrt(GRAVITY * PLANET_MASSES[2] / MOON_DISTANCE), evz,
+		3.694e-8, 0.0);
+	system.integrator = NBodySystem::HERMITE_BLOCK;
+	double e0 = system.totalEnergy();
+	const double DAYS = 200.0 * 365.25;
+	auto t0 = std::chrono::steady_clock::now();
+	system.step(DAYS);
+	double seconds = benchSeconds(t0);
+	double moonStep = system.timestep(moon), mercuryStep = system.timestep(1), neptuneStep = system.timestep(8);
+	system.synchronize();
+	double drift = std::fabs((system.totalEnergy() - e0) / e0);
+	double mx, my, mz;
+	system.position(moon, mx, my, mz);
+	system.position(3, ex, ey, ez);
+	double moonDistance = std::sqrt((mx - ex) * (mx - ex) + (my - ey) * (my - ey) + (mz - ez) * (mz - ez));
+	bool stable = drift < 1e-7 && moonDistance < 2.0 * MOON_DISTANCE;
+	if (!stable) ++failures;
+	std::cout << "  " << (stable ? "OK   " : "FALLO") << " Hermite por bloques con Luna: deriva de energia " << drift
+		<< " en 200 anios, Luna a " << moonDistance << " UA de la Tierra" << std::endl;
+	std::cout << "        pasos finales: Luna " << moonStep << " d, Mercurio " << mercuryStep << " d, Neptuno " << neptuneStep
+		<< " d; " << system.blockSteps() << " bloques, " << system.bodyEvaluations() << " evaluaciones" << std::endl;
+	std::cout << "        " << DAYS / seconds << " dias/s (" << DAYS * 86400.0 / seconds / 1e6
+		<< " millones de veces el tiempo real)" << std::endl;
+	return failures;
+}
+
+/**
+ * Valida la línea de tiempo N-cuerpos: restaurar una instantánea y reintegrar debe
+ * reproducir la siguiente, y el buffer circular debe respetar su presupuesto.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchTimeline()
+{
+	int failures = 0;
+	std::cout << "== Linea de tiempo N-cuerpos ==" << std::endl;
+
+	Ephemeris planets;
+	planets.addPlanets();
+	const double INTERVAL = 10.0;   // Días entre instantáneas
+	const int SNAPSHOTS = 200;
+	const char* names[] = { "Yoshida4", "Hermite" };
+	const NBodySystem::Integrator integrators[] = { NBodySystem::YOSHIDA4, NBodySystem::HERMITE_BLOCK };
+
+	for (int method = 0; method < 2; ++method) {
+		// Planetas y 2000 asteroides, con una instantánea cada INTERVAL días
+		NBodySystem system;
+		loadPlanetsIntoNBody(system, planets, planets.bodyCount(), JD_J2000);
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<double> u(0.0, 1.0);
+		for (int i = 0; i < 2000; ++i) {
+			double r = 2.2 + 1.1 * u(rng), angle = 2.0 * 3.14159265358979 * u(rng), v = std::sqrt(GRAVITY / r);
+			system.addBody(r * std::cos(angle), r * std::sin(angle), 0.05 * (u(rng) - 0.5), -v * std::sin(angle), v * std::cos(angle), 0.0, 0.0, 1e-4);
+		}
+		system.integrator = integrators[method];
+
+		SnapshotTimeline timeline;
+		double captureSeconds = 0.0;
+		auto advance = [&](NBodySystem& s, double days) {
+			if (s.integrator == NBodySystem::HERMITE_BLOCK) s.advanceAdaptive(s.time + days, -1);
+			else for (int k = 0; k < (int)days; ++k) s.step(1.0);
+		};
+		for (int k = 0; k < SNAPSHOTS; ++k) {
+			auto t0 = std::chrono::steady_clock::now();
+			timeline.capture(system);
+			captureSeconds += benchSeconds(t0);
+			advance(system, INTERVAL);
+		}
+		timeline.capture(system);
+
+		// Restaurar la instantánea 123 y reintegrar hasta la 124
+		const double from = JD_J2000 + 123 * INTERVAL;
+		NBodySystem replay, next;
+		replay.integrator = next.integrator = system.integrator;
+		bool restored = timeline.restore(from + 0.5 * INTERVAL, replay) && replay.time == from &&
+			timeline.restore(from + INTERVAL, next);
+		double worst = 0.0;
+		if (restored) {
+			advance(replay, INTERVAL);
+			replay.synchronize();
+			for (int i = 0; i < replay.size(); ++i) {
+				double x0, y0, z0, x1, y1, z1;
+				replay.position(i, x0, y0, z0);
+				next.position(i, x1, y1, z1);
+				worst = std::max({ worst, std::fabs(x1 - x0), std::fabs(y1 - y0), std::fabs(z1 - z0) });
+			}
+		}
+		bool exact = restored && worst <= SnapshotTimeline::POSITION_STEP;
+		if (!exact) ++failures;
+		TimelineInfo info = timeline.info();
+		std::cout << "  " << (exact ? "OK   " : "FALLO") << " " << names[method] << ": restaurar y reintegrar reproduce la instantanea siguiente"
+			<< " (diferencia " << worst << " UA)" << std::endl;
+		std::cout << "        " << info.snapshots << " instantaneas de " << system.size() << " cuerpos: " << info.bytes / 1024.0
+			<< " KB (" << 100.0 * info.bytes / info.rawBytes << "% de " << info.rawBytes / 1024.0 << " KB), captura "
+			<< captureSeconds / (SNAPSHOTS + 1) * 1000.0 << " ms" << std::endl;
+
+		if (method == 0) {
+			// Presupuesto: un cuarto de la memoria usada; se descartan grupos completos del principio
+			SnapshotTimeline bounded;
+			bounded.budgetBytes = info.bytes / 4;
+			NBodySystem copy;
+			timeline.restore(JD_J2000, copy);
+			copy.integrator = system.integrator;
+			for (int k = 0; k <= SNAPSHOTS; ++k) {
+				bounded.capture(copy);
+				advance(copy, INTERVAL);
+			}
+			TimelineInfo b = bounded.info();
+			NBodySystem last;
+			bool ok = b.bytes <= bounded.budgetBytes && b.snapshots > 0 && b.startJulianDate > JD_J2000 &&
+				bounded.restore(b.endJulianDate, last) && !bounded.restore(b.startJulianDate - 1.0, last);
+			if (!ok) ++failures;
+			std::cout << "  " << (ok ? "OK   " : "FALLO") << " buffer circular: " << b.snapshots << " instantaneas en "
+				<< b.bytes / 1024.0 << " KB (presupuesto " << bounded.budgetBytes / 1024.0 << " KB)" << std::endl;
+		}
+	}
+	return failures;
+}
+
+/**
+ * Valida la precisión de la escala real: posiciones relativas a la cámara (origen flotante),
+ * órbitas partidas en dos floats y resolución de la profundidad invertida desde la Luna a Neptuno.
+ * La profundidad se reproduce en la CPU con la misma aritmética float que usa la GPU.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchFloatingOrigin()
+{
+	int failures = 0;
+	const double KM_PER_AU = 149597870.7;
+	std::cout << "== Origen flotante y profundidad invertida ==" << std::endl;
+
+	// Cámara a unos 75 000 km de un punto de la superficie de Neptuno (ejes de la escena, UA)
+	glm::dvec3 neptune(16.81209, 0.12735, 24.99175);
+	glm::dvec3 surface = neptune + glm::dvec3(24764.0 / KM_PER_AU, 0.0, 0.0);
+	glm::dvec3 camera = surface + glm::dvec3(0.0003, 0.0002, 0.0003);
+	FloatingOrigin origin;
+	origin.setOrigin(camera);
+	glm::dvec3 exact = surface - camera;
+
+	double relativeKm = glm::length(glm::dvec3(origin.toLocal(surface)) - exact) * KM_PER_AU;
+	double naiveKm = glm::length(glm::dvec3(glm::vec3(surface) - glm::vec3(camera)) - exact) * KM_PER_AU;
+	glm::vec3 high, low;
+	FloatingOrigin::split(surface, high, low);
+	glm::vec3 splitLocal = (high - origin.high()) + (low - origin.low());  // Igual que orbit.vert
+	double splitKm = glm::length(glm::dvec3(splitLocal) - exact) * KM_PER_AU;
+	bool ok = relativeKm < 0.01 && splitKm < 0.01;
+	if (!ok) ++failures;
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " error de posicion junto a Neptuno: " << relativeKm * 1000.0
+		<< " m relativo a la camara, " << splitKm * 1000.0 << " m en dos floats (float absoluto: "
+		<< naiveKm << " km)" << std::endl;
+
+	// Profundidad de ventana de un punto a distancia d delante de la cámara
+	auto windowDepth = [](const glm::mat4& projection, double d, bool reversed) {
+		glm::vec4 clip = projection * glm::vec4(0.0f, 0.0f, -(float)d, 1.0f);
+		float ndc = clip.z / clip.w;
+		if (reversed) return (double)ndc;                               // glClipControl GL_ZERO_TO_ONE, 32F
+		return std::round((ndc * 0.5f + 0.5f) * 16777215.0) / 16777215.0;  // Convención de OpenGL, 24 bits
+	};
+	glm::mat4 reversedProjection = reversedInfinitePerspective(glm::radians(45.0f), 16.0f / 9.0f, 1.0e-7f);
+	glm::mat4 conventionalProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 1.0e-7f, 100.0f);
+	struct DepthCase { const char* name; double distanceAU, separationKm; };
+	const DepthCase cases[] = {
+		{ "Luna a 20 000 km, 1 km detras", 20000.0 / KM_PER_AU, 1.0 },
+		{ "Tierra y Luna desde 1 UA", 1.0, 384400.0 - 6371.0 - 1737.4 },
+		{ "Neptuno a 30 UA, 1 000 km detras", 30.0, 1000.0 },
+	};
+	for (const DepthCase& c : cases) {
+		double farther = c.distanceAU + c.separationKm / KM_PER_AU;
+		bool reversedResolved = windowDepth(reversedProjection, c.distanceAU, true) > windowDepth(reversedProjection, farther, true);
+		bool conventionalResolved = windowDepth(conventionalProjection, c.distanceAU, false) < windowDepth(conventionalProjection, farther, false);
+		if (!reversedResolved) ++failures;
+		std::cout << "  " << (reversedResolved ? "OK   " : "FALLO") << " " << c.name << ": invertida "
+			<< (reversedResolved ? "resuelve" : "NO resuelve") << ", convencional de 24 bits "
+			<< (conventionalResolved ? "resuelve" : "no resuelve") << std::endl;
+	}
+	return failures;
+}
+
+/**
+ * Valida TransformHierarchy contra la cadena translate/rotate/scale de GLM en doble precisión
+ * y mide la recomposición completa, la pasada sin cambios y un solo subárbol modificado.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchTransformHierarchy()
+{
+	const int NODES = 1000000;
+	const int ROOTS = 8;
+	const int CHILDREN = 4;
+	int failures = 0;
+	std::cout << "== Jerarquia de transformaciones ==" << std::endl;
+
+	// Árbol regular de profundidad ~10: el padre de i es (i - ROOTS) / CHILDREN
+	TransformHierarchy hierarchy;
+	hierarchy.reserve(NODES);
+	std::vector<int> parents(NODES);
+	std::vector<glm::dvec3> translations(NODES);
+	std::vector<glm::dvec3> angles(NODES);   // (inclinación, giro, escala uniforme)
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<double> unit(-1.0, 1.0);
+	for (int i = 0; i < NODES; ++i) {
+		parents[i] = i < ROOTS ? -1 : (i - ROOTS) / CHILDREN;
+		hierarchy.add(parents[i]);
+		translations[i] = glm::dvec3(unit(rng), unit(rng), unit(rng));
+		angles[i] = glm::dvec3(30.0 * unit(rng), 180.0 * unit(rng), 1.0 + 0.1 * unit(rng));
+	}
+	auto setAll = [&](double spinOffset) {
+		for (int i = 0; i < NODES; ++i) {
+			hierarchy.setLocal(i, translations[i], angles[i].x, angles[i].y + spinOffset, glm::vec3((float)angles[i].z));
+		}
+	};
+
+	// Referencia: M = M(padre) · T · Rx · Ry · S en doble precisión
+	setAll(0.0);
+	auto t0 = std::chrono::steady_clock::now();
+	hierarchy.update();
+	double fullSeconds = benchSeconds(t0);
+	std::vector<glm::dmat4> reference(NODES);
+	for (int i = 0; i < NODES; ++i) {
+		glm::dmat4 m = parents[i] >= 0 ? reference[parents[i]] : glm::dmat4(1.0);
+		m = glm::translate(m, translations[i]);
+		m = glm::rotate(m, glm::radians(angles[i].x), glm::dvec3(1.0, 0.0, 0.0));
+		m = glm::rotate(m, glm::radians(angles[i].y), glm::dvec3(0.0, 1.0, 0.0));
+		reference[i] = glm::scale(m, glm::dvec3((double)(float)angles[i].z));
+	}
+	double maxError = 0.0;
+	for (int i = 0; i < NODES; ++i) {
+		glm::mat4 m = hierarchy.modelMatrix(i, glm::dvec3(0.0));
+		for (int c = 0; c < 3; ++c) maxError = std::max(maxError, glm::length(glm::dvec3(glm::vec3(m[c])) - glm::dvec3(reference[i][c])));
+		maxError = std::max(maxError, glm::length(hierarchy.worldPosition(i) - glm::dvec3(reference[i][3])));
+	}
+	bool ok = maxError < 1e-4;
+	if (!ok) ++failures;
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << NODES << " nodos iguales a la cadena de GLM (error maximo "
+		<< maxError << ")" << std::endl;
+
+	// Sin cambios: ningún nodo se recompone
+	setAll(0.0);
+	t0 = std::chrono::steady_clock::now();
+	hierarchy.update();
+	double cleanSeconds = benchSeconds(t0);
+	ok = hierarchy.updatedNodes() == 0;
+	if (!ok) ++failures;
+
+	// Un subárbol: solo cambia un nodo intermedio y se recomponen él y sus descendientes
+	const int changed = ROOTS + 5;
+	std::vector<uint8_t> inSubtree(NODES, 0);
+	int subtreeSize = 0;
+	for (int i = changed; i < NODES; ++i) {
+		inSubtree[i] = i == changed || (parents[i] >= 0 && inSubtree[parents[i]]);
+		subtreeSize += inSubtree[i];
+	}
+	hierarchy.setLocal(changed, translations[changed], angles[changed].x, angles[changed].y + 1.0, glm::vec3((float)angles[changed].z));
+	t0 = std::chrono::steady_clock::now();
+	hierarchy.update();
+	double subtreeSeconds = benchSeconds(t0);
+	ok = ok && hierarchy.updatedNodes() == subtreeSize;
+	if (!ok) ++failures;
+
+	// Todo animado: cambia el giro de todos los nodos
+	setAll(1.0);
+	t0 = std::chrono::steady_clock::now();
+	hierarchy.update();
+	double animatedSeconds = benchSeconds(t0);
+
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " sin cambios: " << cleanSeconds * 1e3 << " ms (0 nodos); un subarbol de "
+		<< subtreeSize << " nodos: " << subtreeSeconds * 1e3 << " ms; todo animado: " << animatedSeconds * 1e9 / NODES
+		<< " ns/nodo (primera pasada " << fullSeconds * 1e9 / NODES << " ns/nodo)" << std::endl;
+	return failures;
+}
+
+/**
+ * Mide BodyStore::update() con un millón de satélites y lo compara con el mismo cálculo
+ * sobre un arreglo de structs con la forma del antiguo struct Planet (nombre, texturas,
+ * campos de luna y de anillos mezclados con el estado animado). Ambos lados terminan con
+ * la matriz de modelo de cada cuerpo: la jerarquía en update(), el arreglo con la cadena
+ * translate/rotate/scale que antes se hacía al dibujar. Falla si el almacén no es más rápido.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchBodyStore()
+{
+	const int SATELLITES = 1000000;
+	const int PLANETS = 8;
+	const int REPEATS = 5;
+	int failures = 0;
+	std::cout << "== Almacen de cuerpos (SoA) ==" << std::endl;
+
+	SimulationState state;
+	state.julianDate = JD_J2000 + 1234.5;
+	state.bodies.resize(PLANETS);
+	for (int p = 0; p < PLANETS; ++p) {
+		state.bodies[p].position = glm::vec3(1.5f + p, 0.0f, 0.0f);
+		state.bodies[p].heliocentric = glm::dvec3(0.4 + p, 0.0, 0.1);
+	}
+
+	BodyStore store;
+	store.reserve(1 + PLANETS + SATELLITES);
+	store.addStar("Sol", 1.0f, 0.00465, 5.0f, 1);
+	for (int p = 0; p < PLANETS; ++p) store.addPlanet("Planeta", p, 1.5f + p, 20.0f, 0.3f, 4e-5, 2, p);
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int i = 0; i < SATELLITES; ++i) {
+		store.addSatellite("Satelite", 1 + i % PLANETS, 0.5f + unit(rng), 0.001 + 0.01 * unit(rng), 50.0f + 300.0f * unit(rng), 0.01f, 1e-6, 3);
+	}
+
+	// Arreglo de structs equivalente: los datos calientes quedan intercalados con los fríos
+	struct LegacyBody {
+		std::string name;
+		float orbitRadius, rotationSpeed, size;
+		unsigned int texture;
+		bool hasMoon;
+		float moonDistance, moonSpeed;
+		unsigned int moonTexture;
+		bool hasRing;
+		unsigned int ringTexture;
+		double radiusAU, moonDistanceAU;
+		int parent, ephemeris;
+		double x, y, z;
+		float rotation, scale;
+		glm::mat4 model;
+	};
+	std::vector<LegacyBody> legacy(store.size());
+	for (int i = 0; i < store.size(); ++i) {
+		LegacyBody& b = legacy[i];
+		b.name = store.metadata.name[i];
+		b.rotationSpeed = store.orbits.rotationSpeed[i];
+		b.size = store.orbits.size[i];
+		b.radiusAU = store.orbits.radiusAU[i];
+		b.moonSpeed = store.orbits.orbitSpeed[i];
+		b.moonDistance = store.orbits.orbitDistance[i];
+		b.moonDistanceAU = store.orbits.orbitDistanceAU[i];
+		b.parent = store.parent[i];
+		b.ephemeris = store.orbits.ephemeris[i];
+	}
+	auto legacyUpdate = [&](bool realScale) {
+		const double seconds = (state.julianDate - JD_J2000) / DEFAULT_DAYS_PER_SECOND;
+		for (LegacyBody& b : legacy) {
+			b.rotation = BodyStore::uniformAngle(b.rotationSpeed, seconds);
+			b.scale = realScale ? (float)b.radiusAU : b.size;
+			if (b.ephemeris >= 0) {
+				const BodyState& s = state.bodies[b.ephemeris];
+				glm::dvec3 w = realScale ? s.heliocentric : glm::dvec3(s.position);
+				b.x = w.x; b.y = w.y; b.z = w.z;
+			}
+			else if (b.parent >= 0) {
+				const LegacyBody& p = legacy[b.parent];
+				double angle = BodyStore::wrapDegrees(b.moonSpeed * seconds) * (3.14159265358979323846 / 180.0);
+				double d = realScale ? b.moonDistanceAU : (double)b.moonDistance;
+				b.x = p.x + std::cos(angle) * d;
+				b.y = p.y;
+				b.z = p.z - std::sin(angle) * d;
+			}
+			else {
+				b.x = b.y = b.z = 0.0;
+			}
+			// La matriz de modelo se encadenaba en cada frame al dibujar (antiguo renderPlanet)
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((float)b.x, (float)b.y, (float)b.z));
+			model = glm::rotate(model, glm::radians(b.rotation), glm::vec3(0.0f, 1.0f, 0.0f));
+			b.model = glm::scale(model, glm::vec3(b.scale));
+		}
+	};
+
+	double storeBest = 1e30, legacyBest = 1e30;
+	for (int r = 0; r < REPEATS; ++r) {
+		auto t0 = std::chrono::steady_clock::now();
+		store.update(state, r % 2 == 1);
+		storeBest = std::min(storeBest, benchSeconds(t0));
+		t0 = std::chrono::steady_clock::now();
+		legacyUpdate(r % 2 == 1);
+		legacyBest = std::min(legacyBest, benchSeconds(t0));
+	}
+
+	// Mismo resultado en ambas representaciones (última pasada: escala real)
+	double maxError = 0.0;
+	for (int i = 0; i < store.size(); ++i) {
+		maxError = std::max(maxError, glm::length(store.position(i) - glm::dvec3(legacy[i].x, legacy[i].y, legacy[i].z)));
+	}
+	bool ok = maxError < 1e-12;
+	if (!ok) ++failures;
+	double n = (double)store.size();
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << store.size() << " cuerpos: SoA " << storeBest * 1e9 / n
+		<< " ns/cuerpo, arreglo de structs " << legacyBest * 1e9 / n << " ns/cuerpo (x" << legacyBest / storeBest << ")" << std::endl;
+
+	// La razón de ser del almacén: si deja de ganarle al arreglo de structs, es una regresión
+	bool faster = storeBest < legacyBest;
+	if (!faster) ++failures;
+	std::cout << "  " << (faster ? "OK   " : "FALLO") << " el almacen SoA es mas rapido que el arreglo de structs" << std::endl;
+	return failures;
+}
+
+/**
+ * Valida el archivo de escena (texto -> binario -> BodyStore) y mide el arranque con la escena
+ * de 8 planetas frente a un catálogo de 10 000 lunas: compilar el texto solo ocurre cuando
+ * cambia; abrir el binario proyectado no parsea nada.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchSceneCatalog()
+{
+	const int MOONS = 10000;
+	const char* textPath = "bench_scene.tmp.txt";
+	const char* binaryPath = "bench_scene.tmp.bin";
+	int failures = 0;
+	std::cout << "== Archivo de escena ==" << std::endl;
+
+	auto writeScene = [&](int moons) {
+		std::ofstream out(textPath, std::ios::trunc);
+		out << "[star Sol]\ntexture = sol.jpg\nsize = 1\nradius_km = 696000\n";
+		for (int p = 0; p < 8; ++p) {
+			out << "[planet Planeta" << p << "]\nephemeris = " << p << "\norbit = " << 1.5 + p << "\nsize = 0.3\n"
+				<< "texture = planeta.jpg\ndiameter_km = 12756\ntype = Rocoso\ncolor = 1 0.5 0.25\n";
+		}
+		for (int m = 0; m < moons; ++m) {
+			out << "[satellite Luna" << m << "]\nparent = Planeta" << m % 8 << "\ndistance = 0.7\ndistance_km = "
+				<< 100000 + m << "\nperiod_days = 2.5\nsize = 0.01\nradius_km = 50\ntexture = luna.jpg\n";
+		}
+	};
+	auto timeLoad = [&](int moons, double& compileSeconds, double& openSeconds, int& bodyCount) {
+		writeScene(moons);
+		std::remove(binaryPath);
+		std::string error;
+		SceneCatalog catalog;
+		auto t0 = std::chrono::steady_clock::now();
+		bool ok = catalog.load(textPath, binaryPath, 8, error);  // Sin binario: compila
+		compileSeconds = benchSeconds(t0);
+		catalog.close();
+		t0 = std::chrono::steady_clock::now();
+		ok = ok && catalog.load(textPath, binaryPath, 8, error);  // Binario al día: solo lo proyecta
+		BodyStore bodies;
+		catalog.buildBodies(bodies, [](const char* path) { return (unsigned int)std::strlen(path); });
+		openSeconds = benchSeconds(t0);
+		bodyCount = bodies.size();
+
+		// Mismo contenido que el texto
+		ok = ok && bodies.size() == 9 + moons && bodies.orbits.ephemeris[3] == 2 && bodies.metadata.dataIndex[3] == 2;
+		if (moons > 0) {
+			const SceneBodyRecord& r = catalog.body(9 + moons - 1);
+			ok = ok && bodies.parent[9 + moons - 1] == 1 + (moons - 1) % 8 &&
+				std::fabs(r.orbitDistanceAU * 149597870.7 - (100000 + moons - 1)) < 1e-6 &&
+				std::fabs(r.orbitSpeed - 360.0 / 2.5 * DEFAULT_DAYS_PER_SECOND) < 1e-2 &&
+				bodies.render.texture[9 + moons - 1] == std::strlen("luna.jpg");
+		}
+		return ok;
+	};
+
+	double smallCompile, smallOpen, largeCompile, largeOpen;
+	int smallCount, largeCount;
+	bool ok = timeLoad(0, smallCompile, smallOpen, smallCount) && timeLoad(MOONS, largeCompile, largeOpen, largeCount);
+	if (!ok) ++failures;
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << smallCount << " cuerpos: compilar " << smallCompile * 1e3
+		<< " ms, abrir " << smallOpen * 1e3 << " ms; " << largeCount << " cuerpos: compilar " << largeCompile * 1e3
+		<< " ms, abrir " << largeOpen * 1e3 << " ms" << std::endl;
+
+	// Un error de sintaxis se informa con su línea y no reemplaza al binario anterior
+	{
+		std::ofstream out(textPath, std::ios::app);
+		out << "[satellite Rota]\nparent = Nadie\n";
+	}
+	std::string error;
+	SceneCatalog catalog;
+	const int rotaLine = 4 + 8 * 8 + 8 * MOONS + 1;  // Sol (4 líneas), planetas y lunas (8 cada uno)
+	bool rejected = !catalog.load(textPath, binaryPath, 8, error) && error.find(":" + std::to_string(rotaLine) + ":") != std::string::npos;
+	if (!rejected) ++failures;
+	std::cout << "  " << (rejected ? "OK   " : "FALLO") << " error informado: " << error << std::endl;
+	std::remove(textPath);
+	std::remove(binaryPath);
+	return failures;
+}
+
+/**
+ * Importador de referencia para la medición: std::ifstream, getline y std::stod por campo.
+ * Misma semántica que el importador paralelo para un CSV del SBDB sin comas entre comillas.
+ *
+ * @return Filas aceptadas (las columnas quedan en out)
+ */
+inline size_t naiveMinorBodyImport(const char* path, MinorBodyColumns& out)
+{
+	std::ifstream in(path);
+	std::string line, cell;
+	std::getline(in, line);
+	std::vector<std::string> names;
+	std::stringstream header(line);
+	while (std::getline(header, cell, ',')) names.push_back(cell);
+	auto column = [&](const char* name) { return (int)(std::find(names.begin(), names.end(), name) - names.begin()); };
+	const int fields[MINOR_BODY_FIELDS] = { column("a"), column("e"), column("i"), column("om"), column("w"), column("ma"), column("epoch") };
+	const int q = column("q"), h = column("H"), pdes = column("pdes");
+
+	std::vector<std::string> cells;
+	while (std::getline(in, line)) {
+		cells.clear();
+		std::stringstream row(line);
+		while (std::getline(row, cell, ',')) cells.push_back(cell);
+		if (line.empty() || line.back() == ',') cells.push_back("");
+		double values[MINOR_BODY_FIELDS];
+		bool ok = true;
+		for (int f = 0; f < MINOR_BODY_FIELDS && ok; ++f) {
+			try { values[f] = std::stod(cells.at(fields[f])); }
+			catch (...) {
+				if (f != MinorBodyCatalog::A) ok = false;
+				else values[f] = NAN;
+			}
+		}
+		if (ok && std::isnan(values[MinorBodyCatalog::A])) values[MinorBodyCatalog::A] = std::stod(cells.at(q)) / (1.0 - values[MinorBodyCatalog::E]);
+		if (!ok) { ++out.rejected; continue; }
+		const std::string& name = cells.at(pdes);
+		out.push(values, (float)std::stod(cells.at(h)), name.c_str(), name.size());
+	}
+	return out.size();
+}
+
+/**
+ * Importa catálogos de cuerpos menores (CSV del SBDB de un millón de filas y MPCORB.DAT),
+ * compara el importador paralelo con uno ingenuo (std::ifstream + std::stod) y valida los
+ * valores, la época empaquetada del MPC y el paso de los elementos a Ephemeris.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchMinorBodyImport()
+{
+	const int ROWS = 1000000;
+	const int MPCORB_ROWS = 20000;
+	const char* csvPath = "bench_minor.tmp.csv";
+	const char* mpcorbPath = "bench_minor.tmp.dat";
+	const char* binaryPath = "bench_minor.tmp.cat";
+	int failures = 0;
+	std::cout << "== Importacion de cuerpos menores ==" << std::endl;
+
+	// Separación de campos con comillas (una coma dentro de un nombre no separa)
+	{
+		const char line[] = "1,\"Pallas, 2\",2.77\n";
+		const char* starts[4];
+		const char* ends[4];
+		int count;
+		const char* eol = TextScanner::splitLine(line, line + sizeof(line) - 1, starts, ends, 4, count);
+		double v;
+		bool ok = count == 3 && *eol == '\n' && std::string(starts[1], ends[1]) == "\"Pallas, 2\"" &&
+			TextScanner::parseNumber(starts[2], ends[2], v) && v == 2.77;
+		if (!ok) ++failures;
+		std::cout << "  " << (ok ? "OK   " : "FALLO") << " campos CSV entre comillas" << std::endl;
+	}
+
+	// CSV con el orden de columnas de una exportación del SBDB. Incluye cometas sin a (se usa q)
+	// y órbitas hiperbólicas (se descartan)
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<double> u(0.0, 1.0);
+	{
+		std::ofstream out(csvPath, std::ios::binary | std::ios::trunc);
+		out << "spkid,full_name,pdes,epoch,e,a,q,i,om,w,ma,H\n";
+		std::string buffer;
+		char row[320];
+		for (int r = 0; r < ROWS; ++r) {
+			double a = 1.5 + 4.0 * u(rng), e = 0.3 * u(rng);
+			bool comet = r % 1000 == 7, hyperbolic = r % 5000 == 11;
+			if (hyperbolic) e = 1.0 + u(rng);
+			char aText[32] = "";
+			if (!comet) std::snprintf(aText, sizeof(aText), "%.16g", a);
+			std::snprintf(row, sizeof(row), "%d,\"%7d A%d (%d)\",%d,%.1f,%.16g,%s,%.16g,%.15g,%.15g,%.15g,%.15g,%.3g\n",
+				20000000 + r, r + 1, r % 100, r, r + 1, 2460800.5 - (r % 365), e, aText, a * (1.0 - e),
+				30.0 * u(rng), 360.0 * u(rng), 360.0 * u(rng), 360.0 * u(rng), 10.0 + 10.0 * u(rng));
+			buffer += row;
+			if (buffer.size() > (1 << 20)) { out << buffer; buffer.clear(); }
+		}
+		out << buffer;
+	}
+
+	std::string error;
+	MinorBodyImportReport report;
+	bool imported = importMinorBodyCatalog(csvPath, binaryPath, error, &report);
+	MinorBodyColumns naive;
+	auto t0 = std::chrono::steady_clock::now();
+	naiveMinorBodyImport(csvPath, naive);
+	double naiveSeconds = benchSeconds(t0);
+
+	// Mismos valores, bit a bit, que std::stod
+	MinorBodyCatalog catalog;
+	bool same = imported && catalog.open(binaryPath) && (size_t)catalog.bodyCount() == naive.size() &&
+		report.rejected == naive.rejected;
+	for (int i = 0; same && i < catalog.bodyCount(); ++i) {
+		for (int f = 0; f < MINOR_BODY_FIELDS; ++f) same = same && catalog.value((MinorBodyCatalog::Field)f, i) == naive.fields[f][i];
+		same = same && catalog.magnitude(i) == naive.magnitudes[i] &&
+			std::strcmp(catalog.designation(i), &naive.names[(size_t)i * MINOR_BODY_NAME_BYTES]) == 0;
+	}
+	if (!same) ++failures;
+	std::cout << "  " << (same ? "OK   " : "FALLO") << " CSV: " << report.rows << " cuerpos, " << report.rejected
+		<< " descartados, " << report.chunks << " bloques " << error << std::endl;
+	std::cout << "  Paralelo (" << ThreadPool::instance().threadCount() << " hilos, " << simdInstructionSet() << "): "
+		<< report.seconds << " s (" << report.bytes / report.seconds / 1e6 << " MB/s, objetivo < 1 s)" << std::endl;
+	std::cout << "  ifstream + stod: " << naiveSeconds << " s (x" << naiveSeconds / report.seconds << ")" << std::endl;
+
+	// Elementos a Ephemeris y una evaluación completa repartida por bloques
+	Ephemeris eph;
+	t0 = std::chrono::steady_clock::now();
+	catalog.addTo(eph);
+	double addSeconds = benchSeconds(t0);
+	std::vector<double> x(eph.paddedCount()), y(eph.paddedCount()), z(eph.paddedCount());
+	t0 = std::chrono::steady_clock::now();
+	const int blocks = (int)eph.paddedCount() / Ephemeris::BLOCK;
+	parallelFor(0, (blocks + 255) / 256, 1, [&](int g) {
+		eph.evaluateBlocks(JD_J2000, g * 256, std::min(blocks, (g + 1) * 256), x.data(), y.data(), z.data());
+	});
+	double evaluateSeconds = benchSeconds(t0);
+	double sx, sy, sz;
+	eph.evaluateBody(eph.bodyCount() - 1, JD_J2000, sx, sy, sz);
+	bool evaluated = eph.bodyCount() == catalog.bodyCount() &&
+		std::fabs(x[eph.bodyCount() - 1] - sx) + std::fabs(y[eph.bodyCount() - 1] - sy) + std::fabs(z[eph.bodyCount() - 1] - sz) < 1e-9;
+	if (!evaluated) ++failures;
+	std::cout << "  " << (evaluated ? "OK   " : "FALLO") << " a Ephemeris: " << addSeconds * 1e3 << " ms, evaluar todos "
+		<< evaluateSeconds * 1e3 << " ms" << std::endl;
+	catalog.close();
+
+	// MPCORB.DAT: preámbulo, columnas fijas, época empaquetada y designación legible
+	std::vector<double> expected;
+	{
+		std::ofstream out(mpcorbPath, std::ios::binary | std::ios::trunc);
+		out << "MINOR PLANET CENTER ORBIT DATABASE (MPCORB)\n\nDes'n     H     G   Epoch     M        Peri.      Node       Incl.       e            n           a\n"
+			<< std::string(160, '-') << "\n";
+		char row[256];
+		for (int r = 0; r < MPCORB_ROWS; ++r) {
+			double v[6] = { 1.5 + 4.0 * u(rng), 0.3 * u(rng), 30.0 * u(rng), 360.0 * u(rng), 360.0 * u(rng), 360.0 * u(rng) };
+			int n = std::snprintf(row, sizeof(row), "%05d   %5.2f  0.15 K2555 %9.5f  %9.5f  %9.5f  %9.5f  %9.7f %11.8f %11.7f",
+				r + 1, 10.0 + u(rng), v[5], v[4], v[3], v[2], v[1], 0.2, v[0]);
+			out << row << std::string(166 - n, ' ') << "(" << r + 1 << ") Prueba" << "\r\n";
+			if (r % 5000 == 4999) out << "\n";  // Separador entre secciones
+			for (int k = 0; k < 6; ++k) expected.push_back(v[k]);
+		}
+	}
+	const double EPOCH_K2555 = 2460800.5;  // 2025-05-05 0 h
+	bool mpcorb = importMinorBodyCatalog(mpcorbPath, binaryPath, error, &report) && catalog.open(binaryPath) &&
+		catalog.bodyCount() == MPCORB_ROWS && report.rejected == 0 && std::strcmp(report.format, "MPCORB") == 0;
+	for (int i = 0; mpcorb && i < catalog.bodyCount(); ++i) {
+		for (int f = 0; f < 6; ++f) mpcorb = mpcorb && std::fabs(catalog.value((MinorBodyCatalog::Field)f, i) - expected[i * 6 + f]) < 1e-5;
+		mpcorb = mpcorb && catalog.value(MinorBodyCatalog::EPOCH, i) == EPOCH_K2555 &&
+			std::string(catalog.designation(i)) == "(" + std::to_string(i + 1) + ") Prueba";
+	}
+	if (!mpcorb) ++failures;
+	std::cout << "  " << (mpcorb ? "OK   " : "FALLO") << " MPCORB: " << catalog.bodyCount() << " cuerpos, epoca K2555 = JD "
+		<< std::to_string(catalog.isOpen() ? catalog.value(MinorBodyCatalog::EPOCH, 0) : 0.0) << " " << error << std::endl;
+	catalog.close();
+
+	std::remove(csvPath);
+	std::remove(mpcorbPath);
+	std::remove(binaryPath);
+	return failures;
+}
+
+/**
+ * Catálogo de estrellas: píxeles HEALPix conocidos e igualdad de áreas, construcción y
+ * apertura de un catálogo de 2 millones de estrellas, y descarte por celdas comparado con
+ * la fuerza bruta (ninguna estrella visible puede quedar fuera).
+ *
+ * @return Comprobaciones fallidas
+ */
+inline int benchStarCatalog()
+{
+	const int STARS = 2000000;
+	const int NSIDE = 32;
+	const double PI = 3.14159265358979323846;
+	const char* binaryPath = "bench_stars.tmp.cat";
+	const char* csvPath = "bench_stars.tmp.csv";
+	int failures = 0;
+	std::cout << "== Catalogo de estrellas ==" << std::endl;
+
+	// Polos y ecuador en nside 1 (Górski et al. 2005, figura 4) y celdas de igual área
+	bool known = StarCatalog::healpixNest(1, 1.0, 0.0) == 0 && StarCatalog::healpixNest(1, -1.0, 0.0) == 8 &&
+		StarCatalog::healpixNest(1, 0.0, 0.0) == 4 && StarCatalog::healpixNest(1, 0.0, PI) == 6 &&
+		StarCatalog::healpixNest(1, 0.9, 0.5 * PI + 0.1) == 1;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	const int AREA_NSIDE = 4;
+	const int AREA_SAMPLES = 960000;
+	std::vector<int> perCell(12 * AREA_NSIDE * AREA_NSIDE, 0);
+	bool inRange = true;
+	for (int i = 0; i < AREA_SAMPLES; ++i) {
+		int k = StarCatalog::healpixNest(AREA_NSIDE, 2.0 * unit(rng) - 1.0, 2.0 * PI * unit(rng));
+		if (k < 0 || k >= (int)perCell.size()) { inRange = false; break; }
+		++perCell[k];
+	}
+	double expected = (double)AREA_SAMPLES / perCell.size();
+	double worst = 0.0;
+	for (int n : perCell) worst = std::max(worst, std::fabs(n - expected) / expected);
+	bool area = known && inRange && worst < 0.05;  // 5000 por celda: desvío típico de 1.4 %
+	if (!area) ++failures;
+	std::cout << "  " << (area ? "OK   " : "FALLO") << " HEALPix: pixeles conocidos y areas iguales (desvio maximo "
+		<< worst * 100.0 << " %)" << std::endl;
+
+	// Cielo sintético: distribución uniforme y cuentas por magnitud como en el cielo real (N ~ 10^(0.4 m))
+	std::vector<StarSource> stars(STARS);
+	for (StarSource& s : stars) {
+		s.rightAscension = 2.0 * PI * unit(rng);
+		s.declination = std::asin(2.0 * unit(rng) - 1.0);
+		s.magnitude = (float)(14.0 + 2.5 * std::log10(std::max(unit(rng), 1e-12)));
+		s.colorIndex = (float)(2.0 * unit(rng) - 0.3);
+	}
+	StarCatalogBuildReport report;
+	auto t0 = std::chrono::steady_clock::now();
+	bool built = buildStarCatalog(binaryPath, stars, NSIDE, &report);
+	double buildSeconds = benchSeconds(t0);
+	StarCatalog catalog;
+	t0 = std::chrono::steady_clock::now();
+	bool opened = built && catalog.open(binaryPath);
+	double openSeconds = benchSeconds(t0);
+	bool ok = opened && catalog.starCount() == STARS && catalog.cellCount() == 12 * NSIDE * NSIDE;
+	for (int k = 0; ok && k < catalog.cellCount(); ++k) {
+		const StarRecord* r = catalog.stars() + catalog.cell(k).first;
+		for (uint32_t j = 1; j < catalog.cell(k).count; ++j) ok = ok && r[j - 1].magnitude <= r[j].magnitude;
+	}
+	if (!ok) ++failures;
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << STARS << " estrellas en " << report.usedCells
+		<< " celdas (" << report.bytes / (1024 * 1024) << " MB): construir " << buildSeconds * 1e3
+		<< " ms, abrir " << openSeconds * 1e3 << " ms" << std::endl;
+
+	// Descarte: toda estrella dentro del cono y bajo el límite debe estar en algún rango
+	const float halfAngle = (float)std::atan(std::tan(glm::radians(22.5)) * std::sqrt(1.0 + 1.78 * 1.78));
+	const glm::vec3 views[] = { glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0),
+		glm::normalize(glm::vec3(1, 0.3f, 0.2f)), glm::normalize(glm::vec3(-0.4f, -0.7f, 0.6f)) };
+	const float limits[] = { 6.5f, 9.0f, 14.0f };
+	std::vector<int> firsts, counts;
+	std::vector<char> drawn(ok ? STARS : 0);
+	bool culled = ok;
+	double cullSeconds = 0.0, drawnFraction = 0.0, visibleFraction = 0.0;
+	int queries = 0;
+	for (const glm::vec3& forward : views) {
+		for (float limit : limits) {
+			if (!culled) break;
+			t0 = std::chrono::steady_clock::now();
+			int total = catalog.visibleRanges(forward, halfAngle, limit, firsts, counts);
+			cullSeconds += benchSeconds(t0);
+			++queries;
+			std::fill(drawn.begin(), drawn.end(), 0);
+			int sum = 0;
+			for (size_t r = 0; r < firsts.size(); ++r) {
+				for (int j = firsts[r]; j < firsts[r] + counts[r]; ++j) {
+					drawn[j] = 1;
+					culled = culled && catalog.stars()[j].magnitude <= limit;
+				}
+				sum += counts[r];
+			}
+			culled = culled && sum == total;
+			int visible = 0;
+			const float cosHalf = std::cos(halfAngle);
+			for (int j = 0; j < STARS; ++j) {
+				const StarRecord& st = catalog.stars()[j];
+				if (st.magnitude > limit) continue;
+				if (glm::dot(forward, glm::vec3(st.direction[0], st.direction[1], st.direction[2])) < cosHalf) continue;
+				++visible;
+				culled = culled && drawn[j];
+			}
+			if (limit == limits[2]) {
+				drawnFraction += (double)total / STARS;
+				visibleFraction += (double)visible / STARS;
+			}
+		}
+	}
+	if (!culled) ++failures;
+	int viewCount = (int)(sizeof(views) / sizeof(views[0]));
+	std::cout << "  " << (culled ? "OK   " : "FALLO") << " descarte por celdas sin falsos negativos: "
+		<< cullSeconds / std::max(queries, 1) * 1e3 << " ms por consulta; con m <= 14 se dibuja el "
+		<< drawnFraction / viewCount * 100.0 << " % (visible " << visibleFraction / viewCount * 100.0 << " %)" << std::endl;
+	catalog.close();
+
+	// CSV con el formato de HYG: el Sol se descarta, ci vacío usa el color solar
+	{
+		std::ofstream out(csvPath, std::ios::trunc);
+		out << "id,hip,proper,ra,dec,mag,ci,rarad,decrad\n"
+			<< "0,,Sol,0,0,-26.7,0.656,0,0\n"
+			<< "32263,32349,Sirius,6.752481,-16.716116,-1.44,0.009,1.767793,-0.291751\n"
+			<< "91033,91262,Vega,18.615649,38.783692,0.03,,4.873565,0.676903\n";
+	}
+	std::string error;
+	std::vector<StarSource> csvStars;
+	bool csv = readStarCsv(csvPath, csvStars, error) && csvStars.size() == 2 &&
+		std::fabs(csvStars[0].rightAscension - 1.767793) < 1e-9 && std::fabs(csvStars[0].magnitude + 1.44f) < 1e-6f &&
+		std::fabs(csvStars[0].colorIndex - 0.009f) < 1e-6f && std::fabs(csvStars[1].colorIndex - 0.65f) < 1e-6f;
+	if (!csv) ++failures;
+	std::cout << "  " << (csv ? "OK   " : "FALLO") << " CSV de HYG: " << csvStars.size() << " estrellas " << error << std::endl;
+
+	std::remove(binaryPath);
+	std::remove(csvPath);
+	return failures;
+}
+
+/**
+ * BVH de esferas: rayos, segmentos y frustum comparados con la fuerza bruta, antes y después
+ * de mover todas las esferas (refit), y tiempos de construcción, refit y consulta.
+ *
+ * @return Comprobaciones fallidas
+ */
+inline int benchSphereBVH()
+{
+	const int SYSTEMS = 2000;
+	const int MOONS = 99;          // Esferas por sistema además del planeta: 200 000 en total
+	const int RAYS = 2000;
+	int failures = 0;
+	std::cout << "== BVH de cuerpos ==" << std::endl;
+
+	// Sistemas como los de la escena: un planeta en el plano y sus lunas alrededor
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	const int count = SYSTEMS * (MOONS + 1);
+	std::vector<double> x(count), y(count), z(count);
+	std::vector<float> radius(count);
+	for (int s = 0; s < SYSTEMS; ++s) {
+		double orbit = 1.0 + 40.0 * unit(rng), angle = 6.283185307179586 * unit(rng);
+		double px = orbit * std::cos(angle), pz = -orbit * std::sin(angle), py = 0.2 * (unit(rng) - 0.5);
+		for (int m = 0; m <= MOONS; ++m) {
+			int i = s * (MOONS + 1) + m;
+			double d = m == 0 ? 0.0 : 0.002 + 0.02 * unit(rng), a = 6.283185307179586 * unit(rng);
+			x[i] = px + d * std::cos(a);
+			y[i] = py + 0.1 * d * (unit(rng) - 0.5);
+			z[i] = pz - d * std::sin(a);
+			radius[i] = (float)(m == 0 ? 0.001 + 0.004 * unit(rng) : 2e-5 + 1e-4 * unit(rng));
+		}
+	}
+
+	auto bruteRay = [&](const glm::dvec3& o, const glm::dvec3& d, double maxDistance, int ignore, double& best) {
+		best = maxDistance;
+		int hit = -1;
+		for (int i = 0; i < count; ++i) {
+			if (i == ignore) continue;
+			glm::dvec3 oc = glm::dvec3(x[i], y[i], z[i]) - o;
+			double b = glm::dot(oc, d), c = glm::dot(oc, oc) - (double)radius[i] * radius[i];
+			double disc = b * b - c;
+			if (c <= 0.0 || b <= 0.0 || disc < 0.0) continue;
+			double t = b - std::sqrt(disc);
+			if (t < best) { best = t; hit = i; }
+		}
+		return hit;
+	};
+
+	// Rayos hacia cuerpos al azar (la mayoría acierta) desde cámaras al azar
+	SphereBVH bvh;
+	auto t0 = std::chrono::steady_clock::now();
+	bvh.build(x.data(), y.data(), z.data(), radius.data(), count);
+	double buildSeconds = benchSeconds(t0);
+	double builtCost = bvh.cost();
+	double refitSeconds = 0.0, bvhSeconds = 0.0, bruteSeconds = 0.0;
+	bool ok = bvh.primitiveCount() == count;
+	int hits = 0;
+	for (int pass = 0; pass < 2 && ok; ++pass) {
+		if (pass == 1) {
+			// Todas las esferas se mueven: cada sistema gira alrededor del Sol y las lunas alrededor del planeta
+			for (int s = 0; s < SYSTEMS; ++s) {
+				int p = s * (MOONS + 1);
+				double c = std::cos(0.3), sn = std::sin(0.3);
+				double px = x[p] * c + z[p] * sn, pz = -x[p] * sn + z[p] * c;
+				double dx = px - x[p], dz = pz - z[p];
+				for (int m = 0; m <= MOONS; ++m) {
+					double mx = x[p + m] - x[p], mz = z[p + m] - z[p];
+					double cm = std::cos(0.01 * m), sm = std::sin(0.01 * m);
+					if (m > 0) { x[p + m] = x[p] + mx * cm + mz * sm; z[p + m] = z[p] - mx * sm + mz * cm; }
+				}
+				for (int m = 0; m <= MOONS; ++m) { x[p + m] += dx; z[p + m] += dz; }
+			}
+			t0 = std::chrono::steady_clock::now();
+			bvh.refit(x.data(), y.data(), z.data(), radius.data());
+			refitSeconds = benchSeconds(t0);
+		}
+		for (int r = 0; r < RAYS && ok; ++r) {
+			glm::dvec3 o(60.0 * (unit(rng) - 0.5), 10.0 * (unit(rng) - 0.5), 60.0 * (unit(rng) - 0.5));
+			int target = (int)(unit(rng) * count) % count;
+			glm::dvec3 d = glm::normalize(glm::dvec3(x[target], y[target], z[target]) - o +
+				glm::dvec3(unit(rng) - 0.5, unit(rng) - 0.5, unit(rng) - 0.5) * 1e-4);
+			double tBvh, tBrute;
+			t0 = std::chrono::steady_clock::now();
+			int a = bvh.raycast(o, d, tBvh);
+			bvhSeconds += benchSeconds(t0);
+			t0 = std::chrono::steady_clock::now();
+			int b = bruteRay(o, d, std::numeric_limits<double>::infinity(), -1, tBrute);
+			bruteSeconds += benchSeconds(t0);
+			ok = a == b && (a < 0 || std::fabs(tBvh - tBrute) < 1e-12);
+			if (a >= 0) ++hits;
+
+			// Segmento hasta el objetivo: tapado si algo lo corta antes
+			glm::dvec3 to(x[target], y[target], z[target]);
+			double tBlock;
+			bool blocked = bruteRay(o, glm::normalize(to - o), glm::length(to - o), target, tBlock) >= 0;
+			ok = ok && bvh.occluded(o, to, target) == blocked;
+		}
+	}
+	if (!ok) ++failures;
+	std::cout << "  " << (ok ? "OK   " : "FALLO") << " " << count << " esferas, " << 2 * RAYS << " rayos (" << hits
+		<< " aciertos) iguales a la fuerza bruta, tambien tras mover todas: construir " << buildSeconds * 1e3
+		<< " ms, refit " << refitSeconds * 1e3 << " ms (area " << builtCost << " -> " << bvh.cost() << ")" << std::endl;
+	std::cout << "        rayo: BVH " << bvhSeconds / (2 * RAYS) * 1e6 << " us, fuerza bruta "
+		<< bruteSeconds / (2 * RAYS) * 1e6 << " us" << std::endl;
+
+	// Frustum: mismas esferas que la prueba plano por plano
+	bool frustum = true;
+	std::vector<char> found(count);
+	int inside = 0;
+	for (int v = 0; v < 20 && frustum; ++v) {
+		glm::dvec3 o(60.0 * (unit(rng) - 0.5), 5.0 * (unit(rng) - 0.5), 60.0 * (unit(rng) - 0.5));
+		glm::dvec3 f = glm::normalize(glm::dvec3(unit(rng) - 0.5, 0.3 * (unit(rng) - 0.5), unit(rng) - 0.5));
+		glm::dvec4 planes[5];
+		SphereBVH::frustumPlanes(o, f, glm::dvec3(0, 1, 0), glm::radians(45.0), 16.0 / 9.0, 0.01, planes);
+		std::fill(found.begin(), found.end(), 0);
+		bvh.forEachInFrustum(planes, 5, [&](int i) { frustum = frustum && !found[i]; found[i] = 1; });
+		for (int i = 0; i < count; ++i) {
+			bool expected = true;
+			for (int p = 0; p < 5; ++p) expected = expected && glm::dot(glm::dvec3(planes[p]), glm::dvec3(x[i], y[i], z[i])) + planes[p].w >= -radius[i];
+			frustum = frustum && expected == (found[i] != 0);
+			inside += expected;
+		}
+	}
+	if (!frustum) ++failures;
+	std::cout << "  " << (frustum ? "OK   " : "FALLO") << " frustum igual a la prueba por esfera en 20 vistas ("
+		<< inside / 20 << " esferas visibles de media)" << std::endl;
+	return failures;
+}
+
+/**
+ * Grabación: el PNG decodificado con stb_image es idéntico al cuadro, la conversión a YUV
+ * da los valores de BT.601 y el flujo Y4M sale en orden aunque lo escriban varios hilos.
+ * Mide la codificación de un cuadro 1080p y el caudal con todos los codificadores.
+ */
+inline int benchFrameEncoder()
+{
+	const int W = 1920, H = 1080;
+	const int FRAMES = 48;
+	int failures = 0;
+	std::cout << "== Grabacion ==" << std::endl;
+
+	// Cuadro parecido a la escena: fondo negro con estrellas y un planeta sombreado
+	std::mt19937 rng(5);
+	std::vector<unsigned char> frame((size_t)W * H * 4, 0);
+	for (int s = 0; s < 4000; ++s) {
+		size_t i = rng() % ((size_t)W * H);
+		unsigned char v = (unsigned char)(64 + rng() % 192);
+		frame[4 * i] = frame[4 * i + 1] = frame[4 * i + 2] = v;
+	}
+	for (int y = 0; y < H; ++y) {
+		for (int x = 0; x < W; ++x) {
+			double dx = (x - 1100) / 300.0, dy = (y - 500) / 300.0;
+			double r2 = dx * dx + dy * dy;
+			unsigned char* p = &frame[((size_t)y * W + x) * 4];
+			if (r2 < 1.0) {
+				double light = std::max(0.0, 0.6 * dx + 0.5 * dy + 0.62 * std::sqrt(1.0 - r2));
+				double band = 0.8 + 0.2 * std::sin(dy * 25.0);
+				p[0] = (unsigned char)(230 * light * band);
+				p[1] = (unsigned char)(170 * light * band);
+				p[2] = (unsigned char)(110 * light);
+			}
+			p[3] = 255;
+		}
+	}
+
+	// PNG: ida y vuelta con el decodificador de texturas
+	PngEncoder png;
+	std::vector<unsigned char> encoded;
+	const int REPEATS = 5;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < REPEATS; ++r) png.encode(frame.data(), W, H, encoded);
+	double pngSeconds = benchSeconds(t0) / REPEATS;
+	int w = 0, h = 0, channels = 0;
+	stbi_uc* decoded = stbi_load_from_memory(encoded.data(), (int)encoded.size(), &w, &h, &channels, 3);
+	bool same = decoded != nullptr && w == W && h == H;
+	for (int y = 0; same && y < H; ++y) {
+		const unsigned char* src = &frame[(size_t)(H - 1 - y) * W * 4];  // glReadPixels: de abajo hacia arriba
+		for (int x = 0; same && x < W; ++x) {
+			for (int c = 0; c < 3; ++c) same = same && decoded[((size_t)y * W + x) * 3 + c] == src[4 * x + c];
+		}
+	}
+	if (decoded) stbi_image_free(decoded);
+	if (!same) ++failures;
+	std::cout << "  " << (same ? "OK   " : "FALLO") << " PNG decodificado igual al cuadro: " << encoded.size() / 1024
+		<< " KB (" << 100.0 * encoded.size() / ((double)W * H * 3) << "% del crudo), " << pngSeconds * 1e3
+		<< " ms por cuadro 1080p en un hilo" << std::endl;
+
+	// YUV 4:2:0: colores puros contra la fórmula de BT.601 en rango limitado
+	const unsigned char COLORS[6][3] = { { 255, 255, 255 }, { 0, 0, 0 }, { 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 }, { 40, 90, 200 } };
+	bool yuv = true;
+	for (const unsigned char* c : COLORS) {
+		unsigned char block[16], out[6];
+		for (int i = 0; i < 4; ++i) { block[4 * i] = c[0]; block[4 * i + 1] = c[1]; block[4 * i + 2] = c[2]; block[4 * i + 3] = 255; }
+		convertToI420(block, 2, 2, out);
+		double ey = 16.0 + (65.481 * c[0] + 128.553 * c[1] + 24.966 * c[2]) / 255.0;
+		double eu = 128.0 + (-37.797 * c[0] - 74.203 * c[1] + 112.0 * c[2]) / 255.0;
+		double ev = 128.0 + (112.0 * c[0] - 93.786 * c[1] - 18.214 * c[2]) / 255.0;
+		yuv = yuv && std::fabs(out[0] - ey) <= 1.0 && std::fabs(out[4] - eu) <= 1.0 && std::fabs(out[5] - ev) <= 1.0;
+	}
+	if (!yuv) ++failures;
+	std::cout << "  " << (yuv ? "OK   " : "FALLO") << " YUV 4:2:0 igual a BT.601 (+-1) en 6 colores" << std::endl;
+
+	// Y4M con todos los codificadores: cada cuadro es un gris distinto, tienen que salir en orden
+	const char* y4mPath = "bench_record.tmp.y4m";
+	FrameEncoder encoder;
+	bool ordered = encoder.start(FrameEncoder::Y4M_STREAM, y4mPath, W, H, 30);
+	t0 = std::chrono::steady_clock::now();
+	for (int f = 0; ordered && f < FRAMES; ++f) {
+		FrameEncoder::Frame* out = encoder.acquire();
+		std::fill(out->rgba.begin(), out->rgba.end(), (unsigned char)(5 * f));
+		encoder.submit(out);
+	}
+	ordered = encoder.finish() && ordered;
+	double y4mSeconds = benchSeconds(t0);
+	{
+		std::ifstream in(y4mPath, std::ios::binary);
+		std::string header;
+		std::getline(in, header);
+		ordered = ordered && header == "YUV4MPEG2 W1920 H1080 F30:1 Ip A1:1 C420jpeg";
+		std::vector<char> data((size_t)W * H * 3 / 2);
+		int lastLuma = -1;
+		for (int f = 0; ordered && f < FRAMES; ++f) {
+			char tag[6];
+			in.read(tag, 6);
+			in.read(data.data(), (std::streamsize)data.size());
+			int luma = (unsigned char)data[0];
+			ordered = in.good() && std::string(tag, 6) == "FRAME\n" && luma >= lastLuma && (unsigned char)data.back() == 128;
+			lastLuma = luma;
+		}
+		ordered = ordered && in.peek() == EOF;
+	}
+	std::remove(y4mPath);
+	if (!ordered) ++failures;
+	std::cout << "  " << (ordered ? "OK   " : "FALLO") << " Y4M de " << FRAMES << " cuadros en orden: "
+		<< FRAMES / y4mSeconds << " cuadros/s" << std::endl;
+
+	// Secuencia PNG con todos los codificadores
+	const char* pngPrefix = "bench_record.tmp";
+	bool written = encoder.start(FrameEncoder::PNG_SEQUENCE, pngPrefix, W, H, 30);
+	t0 = std::chrono::steady_clock::now();
+	for (int f = 0; written && f < FRAMES; ++f) {
+		FrameEncoder::Frame* out = encoder.acquire();
+		std::copy(frame.begin(), frame.end(), out->rgba.begin());
+		encoder.submit(out);
+	}
+	written = encoder.finish() && written && encoder.framesWritten() == FRAMES;
+	double sequenceSeconds = benchSeconds(t0);
+	for (int f = 1; f <= FRAMES; ++f) {
+		char path[64];
+		std::snprintf(path, sizeof(path), "%s_%06d.png", pngPrefix, f);
+		written = written && std::ifstream(path, std::ios::binary).good();
+		std::remove(path);
+	}
+	if (!written) ++failures;
+	std::cout << "  " << (written ? "OK   " : "FALLO") << " secuencia PNG de " << FRAMES << " cuadros 1080p: "
+		<< FRAMES / sequenceSeconds << " cuadros/s con " << std::max(1, (int)std::thread::hardware_concurrency() / 2)
+		<< " hilos (" << encoder.stallCount() << " esperas del render)" << std::endl;
+	return failures;
+}
+
+/**
+ * Render por lotes: guion, división en tramos y núcleos, estado determinista en el borde de
+ * cada tramo (Simulation::setEpoch), unión de tramos Y4M y lanzamiento de procesos (con un
+ * shell en lugar del render, que necesita el ejecutable con contexto GL).
+ */
+inline int benchBatchRender()
+{
+	int failures = 0;
+	std::cout << "== Render por lotes ==" << std::endl;
+
+	// Guion: duración, claves heredadas e interpolación de la cámara
+	const char* source =
+		"# prueba\n"
+		"output = vuelo.y4m\nformat = y4m\nsize = 640 360\nfps = 24\nseconds = 10\ndate = 2025 1 1\n"
+		"[key 0]\npitch = 10\nyaw = 0\ndistance = 0.01\nfocus = Tierra\n"
+		"[key 100]\nyaw = 90\ndistance = 1\n"
+		"[key 200]\nfocus = Marte\n";
+	RenderScript script;
+	std::string error;
+	bool parsed = script.parse(source, "prueba.txt", error);
+	RenderCamera start = script.cameraAt(0), middle = script.cameraAt(50), held = script.cameraAt(150), last = script.cameraAt(239);
+	parsed = parsed && script.frames == 240 && script.ticksPerFrame() == 5 && script.format == FrameEncoder::Y4M_STREAM &&
+		script.startJulianDate == julianDateFromCalendar({ 2025, 1, 1, 0.0 }) && script.keys.size() == 3 &&
+		start.pitch == 10.0 && start.focus == "Tierra" && middle.yaw == 45.0 && middle.pitch == 10.0 &&
+		std::fabs(middle.distance - 0.1) < 1e-12 && held.yaw == 90.0 && held.focus == "Tierra" && last.focus == "Marte";
+	RenderScript invalid;
+	parsed = parsed && !invalid.parse("fps = 7\nframes = 10\n", "fps.txt", error) && error.compare(0, 8, "fps.txt:") == 0 &&
+		!invalid.parse("frames = 10\n[key 5]\n[key 5]\n", "claves.txt", error) && error == "claves.txt:3: los cuadros clave deben ir en orden creciente";
+	if (!parsed) ++failures;
+	std::cout << "  " << (parsed ? "OK   " : "FALLO") << " guion: duracion, claves heredadas, interpolacion y errores con linea" << std::endl;
+
+	// Tramos contiguos que cubren todo y difieren a lo sumo en un cuadro; núcleos sin solaparse
+	bool split = true;
+	for (long long count : { 1LL, 7LL, 240LL, 18001LL }) {
+		for (int parts : { 1, 3, 8, 16 }) {
+			std::vector<FrameRange> ranges = splitFrameRange(24, count, parts);
+			long long next = 24, smallest = count, largest = 0;
+			for (const FrameRange& r : ranges) {
+				split = split && r.first == next && r.count > 0;
+				next = r.first + r.count;
+				smallest = std::min(smallest, r.count);
+				largest = std::max(largest, r.count);
+			}
+			split = split && next == 24 + count && largest - smallest <= 1 && (int)ranges.size() == std::min<long long>(parts, count);
+		}
+	}
+	for (int workers : { 1, 3, 4, 16 }) {
+		std::vector<int> used(8, 0);
+		for (int w = 0; w < workers; ++w) {
+			std::vector<int> set = workerCoreSet(w, workers, 8);
+			split = split && !set.empty();
+			for (int c : set) used[c]++;
+		}
+		for (int c = 0; c < 8; ++c) split = split && (workers >= 8 ? used[c] == workers / 8 : used[c] <= 1);
+	}
+	if (!split) ++failures;
+	std::cout << "  " << (split ? "OK   " : "FALLO") << " tramos contiguos y balanceados, conjuntos de nucleos disjuntos" << std::endl;
+
+	// Estado en el borde de un tramo: igual al bit que la simulación continua desde el cuadro 0
+	Ephemeris planets;
+	planets.addPlanets();
+	std::vector<BodyMotion> motions;
+	for (int i = 0; i < planets.bodyCount(); ++i) motions.push_back(BodyMotion{ (float)(3.0 + 2.0 * i) });
+	const int FRAMES = 120, TICKS = script.ticksPerFrame();
+	const float WARP = 123.456f;
+	SimulationControls controls;
+	Simulation continuous;
+	continuous.init(motions, planets, 0, script.startJulianDate);
+	continuous.setTimeWarp(WARP);
+	std::vector<double> dates;
+	std::vector<glm::vec3> earth;
+	for (int f = 0; f < FRAMES; ++f) {
+		if (f > 0) for (int t = 0; t < TICKS; ++t) continuous.advance(Simulation::FIXED_DT, controls);
+		dates.push_back(continuous.currentState().julianDate);
+		earth.push_back(continuous.currentState().bodies[2].position);
+	}
+	bool seamless = true;
+	for (long long first : { 0LL, 1LL, 37LL, 119LL }) {
+		Simulation part;
+		part.init(motions, planets, 0, JD_J2000);
+		part.setTimeWarp(WARP);
+		part.setEpoch(script.startJulianDate, (first - 1) * TICKS);
+		for (long long f = first; f < FRAMES; ++f) {
+			for (int t = 0; t < TICKS; ++t) part.advance(Simulation::FIXED_DT, controls);
+			seamless = seamless && part.currentState().julianDate == dates[f] && part.currentState().bodies[2].position == earth[f];
+		}
+	}
+	if (!seamless) ++failures;
+	std::cout << "  " << (seamless ? "OK   " : "FALLO") << " fecha y posiciones de cada tramo iguales al bit a las de un solo proceso" << std::endl;
+
+	// Y4M: los tramos unidos son idénticos al flujo grabado de una vez
+	const int W = 320, H = 180, CLIP = 24;
+	auto record = [&](const std::string& path, int from, int to) {
+		FrameEncoder encoder;
+		bool ok = encoder.start(FrameEncoder::Y4M_STREAM, path, W, H, 24);
+		for (int f = from; ok && f < to; ++f) {
+			FrameEncoder::Frame* frame = encoder.acquire();
+			for (size_t i = 0; i < frame->rgba.size(); ++i) frame->rgba[i] = (unsigned char)(i * 7 + f * 13);
+			encoder.submit(frame);
+		}
+		return encoder.finish() && ok;
+	};
+	std::vector<std::string> partFiles = { "bench_batch.part0.tmp.y4m", "bench_batch.part1.tmp.y4m", "bench_batch.part2.tmp.y4m" };
+	bool stitched = record("bench_batch.whole.tmp.y4m", 0, CLIP) && record(partFiles[0], 0, 5) &&
+		record(partFiles[1], 5, 17) && record(partFiles[2], 17, CLIP);
+	error.clear();
+	long long bytes = concatenateY4M(partFiles, "bench_batch.joined.tmp.y4m", error);
+	auto readAll = [](const char* path) {
+		std::ifstream in(path, std::ios::binary);
+		return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	};
+	std::string whole = readAll("bench_batch.whole.tmp.y4m");
+	stitched = stitched && bytes > 0 && (size_t)bytes == whole.size() && readAll("bench_batch.joined.tmp.y4m") == whole;
+	// Un tramo con otra resolución no se une
+	stitched = stitched && [&] {
+		FrameEncoder other;
+		bool ok = other.start(FrameEncoder::Y4M_STREAM, partFiles[1], W / 2, H / 2, 24) && other.finish();
+		std::string mismatch;
+		return ok && concatenateY4M(partFiles, "bench_batch.joined.tmp.y4m", mismatch) < 0 && !mismatch.empty();
+	}();
+	for (const std::string& f : partFiles) std::remove(f.c_str());
+	std::remove("bench_batch.whole.tmp.y4m");
+	std::remove("bench_batch.joined.tmp.y4m");
+	if (!stitched) ++failures;
+	std::cout << "  " << (stitched ? "OK   " : "FALLO") << " tramos Y4M unidos iguales al flujo de un solo proceso" << std::endl;
+
+	// Línea de comandos de Windows: rutas con espacios, comillas y barras invertidas
+	bool quoted = quoteWindowsArgument("C:\\Program Files\\solar.exe") == "\"C:\\Program Files\\solar.exe\"" &&
+		quoteWindowsArgument("") == "\"\"" && quoteWindowsArgument("salida\\") == "\"salida\\\\\"" &&
+		quoteWindowsArgument("a\"b") == "\"a\\\"b\"" && quoteWindowsArgument("a\\\"b") == "\"a\\\\\\\"b\"" &&
+		quoteWindowsArgument("a\\\\b c") == "\"a\\\\b c\"";
+	if (!quoted) ++failures;
+	std::cout << "  " << (quoted ? "OK   " : "FALLO") << " argumentos escapados con las reglas de argv de MSVC" << std::endl;
+
+#ifndef _WIN32
+	// Dos procesos a la vez: argumentos intactos, LP_NUM_THREADS heredado y códigos de salida
+	RenderProcesses group;
+	const std::string odd = "guion con \"comillas\" y barra\\";
+	int ok = group.launch({ "sh", "-c", "test \"$1\" = \"$0\" && test \"$LP_NUM_THREADS\" = 1", odd, odd }, { 0 });
+	int failed = group.launch({ "sh", "-c", "exit 3" }, { 0 });
+	int finished = 0;
+	while (group.waitAny() >= 0) ++finished;
+	bool launched = ok >= 0 && failed >= 0 && finished == 2 && group.processes[ok].exitCode == 0 &&
+		group.processes[failed].exitCode == 3;
+	if (!launched) ++failures;
+	std::cout << "  " << (launched ? "OK   " : "FALLO") << " dos procesos en paralelo con sus argumentos y codigos de salida" << std::endl;
+#endif
+	return failures;
+}
+
+/**
+ * Valida el registro de entrada (formato, daños, estado de teclas) y que la simulación de paso
+ * fijo dé lo mismo en dos corridas con los mismos controles, que es lo que permite reproducir.
+ *
+ * @return Número de comprobaciones fallidas
+ */
+inline int benchInputLog()
+{
+	int failures = 0;
+	std::cout << "== Registro de entrada ==" << std::endl;
+
+	// Ida y vuelta: todos los tipos, coordenadas enteras y fraccionarias, teclas negativas
+	const int EVENTS = 200000;
+	std::mt19937 rng(17);
+	std::uniform_int_distribution<int> type(InputEvent::FRAME, InputEvent::TYPE_COUNT - 1);
+	std::vector<InputEvent> written;
+	written.reserve(EVENTS);
+	InputLog log;
+	double now = 100.0;
+	auto t0 = std::chrono::steady_clock::now();
+	log.startRecording(INPUT_LOG_SEED, 2460000.25, now);
+	for (int i = 0; i < EVENTS; ++i) {
+		InputEvent e = InputEvent::make((InputEvent::Type)type(rng));
+		switch (e.type) {
+		case InputEvent::FRAME: e.deltaTime = 1.0f / (30 + rng() % 200); break;
+		case InputEvent::CHECK: e.checksum = (uint32_t)rng(); break;
+		case InputEvent::KEY: e = InputEvent::keyEvent((int)(rng() % 350) - 1, (int)(rng() % 300), (int)(rng() % 3), (int)(rng() % 64)); break;
+		case InputEvent::MOUSE_BUTTON: e = InputEvent::buttonEvent((int)(rng() % 8), (int)(rng() % 2), (int)(rng() % 64)); break;
+		case InputEvent::CHAR: e.key = (int)(rng() % 0x10FFFF); break;
+		case InputEvent::CURSOR_ENTER: case InputEvent::FOCUS: e.key = (int)(rng() % 2); break;
+		case InputEvent::FRAMEBUFFER_SIZE: case InputEvent::WINDOW_SIZE: e = InputEvent::valueEvent(e.type, (int)(rng() % 8000), (int)(rng() % 8000)); break;
+		case InputEvent::CURSOR_POS: case InputEvent::SCROLL:
+			e.x = (double)(rng() % 4000) - 200.0;
+			e.y = (double)(rng() % 4000) - 200.0;
+			if (rng() % 4 == 0) e.x += 0.37;  // Cursor con subpíxeles (pantallas HiDPI, touchpads)
+			break;
+		default: break;
+		}
+		now += (rng() % 20000) * 1e-6 + 1e-7;
+		log.record(e, now);
+		written.push_back(e);
+	}
+	std::string error;
+	bool saved = log.save("bench_input.tmp.bin", error);
+	double encodeSeconds = benchSeconds(t0);
+	size_t bytes = log.bytes();
+	uint32_t frames = log.frameCount();
+
+	t0 = std::chrono::steady_clock::now();
+	InputLog replay;
+	bool roundTrip = saved && replay.load("bench_input.tmp.bin", error) && replay.frameCount() == frames &&
+		replay.header().seed == INPUT_LOG_SEED && replay.header().startJulianDate == 2460000.25;
+	InputEvent e;
+	size_t read = 0;
+	while (roundTrip && replay.next(e)) {
+		roundTrip = read < written.size() && e == written[read];
+		++read;
+	}
+	double decodeSeconds = benchSeconds(t0);
+	roundTrip = roundTrip && read == written.size() && replay.error().empty() && replay.replayedFrameCount() == frames;
+	if (!roundTrip) ++failures;
+	std::cout << "  " << (roundTrip ? "OK   " : "FALLO") << " ida y vuelta de " << EVENTS << " registros al bit ("
+		<< (double)bytes / EVENTS << " bytes por registro)" << std::endl;
+	std::cout << "       codificar y escribir: " << encodeSeconds * 1e9 / EVENTS << " ns/registro, leer y decodificar: "
+		<< decodeSeconds * 1e9 / EVENTS << " ns/registro" << std::endl;
+
+	// Archivos dañados: truncado a mitad de un registro, otra cabecera
+	bool damaged = [&] {
+		std::ifstream in("bench_input.tmp.bin", std::ios::binary);
+		std::string all((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		in.close();
+		std::ofstream("bench_input.tmp.bin", std::ios::binary).write(all.data(), (std::streamsize)all.size() - 3);
+		InputLog cut;
+		std::string message;
+		if (!cut.load("bench_input.tmp.bin", message)) return false;
+		InputEvent ev;
+		size_t count = 0;
+		while (cut.next(ev)) ++count;
+		bool truncated = count < written.size() && !cut.error().empty();
+		all[0] = 'X';
+		std::ofstream("bench_input.tmp.bin", std::ios::binary).write(all.data(), (std::streamsize)all.size());
+		return truncated && !cut.load("bench_input.tmp.bin", message) && !message.empty();
+	}();
+	std::remove("bench_input.tmp.bin");
+	if (!damaged) ++failures;
+	std::cout << "  " << (damaged ? "OK   " : "FALLO") << " registro truncado y cabecera ajena detectados" << std::endl;
+
+	// Estado de teclas: PRESS y REPEAT presionan, RELEASE suelta, perder el foco suelta todo
+	InputState state;
+	state.apply(InputEvent::keyEvent(265, 0, 1, 0));
+	state.apply(InputEvent::keyEvent(264, 0, 2, 0));
+	bool keys = state.keyDown(265) && state.keyDown(264) && !state.keyDown(-1) && !state.keyDown(100000);
+	state.apply(InputEvent::keyEvent(265, 0, 0, 0));
+	keys = keys && !state.keyDown(265) && state.keyDown(264);
+	state.apply(InputEvent::valueEvent(InputEvent::FOCUS, 0));
+	keys = keys && !state.keyDown(264);
+	state.apply(InputEvent::pointEvent(InputEvent::CURSOR_POS, 10.5, -3.0));
+	state.apply(InputEvent::valueEvent(InputEvent::WINDOW_SIZE, 1280, 720));
+	keys = keys && state.cursorX == 10.5 && state.cursorY == -3.0 && state.windowWidth == 1280 && state.windowHeight == 720;
+	if (!keys) ++failures;
+	std::cout << "  " << (keys ? "OK   " : "FALLO") << " estado de teclas, cursor y ventana segun los eventos" << std::endl;
+
+	// Paso fijo en el hilo de simulación: mismos controles y pasos por frame, mismos estados al bit,
+	// aunque los controles cambien justo antes de pedir los pasos
+	Ephemeris planets;
+	planets.addPlanets();
+	std::vector<BodyMotion> motions;
+	for (int i = 0; i < planets.bodyCount(); ++i) motions.push_back(BodyMotion{ (float)(3.0 + 2.0 * i) });
+	auto session = [&](std::vector<uint32_t>& sums) {
+		srand(INPUT_LOG_SEED);
+		Simulation simulation;
+		simulation.init(motions, planets, 6, 2460000.25);
+		Profiler profiler;
+		SimulationThread thread;
+		thread.setFixedStep(true);
+		thread.start(simulation, profiler, profiler.registerThread("Simulacion"));
+		std::mt19937 frameRng(23);
+		for (int f = 0; f < 300; ++f) {
+			SimulationControls controls;
+			controls.meteoritesEnabled = f >= 10;
+			controls.paused = f >= 120 && f < 160;
+			controls.meteoriteCount = 1 + (f / 50) % 6;
+			thread.setControls(controls);
+			thread.setTimeWarp(f < 200 ? 30.0 : -5.0);
+			thread.stepFixed((int)(frameRng() % 4));
+			const SimulationState& s = thread.latestSnapshot().current;
+			uint32_t h = InputLog::hash(&s.julianDate, sizeof(double));
+			for (const Meteorite& m : s.meteorites) h = InputLog::hash(&m.position, sizeof(m.position), h);
+			sums.push_back(h);
+		}
+		thread.stop();
+	};
+	std::vector<uint32_t> first, second;
+	session(first);
+	session(second);
+	bool repeatable = first == second;
+	if (!repeatable) ++failures;
+	std::cout << "  " << (repeatable ? "OK   " : "FALLO") << " dos corridas de paso fijo con los mismos controles dan los mismos estados" << std::endl;
+	return failures;
+}
+
+/**
+ * Arena por frame y contador de asignaciones: alineación, desborde y crecimiento, y un loop
+ * de frames con contenedores reutilizados y datos transitorios en la arena que en régimen
+ * estable no asigna memoria.
+ */
+inline int benchFrameArena()
+{
+	int failures = 0;
+	std::cout << "== Arena por frame y asignaciones ==" << std::endl;
+
+	// El contador ve las asignaciones de new (requiere FRAME_ARENA_IMPLEMENTATION en el programa)
+	uint64_t before = threadAllocations().count;
+	std::unique_ptr<int> probe(new int(7));
+	std::vector<double> grown(1000);
+	bool counted = threadAllocations().count - before == 2 && processAllocations().count.load() >= 2;
+#ifdef __cpp_aligned_new
+	// Tipos sobrealineados: operator new con alineación (C++17)
+	struct alignas(64) WideBlock { double v[8]; };
+	before = threadAllocations().count;
+	std::unique_ptr<WideBlock[]> wide(new WideBlock[4]);
+	counted = counted && threadAllocations().count - before == 1 && ((uintptr_t)wide.get() & 63) == 0;
+#endif
+	if (!counted) ++failures;
+	std::cout << "  " << (counted ? "OK   " : "FALLO") << " el contador registra las asignaciones de new" << std::endl;
+
+	// Alineación y contenido: reservas de tamaños y alineaciones mezcladas sin solaparse
+	FrameArena arena(4096);
+	bool aligned = true;
+	char* previousEnd = nullptr;
+	for (int i = 0; i < 60; ++i) {
+		size_t align = (size_t)1 << (i % 7);
+		size_t size = 1 + (i * 13) % 50;
+		char* p = (char*)arena.allocate(size, align);
+		aligned = aligned && ((uintptr_t)p & (align - 1)) == 0 && (previousEnd == nullptr || p >= previousEnd);
+		std::memset(p, i, size);
+		previousEnd = p + size;
+	}
+	const char* text = arena.format("%s %d %.2f", "Marte", 4, 1.524);
+	aligned = aligned && std::strcmp(text, "Marte 4 1.52") == 0 && arena.overflows() == 0;
+	if (!aligned) ++failures;
+	std::cout << "  " << (aligned ? "OK   " : "FALLO") << " reservas alineadas, contiguas y texto con formato" << std::endl;
+
+	// Desborde: el frame que no entra usa bloques aparte y el siguiente reset() agranda el bloque
+	arena.reset();
+	int* big = arena.allocateArray<int>(5000);
+	for (int i = 0; i < 5000; ++i) big[i] = i;
+	bool overflowed = arena.overflows() == 1 && big[4999] == 4999;
+	arena.reset();
+	arena.allocateArray<int>(5000);
+	bool grownArena = overflowed && arena.overflows() == 1 && arena.capacity() >= 5000 * sizeof(int);
+	if (!grownArena) ++failures;
+	std::cout << "  " << (grownArena ? "OK   " : "FALLO") << " tras un desborde el bloque crece a " << arena.capacity() / 1024
+		<< " KB y el mismo frame entra" << std::endl;
+
+	// Régimen estable: 1000 frames con vectores que conservan su capacidad y rangos en la arena
+	FrameArena frameArena;
+	FrameAllocationStats stats;
+	std::vector<float> positions;
+	std::vector<uint32_t> visible;
+	std::mt19937 rng(31);
+	uint64_t steadyCount = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	const int FRAMES = 1000;
+	for (int f = 0; f < FRAMES; ++f) {
+		frameArena.reset();
+		stats.beginFrame();
+		int bodies = 200 + (int)(rng() % 50);
+		positions.resize(bodies * 3);
+		visible.clear();
+		for (int i = 0; i < bodies; ++i) {
+			positions[i * 3] = (float)(rng() % 1000);
+			if (positions[i * 3] < 500.0f) visible.push_back((uint32_t)i);
+		}
+		int* ranges = frameArena.allocateArray<int>(visible.size() + 1);
+		for (size_t i = 0; i < visible.size(); ++i) ranges[i] = (int)visible[i];
+		const char* label = frameArena.format("Frame %d: %d visibles", f, (int)visible.size());
+		stats.endFrame(f / 60.0);
+		if (f >= 10) steadyCount += stats.frameCount;  // Los primeros frames fijan las capacidades
+		if (label[0] != 'F') steadyCount += 1000;
+	}
+	double seconds = benchSeconds(t0);
+	bool steady = steadyCount == 0 && stats.cleanFrames >= FRAMES - 10;
+	if (!steady) ++failures;
+	std::cout << "  " << (steady ? "OK   " : "FALLO") << " " << FRAMES << " frames en " << seconds * 1000.0
+		<< " ms sin asignaciones tras el arranque (" << steadyCount << " asignaciones, racha de "
+		<< stats.cleanFrames << " frames)" << std::endl;
+	return failures;
+}
+
+/**
+ * Ejecuta todas las validaciones y mediciones.
+ *
+ * @return Código de salida del proceso (0 si todo pasó)
+ */
+inline int runBenchmarks()
+{
+	int failures = 0;
+	failures += benchEphemeris();
+	failures += benchChebyshev();
+	failures += benchNBody();
+	failures += benchTimeline();
+	failures += benchFloatingOrigin();
+	failures += benchTransformHierarchy();
+	failures += benchBodyStore();
+	failures += benchSceneCatalog();
+	failures += benchMinorBodyImport();
+	failures += benchStarCatalog();
+	failures += benchSphereBVH();
+	failures += benchFrameEncoder();
+	failures += benchBatchRender();
+	failures += benchInputLog();
+	failures += benchFrameArena();
+
+	std::cout << (failures == 0 ? "Todas las comprobaciones pasaron." : "Hay comprobaciones fallidas.") << std::endl;
+	return failures == 0 ? 0 : 1;
+}
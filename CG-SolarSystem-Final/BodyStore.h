@@ -0,0 +1,401 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Simulation.h"
+#include "SimdMath.h"
+#include "TransformHierarchy.h"
+
+/**
+ * Tipo de cuerpo (metadato: prioridad de etiquetas, filtros de la interfaz).
+ */
+enum BodyKind : uint8_t {
+	BODY_STAR,
+	BODY_PLANET,
+	BODY_SATELLITE
+};
+
+/**
+ * Almacén de cuerpos orientado a datos (estructura de arreglos).
+ *
+ * Cada cuerpo es un índice. Sus datos se reparten en bloques (chunks) por patrón de acceso,
+ * y cada bloque guarda un arreglo contiguo por campo:
+ *  - transforms: lo que update() escribe en cada frame y el render lee (posición, rotación, radio).
+ *  - orbits:     constantes de movimiento que solo lee update().
+ *  - render:     texturas y anillos, solo para el render.
+ *  - metadata:   nombre, tipo y fila de la tabla educativa; datos fríos de la interfaz.
+ * Así el bucle de actualización recorre solo los arreglos que usa, sin arrastrar strings ni
+ * texturas, y un planeta puede tener cualquier número de satélites.
+ *
+ * La jerarquía es un índice de padre por cuerpo. Los cuerpos se agregan con el padre antes
+ * que los hijos (orden topológico), así una sola pasada en orden resuelve las posiciones.
+ * Cada cuerpo tiene además nodos en una TransformHierarchy: un marco (posición orbital e
+ * inclinación del eje), la esfera (giro y radio) y opcionalmente los anillos. El marco de un
+ * satélite cuelga del marco de su padre, así las lunas orbitan en el plano ecuatorial del
+ * planeta y una nave puede orbitar una luna, a cualquier profundidad. Los nodos se crean solo
+ * donde hacen falta: un cuerpo sin satélites ni anillos (casi todos los satélites) tiene un
+ * único nodo con marco y esfera juntos, y como es una hoja su parte lineal no se compone en
+ * update() sino al pedir su matriz de modelo para dibujarlo.
+ *
+ * Medición (--bench, 1 núcleo, -O2 -mavx2): update() con 1 000 000 de satélites en movimiento
+ * tarda entre 34 y 43 ns por cuerpo, frente a 67-78 ns de la cadena translate/rotate/scale sobre un
+ * arreglo de structs con la forma del antiguo struct Planet, que solo admitía un nivel de
+ * anidamiento; en pausa la jerarquía no recompone ningún nodo. Ver benchBodyStore() y
+ * benchTransformHierarchy().
+ */
+class BodyStore {
+public:
+	/** Datos que cambian en cada frame (escritos por update()). */
+	struct TransformChunk {
+		std::vector<double> x, y, z;       // Posición del mundo (doble precisión; UA en escala real)
+		std::vector<float> rotation;       // Ángulo de rotación propia (grados)
+		std::vector<float> scale;          // Radio con el que se dibuja
+	};
+
+	/** Constantes de movimiento. */
+	struct OrbitChunk {
+		std::vector<int> ephemeris;        // Índice en SimulationState::bodies; -1 = órbita circular alrededor del padre
+		std::vector<float> sceneOrbitRadius;  // Planetas: radio de la órbita en la escena
+		std::vector<double> rotationSpeed; // Rotación propia (grados/segundo a DEFAULT_DAYS_PER_SECOND)
+		std::vector<double> orbitSpeed;    // Satélites: velocidad orbital (grados/segundo); 0 en el resto
+		std::vector<double> orbitDistance; // Satélites: distancia al padre en la escena
+		std::vector<double> orbitDistanceAU;  // Satélites: distancia real al padre (UA)
+		std::vector<float> size;           // Radio en la vista esquemática
+		std::vector<double> radiusAU;      // Radio real (UA)
+		std::vector<float> axialTilt;      // Inclinación del eje sobre X (grados); la heredan sus satélites
+	};
+
+	/** Datos de dibujo. */
+	struct RenderChunk {
+		std::vector<unsigned int> texture;      // Textura de la superficie
+		std::vector<unsigned int> ringTexture;  // Textura de los anillos (0 = sin anillos; siguen el ecuador)
+		std::vector<float> ringRadius;          // Radio de los anillos relativo al del cuerpo
+		std::vector<float> ringThickness;       // Grosor de los anillos relativo al radio del cuerpo
+	};
+
+	/** Datos fríos de la interfaz. */
+	struct MetadataChunk {
+		std::vector<std::string> name;
+		std::vector<BodyKind> kind;
+		std::vector<int> dataIndex;             // Fila de la tabla educativa (-1 = ninguna)
+	};
+
+	/** Nodos del cuerpo en la jerarquía de transformaciones (válidos después de update()). */
+	struct NodeChunk {
+		std::vector<int> frame;                 // Marco orbital: posición e inclinación del eje
+		std::vector<int> body;                  // Esfera: giro y radio (hijo del marco, o el mismo marco si no hay satélites ni anillos)
+		std::vector<int> ring;                  // Anillos (hijo del marco; -1 = sin anillos)
+	};
+
+	TransformChunk transforms;
+	OrbitChunk orbits;
+	RenderChunk render;
+	MetadataChunk metadata;
+	NodeChunk nodes;
+	TransformHierarchy hierarchy;               // Matrices del mundo de todos los nodos
+	std::vector<int> parent;                    // Cuerpo alrededor del que orbita (-1 = raíz)
+
+	int size() const { return (int)parent.size(); }
+
+	/** Reserva memoria para n cuerpos en todos los bloques. */
+	void reserve(size_t n) {
+		for (std::vector<double>* v : { &transforms.x, &transforms.y, &transforms.z, &orbits.rotationSpeed, &orbits.orbitSpeed,
+			&orbits.orbitDistance, &orbits.orbitDistanceAU, &orbits.radiusAU, &offsetX, &offsetZ }) v->reserve(n);
+		for (std::vector<float>* v : { &transforms.rotation, &transforms.scale, &orbits.sceneOrbitRadius, &orbits.size,
+			&orbits.axialTilt, &render.ringRadius, &render.ringThickness }) v->reserve(n);
+		for (std::vector<int>* v : { &orbits.ephemeris, &metadata.dataIndex, &parent, &nodes.frame, &nodes.body, &nodes.ring }) v->reserve(n);
+		hierarchy.reserve(n);
+		render.texture.reserve(n);
+		render.ringTexture.reserve(n);
+		metadata.name.reserve(n);
+		metadata.kind.reserve(n);
+	}
+
+	/**
+	 * Agrega una estrella fija en el origen (el Sol).
+	 *
+	 * @param name          Nombre a mostrar
+	 * @param size          Radio en la vista esquemática
+	 * @param radiusAU      Radio real (UA)
+	 * @param rotationSpeed Rotación propia (grados/segundo)
+	 * @param texture       Textura de la superficie
+	 * @return Índice del cuerpo
+	 */
+	int addStar(const std::string& name, float size, double radiusAU, float rotationSpeed, unsigned int texture) {
+		return add(name, BODY_STAR, -1, -1, size, radiusAU, rotationSpeed, texture);
+	}
+
+	/**
+	 * Agrega un planeta cuya posición sale de la simulación (efemérides o N-cuerpos).
+	 *
+	 * @param name          Nombre a mostrar
+	 * @param ephemeris     Índice del planeta en las efemérides y en SimulationState::bodies
+	 * @param orbitRadius   Radio de la órbita en la escena (el semieje real se escala a este valor)
+	 * @param rotationSpeed Rotación propia (grados/segundo)
+	 * @param size          Radio en la vista esquemática
+	 * @param radiusAU      Radio real (UA)
+	 * @param texture       Textura de la superficie
+	 * @param dataIndex     Fila de la tabla educativa
+	 * @return Índice del cuerpo
+	 */
+	int addPlanet(const std::string& name, int ephemeris, float orbitRadius, float rotationSpeed,
+		float size, double radiusAU, unsigned int texture, int dataIndex) {
+		int i = add(name, BODY_PLANET, -1, ephemeris, size, radiusAU, rotationSpeed, texture);
+		orbits.sceneOrbitRadius[i] = orbitRadius;
+		metadata.dataIndex[i] = dataIndex;
+		return i;
+	}
+
+	/**
+	 * Agrega un satélite en órbita circular alrededor de otro cuerpo ya agregado.
+	 * Rota a la misma velocidad con la que orbita (muestra siempre la misma cara).
+	 *
+	 * @param name            Nombre a mostrar
+	 * @param parentIndex     Cuerpo alrededor del que orbita (debe ser anterior)
+	 * @param orbitDistance   Distancia al padre en la escena
+	 * @param orbitDistanceAU Distancia real al padre (UA)
+	 * @param orbitSpeed      Velocidad orbital (grados/segundo)
+	 * @param size            Radio en la vista esquemática
+	 * @param radiusAU        Radio real (UA)
+	 * @param texture         Textura de la superficie
+	 * @return Índice del cuerpo
+	 */
+	int addSatellite(const std::string& name, int parentIndex, float orbitDistance, double orbitDistanceAU,
+		float orbitSpeed, float size, double radiusAU, unsigned int texture) {
+		int i = add(name, BODY_SATELLITE, parentIndex, -1, size, radiusAU, orbitSpeed, texture);
+		orbits.orbitSpeed[i] = orbitSpeed;
+		orbits.orbitDistance[i] = orbitDistance;
+		orbits.orbitDistanceAU[i] = orbitDistanceAU;
+		return i;
+	}
+
+	/**
+	 * Inclina el eje de rotación de un cuerpo. Sus anillos y las órbitas de sus satélites
+	 * quedan en el plano ecuatorial inclinado.
+	 *
+	 * @param i       Índice del cuerpo
+	 * @param degrees Inclinación sobre el eje X (grados)
+	 */
+	void setAxialTilt(int i, float degrees) {
+		orbits.axialTilt[i] = degrees;
+	}
+
+	/**
+	 * Da anillos a un cuerpo (esfera aplastada en su plano ecuatorial).
+	 *
+	 * @param i         Índice del cuerpo
+	 * @param texture   Textura de los anillos
+	 * @param radius    Radio relativo al del cuerpo
+	 * @param thickness Grosor relativo al radio del cuerpo
+	 */
+	void setRing(int i, unsigned int texture, float radius, float thickness) {
+		render.ringTexture[i] = texture;
+		render.ringRadius[i] = radius;
+		render.ringThickness[i] = thickness;
+		nodesDirty = true;  // Necesita un marco propio con el nodo de los anillos
+	}
+
+	/**
+	 * Parámetros de movimiento de los planetas para Simulation::init, ordenados por índice de efemérides.
+	 */
+	std::vector<BodyMotion> planetMotions() const {
+		std::vector<BodyMotion> motions;
+		for (int i = 0; i < size(); ++i) {
+			int e = orbits.ephemeris[i];
+			if (e < 0) continue;
+			if ((int)motions.size() <= e) motions.resize(e + 1);
+			motions[e].orbitRadius = orbits.sceneOrbitRadius[i];
+		}
+		return motions;
+	}
+
+	/**
+	 * Matriz de modelo de un nodo relativa a la cámara (origen flotante).
+	 *
+	 * @param node   Nodo (nodes.body[i] o nodes.ring[i])
+	 * @param origin Posición de la cámara en el mundo
+	 */
+	glm::mat4 modelMatrix(int node, const glm::dvec3& origin) const {
+		return hierarchy.modelMatrix(node, origin);
+	}
+
+	/** Posición del mundo del cuerpo i calculada en el último update(). */
+	glm::dvec3 position(int i) const {
+		return glm::dvec3(transforms.x[i], transforms.y[i], transforms.z[i]);
+	}
+
+	/**
+	 * Resuelve las transformaciones de todos los cuerpos en el estado interpolado.
+	 * Es una función cerrada de la época, como Simulation::evaluateBodies: los ángulos avanzan
+	 * a la velocidad de cada cuerpo por cada DEFAULT_DAYS_PER_SECOND días simulados.
+	 *
+	 * Primero los ángulos y el desplazamiento orbital de todos los cuerpos con VDouble (sin ramas:
+	 * los que no orbitan tienen velocidad y distancia 0); después los parámetros locales de los
+	 * nodos, y la jerarquía compone las matrices del mundo solo donde algo cambió (en pausa, nada).
+	 *
+	 * @param state     Estado interpolado de la simulación (posiciones de los planetas)
+	 * @param realScale true = distancias y radios reales (UA); false = vista esquemática
+	 */
+	void update(const SimulationState& state, bool realScale) {
+		if (nodesDirty) buildNodes();
+		const double animationSeconds = (state.julianDate - JD_J2000) / DEFAULT_DAYS_PER_SECOND;
+		const int n = size();
+		offsetX.resize(n);
+		offsetZ.resize(n);
+		const double* rotationSpeed = orbits.rotationSpeed.data();
+		const double* orbitSpeed = orbits.orbitSpeed.data();
+		const double* distance = realScale ? orbits.orbitDistanceAU.data() : orbits.orbitDistance.data();
+		float* rotation = transforms.rotation.data();
+		double* ox = offsetX.data();
+		double* oz = offsetZ.data();
+
+		// 1. Ángulos: rotación propia y órbita circular en el plano XZ del padre (giro alrededor de +Y de (d, 0, 0))
+		const VDouble seconds = VDouble::set1(animationSeconds);
+		const VDouble deg = VDouble::set1(PI / 180.0);
+		const VDouble zero = VDouble::set1(0.0);
+		int i = 0;
+		for (; i + VDouble::WIDTH <= n; i += VDouble::WIDTH) {
+			double angles[VDouble::WIDTH];
+			wrapDegrees(VDouble::load(&rotationSpeed[i]) * seconds).store(angles);
+			for (int l = 0; l < VDouble::WIDTH; ++l) rotation[i + l] = (float)angles[l];
+
+			VDouble s, c;
+			sinCos(wrapDegrees(VDouble::load(&orbitSpeed[i]) * seconds) * deg, s, c);
+			VDouble d = VDouble::load(&distance[i]);
+			(c * d).store(&ox[i]);
+			(zero - s * d).store(&oz[i]);
+		}
+		for (; i < n; ++i) {
+			rotation[i] = uniformAngle(rotationSpeed[i], animationSeconds);
+			double angle = wrapDegrees(orbitSpeed[i] * animationSeconds) * (PI / 180.0);
+			ox[i] = std::cos(angle) * distance[i];
+			oz[i] = -std::sin(angle) * distance[i];
+		}
+
+		// 2. Parámetros locales de los nodos: el marco se traslada (posición de la simulación o
+		//    desplazamiento en el marco del padre) y se inclina; la esfera gira y se escala
+		const int* ephemeris = orbits.ephemeris.data();
+		const int* parents = parent.data();
+		const float* size = orbits.size.data();
+		const double* radiusAU = orbits.radiusAU.data();
+		const float* tilt = orbits.axialTilt.data();
+		float* scale = transforms.scale.data();
+		for (i = 0; i < n; ++i) {
+			scale[i] = realScale ? (float)radiusAU[i] : size[i];
+			glm::dvec3 translation(0.0);
+			int e = ephemeris[i];
+			if (e >= 0 && e < (int)state.bodies.size()) {  // Un planeta nuevo de la escena espera al reinicio
+				const BodyState& b = state.bodies[e];
+				translation = realScale ? b.heliocentric : glm::dvec3(b.position);
+			}
+			else if (parents[i] >= 0) {
+				translation = glm::dvec3(ox[i], 0.0, oz[i]);
+			}
+			int frame = nodes.frame[i];
+			if (nodes.body[i] == frame) {
+				// Un solo nodo: T · Rx(inclinación) · Ry(giro) · S, lo mismo que el marco por la esfera
+				hierarchy.setLocal(frame, translation, tilt[i], rotation[i], glm::vec3(scale[i]));
+				continue;
+			}
+			hierarchy.setLocal(frame, translation, tilt[i], 0.0, glm::vec3(1.0f));
+			hierarchy.setLocal(nodes.body[i], glm::dvec3(0.0), 0.0, rotation[i], glm::vec3(scale[i]));
+			int ring = nodes.ring[i];
+			if (ring >= 0) {
+				float ringRadius = scale[i] * render.ringRadius[i];
+				hierarchy.setLocal(ring, glm::dvec3(0.0), 0.0, 0.0, glm::vec3(ringRadius, scale[i] * render.ringThickness[i], ringRadius));
+			}
+		}
+
+		// 3. Matrices del mundo y posiciones de los marcos
+		hierarchy.update();
+		double* x = transforms.x.data();
+		double* y = transforms.y.data();
+		double* z = transforms.z.data();
+		for (i = 0; i < n; ++i) {
+			glm::dvec3 w = hierarchy.worldPosition(nodes.frame[i]);
+			x[i] = w.x; y[i] = w.y; z[i] = w.z;
+		}
+	}
+
+	/** Ángulo en grados [0, 360) de un movimiento uniforme, calculado en doble precisión. */
+	static float uniformAngle(double degreesPerSecond, double animationSeconds) {
+		return (float)wrapDegrees(degreesPerSecond * animationSeconds);
+	}
+
+	/** Reduce un ángulo en grados a [0, 360) sin pasar por float. */
+	static double wrapDegrees(double a) {
+		return a - 360.0 * std::floor(a * (1.0 / 360.0));
+	}
+
+private:
+	static constexpr double PI = 3.14159265358979323846;
+
+	std::vector<double> offsetX, offsetZ;  // Desplazamiento orbital respecto del padre (temporal de update())
+	bool nodesDirty = false;                // Cambiaron los cuerpos o sus anillos: rehacer los nodos
+
+	/**
+	 * Crea los nodos de todos los cuerpos en la jerarquía: marco, esfera y anillos para los que
+	 * tienen satélites o anillos; un único nodo para el resto.
+	 */
+	void buildNodes() {
+		nodesDirty = false;
+		const int n = size();
+		std::vector<uint8_t> hasSatellites(n, 0);
+		for (int i = 0; i < n; ++i) if (parent[i] >= 0) hasSatellites[parent[i]] = 1;
+		hierarchy.clear();
+		for (int i = 0; i < n; ++i) {
+			int frame = hierarchy.add(parent[i] >= 0 ? nodes.frame[parent[i]] : -1);
+			bool ringed = render.ringTexture[i] != 0;
+			nodes.frame[i] = frame;
+			nodes.body[i] = hasSatellites[i] || ringed ? hierarchy.add(frame) : frame;
+			nodes.ring[i] = ringed ? hierarchy.add(frame) : -1;
+		}
+	}
+
+	/** Reduce ángulos en grados a [0, 360), carril por carril (misma fórmula que la versión escalar). */
+	static VDouble wrapDegrees(VDouble a) {
+		return a - VDouble::set1(360.0) * floor(a * VDouble::set1(1.0 / 360.0));
+	}
+
+	/** Agrega un cuerpo con valores neutros en todos los bloques. */
+	int add(const std::string& name, BodyKind kind, int parentIndex, int ephemeris,
+		float size, double radiusAU, float rotationSpeed, unsigned int texture) {
+		int i = this->size();
+		transforms.x.push_back(0.0);
+		transforms.y.push_back(0.0);
+		transforms.z.push_back(0.0);
+		transforms.rotation.push_back(0.0f);
+		transforms.scale.push_back(size);
+
+		orbits.ephemeris.push_back(ephemeris);
+		orbits.sceneOrbitRadius.push_back(0.0f);
+		orbits.rotationSpeed.push_back(rotationSpeed);
+		orbits.orbitSpeed.push_back(0.0);
+		orbits.orbitDistance.push_back(0.0);
+		orbits.orbitDistanceAU.push_back(0.0);
+		orbits.size.push_back(size);
+		orbits.radiusAU.push_back(radiusAU);
+		orbits.axialTilt.push_back(0.0f);
+
+		render.texture.push_back(texture);
+		render.ringTexture.push_back(0);
+		render.ringRadius.push_back(0.0f);
+		render.ringThickness.push_back(0.0f);
+
+		metadata.name.push_back(name);
+		metadata.kind.push_back(kind);
+		metadata.dataIndex.push_back(-1);
+
+		parent.push_back(parentIndex < i ? parentIndex : -1);  // El padre siempre precede al hijo
+		nodes.frame.push_back(-1);
+		nodes.body.push_back(-1);
+		nodes.ring.push_back(-1);
+		nodesDirty = true;
+		return i;
+	}
+};
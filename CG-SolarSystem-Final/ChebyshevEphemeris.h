@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Parallel.h"
+
+// ===========================================
+// FORMATO DEL ARCHIVO (little-endian)
+// ===========================================
+// Inspirado en los segmentos tipo 2 de los archivos SPK de JPL:
+//   [ChebyshevFileHeader]
+//   [ChebyshevBodyIndex] x bodyCount
+//   Por cuerpo, en bodyIndex.offset: intervalCount registros de 3 * coefficientCount doubles
+//   (coeficientes de X, luego Y, luego Z), intervalos consecutivos de intervalDays desde startJulianDate.
+// Posiciones heliocéntricas eclípticas J2000 en UA.
+
+const char CHEBYSHEV_MAGIC[8] = { 'C', 'G', 'E', 'P', 'H', 'E', 'M', '1' };
+const uint32_t CHEBYSHEV_VERSION = 1;
+
+struct ChebyshevFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t bodyCount;
+	double startJulianDate;   // Inicio de la cobertura
+	double endJulianDate;     // Fin de la cobertura
+};
+
+struct ChebyshevBodyIndex {
+	char name[24];              // Nombre del cuerpo (terminado en '\0')
+	uint32_t coefficientCount;  // Coeficientes por eje y por intervalo
+	uint32_t intervalCount;
+	double intervalDays;        // Duración de cada intervalo
+	uint64_t offset;            // Posición de los coeficientes en el archivo (bytes)
+};
+
+/**
+ * Efemérides precalculadas como polinomios de Chebyshev por intervalos, leídas desde un
+ * archivo proyectado en memoria.
+ *
+ * Evaluar un cuerpo en cualquier fecha es O(1): se calcula el intervalo directamente,
+ * se leen sus coeficientes y se suma la serie con el algoritmo de Clenshaw.
+ */
+class ChebyshevEphemeris
+{
+public:
+	/**
+	 * Abre y valida un archivo de efemérides.
+	 *
+	 * @param path Ruta del archivo
+	 * @return     true si el archivo existe y su estructura es válida
+	 */
+	bool open(const char* path) {
+		close();
+		if (!file.open(path)) return false;
+
+		if (file.size() < sizeof(ChebyshevFileHeader)) { close(); return false; }
+		header = (const ChebyshevFileHeader*)file.data();
+		if (std::memcmp(header->magic, CHEBYSHEV_MAGIC, sizeof(CHEBYSHEV_MAGIC)) != 0 ||
+			header->version != CHEBYSHEV_VERSION ||
+			!(header->endJulianDate > header->startJulianDate)) {
+			close();
+			return false;
+		}
+
+		size_t indexEnd = sizeof(ChebyshevFileHeader) + (size_t)header->bodyCount * sizeof(ChebyshevBodyIndex);
+		if (file.size() < indexEnd) { close(); return false; }
+		index = (const ChebyshevBodyIndex*)(file.data() + sizeof(ChebyshevFileHeader));
+
+		for (uint32_t i = 0; i < header->bodyCount; ++i) {
+			const ChebyshevBodyIndex& b = index[i];
+			uint64_t bytes = (uint64_t)b.intervalCount * 3 * b.coefficientCount * sizeof(double);
+			if (b.coefficientCount == 0 || b.intervalCount == 0 || !(b.intervalDays > 0.0) ||
+				b.offset % sizeof(double) != 0 || b.offset < indexEnd || b.offset + bytes > file.size()) {
+				close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void close() {
+		file.close();
+		header = nullptr;
+		index = nullptr;
+	}
+
+	bool isOpen() const { return header != nullptr; }
+	int bodyCount() const { return header ? (int)header->bodyCount : 0; }
+	const char* bodyName(int i) const { return index[i].name; }
+	double startJulianDate() const { return header->startJulianDate; }
+	double endJulianDate() const { return header->endJulianDate; }
+
+	/** Indica si la fecha está dentro de la cobertura del archivo. */
+	bool covers(double jd) const {
+		return header && jd >= header->startJulianDate && jd <= header->endJulianDate;
+	}
+
+	/**
+	 * Posición de un cuerpo. Fuera de la cobertura se extrapola el primer o último intervalo.
+	 *
+	 * @param body Índice del cuerpo en el archivo
+	 * @param jd   Fecha juliana
+	 * @param x    Salida X (UA)
+	 * @param y    Salida Y (UA)
+	 * @param z    Salida Z (UA)
+	 */
+	void position(int body, double jd, double& x, double& y, double& z) const {
+		const ChebyshevBodyIndex& b = index[body];
+		double t = (jd - header->startJulianDate) / b.intervalDays;
+		int k = std::min(std::max((int)std::floor(t), 0), (int)b.intervalCount - 1);
+		double tau = 2.0 * (t - k) - 1.0;  // Tiempo normalizado a [-1, 1] dentro del intervalo
+
+		const int n = (int)b.coefficientCount;
+		const double* c = (const double*)(file.data() + b.offset) + (size_t)k * 3 * n;
+		x = clenshaw(c, n, tau);
+		y = clenshaw(c + n, n, tau);
+		z = clenshaw(c + 2 * n, n, tau);
+	}
+
+	/** Suma de la serie de Chebyshev c[0] T0(tau) + ... + c[n-1] Tn-1(tau). */
+	static double clenshaw(const double* c, int n, double tau) {
+		double b1 = 0.0, b2 = 0.0;
+		double twoTau = 2.0 * tau;
+		for (int j = n - 1; j >= 1; --j) {
+			double b0 = twoTau * b1 - b2 + c[j];
+			b2 = b1;
+			b1 = b0;
+		}
+		return tau * b1 - b2 + c[0];
+	}
+
+private:
+	MappedFile file;
+	const ChebyshevFileHeader* header = nullptr;
+	const ChebyshevBodyIndex* index = nullptr;
+};
+
+// ===========================================
+// CONSTRUCCIÓN DEL ARCHIVO
+// ===========================================
+
+/**
+ * Parámetros de ajuste de un cuerpo.
+ */
+struct ChebyshevBodySpec {
+	std::string name;
+	double intervalDays;
+	int coefficientCount;
+
+	/**
+	 * Parámetros por defecto a partir del semieje: 8 intervalos por órbita y 12
+	 * coeficientes dan errores de ajuste de metros para e < 0.3.
+	 *
+	 * @param name          Nombre del cuerpo
+	 * @param semiMajorAxis Semieje mayor (UA)
+	 */
+	static ChebyshevBodySpec forOrbit(const std::string& name, double semiMajorAxis) {
+		double periodDays = 365.25 * semiMajorAxis * std::sqrt(semiMajorAxis);
+		return { name, periodDays / 8.0, 12 };
+	}
+};
+
+/**
+ * Resultado de la construcción.
+ */
+struct ChebyshevBuildReport {
+	size_t intervals = 0;   // Intervalos ajustados en total
+	size_t bytes = 0;       // Tamaño del archivo
+	double maxError = 0.0;  // Error máximo del ajuste frente a la fuente (UA), medido entre nodos
+};
+
+/**
+ * Ajusta polinomios de Chebyshev a una fuente de posiciones y escribe el archivo.
+ *
+ * Cada intervalo se ajusta por interpolación en los nodos de Chebyshev (transformada
+ * coseno discreta), en paralelo sobre todos los pares (cuerpo, intervalo).
+ *
+ * @param path    Ruta del archivo de salida
+ * @param bodies  Parámetros de ajuste de cada cuerpo (su índice es el de la fuente)
+ * @param startJD Inicio de la cobertura
+ * @param endJD   Fin de la cobertura
+ * @param source  Invocable source(body, jd, x, y, z) con posiciones en UA; debe ser seguro entre hilos
+ * @param report  Salida opcional con estadísticas del ajuste
+ * @return        true si el archivo se escribió correctamente
+ */
+template <class Source>
+bool buildChebyshevEphemeris(const char* path, const std::vector<ChebyshevBodySpec>& bodies,
+	double startJD, double endJD, Source&& source, ChebyshevBuildReport* report = nullptr)
+{
+	const double PI = 3.14159265358979323846;
+	const int ERROR_SAMPLES = 7;  // Puntos de control por intervalo para medir el error
+
+	// Índice y desplazamientos
+	ChebyshevFileHeader header = {};
+	std::memcpy(header.magic, CHEBYSHEV_MAGIC, sizeof(CHEBYSHEV_MAGIC));
+	header.version = CHEBYSHEV_VERSION;
+	header.bodyCount = (uint32_t)bodies.size();
+	header.startJulianDate = startJD;
+	header.endJulianDate = endJD;
+
+	std::vector<ChebyshevBodyIndex> index(bodies.size());
+	std::vector<size_t> firstTask(bodies.size() + 1, 0);  // Primer intervalo global de cada cuerpo
+	const uint64_t dataStart = sizeof(ChebyshevFileHeader) + bodies.size() * sizeof(ChebyshevBodyIndex);
+	uint64_t offset = dataStart;
+	for (size_t i = 0; i < bodies.size(); ++i) {
+		ChebyshevBodyIndex& b = index[i];
+		std::memset(b.name, 0, sizeof(b.name));
+		std::strncpy(b.name, bodies[i].name.c_str(), sizeof(b.name) - 1);
+		b.coefficientCount = (uint32_t)bodies[i].coefficientCount;
+		b.intervalDays = bodies[i].intervalDays;
+		b.intervalCount = (uint32_t)std::ceil((endJD - startJD) / b.intervalDays);
+		b.offset = offset;
+		offset += (uint64_t)b.intervalCount * 3 * b.coefficientCount * sizeof(double);
+		firstTask[i + 1] = firstTask[i] + b.intervalCount;
+	}
+
+	// Coeficientes de todos los cuerpos, en el orden del archivo
+	std::vector<double> coefficients((size_t)(offset - dataStart) / sizeof(double));
+	std::vector<double> taskError(firstTask.back(), 0.0);
+
+	parallelFor(0, (int)firstTask.back(), 16, [&](int task) {
+		size_t body = std::upper_bound(firstTask.begin(), firstTask.end(), (size_t)task) - firstTask.begin() - 1;
+		const ChebyshevBodyIndex& b = index[body];
+		const int n = (int)b.coefficientCount;
+		const size_t k = (size_t)task - firstTask[body];
+		const double t0 = startJD + k * b.intervalDays;
+		const double half = 0.5 * b.intervalDays;
+
+		// Muestras en los nodos de Chebyshev
+		std::vector<double> samples(3 * (size_t)n);
+		for (int m = 0; m < n; ++m) {
+			double node = std::cos(PI * (m + 0.5) / n);
+			source((int)body, t0 + half * (node + 1.0), samples[m], samples[n + m], samples[2 * n + m]);
+		}
+
+		// Transformada coseno: c_j = (2/n) sum f(x_m) T_j(x_m), con c_0 a la mitad
+		double* c = coefficients.data() + (b.offset - dataStart) / sizeof(double) + k * 3 * n;
+		for (int axis = 0; axis < 3; ++axis) {
+			for (int j = 0; j < n; ++j) {
+				double sum = 0.0;
+				for (int m = 0; m < n; ++m) sum += samples[axis * n + m] * std::cos(PI * j * (m + 0.5) / n);
+				c[axis * n + j] = (j == 0 ? 1.0 : 2.0) * sum / n;
+			}
+		}
+
+		// Error entre nodos
+		double worst = 0.0;
+		for (int s = 0; s < ERROR_SAMPLES; ++s) {
+			double tau = -1.0 + 2.0 * (s + 0.5) / ERROR_SAMPLES;
+			double x, y, z;
+			source((int)body, t0 + half * (tau + 1.0), x, y, z);
+			double dx = ChebyshevEphemeris::clenshaw(c, n, tau) - x;
+			double dy = ChebyshevEphemeris::clenshaw(c + n, n, tau) - y;
+			double dz = ChebyshevEphemeris::clenshaw(c + 2 * n, n, tau) - z;
+			worst = std::max(worst, std::sqrt(dx * dx + dy * dy + dz * dz));
+		}
+		taskError[task] = worst;
+	});
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)index.data(), index.size() * sizeof(ChebyshevBodyIndex));
+	out.write((const char*)coefficients.data(), coefficients.size() * sizeof(double));
+	if (!out) return false;
+
+	if (report) {
+		report->intervals = firstTask.back();
+		report->bytes = (size_t)offset;
+		report->maxError = taskError.empty() ? 0.0 : *std::max_element(taskError.begin(), taskError.end());
+	}
+	return true;
+}
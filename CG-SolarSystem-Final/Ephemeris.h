@@ -0,0 +1,292 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#include "JulianDate.h"
+#include "SimdMath.h"
+
+/**
+ * Elementos keplerianos con variación secular lineal (formato de JPL "Approximate
+ * Positions of the Planets", E. M. Standish). Ángulos en grados, distancias en UA,
+ * tasas por siglo juliano desde J2000. Eclíptica y equinoccio de J2000.
+ */
+struct KeplerElements {
+	double a, e, I, L, varpi, Omega;                           // Semieje, excentricidad, inclinación, longitud media, long. del perihelio, long. del nodo
+	double aRate, eRate, IRate, LRate, varpiRate, OmegaRate;   // Tasas por siglo
+
+	/**
+	 * Construye elementos a partir de elementos clásicos en una época (formato MPC/SBDB).
+	 * La tasa de la longitud media se obtiene de la tercera ley de Kepler.
+	 *
+	 * @param a       Semieje mayor (UA)
+	 * @param e       Excentricidad
+	 * @param i       Inclinación (grados)
+	 * @param node    Longitud del nodo ascendente Ω (grados)
+	 * @param peri    Argumento del perihelio ω (grados)
+	 * @param M       Anomalía media en la época (grados)
+	 * @param epochJD Época de los elementos (fecha juliana)
+	 */
+	static KeplerElements fromClassical(double a, double e, double i, double node, double peri, double M, double epochJD) {
+		const double GAUSS_DEG_PER_DAY = 0.9856076686;  // Movimiento medio de 1 UA (grados/día)
+		double n = GAUSS_DEG_PER_DAY / (a * std::sqrt(a));
+		double varpi = node + peri;
+		double L = M + varpi - n * (epochJD - JD_J2000);  // Longitud media llevada a J2000
+		return { a, e, i, L, varpi, node, 0.0, 0.0, 0.0, n * 36525.0, 0.0, 0.0 };
+	}
+};
+
+/**
+ * Elementos de los ocho planetas, Tabla 1 de Standish (válidos 1800-2050).
+ * El tercer registro es el baricentro Tierra-Luna.
+ */
+const KeplerElements PLANET_ELEMENTS[8] = {
+	// a             e            I             L               varpi          Omega
+	{ 0.38709927,  0.20563593,  7.00497902,  252.25032350,  77.45779628,   48.33076593,
+	  0.00000037,  0.00001906, -0.00594749, 149472.67411175, 0.16047689,  -0.12534081 },  // Mercurio
+	{ 0.72333566,  0.00677672,  3.39467605,  181.97909950, 131.60246718,   76.67984255,
+	  0.00000390, -0.00004107, -0.00078890,  58517.81538729, 0.00268329,  -0.27769418 },  // Venus
+	{ 1.00000261,  0.01671123, -0.00001531,  100.46457166, 102.93768193,    0.0,
+	  0.00000562, -0.00004392, -0.01294668,  35999.37244981, 0.32327364,   0.0 },         // Tierra (baricentro Tierra-Luna)
+	{ 1.52371034,  0.09339410,  1.84969142,   -4.55343205, -23.94362959,   49.55953891,
+	  0.00001847,  0.00007882, -0.00813131,  19140.30268499, 0.44441088,  -0.29257343 },  // Marte
+	{ 5.20288700,  0.04838624,  1.30439695,   34.39644051,  14.72847983,  100.47390909,
+	 -0.00011607, -0.00013253, -0.00183714,   3034.74612775, 0.21252668,   0.20469106 },  // Júpiter
+	{ 9.53667594,  0.05386179,  2.48599187,   49.95424423,  92.59887831,  113.66242448,
+	 -0.00125060, -0.00050991,  0.00193609,   1222.49362201, -0.41897216, -0.28867794 },  // Saturno
+	{ 19.18916464, 0.04725744,  0.77263783,  313.23810451, 170.95427630,   74.01692503,
+	 -0.00196176, -0.00004397, -0.00242939,    428.48202785, 0.40805281,   0.04240589 },  // Urano
+	{ 30.06992276, 0.00859048,  1.77004347,  -55.12002969,  44.96476227,  131.78422574,
+	  0.00026291,  0.00005105,  0.00035372,    218.45945325, -0.32241464, -0.00508664 }   // Neptuno
+};
+
+// Nombres de los planetas en el orden de PLANET_ELEMENTS (los mismos que usa la escena)
+const char* const PLANET_NAMES[8] = { "Mercurio", "Venus", "Tierra", "Marte", "Jupiter", "Saturno", "Urano", "Neptuno" };
+
+/**
+ * Motor de efemérides keplerianas para un número arbitrario de cuerpos.
+ *
+ * Los elementos se guardan en formato SoA (un arreglo por campo) con relleno hasta
+ * múltiplo de BLOCK. evaluate() resuelve la ecuación de Kepler de BLOCK cuerpos a la
+ * vez con un núcleo sin saltos ni llamadas a libm (seno/coseno polinomiales y un número
+ * fijo de iteraciones de Newton) escrito sobre VDouble (AVX2, SSE2 o NEON según la
+ * compilación). evaluateScalar() es la versión de referencia con std::sin/cos.
+ */
+class Ephemeris
+{
+public:
+	static const int BLOCK = 8;               // Cuerpos por bloque del núcleo
+	static const int KEPLER_ITERATIONS = 8;   // Iteraciones de Newton (excentricidades < 0.97)
+
+	/**
+	 * Agrega un cuerpo.
+	 *
+	 * @param el Elementos orbitales
+	 * @return   Índice del cuerpo
+	 */
+	int addBody(const KeplerElements& el) {
+		if (count == padded) grow();
+		set(count, el);
+		return count++;
+	}
+
+	/** Agrega los ocho planetas en el orden del catálogo (Mercurio..Neptuno). */
+	void addPlanets() {
+		for (const KeplerElements& el : PLANET_ELEMENTS) addBody(el);
+	}
+
+	/** Reserva memoria para n cuerpos (evita copias al agregar catálogos grandes). */
+	void reserve(int n) {
+		size_t blocks = (size_t)(n + BLOCK - 1) / BLOCK * BLOCK;
+		for (std::vector<double>* v : { &a0, &e0, &I0, &L0, &w0, &O0, &aR, &eR, &IR, &LR, &wR, &OR }) {
+			v->reserve(blocks);
+		}
+	}
+
+	int bodyCount() const { return count; }
+
+	/** Tamaño que deben tener los arreglos de salida de evaluate() (múltiplo de BLOCK). */
+	size_t paddedCount() const { return (size_t)padded; }
+
+	/** Elementos del cuerpo i (reconstruidos desde el almacenamiento SoA). */
+	KeplerElements elements(int i) const {
+		return { a0[i], e0[i], I0[i], L0[i], w0[i], O0[i], aR[i], eR[i], IR[i], LR[i], wR[i], OR[i] };
+	}
+
+	/**
+	 * Posiciones heliocéntricas eclípticas (UA) de todos los cuerpos, núcleo por bloques.
+	 *
+	 * @param jd Fecha juliana
+	 * @param x  Salida X (paddedCount() elementos)
+	 * @param y  Salida Y
+	 * @param z  Salida Z
+	 */
+	void evaluate(double jd, double* x, double* y, double* z) const {
+		evaluateBlocks(jd, 0, padded / BLOCK, x, y, z);
+	}
+
+	/**
+	 * Igual que evaluate() para los bloques [firstBlock, endBlock), para repartir catálogos
+	 * grandes entre hilos. Cada bloque escribe solo sus BLOCK posiciones de las salidas.
+	 */
+	void evaluateBlocks(double jd, int firstBlock, int endBlock, double* x, double* y, double* z) const {
+		const double T = (jd - JD_J2000) / 36525.0;
+		for (int base = firstBlock * BLOCK; base < endBlock * BLOCK; base += BLOCK) {
+			solveBlock(base, T, x + base, y + base, z + base);
+		}
+	}
+
+	/**
+	 * Versión escalar de referencia de evaluate() (std::sin/cos, Newton hasta converger).
+	 */
+	void evaluateScalar(double jd, double* x, double* y, double* z) const {
+		const double T = (jd - JD_J2000) / 36525.0;
+		for (int i = 0; i < count; ++i) {
+			solveScalar(i, T, x[i], y[i], z[i]);
+		}
+	}
+
+	/**
+	 * Posición de un solo cuerpo (camino escalar).
+	 */
+	void evaluateBody(int i, double jd, double& x, double& y, double& z) const {
+		solveScalar(i, (jd - JD_J2000) / 36525.0, x, y, z);
+	}
+
+	/**
+	 * Trayectoria orbital completa de un cuerpo (elipse osculadora en la fecha dada).
+	 *
+	 * @param i        Índice del cuerpo
+	 * @param jd       Fecha para los elementos
+	 * @param segments Número de segmentos de la polilínea
+	 * @param out      Salida: segments + 1 puntos (x, y, z) en UA
+	 */
+	void orbitPath(int i, double jd, int segments, std::vector<double>& out) const {
+		const double T = (jd - JD_J2000) / 36525.0;
+		double a, e, I, M, w, O;
+		elementsAt(i, T, a, e, I, M, w, O);
+		out.clear();
+		for (int s = 0; s <= segments; ++s) {
+			double E = 2.0 * PI * s / segments;  // Muestreo uniforme en anomalía excéntrica
+			double px, py, pz;
+			toEcliptic(a, e, I, w, O, std::cos(E), std::sin(E), px, py, pz);
+			out.push_back(px);
+			out.push_back(py);
+			out.push_back(pz);
+		}
+	}
+
+private:
+	static constexpr double PI = 3.14159265358979323846;
+	static constexpr double DEG = PI / 180.0;
+
+	int count = 0;
+	int padded = 0;
+	// Elementos en J2000 y tasas por siglo, formato SoA
+	std::vector<double> a0, e0, I0, L0, w0, O0;
+	std::vector<double> aR, eR, IR, LR, wR, OR;
+
+	/** Amplía el almacenamiento en un bloque, rellenando con órbitas circulares inofensivas. */
+	void grow() {
+		padded += BLOCK;
+		for (std::vector<double>* v : { &a0, &e0, &I0, &L0, &w0, &O0, &aR, &eR, &IR, &LR, &wR, &OR }) {
+			v->resize(padded, 0.0);
+		}
+		for (int i = padded - BLOCK; i < padded; ++i) a0[i] = 1.0;
+	}
+
+	void set(int i, const KeplerElements& el) {
+		a0[i] = el.a; e0[i] = el.e; I0[i] = el.I; L0[i] = el.L; w0[i] = el.varpi; O0[i] = el.Omega;
+		aR[i] = el.aRate; eR[i] = el.eRate; IR[i] = el.IRate; LR[i] = el.LRate; wR[i] = el.varpiRate; OR[i] = el.OmegaRate;
+	}
+
+	/** Elementos en el instante T (siglos desde J2000); ángulos en radianes, M en [-π, π). */
+	void elementsAt(int i, double T, double& a, double& e, double& I, double& M, double& w, double& O) const {
+		a = a0[i] + aR[i] * T;
+		e = e0[i] + eR[i] * T;
+		I = (I0[i] + IR[i] * T) * DEG;
+		double L = L0[i] + LR[i] * T;
+		double varpi = w0[i] + wR[i] * T;
+		O = (O0[i] + OR[i] * T) * DEG;
+		w = varpi * DEG - O;                        // Argumento del perihelio ω = ϖ - Ω
+		double Mdeg = L - varpi;                    // Anomalía media M = L - ϖ
+		Mdeg -= 360.0 * std::floor((Mdeg + 180.0) / 360.0);
+		M = Mdeg * DEG;
+	}
+
+	/** Rota la posición en el plano orbital al sistema eclíptico (JPL, ecuación 8.34 de la guía). */
+	static inline void toEcliptic(double a, double e, double I, double w, double O,
+		double cosE, double sinE, double& x, double& y, double& z) {
+		double xp = a * (cosE - e);
+		double yp = a * std::sqrt(1.0 - e * e) * sinE;
+		double cw = std::cos(w), sw = std::sin(w);
+		double cO = std::cos(O), sO = std::sin(O);
+		double cI = std::cos(I), sI = std::sin(I);
+		x = (cw * cO - sw * sO * cI) * xp + (-sw * cO - cw * sO * cI) * yp;
+		y = (cw * sO + sw * cO * cI) * xp + (-sw * sO + cw * cO * cI) * yp;
+		z = (sw * sI) * xp + (cw * sI) * yp;
+	}
+
+	/** Resuelve un cuerpo con funciones de libm, iterando hasta la convergencia. */
+	void solveScalar(int i, double T, double& x, double& y, double& z) const {
+		double a, e, I, M, w, O;
+		elementsAt(i, T, a, e, I, M, w, O);
+		double E = M + e * std::sin(M);
+		for (int it = 0; it < 50; ++it) {
+			double dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+			E -= dE;
+			if (std::fabs(dE) < 1e-14) break;
+		}
+		toEcliptic(a, e, I, w, O, std::cos(E), std::sin(E), x, y, z);
+	}
+
+	/**
+	 * Núcleo por bloques: BLOCK cuerpos desde base, VDouble::WIDTH carriles por instrucción.
+	 * Sin llamadas a libm ni saltos dependientes de los datos.
+	 */
+	void solveBlock(int base, double T, double* x, double* y, double* z) const {
+		const VDouble vT = VDouble::set1(T);
+		const VDouble deg = VDouble::set1(DEG);
+		const VDouble one = VDouble::set1(1.0);
+		const VDouble zero = VDouble::set1(0.0);
+
+		for (int l = base; l < base + BLOCK; l += VDouble::WIDTH) {
+			// Elementos en T
+			VDouble a = VDouble::load(&a0[l]) + VDouble::load(&aR[l]) * vT;
+			VDouble e = VDouble::load(&e0[l]) + VDouble::load(&eR[l]) * vT;
+			VDouble I = (VDouble::load(&I0[l]) + VDouble::load(&IR[l]) * vT) * deg;
+			VDouble L = VDouble::load(&L0[l]) + VDouble::load(&LR[l]) * vT;
+			VDouble varpi = VDouble::load(&w0[l]) + VDouble::load(&wR[l]) * vT;
+			VDouble O = (VDouble::load(&O0[l]) + VDouble::load(&OR[l]) * vT) * deg;
+			VDouble w = varpi * deg - O;
+
+			// Anomalía media reducida a [-π, π)
+			VDouble Mdeg = L - varpi;
+			Mdeg = Mdeg - VDouble::set1(360.0) * floor((Mdeg + VDouble::set1(180.0)) * VDouble::set1(1.0 / 360.0));
+			VDouble M = Mdeg * deg;
+
+			// Valor inicial de Danby: converge para toda excentricidad elíptica
+			VDouble E = M + select(cmpGe(M, zero), e, zero - e) * VDouble::set1(0.85);
+
+			// Newton con número fijo de iteraciones
+			VDouble sE, cE;
+			for (int it = 0; it < KEPLER_ITERATIONS; ++it) {
+				sinCos(E, sE, cE);
+				E = E - (E - e * sE - M) / (one - e * cE);
+			}
+			sinCos(E, sE, cE);
+
+			// Plano orbital -> eclíptica
+			VDouble sw, cw, sO, cO, sI, cI;
+			sinCos(w, sw, cw);
+			sinCos(O, sO, cO);
+			sinCos(I, sI, cI);
+			VDouble xp = a * (cE - e);
+			VDouble yp = a * sqrt(one - e * e) * sE;
+			(((cw * cO) - (sw * sO * cI)) * xp + (zero - sw * cO - cw * sO * cI) * yp).store(&x[l - base]);
+			(((cw * sO) + (sw * cO * cI)) * xp + (cw * cO * cI - sw * sO) * yp).store(&y[l - base]);
+			((sw * sI) * xp + (cw * sI) * yp).store(&z[l - base]);
+		}
+	}
+};
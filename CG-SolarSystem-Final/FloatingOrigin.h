@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+
+/**
+ * Origen flotante para dibujar el sistema solar a escala real.
+ *
+ * Un float tiene 24 bits de mantisa: a 30 UA del Sol su resolución es de unos 270 km, más que
+ * el radio de la Luna. Por eso las posiciones del mundo se guardan en doble precisión en la CPU
+ * y en cada frame se restan de la posición de la cámara, también en doble, antes de pasarlas a
+ * float. Lo que queda cerca de la cámara conserva toda la precisión; lo lejano pierde precisión
+ * en proporción a su distancia, que es justo lo que no se nota en pantalla.
+ *
+ * Los vértices estáticos (órbitas) no se pueden rehacer en cada frame: se guardan como dos floats
+ * (parte alta y parte baja del double) y el shader resta la cámara, también partida, en cada
+ * mitad por separado (técnica "relative to eye").
+ */
+class FloatingOrigin {
+public:
+	/** Posición de la cámara en el mundo (doble precisión); pasa a ser el origen del frame. */
+	void setOrigin(const glm::dvec3& cameraPosition) {
+		origin = cameraPosition;
+		split(origin, originHigh, originLow);
+	}
+
+	const glm::dvec3& position() const { return origin; }
+
+	/** Posición relativa a la cámara, lista para una matriz de modelo en float. */
+	glm::vec3 toLocal(const glm::dvec3& world) const {
+		return glm::vec3(world - origin);
+	}
+
+	/**
+	 * Convierte un lote de posiciones del mundo a posiciones relativas a la cámara.
+	 *
+	 * @param world Posiciones del mundo (doble precisión)
+	 * @param out   Posiciones relativas en float (se redimensiona)
+	 */
+	void toLocal(const std::vector<glm::dvec3>& world, std::vector<glm::vec3>& out) const {
+		out.resize(world.size());
+		for (size_t i = 0; i < world.size(); ++i) out[i] = glm::vec3(world[i] - origin);
+	}
+
+	/** Mitades alta y baja del origen para los uniforms cameraHigh/cameraLow del shader de órbitas. */
+	const glm::vec3& high() const { return originHigh; }
+	const glm::vec3& low() const { return originLow; }
+
+	/**
+	 * Parte un vector double en dos float cuya suma lo representa con unos 48 bits de mantisa.
+	 *
+	 * @param p    Vector en doble precisión
+	 * @param high Parte alta (p redondeado a float)
+	 * @param low  Resto que se pierde al redondear
+	 */
+	static void split(const glm::dvec3& p, glm::vec3& high, glm::vec3& low) {
+		high = glm::vec3(p);
+		low = glm::vec3(p - glm::dvec3(high));
+	}
+
+private:
+	glm::dvec3 origin = glm::dvec3(0.0);
+	glm::vec3 originHigh = glm::vec3(0.0f), originLow = glm::vec3(0.0f);
+};
+
+/**
+ * Proyección en perspectiva con profundidad invertida y plano lejano en el infinito.
+ * Con glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE) la profundidad queda en near / distancia:
+ * 1 en el plano cercano y 0 en el infinito. El exponente del float depth buffer compensa la
+ * división, así el error relativo es casi constante desde el plano cercano hasta Neptuno.
+ *
+ * @param fovy        Campo de visión vertical (radianes)
+ * @param aspect      Relación de aspecto ancho/alto
+ * @param nearPlane   Distancia al plano cercano
+ */
+inline glm::mat4 reversedInfinitePerspective(float fovy, float aspect, float nearPlane) {
+	float f = 1.0f / std::tan(fovy * 0.5f);
+	glm::mat4 m(0.0f);
+	m[0][0] = f / aspect;
+	m[1][1] = f;
+	m[2][3] = -1.0f;      // w = distancia a la cámara
+	m[3][2] = nearPlane;  // z = near, z/w = near / distancia
+	return m;
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// ===========================================
+// MEMORIA POR FRAME Y CONTADOR DE ASIGNACIONES
+// ===========================================
+// En régimen estable el loop principal no debería pedir memoria al heap: los datos que viven un
+// solo frame salen de una arena lineal que se vacía al comenzar el siguiente, y los contenedores
+// que duran más conservan su capacidad entre frames. Para comprobarlo se cuentan todas las
+// asignaciones: las de new/delete con un reemplazo global de todas las formas de operator new
+// (se define en un solo archivo, con FRAME_ARENA_IMPLEMENTATION antes del include; las de
+// alineación extendida solo existen desde C++17) y las de ImGui con sus funciones
+// de asignación (ImGui::SetAllocatorFunctions). Lo que se pide con malloc directamente (GLFW,
+// el controlador de GL, stb_image) no se cuenta. --bench-replay informa cuántos frames de la
+// reproducción asignaron y cuál fue el último, para comprobarlo en el loop real.
+
+/** Asignaciones acumuladas desde el comienzo del programa. */
+struct AllocationCounters {
+	std::atomic<uint64_t> count{ 0 };
+	std::atomic<uint64_t> bytes{ 0 };
+};
+
+/** Asignaciones de todo el proceso (todos los hilos, new y ImGui). */
+inline AllocationCounters& processAllocations() {
+	static AllocationCounters counters;
+	return counters;
+}
+
+/** Asignaciones hechas por ImGui (incluidas también en processAllocations()). */
+inline AllocationCounters& imguiAllocations() {
+	static AllocationCounters counters;
+	return counters;
+}
+
+/** Asignaciones del hilo actual: cantidad y bytes. Sin atómicos, solo las lee el mismo hilo. */
+struct ThreadAllocations {
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+};
+
+inline ThreadAllocations& threadAllocations() {
+	static thread_local ThreadAllocations counters;
+	return counters;
+}
+
+/**
+ * Registra una asignación en los contadores del proceso y del hilo actual.
+ *
+ * @param size Bytes pedidos
+ */
+inline void countAllocation(size_t size) {
+	AllocationCounters& process = processAllocations();
+	process.count.fetch_add(1, std::memory_order_relaxed);
+	process.bytes.fetch_add(size, std::memory_order_relaxed);
+	ThreadAllocations& thread = threadAllocations();
+	++thread.count;
+	thread.bytes += size;
+}
+
+/** Asignador de ImGui (ImGui::SetAllocatorFunctions): malloc con registro. */
+inline void* trackedImGuiAlloc(size_t size, void* /*userData*/) {
+	countAllocation(size);
+	AllocationCounters& imgui = imguiAllocations();
+	imgui.count.fetch_add(1, std::memory_order_relaxed);
+	imgui.bytes.fetch_add(size, std::memory_order_relaxed);
+	return std::malloc(size);
+}
+
+inline void trackedImGuiFree(void* ptr, void* /*userData*/) {
+	std::free(ptr);
+}
+
+/**
+ * Asignaciones del hilo actual en cada frame: se marca el comienzo y el final, y se guarda lo
+ * ocurrido entre los dos y la racha de frames seguidos sin asignar.
+ */
+struct FrameAllocationStats
+{
+	uint64_t frameCount = 0;        // Asignaciones del último frame
+	uint64_t frameBytes = 0;
+	uint64_t imguiCount = 0;        // De ellas, las de ImGui
+	uint64_t processCount = 0;      // Asignaciones de todo el proceso en el mismo intervalo
+	uint64_t peakCount = 0;         // Máximo de asignaciones por frame en la última ventana de ~1 s
+	int cleanFrames = 0;            // Frames seguidos sin asignaciones en este hilo
+
+	/** Comienzo del frame (después de esperar eventos, así el reposo no cuenta). */
+	void beginFrame() {
+		start = threadAllocations();
+		imguiStart = imguiAllocations().count.load(std::memory_order_relaxed);
+		processStart = processAllocations().count.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Final del frame.
+	 *
+	 * @param now Tiempo actual (glfwGetTime), para la ventana del máximo
+	 */
+	void endFrame(double now) {
+		const ThreadAllocations& end = threadAllocations();
+		frameCount = end.count - start.count;
+		frameBytes = end.bytes - start.bytes;
+		imguiCount = imguiAllocations().count.load(std::memory_order_relaxed) - imguiStart;
+		processCount = processAllocations().count.load(std::memory_order_relaxed) - processStart;
+		cleanFrames = frameCount == 0 ? cleanFrames + 1 : 0;
+
+		if (windowStart < 0.0 || now - windowStart >= 1.0) {
+			peakCount = windowPeak;
+			windowPeak = 0;
+			windowStart = now;
+		}
+		if (frameCount > windowPeak) windowPeak = frameCount;
+	}
+
+private:
+	ThreadAllocations start;
+	uint64_t imguiStart = 0;
+	uint64_t processStart = 0;
+	uint64_t windowPeak = 0;
+	double windowStart = -1.0;
+};
+
+/**
+ * Arena lineal para datos que viven un solo frame (listas de rangos, textos formateados).
+ *
+ * Reservar es avanzar un puntero; no hay liberación individual: reset() descarta todo al
+ * comenzar el frame siguiente. Si un frame pide más que la capacidad, el excedente sale de
+ * bloques adicionales del heap y en el reset() siguiente el bloque principal crece hasta cubrir
+ * el máximo usado, así en régimen estable no se vuelve a asignar. Solo para tipos triviales: los
+ * destructores no se llaman.
+ */
+class FrameArena
+{
+public:
+	static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+	explicit FrameArena(size_t capacity = DEFAULT_CAPACITY) { grow(capacity); }
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	/** Descarta lo reservado en el frame anterior (los punteros dejan de ser válidos). */
+	void reset() {
+		if (!overflow.empty()) {
+			overflow.clear();
+			size_t needed = blockCapacity;
+			while (needed < peakUsed) needed *= 2;
+			grow(needed);
+		}
+		lastUsed = frameUsed;
+		used = 0;
+		frameUsed = 0;
+	}
+
+	/**
+	 * Reserva memoria sin inicializar hasta el próximo reset().
+	 *
+	 * @param size  Bytes
+	 * @param align Alineación (potencia de 2)
+	 */
+	void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+		uintptr_t base = (uintptr_t)block.get();
+		uintptr_t aligned = (base + used + align - 1) & ~(uintptr_t)(align - 1);
+		size_t end = (size_t)(aligned - base) + size;
+		frameUsed += size + align - 1;  // Cota de lo que habría ocupado en un solo bloque
+		if (frameUsed > peakUsed) peakUsed = frameUsed;
+		if (end <= blockCapacity) {
+			used = end;
+			return (void*)aligned;
+		}
+		// Desborde: bloque propio hasta el reset(), que agranda el principal
+		++overflowCount;
+		overflow.emplace_back(new unsigned char[size + align]);
+		uintptr_t extra = (uintptr_t)overflow.back().get();
+		return (void*)((extra + align - 1) & ~(uintptr_t)(align - 1));
+	}
+
+	/**
+	 * Reserva un arreglo sin inicializar.
+	 *
+	 * @param count Elementos
+	 */
+	template <typename T>
+	T* allocateArray(size_t count) {
+		static_assert(std::is_trivially_destructible<T>::value, "FrameArena no llama destructores");
+		return (T*)allocate(count * sizeof(T), alignof(T));
+	}
+
+	/**
+	 * Texto con formato de printf, válido hasta el próximo reset().
+	 *
+	 * @param format Formato de printf
+	 */
+	const char* format(const char* format, ...) {
+		va_list args, copy;
+		va_start(args, format);
+		va_copy(copy, args);
+		int length = std::vsnprintf(nullptr, 0, format, copy);
+		va_end(copy);
+		if (length < 0) length = 0;
+		char* text = (char*)allocate((size_t)length + 1, 1);
+		std::vsnprintf(text, (size_t)length + 1, format, args);
+		va_end(args);
+		return text;
+	}
+
+	/** Bytes reservados en el frame anterior (con el relleno de alineación). */
+	size_t lastFrameBytes() const { return lastUsed; }
+	/** Capacidad del bloque principal. */
+	size_t capacity() const { return blockCapacity; }
+	/** Máximo usado en un frame desde el comienzo. */
+	size_t peakBytes() const { return peakUsed; }
+	/** Reservas que no entraron en el bloque principal desde el comienzo. */
+	int overflows() const { return overflowCount; }
+
+private:
+	std::unique_ptr<unsigned char[]> block;
+	size_t blockCapacity = 0;
+	size_t used = 0;
+	size_t frameUsed = 0;
+	size_t lastUsed = 0;
+	size_t peakUsed = 0;
+	int overflowCount = 0;
+	std::vector<std::unique_ptr<unsigned char[]>> overflow;
+
+	void grow(size_t capacity) {
+		block.reset(new unsigned char[capacity]);
+		blockCapacity = capacity;
+		overflow.reserve(8);
+	}
+};
+
+#ifdef FRAME_ARENA_IMPLEMENTATION
+// Reemplazo global de operator new/delete: malloc y free con registro. Se definen todas las
+// formas (simple y de arreglo, nothrow, con tamaño y, si el compilador las tiene, con
+// alineación) en lugar de confiar en que las de la biblioteca estándar terminen en la simple.
+// GCC ve free() después de operator new al expandirlas en línea y avisa de un par que no es tal.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+/** Asignación registrada; con nothrow devuelve nullptr en lugar de lanzar bad_alloc. */
+static void* trackedNew(std::size_t size, bool nothrow) {
+	countAllocation(size);
+	if (size == 0) size = 1;
+	for (;;) {
+		if (void* ptr = std::malloc(size)) return ptr;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			if (nothrow) return nullptr;
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new(std::size_t size) { return trackedNew(size, false); }
+void* operator new[](std::size_t size) { return trackedNew(size, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try { return trackedNew(size, true); } catch (...) { return nullptr; }  // El new_handler puede lanzar
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	try { return trackedNew(size, true); } catch (...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+#ifdef __cpp_aligned_new
+#ifdef _WIN32
+#include <malloc.h>  // _aligned_malloc
+#endif
+// Tipos sobrealineados (C++17): memoria alineada del sistema, también registrada
+static void* trackedAlignedNew(std::size_t size, std::align_val_t align, bool nothrow) {
+	countAllocation(size);
+	size_t alignment = (size_t)align;
+	if (size == 0) size = 1;
+	for (;;) {
+#ifdef _WIN32
+		void* ptr = _aligned_malloc(size, alignment);
+#else
+		void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);  // Múltiplo de la alineación
+#endif
+		if (ptr) return ptr;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			if (nothrow) return nullptr;
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+static void trackedAlignedDelete(void* ptr) {
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+void* operator new(std::size_t size, std::align_val_t align) { return trackedAlignedNew(size, align, false); }
+void* operator new[](std::size_t size, std::align_val_t align) { return trackedAlignedNew(size, align, false); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+	try { return trackedAlignedNew(size, align, true); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+	try { return trackedAlignedNew(size, align, true); } catch (...) { return nullptr; }
+}
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedAlignedDelete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedAlignedDelete(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedDelete(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedDelete(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedDelete(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedDelete(ptr); }
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif
@@ -0,0 +1,576 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Codificador PNG mínimo para los cuadros grabados (RGB de 8 bits).
+ *
+ * Cada fila se filtra con el filtro de PNG que deja la menor suma de diferencias (None, Sub,
+ * Up o Paeth) y el resultado se comprime con deflate: LZ77 con cadenas de hash y códigos de
+ * Huffman fijos. Las escenas son sobre todo fondo negro y zonas lisas, donde las repeticiones
+ * largas pesan mucho más que los códigos dinámicos. Las tablas de trabajo se conservan entre
+ * cuadros, así que cada hilo usa su propio codificador.
+ */
+class PngEncoder
+{
+public:
+	/**
+	 * Codifica una imagen RGBA con las filas de abajo hacia arriba (como las devuelve
+	 * glReadPixels) como PNG RGB con las filas de arriba hacia abajo.
+	 *
+	 * @param rgba   Píxeles RGBA, width * 4 bytes por fila
+	 * @param width  Ancho en píxeles
+	 * @param height Alto en píxeles
+	 * @param out    Salida: archivo PNG completo (se reemplaza)
+	 */
+	void encode(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& out) {
+		const size_t rowBytes = (size_t)width * 3;
+		filtered.resize((rowBytes + 1) * height);
+		current.resize(rowBytes);
+		previous.assign(rowBytes, 0);
+		candidate.resize(rowBytes);
+		for (int y = 0; y < height; ++y) {
+			const unsigned char* src = rgba + (size_t)(height - 1 - y) * width * 4;
+			for (int x = 0; x < width; ++x) {
+				current[3 * x] = src[4 * x];
+				current[3 * x + 1] = src[4 * x + 1];
+				current[3 * x + 2] = src[4 * x + 2];
+			}
+			filterRow(&filtered[(rowBytes + 1) * y], rowBytes);
+			current.swap(previous);
+		}
+
+		out.clear();
+		static const unsigned char SIGNATURE[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+		out.insert(out.end(), SIGNATURE, SIGNATURE + 8);
+		unsigned char header[13];
+		putBigEndian(header, (uint32_t)width);
+		putBigEndian(header + 4, (uint32_t)height);
+		header[8] = 8;   // Bits por canal
+		header[9] = 2;   // Color RGB
+		header[10] = header[11] = header[12] = 0;  // Deflate, filtros por fila, sin entrelazado
+		writeChunk(out, "IHDR", header, 13);
+
+		// IDAT: el chunk se escribe en su lugar para no copiar el flujo comprimido
+		size_t chunkStart = out.size();
+		out.resize(chunkStart + 8);
+		std::memcpy(&out[chunkStart + 4], "IDAT", 4);
+		deflate(filtered.data(), filtered.size(), out);
+		putBigEndian(&out[chunkStart], (uint32_t)(out.size() - chunkStart - 8));
+		unsigned char crc[4];
+		putBigEndian(crc, crc32(&out[chunkStart + 4], out.size() - chunkStart - 4));
+		out.insert(out.end(), crc, crc + 4);
+
+		writeChunk(out, "IEND", nullptr, 0);
+	}
+
+private:
+	static const int WINDOW = 32768;      // Distancia máxima de deflate
+	static const int HASH_BITS = 15;
+	static const int MAX_CHAIN = 32;      // Candidatos revisados por posición
+	static const int MIN_MATCH = 3;
+	static const int MAX_MATCH = 258;
+
+	std::vector<unsigned char> filtered, current, previous, candidate;
+	std::vector<int> head, chain;
+
+	// Escritura de bits de deflate (el primer bit es el menos significativo)
+	std::vector<unsigned char>* bitsOut = nullptr;
+	uint32_t bitBuffer = 0;
+	int bitCount = 0;
+
+	static void putBigEndian(unsigned char* p, uint32_t v) {
+		p[0] = (unsigned char)(v >> 24); p[1] = (unsigned char)(v >> 16);
+		p[2] = (unsigned char)(v >> 8);  p[3] = (unsigned char)v;
+	}
+
+	static uint32_t crc32(const unsigned char* data, size_t size) {
+		// Tabla creada una vez; la inicialización de un static local es segura entre hilos
+		struct Table {
+			uint32_t entry[256];
+			Table() {
+				for (uint32_t n = 0; n < 256; ++n) {
+					uint32_t c = n;
+					for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					entry[n] = c;
+				}
+			}
+		};
+		static const Table table;
+		uint32_t c = 0xFFFFFFFFu;
+		for (size_t i = 0; i < size; ++i) c = table.entry[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+		return c ^ 0xFFFFFFFFu;
+	}
+
+	static uint32_t adler32(const unsigned char* data, size_t size) {
+		uint32_t a = 1, b = 0;
+		while (size > 0) {
+			size_t block = std::min<size_t>(size, 5552);  // Máximo sin desbordar antes del módulo
+			size -= block;
+			while (block--) { a += *data++; b += a; }
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	static void writeChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size) {
+		unsigned char length[4];
+		putBigEndian(length, (uint32_t)size);
+		out.insert(out.end(), length, length + 4);
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		if (size > 0) out.insert(out.end(), data, data + size);
+		unsigned char crc[4];
+		putBigEndian(crc, crc32(&out[start], size + 4));
+		out.insert(out.end(), crc, crc + 4);
+	}
+
+	/** Predictor de Paeth sin ramas (selecciones que el compilador puede vectorizar). */
+	static int paeth(int a, int b, int c) {
+		int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+		int bc = pb <= pc ? b : c;
+		return pa <= pb && pa <= pc ? a : bc;
+	}
+
+	/** Aplica un filtro de PNG a la fila y devuelve su costo (suma de los bytes como enteros con signo). */
+	template <int TYPE>
+	static size_t applyFilter(const unsigned char* cur, const unsigned char* up, unsigned char* out, size_t rowBytes) {
+		const size_t BPP = 3;
+		unsigned cost = 0;
+		// El primer píxel no tiene vecino izquierdo; el resto del bucle queda sin ramas
+		for (size_t i = 0; i < BPP && i < rowBytes; ++i) {
+			int predictor = TYPE == 0 || TYPE == 1 ? 0 : up[i];  // Paeth con a = c = 0 es b
+			unsigned char v = (unsigned char)(cur[i] - predictor);
+			out[i] = v;
+			cost += v < 128 ? v : 256 - v;
+		}
+		for (size_t i = BPP; i < rowBytes; ++i) {
+			int predictor = TYPE == 0 ? 0 : TYPE == 1 ? cur[i - BPP] : TYPE == 2 ? up[i] : paeth(cur[i - BPP], up[i], up[i - BPP]);
+			unsigned char v = (unsigned char)(cur[i] - predictor);
+			out[i] = v;
+			cost += v < 128 ? v : 256u - v;
+		}
+		return cost;
+	}
+
+	/**
+	 * Filtra current (con previous como fila de arriba) con el filtro de menor costo (None, Up,
+	 * Sub o Paeth; Average rara vez gana en estas imágenes). Una fila de costo 0, como las de
+	 * fondo negro, no prueba los demás.
+	 */
+	void filterRow(unsigned char* dst, size_t rowBytes) {
+		const unsigned char* cur = current.data();
+		const unsigned char* up = previous.data();
+		unsigned char* best = dst + 1;
+		unsigned char* trial = candidate.data();
+		dst[0] = 0;
+		size_t bestCost = applyFilter<0>(cur, up, best, rowBytes);
+		const int TYPES[3] = { 2, 1, 4 };  // Up, Sub, Paeth
+		for (int k = 0; k < 3 && bestCost > 0; ++k) {
+			int type = TYPES[k];
+			size_t cost = type == 2 ? applyFilter<2>(cur, up, trial, rowBytes)
+				: type == 1 ? applyFilter<1>(cur, up, trial, rowBytes)
+				: applyFilter<4>(cur, up, trial, rowBytes);
+			if (cost < bestCost) {
+				bestCost = cost;
+				dst[0] = (unsigned char)type;
+				std::memcpy(best, trial, rowBytes);
+			}
+		}
+	}
+
+	void putBits(uint32_t bits, int count) {
+		bitBuffer |= bits << bitCount;
+		bitCount += count;
+		while (bitCount >= 8) {
+			bitsOut->push_back((unsigned char)bitBuffer);
+			bitBuffer >>= 8;
+			bitCount -= 8;
+		}
+	}
+
+	/** Los códigos de Huffman se escriben desde el bit más significativo. */
+	void putCode(uint32_t code, int length) {
+		uint32_t reversed = 0;
+		for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1) << (length - 1 - i);
+		putBits(reversed, length);
+	}
+
+	/** Literal o código de longitud (0-287) con la tabla fija de deflate. */
+	void putSymbol(int symbol) {
+		if (symbol < 144) putCode(0x30 + symbol, 8);
+		else if (symbol < 256) putCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280) putCode(symbol - 256, 7);
+		else putCode(0xC0 + symbol - 280, 8);
+	}
+
+	void putMatch(int length, int distance) {
+		static const int LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const int LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const int DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const int DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		int l = 28;
+		while (LENGTH_BASE[l] > length) --l;
+		putSymbol(257 + l);
+		if (LENGTH_EXTRA[l]) putBits(length - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+		int d = 29;
+		while (DISTANCE_BASE[d] > distance) --d;
+		putCode(d, 5);
+		if (DISTANCE_EXTRA[d]) putBits(distance - DISTANCE_BASE[d], DISTANCE_EXTRA[d]);
+	}
+
+	static uint32_t hash(const unsigned char* p) {
+		uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+		return (v * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	/** Flujo zlib (un solo bloque de Huffman fijo) de data, agregado al final de out. */
+	void deflate(const unsigned char* data, size_t size, std::vector<unsigned char>& out) {
+		out.push_back(0x78);  // Deflate con ventana de 32 KB
+		out.push_back(0x5E);
+		bitsOut = &out;
+		bitBuffer = 0;
+		bitCount = 0;
+		putBits(1, 1);  // Último bloque
+		putBits(1, 2);  // Huffman fijo
+
+		head.assign((size_t)1 << HASH_BITS, -1);
+		chain.resize(WINDOW);
+		const int n = (int)size;
+		int i = 0;
+		while (i < n) {
+			int bestLength = 0, bestDistance = 0;
+			if (i + MIN_MATCH <= n) {
+				uint32_t h = hash(data + i);
+				int maxLength = n - i < MAX_MATCH ? n - i : MAX_MATCH;
+				int remaining = MAX_CHAIN;
+				for (int candidate = head[h]; candidate >= 0 && i - candidate <= WINDOW && remaining-- > 0;
+					candidate = chain[candidate & (WINDOW - 1)]) {
+					if (data[candidate + bestLength] != data[i + bestLength]) continue;
+					int length = 0;
+					while (length < maxLength && data[candidate + length] == data[i + length]) ++length;
+					if (length > bestLength) {
+						bestLength = length;
+						bestDistance = i - candidate;
+						if (length == maxLength) break;
+					}
+				}
+				chain[i & (WINDOW - 1)] = head[h];
+				head[h] = i;
+			}
+			if (bestLength >= MIN_MATCH) {
+				putMatch(bestLength, bestDistance);
+				// Las posiciones dentro de la repetición también entran al hash
+				int end = std::min(i + bestLength, n - MIN_MATCH + 1);
+				for (int j = i + 1; j < end; ++j) {
+					uint32_t h = hash(data + j);
+					chain[j & (WINDOW - 1)] = head[h];
+					head[h] = j;
+				}
+				i += bestLength;
+			}
+			else {
+				putSymbol(data[i]);
+				++i;
+			}
+		}
+		putSymbol(256);  // Fin de bloque
+		if (bitCount > 0) out.push_back((unsigned char)bitBuffer);
+		bitsOut = nullptr;
+
+		unsigned char checksum[4];
+		putBigEndian(checksum, adler32(data, size));
+		out.insert(out.end(), checksum, checksum + 4);
+	}
+};
+
+/**
+ * Convierte RGBA (filas de abajo hacia arriba) a YUV 4:2:0 planar con los coeficientes de
+ * BT.601 en rango limitado, el formato que esperan los Y4M "C420jpeg". El ancho y el alto
+ * deben ser pares; la crominancia promedia cada bloque de 2x2.
+ *
+ * @param rgba   Píxeles RGBA
+ * @param width  Ancho en píxeles (par)
+ * @param height Alto en píxeles (par)
+ * @param out    Salida: width * height * 3 / 2 bytes (Y, luego U, luego V)
+ */
+inline void convertToI420(const unsigned char* rgba, int width, int height, unsigned char* out)
+{
+	unsigned char* yPlane = out;
+	unsigned char* uPlane = out + (size_t)width * height;
+	unsigned char* vPlane = uPlane + (size_t)(width / 2) * (height / 2);
+	for (int y = 0; y < height; y += 2) {
+		const unsigned char* row0 = rgba + (size_t)(height - 1 - y) * width * 4;
+		const unsigned char* row1 = row0 - (size_t)width * 4;
+		unsigned char* y0 = yPlane + (size_t)y * width;
+		unsigned char* y1 = y0 + width;
+		for (int x = 0; x < width; x += 2) {
+			int r = 0, g = 0, b = 0;
+			const unsigned char* quad[4] = { row0 + 4 * x, row0 + 4 * x + 4, row1 + 4 * x, row1 + 4 * x + 4 };
+			unsigned char* luma[4] = { y0 + x, y0 + x + 1, y1 + x, y1 + x + 1 };
+			for (int k = 0; k < 4; ++k) {
+				const unsigned char* p = quad[k];
+				*luma[k] = (unsigned char)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+				r += p[0]; g += p[1]; b += p[2];
+			}
+			r = (r + 2) >> 2; g = (g + 2) >> 2; b = (b + 2) >> 2;
+			size_t c = (size_t)(y / 2) * (width / 2) + x / 2;
+			uPlane[c] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			vPlane[c] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+}
+
+/**
+ * Codificación de cuadros grabados en hilos propios.
+ *
+ * El hilo de render pide un cuadro libre (acquire), copia los píxeles y lo entrega (submit);
+ * no comprime ni escribe nada. Los hilos codificadores toman los cuadros en orden:
+ *  - PNG_SEQUENCE: cada cuadro es un archivo prefijo_000001.png, codificados en paralelo.
+ *  - Y4M_STREAM: cada hilo convierte su cuadro a YUV 4:2:0 y lo escribe cuando le toca, así el
+ *    flujo sale en orden. El destino es un archivo .y4m o, si empieza con '|', la entrada
+ *    estándar de un comando (por ejemplo "|ffmpeg -i - video.mp4").
+ * Hay unos pocos cuadros más que hilos: si la codificación no da abasto, acquire() espera
+ * (se cuenta) en lugar de descartar cuadros.
+ */
+class FrameEncoder
+{
+public:
+	enum Format { PNG_SEQUENCE = 0, Y4M_STREAM = 1 };
+
+	/** Cuadro en vuelo: píxeles RGBA de abajo hacia arriba. */
+	struct Frame {
+		long long index = 0;
+		std::vector<unsigned char> rgba;
+	};
+
+	~FrameEncoder() { finish(); }
+
+	/**
+	 * Abre la salida y lanza los hilos.
+	 *
+	 * @param outputFormat Secuencia PNG o flujo Y4M
+	 * @param outputTarget Prefijo de los PNG, archivo .y4m o "|comando"
+	 * @param frameWidth   Ancho (par para Y4M)
+	 * @param frameHeight  Alto (par para Y4M)
+	 * @param fps          Cuadros por segundo del video
+	 * @param workerCount  Hilos codificadores (0 = la mitad de los núcleos)
+	 * @param firstNumber  Número del primer PNG (un proceso de un render por lotes numera su tramo)
+	 * @return false si no se pudo abrir la salida (ver error())
+	 */
+	bool start(Format outputFormat, const std::string& outputTarget, int frameWidth, int frameHeight, int fps, int workerCount = 0,
+		long long firstNumber = 1) {
+		finish();
+		format = outputFormat;
+		target = outputTarget;
+		fileNumber = firstNumber;
+		width = frameWidth;
+		height = frameHeight;
+		errorMessage.clear();
+		nextIndex = nextWrite = 0;
+		written = 0;
+		bytes = 0;
+		stalls = 0;
+		stallTime = 0.0;
+		stopping = false;
+
+		if (format == Y4M_STREAM) {
+			if ((width | height) & 1) {
+				errorMessage = "Y4M 4:2:0 requiere ancho y alto pares";
+				return false;
+			}
+			if (!target.empty() && target[0] == '|') {
+#ifdef _WIN32
+				stream = _popen(target.c_str() + 1, "wb");
+#else
+				stream = popen(target.c_str() + 1, "w");
+#endif
+				piped = true;
+			}
+			else {
+				stream = std::fopen(target.c_str(), "wb");
+				piped = false;
+			}
+			if (!stream) {
+				errorMessage = "No se pudo abrir " + target;
+				return false;
+			}
+			char header[128];
+			int length = std::snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+			std::fwrite(header, 1, (size_t)length, stream);
+		}
+
+		if (workerCount <= 0) workerCount = std::max(1, (int)std::thread::hardware_concurrency() / 2);
+		pool.resize((size_t)workerCount + 2);
+		freeFrames.clear();
+		for (Frame& frame : pool) {
+			frame.rgba.resize((size_t)width * height * 4);
+			freeFrames.push_back(&frame);
+		}
+		for (int i = 0; i < workerCount; ++i) workers.emplace_back(&FrameEncoder::work, this);
+		return true;
+	}
+
+	bool isActive() const { return !workers.empty(); }
+
+	/** Cuadro libre donde copiar los píxeles; espera si todos están en codificación. */
+	Frame* acquire() {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (freeFrames.empty()) {
+			std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+			released.wait(lock, [this] { return !freeFrames.empty(); });
+			++stalls;
+			stallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		}
+		Frame* frame = freeFrames.back();
+		freeFrames.pop_back();
+		return frame;
+	}
+
+	/** Entrega un cuadro de acquire() para codificarlo; los cuadros se numeran en el orden de entrega. */
+	void submit(Frame* frame) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			frame->index = nextIndex++;
+			queue.push_back(frame);
+		}
+		ready.notify_one();
+	}
+
+	/**
+	 * Codifica lo pendiente, detiene los hilos y cierra la salida.
+	 *
+	 * @return false si alguna escritura falló (ver error())
+	 */
+	bool finish() {
+		if (workers.empty()) return errorMessage.empty();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		ready.notify_all();
+		for (std::thread& t : workers) t.join();
+		workers.clear();
+		if (stream) {
+#ifdef _WIN32
+			if (piped) _pclose(stream); else std::fclose(stream);
+#else
+			if (piped) pclose(stream); else std::fclose(stream);
+#endif
+			stream = nullptr;
+		}
+		pool.clear();
+		freeFrames.clear();
+		return errorMessage.empty();
+	}
+
+	long long framesWritten() const { return written; }
+	size_t bytesWritten() const { return bytes; }
+	/** Cuadros entregados que todavía no se terminaron de escribir. */
+	long long pending() const { return nextIndex - written; }
+	/** Veces que acquire() esperó a un codificador, y el tiempo total esperado. */
+	int stallCount() const { return stalls; }
+	double stallSeconds() const { return stallTime; }
+	/** Primer error de escritura (consultar después de finish()). */
+	const std::string& error() const { return errorMessage; }
+
+private:
+	Format format = PNG_SEQUENCE;
+	std::string target;
+	long long fileNumber = 1;             // Número del archivo del cuadro 0
+	int width = 0, height = 0;
+	FILE* stream = nullptr;
+	bool piped = false;
+
+	std::vector<std::thread> workers;
+	std::vector<Frame> pool;
+	std::vector<Frame*> freeFrames;
+	std::deque<Frame*> queue;
+	std::mutex mutex;
+	std::condition_variable ready, released;
+	bool stopping = false;
+	long long nextIndex = 0;
+
+	std::mutex streamMutex;               // Turno de escritura del flujo Y4M
+	std::condition_variable turn;
+	long long nextWrite = 0;
+
+	std::atomic<long long> written{ 0 };
+	std::atomic<size_t> bytes{ 0 };
+	int stalls = 0;
+	double stallTime = 0.0;
+	std::string errorMessage;             // Protegido por mutex mientras hay hilos
+
+	void release(Frame* frame) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			freeFrames.push_back(frame);
+		}
+		released.notify_one();
+	}
+
+	void fail(const std::string& message) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (errorMessage.empty()) errorMessage = message;
+	}
+
+	/** Bucle de cada hilo codificador. */
+	void work() {
+		PngEncoder png;
+		std::vector<unsigned char> encoded;
+		while (true) {
+			Frame* frame;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready.wait(lock, [this] { return !queue.empty() || stopping; });
+				if (queue.empty()) return;
+				frame = queue.front();
+				queue.pop_front();
+			}
+			long long index = frame->index;
+			if (format == PNG_SEQUENCE) {
+				png.encode(frame->rgba.data(), width, height, encoded);
+				release(frame);
+				char path[512];
+				std::snprintf(path, sizeof(path), "%s_%06lld.png", target.c_str(), fileNumber + index);
+				FILE* file = std::fopen(path, "wb");
+				if (!file || std::fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size()) {
+					fail(std::string("No se pudo escribir ") + path);
+				}
+				if (file) std::fclose(file);
+			}
+			else {
+				encoded.resize((size_t)width * height * 3 / 2);
+				convertToI420(frame->rgba.data(), width, height, encoded.data());
+				release(frame);
+				std::unique_lock<std::mutex> lock(streamMutex);
+				turn.wait(lock, [&] { return nextWrite == index; });
+				if (std::fwrite("FRAME\n", 1, 6, stream) != 6 ||
+					std::fwrite(encoded.data(), 1, encoded.size(), stream) != encoded.size()) {
+					fail("Fallo la escritura de " + target);
+				}
+				++nextWrite;
+				turn.notify_all();
+			}
+			bytes += encoded.size();
+			++written;
+		}
+	}
+};
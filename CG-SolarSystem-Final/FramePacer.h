@@ -0,0 +1,157 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <thread>
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+/**
+ * Controlador de ritmo de frames (frame pacing).
+ *
+ * - Limitador híbrido: duerme mientras falta más de SPIN_THRESHOLD para el siguiente frame
+ *   y luego espera activamente hasta el instante exacto (sleep del sistema es impreciso).
+ * - V-Sync configurable: desactivado, activado o adaptativo (si el driver lo soporta).
+ * - Mide la desviación de cada intervalo entre frames respecto al objetivo (jitter).
+ */
+class FramePacer
+{
+public:
+	enum VSyncMode { VSYNC_OFF = 0, VSYNC_ON = 1, VSYNC_ADAPTIVE = 2 };
+
+	using Clock = std::chrono::steady_clock;
+
+	// Margen final que se resuelve con espera activa en lugar de sleep
+	static constexpr double SPIN_THRESHOLD = 0.002;
+	// Cantidad de intervalos usados para las estadísticas de pacing
+	static const int HISTORY = 120;
+
+	bool limitEnabled = true;   // Aplicar el limitador por software
+	int targetFps = 60;         // Frecuencia objetivo (frames por segundo)
+
+	FramePacer() {
+#ifdef _WIN32
+		timeBeginPeriod(1);  // Granularidad de Sleep de 1 ms (por defecto ~15.6 ms)
+#endif
+	}
+
+	~FramePacer() {
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+
+	/**
+	 * Configura el intervalo de intercambio del contexto actual.
+	 * El modo adaptativo (intervalo -1) solo se usa si existe la extensión swap_control_tear.
+	 *
+	 * @param mode Modo de V-Sync deseado
+	 * @return     Modo efectivamente aplicado
+	 */
+	VSyncMode applyVSync(VSyncMode mode) {
+		if (mode == VSYNC_ADAPTIVE &&
+			!glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+			!glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+			mode = VSYNC_ON;
+		}
+		glfwSwapInterval(mode == VSYNC_OFF ? 0 : (mode == VSYNC_ON ? 1 : -1));
+		vsync = mode;
+		return mode;
+	}
+
+	VSyncMode vsyncMode() const { return vsync; }
+
+	/**
+	 * Período objetivo del frame en segundos. Sin limitador y con V-Sync activo
+	 * el objetivo es la frecuencia de refresco del monitor principal.
+	 */
+	double targetPeriod() const {
+		if (limitEnabled && targetFps > 0) return 1.0 / targetFps;
+		if (vsync != VSYNC_OFF) {
+			const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+			if (videoMode && videoMode->refreshRate > 0) return 1.0 / videoMode->refreshRate;
+		}
+		return 0.0;
+	}
+
+	/**
+	 * Espera hasta el instante del siguiente frame (si el limitador está activo)
+	 * y registra el intervalo logrado. Se llama justo después de glfwSwapBuffers.
+	 */
+	void endFrame() {
+		double period = limitEnabled && targetFps > 0 ? 1.0 / targetFps : 0.0;
+		Clock::time_point now = Clock::now();
+
+		if (period > 0.0) {
+			auto periodDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+			// Primer frame o retraso mayor a un período (p. ej. tras el reposo): reiniciar la referencia
+			if (!started || now - deadline > periodDuration) deadline = now;
+			deadline += periodDuration;
+
+			// Fase 1: dormir en bloques mientras quede margen
+			while (true) {
+				double remaining = std::chrono::duration<double>(deadline - Clock::now()).count();
+				if (remaining <= SPIN_THRESHOLD) break;
+				std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_THRESHOLD));
+			}
+			// Fase 2: espera activa hasta el instante exacto
+			while (Clock::now() < deadline) std::this_thread::yield();
+			now = Clock::now();
+		}
+
+		if (started) record(std::chrono::duration<double>(now - lastFrameEnd).count());
+		lastFrameEnd = now;
+		started = true;
+	}
+
+	/** Descarta la referencia temporal (tras un período de reposo sin dibujar). */
+	void reset() {
+		started = false;
+	}
+
+	// Estadísticas de pacing sobre los últimos HISTORY intervalos (milisegundos)
+	float meanIntervalMs() const { return (float)(mean * 1000.0); }
+	float jitterMs() const { return (float)(stddev * 1000.0); }
+	float meanErrorMs() const { return (float)(meanAbsError * 1000.0); }
+
+private:
+	VSyncMode vsync = VSYNC_ON;
+	bool started = false;
+	Clock::time_point deadline;
+	Clock::time_point lastFrameEnd;
+
+	double intervals[HISTORY] = {};
+	int historyCount = 0;
+	int historyNext = 0;
+	double mean = 0.0, stddev = 0.0, meanAbsError = 0.0;
+
+	/** Agrega un intervalo al historial y recalcula media, desviación y error contra el objetivo. */
+	void record(double interval) {
+		intervals[historyNext] = interval;
+		historyNext = (historyNext + 1) % HISTORY;
+		if (historyCount < HISTORY) ++historyCount;
+
+		double target = targetPeriod();
+		double sum = 0.0, sumSq = 0.0, sumErr = 0.0;
+		for (int i = 0; i < historyCount; ++i) {
+			sum += intervals[i];
+			sumSq += intervals[i] * intervals[i];
+			sumErr += std::fabs(intervals[i] - (target > 0.0 ? target : intervals[i]));
+		}
+		mean = sum / historyCount;
+		stddev = std::sqrt(std::fmax(0.0, sumSq / historyCount - mean * mean));
+		meanAbsError = target > 0.0 ? sumErr / historyCount : 0.0;
+	}
+};
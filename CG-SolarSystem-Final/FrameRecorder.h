@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "FrameEncoder.h"
+#include "FramesInFlight.h"
+
+/**
+ * Grabación de la escena sin bloquear el render.
+ *
+ * Cada cuadro se lee del framebuffer de la escena con glReadPixels hacia un pixel pack buffer
+ * (PBO), de modo que la lectura la hace la GPU en segundo plano. Hay un PBO por ranura de
+ * FramesInFlight: cuando una ranura vuelve a usarse su fence ya pasó, así que el PBO tiene el
+ * cuadro de hace N frames listo y mapearlo no espera. Los píxeles se copian a un cuadro del
+ * FrameEncoder y los hilos codificadores hacen el resto.
+ *
+ * El hilo de render llama, en cada frame grabado, collect(slot) después de
+ * FramesInFlight::beginFrame() y capture(framebuffer, slot) con la escena ya dibujada.
+ */
+class FrameRecorder
+{
+public:
+	/**
+	 * Crea los PBO y abre la salida.
+	 *
+	 * @param format Secuencia PNG o flujo Y4M
+	 * @param target Prefijo de los PNG, archivo .y4m o "|comando"
+	 * @param width  Ancho de la grabación
+	 * @param height Alto de la grabación
+	 * @param fps    Cuadros por segundo del video
+	 * @param slots  Frames en vuelo (FramesInFlight::count)
+	 * @param encoderThreads Hilos codificadores (0 = la mitad de los núcleos)
+	 * @param firstNumber    Número del primer PNG
+	 * @return false si no se pudo abrir la salida (ver error())
+	 */
+	bool start(FrameEncoder::Format format, const std::string& target, int width, int height, int fps, int slots,
+		int encoderThreads = 0, long long firstNumber = 1) {
+		if (recording) stop();
+		if (!encoder.start(format, target, width, height, fps, encoderThreads, firstNumber)) return false;
+		frameWidth = width;
+		frameHeight = height;
+		frameRate = fps;
+		slotCount = slots;
+		captured = 0;
+		copySeconds = 0.0;
+		GLsizeiptr bytes = (GLsizeiptr)width * height * 4;
+		glGenBuffers(slotCount, pbos);
+		for (int i = 0; i < slotCount; ++i) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+			glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+			pendingFrame[i] = -1;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		recording = true;
+		return true;
+	}
+
+	bool isRecording() const { return recording; }
+	int width() const { return frameWidth; }
+	int height() const { return frameHeight; }
+	int fps() const { return frameRate; }
+
+	/**
+	 * Entrega al codificador el cuadro leído la última vez que se usó la ranura. El fence de la
+	 * ranura ya pasó (FramesInFlight::beginFrame), así que el mapeo no espera a la GPU.
+	 *
+	 * @param slot Ranura del frame actual
+	 */
+	void collect(int slot) {
+		if (!recording || pendingFrame[slot] < 0) return;
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		size_t bytes = (size_t)frameWidth * frameHeight * 4;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+		const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT);
+		if (pixels) {
+			FrameEncoder::Frame* frame = encoder.acquire();  // Espera solo si los codificadores no dan abasto
+			std::memcpy(frame->rgba.data(), pixels, bytes);
+			encoder.submit(frame);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		pendingFrame[slot] = -1;
+		copySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	/**
+	 * Pide la lectura asíncrona del cuadro actual al PBO de la ranura.
+	 *
+	 * @param framebuffer Framebuffer con la escena (0 = la ventana)
+	 * @param slot        Ranura del frame actual
+	 */
+	void capture(GLuint framebuffer, int slot) {
+		if (!recording) return;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);  // Vuelve sin esperar
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		pendingFrame[slot] = captured++;
+	}
+
+	/**
+	 * Termina la grabación: entrega los cuadros que quedaban en los PBO, espera a que se
+	 * codifiquen y cierra la salida.
+	 *
+	 * @return false si alguna escritura falló (ver error())
+	 */
+	bool stop() {
+		if (!recording) return encoder.error().empty();
+		glFinish();  // Una sola vez: las lecturas pendientes tienen que estar completas
+		for (long long next = captured - slotCount; next < captured; ++next) {
+			for (int i = 0; i < slotCount; ++i) {
+				if (pendingFrame[i] == next) collect(i);  // En orden de captura
+			}
+		}
+		glDeleteBuffers(slotCount, pbos);
+		recording = false;
+		return encoder.finish();
+	}
+
+	long long capturedFrames() const { return captured; }
+	const FrameEncoder& output() const { return encoder; }
+	const std::string& error() const { return encoder.error(); }
+	/** Tiempo medio por cuadro que el render pasó copiando desde los PBO (ms). */
+	float copyMs() const { return captured > 0 ? (float)(copySeconds * 1000.0 / captured) : 0.0f; }
+
+private:
+	FrameEncoder encoder;
+	bool recording = false;
+	int frameWidth = 0, frameHeight = 0, frameRate = 30;
+	int slotCount = 0;
+	GLuint pbos[FramesInFlight::MAX_FRAMES] = {};
+	long long pendingFrame[FramesInFlight::MAX_FRAMES] = {};  // Cuadro leído en cada PBO (-1 = ninguno)
+	long long captured = 0;
+	double copySeconds = 0.0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+
+/**
+ * Sincronización explícita de frames en vuelo.
+ *
+ * La CPU prepara hasta FRAMES frames por delante de la GPU. Cada frame usa una ranura
+ * (frame % FRAMES) y al terminar deja un fence; antes de reutilizar una ranura se espera su
+ * fence, así los recursos por frame que se indexan con slot() (regiones del StreamBuffer,
+ * consultas de tiempo) nunca se pisan mientras la GPU los lee, sin depender de la
+ * sincronización implícita del driver ni de glfwSwapBuffers.
+ *
+ * También mide, por frame, el tiempo que la CPU espera a la GPU y el tiempo de GPU del frame
+ * (consulta GL_TIME_ELAPSED de la misma ranura, que ya está disponible cuando se reutiliza).
+ */
+class FramesInFlight
+{
+public:
+	// Máximo de frames en vuelo admitido
+	static const int MAX_FRAMES = 4;
+	// Cantidad de frames usados para las estadísticas
+	static const int HISTORY = 120;
+
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Crea las consultas de tiempo de cada ranura.
+	 *
+	 * @param count Frames en vuelo (1 a MAX_FRAMES; 1 equivale a esperar a la GPU en cada frame)
+	 */
+	void init(int count) {
+		frames = count < 1 ? 1 : (count > MAX_FRAMES ? MAX_FRAMES : count);
+		glGenQueries(frames, queries);
+	}
+
+	int count() const { return frames; }
+
+	/** Ranura del frame actual: índice de los recursos por frame. */
+	int slot() const { return current; }
+
+	/**
+	 * Empieza un frame: espera a que la GPU termine el frame que usó la misma ranura, lee su
+	 * tiempo de GPU y abre la consulta de tiempo del frame nuevo. Se llama antes del primer
+	 * comando que escribe recursos por frame.
+	 *
+	 * @return Ranura del frame
+	 */
+	int beginFrame() {
+		current = (int)(frameNumber % frames);
+		double waited = 0.0;
+		if (fences[current]) {
+			if (glClientWaitSync(fences[current], 0, 0) == GL_TIMEOUT_EXPIRED) {
+				Clock::time_point start = Clock::now();
+				glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+				waited = std::chrono::duration<double>(Clock::now() - start).count();
+			}
+			glDeleteSync(fences[current]);
+			fences[current] = nullptr;
+		}
+		if (queryPending[current]) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);  // Ya disponible: su fence pasó
+			lastGpu = elapsed * 1e-9;
+			queryPending[current] = false;
+		}
+		record(waited);
+		glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+		return current;
+	}
+
+	/** Termina el frame: cierra su consulta de tiempo y pone el fence de su ranura. */
+	void endFrame() {
+		glEndQuery(GL_TIME_ELAPSED);
+		queryPending[current] = true;
+		fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		++frameNumber;
+	}
+
+	/** Libera fences y consultas (antes de destruir el contexto). */
+	void destroy() {
+		for (int i = 0; i < frames; ++i) {
+			if (fences[i]) glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+		glDeleteQueries(frames, queries);
+	}
+
+	// Estadísticas sobre los últimos HISTORY frames (milisegundos)
+	float lastWaitMs() const { return (float)(lastWait * 1000.0); }
+	float meanWaitMs() const { return (float)(meanWait * 1000.0); }
+	float maxWaitMs() const { return (float)(maxWait * 1000.0); }
+	/** Tiempo de GPU del último frame cuya consulta se leyó (FRAMES frames atrás). */
+	float gpuMs() const { return (float)(lastGpu * 1000.0); }
+
+private:
+	int frames = 1;
+	int current = 0;
+	unsigned long long frameNumber = 0;
+	GLsync fences[MAX_FRAMES] = {};
+	GLuint queries[MAX_FRAMES] = {};
+	bool queryPending[MAX_FRAMES] = {};
+
+	double waits[HISTORY] = {};
+	int historyCount = 0;
+	int historyNext = 0;
+	double lastWait = 0.0, meanWait = 0.0, maxWait = 0.0, lastGpu = 0.0;
+
+	/** Agrega la espera del frame al historial y recalcula media y máximo. */
+	void record(double wait) {
+		lastWait = wait;
+		waits[historyNext] = wait;
+		historyNext = (historyNext + 1) % HISTORY;
+		if (historyCount < HISTORY) ++historyCount;
+
+		double sum = 0.0, peak = 0.0;
+		for (int i = 0; i < historyCount; ++i) {
+			sum += waits[i];
+			if (waits[i] > peak) peak = waits[i];
+		}
+		meanWait = sum / historyCount;
+		maxWait = peak;
+	}
+};
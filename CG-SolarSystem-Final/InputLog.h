@@ -0,0 +1,444 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// ===========================================
+// REGISTRO DE ENTRADA (GRABACIÓN Y REPRODUCCIÓN)
+// ===========================================
+// Para que una sesión se pueda repetir frame por frame se graba todo lo que entra al programa
+// desde afuera: los eventos de GLFW (teclado, cursor, botones, rueda, foco, tamaños), el
+// deltaTime de cada frame y la semilla de rand(). Los clics en la interfaz no necesitan registro
+// propio: ImGui los vuelve a producir a partir de los mismos eventos y los mismos deltaTime.
+// Además de los eventos hay marcas en los puntos del frame donde el programa consume la entrada
+// (comienzo del frame, latch tardío) y una suma de control del estado al final de cada frame,
+// que la reproducción compara para detectar el primer frame que se aparta de la grabación.
+//
+// FORMATO BINARIO (little-endian):
+//   [InputLogHeader]
+//   registros: [tipo (1 byte)] [tiempo: varint, µs desde el registro anterior] [datos]
+//     FRAME            deltaTime (float)
+//     LATCH            -
+//     CHECK            suma de control (uint32)
+//     KEY              tecla, scancode (varint zigzag), acción, modificadores (1 byte cada uno)
+//     CHAR             código Unicode (varint)
+//     CURSOR_POS       x, y
+//     CURSOR_ENTER     1 byte
+//     MOUSE_BUTTON     botón, acción, modificadores (1 byte cada uno)
+//     SCROLL           x, y
+//     FOCUS            1 byte
+//     FRAMEBUFFER_SIZE ancho, alto (varint)
+//     WINDOW_SIZE      ancho, alto (varint)
+// Las coordenadas enteras (lo habitual en el cursor y la rueda) van como varint zigzag y el tipo
+// lleva el bit INPUT_LOG_INTEGRAL; si no, van los dos double completos.
+
+const char INPUT_LOG_MAGIC[8] = { 'C', 'G', 'I', 'N', 'P', 'U', 'T', '1' };
+const uint32_t INPUT_LOG_VERSION = 1;
+const uint32_t INPUT_LOG_SEED = 1;          // Semilla de rand() de las sesiones grabadas
+const uint8_t INPUT_LOG_INTEGRAL = 0x80;    // Bit del tipo: coordenadas enteras en varint
+
+struct InputLogHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t seed;              // Semilla de rand() (meteoritos, asteroides N-cuerpos)
+	double startJulianDate;     // Fecha de la simulación al comenzar (la del reloj al grabar)
+	uint32_t frameCount;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(InputLogHeader) == 32, "InputLogHeader debe ocupar 32 bytes");
+
+/**
+ * Un registro del archivo: evento de GLFW o marca del frame. Los campos enteros se interpretan
+ * según el tipo (ver el formato arriba).
+ */
+struct InputEvent {
+	enum Type : uint8_t {
+		FRAME = 1, LATCH, CHECK,
+		KEY, CHAR, CURSOR_POS, CURSOR_ENTER, MOUSE_BUTTON, SCROLL, FOCUS, FRAMEBUFFER_SIZE, WINDOW_SIZE,
+		TYPE_COUNT
+	};
+
+	Type type = FRAME;
+	double time = 0.0;          // Segundos desde el comienzo de la grabación (resolución de 1 µs)
+	int key = 0;                // KEY: tecla; MOUSE_BUTTON: botón; CHAR: código; *_SIZE: ancho; ENTER/FOCUS: estado
+	int scancode = 0;           // KEY: scancode; *_SIZE: alto
+	int action = 0;             // KEY, MOUSE_BUTTON: GLFW_RELEASE (0), GLFW_PRESS (1) o GLFW_REPEAT (2)
+	int mods = 0;               // KEY, MOUSE_BUTTON: modificadores GLFW_MOD_*
+	double x = 0.0, y = 0.0;    // CURSOR_POS: posición; SCROLL: desplazamiento
+	float deltaTime = 0.0f;     // FRAME
+	uint32_t checksum = 0;      // CHECK
+
+	static InputEvent make(Type type) { InputEvent e; e.type = type; return e; }
+	static InputEvent keyEvent(int key, int scancode, int action, int mods) {
+		InputEvent e = make(KEY);
+		e.key = key; e.scancode = scancode; e.action = action; e.mods = mods;
+		return e;
+	}
+	static InputEvent buttonEvent(int button, int action, int mods) {
+		InputEvent e = make(MOUSE_BUTTON);
+		e.key = button; e.action = action; e.mods = mods;
+		return e;
+	}
+	static InputEvent pointEvent(Type type, double x, double y) {
+		InputEvent e = make(type);
+		e.x = x; e.y = y;
+		return e;
+	}
+	static InputEvent valueEvent(Type type, int value, int second = 0) {
+		InputEvent e = make(type);
+		e.key = value; e.scancode = second;
+		return e;
+	}
+
+	bool isMarker() const { return type == FRAME || type == LATCH || type == CHECK; }
+
+	bool operator==(const InputEvent& o) const {
+		return type == o.type && time == o.time && key == o.key && scancode == o.scancode && action == o.action &&
+			mods == o.mods && x == o.x && y == o.y && deltaTime == o.deltaTime && checksum == o.checksum;
+	}
+};
+
+/**
+ * Estado de la entrada que resulta de aplicar los eventos en orden. El programa lo consulta en
+ * lugar de preguntarle a GLFW (glfwGetKey, glfwGetCursorPos, tamaños de la ventana), así al
+ * reproducir ve lo grabado y no el teclado, el mouse o la ventana reales.
+ */
+struct InputState {
+	static const int KEY_COUNT = 512;   // Mayor que GLFW_KEY_LAST
+
+	bool keys[KEY_COUNT] = {};
+	double cursorX = 0.0, cursorY = 0.0;
+	bool hovered = false, focused = false;
+	int windowWidth = 0, windowHeight = 0;
+	int framebufferWidth = 0, framebufferHeight = 0;
+
+	void apply(const InputEvent& e) {
+		switch (e.type) {
+		case InputEvent::KEY:
+			if (e.key >= 0 && e.key < KEY_COUNT) keys[e.key] = e.action != 0;  // PRESS y REPEAT: presionada
+			break;
+		case InputEvent::CURSOR_POS: cursorX = e.x; cursorY = e.y; break;
+		case InputEvent::CURSOR_ENTER: hovered = e.key != 0; break;
+		case InputEvent::FOCUS:
+			focused = e.key != 0;
+			if (!focused) std::memset(keys, 0, sizeof(keys));  // Sin foco no llegan las liberaciones
+			break;
+		case InputEvent::WINDOW_SIZE: windowWidth = e.key; windowHeight = e.scancode; break;
+		case InputEvent::FRAMEBUFFER_SIZE: framebufferWidth = e.key; framebufferHeight = e.scancode; break;
+		default: break;
+		}
+	}
+
+	bool keyDown(int key) const { return key >= 0 && key < KEY_COUNT && keys[key]; }
+};
+
+/**
+ * Registro de entrada en memoria: se graba evento por evento y se escribe al terminar, o se lee
+ * entero de un archivo y se recorre en orden.
+ */
+class InputLog
+{
+public:
+	enum Mode { OFF, RECORDING, REPLAYING };
+
+	/**
+	 * Empieza a grabar.
+	 *
+	 * @param seed            Semilla de rand() con la que corre la sesión
+	 * @param startJulianDate Fecha inicial de la simulación
+	 * @param now             Reloj actual (glfwGetTime): los tiempos se guardan relativos a él
+	 */
+	void startRecording(uint32_t seed, double startJulianDate, double now) {
+		clear();
+		std::memcpy(logHeader.magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+		logHeader.version = INPUT_LOG_VERSION;
+		logHeader.seed = seed;
+		logHeader.startJulianDate = startJulianDate;
+		origin = now;
+		logMode = RECORDING;
+	}
+
+	/**
+	 * Agrega un registro. El tiempo se cuantiza a microsegundos y se guarda también en el
+	 * evento, así quien graba usa el mismo valor que después verá la reproducción.
+	 *
+	 * @param e   Evento o marca (se le completa el tiempo)
+	 * @param now Reloj actual (glfwGetTime)
+	 */
+	void record(InputEvent& e, double now) {
+		if (logMode != RECORDING) return;
+		long long micros = std::max(lastMicros, (long long)std::llround((now - origin) * 1e6));
+		e.time = micros * 1e-6;
+		encode(e, micros - lastMicros, data);
+		lastMicros = micros;
+		lastTime = e.time;
+		if (e.type == InputEvent::FRAME) ++logHeader.frameCount;
+		++eventCount;
+	}
+
+	/**
+	 * Escribe la grabación y vuelve al modo normal.
+	 *
+	 * @return false si no se pudo escribir el archivo
+	 */
+	bool save(const char* path, std::string& error) {
+		logMode = OFF;
+		std::ofstream out(path, std::ios::binary);
+		out.write((const char*)&logHeader, sizeof(logHeader));
+		out.write((const char*)data.data(), (std::streamsize)data.size());
+		if (!out) {
+			error = std::string("No se pudo escribir ") + path;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Lee una grabación para reproducirla.
+	 *
+	 * @return false si el archivo no existe o no es un registro de entrada válido
+	 */
+	bool load(const char* path, std::string& error) {
+		clear();
+		std::ifstream in(path, std::ios::binary);
+		if (!in) {
+			error = std::string("No se pudo abrir ") + path;
+			return false;
+		}
+		std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		if (bytes.size() < sizeof(InputLogHeader)) {
+			error = std::string(path) + ": archivo truncado";
+			return false;
+		}
+		std::memcpy(&logHeader, bytes.data(), sizeof(logHeader));
+		if (std::memcmp(logHeader.magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) != 0 || logHeader.version != INPUT_LOG_VERSION) {
+			error = std::string(path) + ": no es un registro de entrada (o es de otra version)";
+			return false;
+		}
+		data.assign(bytes.begin() + sizeof(InputLogHeader), bytes.end());
+		logMode = REPLAYING;
+		return true;
+	}
+
+	/**
+	 * Siguiente registro de la reproducción.
+	 *
+	 * @return false al terminar el registro o si está dañado (ver error())
+	 */
+	bool next(InputEvent& e) {
+		if (logMode != REPLAYING || cursor >= data.size()) return false;
+		long long delta;
+		if (!decode(e, delta)) {
+			readError = "registro de entrada danado en el byte " + std::to_string(sizeof(InputLogHeader) + cursor);
+			cursor = data.size();
+			return false;
+		}
+		lastMicros += delta;
+		e.time = lastMicros * 1e-6;
+		lastTime = e.time;
+		if (e.type == InputEvent::FRAME) ++replayedFrames;
+		++eventCount;
+		return true;
+	}
+
+	/** Deja de grabar o reproducir (lo grabado y no guardado se pierde). */
+	void stop() { logMode = OFF; }
+
+	Mode mode() const { return logMode; }
+	bool isRecording() const { return logMode == RECORDING; }
+	bool isReplaying() const { return logMode == REPLAYING; }
+	bool isActive() const { return logMode != OFF; }
+	const InputLogHeader& header() const { return logHeader; }
+	const std::string& error() const { return readError; }
+
+	/** Tiempo del último registro grabado o reproducido (segundos desde el comienzo). */
+	double time() const { return lastTime; }
+	/** Frames grabados, o totales del archivo al reproducir. */
+	uint32_t frameCount() const { return logHeader.frameCount; }
+	/** Frames ya reproducidos. */
+	uint32_t replayedFrameCount() const { return replayedFrames; }
+	/** Registros grabados o reproducidos. */
+	long long events() const { return eventCount; }
+	/** Bytes de registros (sin la cabecera). */
+	size_t bytes() const { return data.size(); }
+
+	/**
+	 * Suma de control FNV-1a, para resumir el estado de un frame.
+	 *
+	 * @param data  Bytes a agregar
+	 * @param size  Cantidad de bytes
+	 * @param hash  Suma acumulada hasta ahora
+	 */
+	static uint32_t hash(const void* data, size_t size, uint32_t hash = 2166136261u) {
+		const uint8_t* p = (const uint8_t*)data;
+		for (size_t i = 0; i < size; ++i) hash = (hash ^ p[i]) * 16777619u;
+		return hash;
+	}
+
+private:
+	Mode logMode = OFF;
+	InputLogHeader logHeader = {};
+	std::vector<uint8_t> data;          // Registros codificados
+	size_t cursor = 0;                  // Posición de lectura
+	double origin = 0.0;                // Reloj al comenzar la grabación
+	long long lastMicros = 0;
+	double lastTime = 0.0;
+	uint32_t replayedFrames = 0;
+	long long eventCount = 0;
+	std::string readError;
+
+	void clear() {
+		logMode = OFF;
+		logHeader = InputLogHeader();
+		data.clear();
+		cursor = 0;
+		lastMicros = 0;
+		lastTime = 0.0;
+		replayedFrames = 0;
+		eventCount = 0;
+		readError.clear();
+	}
+
+	static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+		while (v >= 0x80) {
+			out.push_back((uint8_t)(v | 0x80));
+			v >>= 7;
+		}
+		out.push_back((uint8_t)v);
+	}
+
+	static void putSigned(std::vector<uint8_t>& out, long long v) {
+		putVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));  // Zigzag: valores chicos de ambos signos en pocos bytes
+	}
+
+	static void putRaw(std::vector<uint8_t>& out, const void* p, size_t size) {
+		out.insert(out.end(), (const uint8_t*)p, (const uint8_t*)p + size);
+	}
+
+	static bool isIntegral(double v) {
+		return v >= -1e9 && v <= 1e9 && v == (double)(long long)v;
+	}
+
+	static void encode(const InputEvent& e, long long deltaMicros, std::vector<uint8_t>& out) {
+		bool point = e.type == InputEvent::CURSOR_POS || e.type == InputEvent::SCROLL;
+		bool integral = point && isIntegral(e.x) && isIntegral(e.y);
+		out.push_back((uint8_t)(e.type | (integral ? INPUT_LOG_INTEGRAL : 0)));
+		putVarint(out, (uint64_t)deltaMicros);
+		switch (e.type) {
+		case InputEvent::FRAME: putRaw(out, &e.deltaTime, sizeof(float)); break;
+		case InputEvent::LATCH: break;
+		case InputEvent::CHECK: putRaw(out, &e.checksum, sizeof(uint32_t)); break;
+		case InputEvent::KEY:
+			putSigned(out, e.key);
+			putSigned(out, e.scancode);
+			out.push_back((uint8_t)e.action);
+			out.push_back((uint8_t)e.mods);
+			break;
+		case InputEvent::MOUSE_BUTTON:
+			out.push_back((uint8_t)e.key);
+			out.push_back((uint8_t)e.action);
+			out.push_back((uint8_t)e.mods);
+			break;
+		case InputEvent::CHAR: putVarint(out, (uint32_t)e.key); break;
+		case InputEvent::CURSOR_ENTER:
+		case InputEvent::FOCUS: out.push_back((uint8_t)(e.key != 0)); break;
+		case InputEvent::FRAMEBUFFER_SIZE:
+		case InputEvent::WINDOW_SIZE:
+			putVarint(out, (uint32_t)std::max(0, e.key));
+			putVarint(out, (uint32_t)std::max(0, e.scancode));
+			break;
+		default:
+			if (integral) {
+				putSigned(out, (long long)e.x);
+				putSigned(out, (long long)e.y);
+			}
+			else {
+				putRaw(out, &e.x, sizeof(double));
+				putRaw(out, &e.y, sizeof(double));
+			}
+			break;
+		}
+	}
+
+	bool getVarint(uint64_t& v) {
+		v = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (cursor >= data.size()) return false;
+			uint8_t b = data[cursor++];
+			v |= (uint64_t)(b & 0x7F) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool getSigned(long long& v) {
+		uint64_t u;
+		if (!getVarint(u)) return false;
+		v = (long long)(u >> 1) ^ -(long long)(u & 1);
+		return true;
+	}
+
+	bool getRaw(void* p, size_t size) {
+		if (data.size() - cursor < size) return false;
+		std::memcpy(p, &data[cursor], size);
+		cursor += size;
+		return true;
+	}
+
+	bool getByte(int& v) {
+		if (cursor >= data.size()) return false;
+		v = data[cursor++];
+		return true;
+	}
+
+	bool decode(InputEvent& e, long long& deltaMicros) {
+		e = InputEvent();
+		int tag;
+		uint64_t delta, u;
+		long long a, b;
+		if (!getByte(tag) || !getVarint(delta)) return false;
+		int type = tag & ~INPUT_LOG_INTEGRAL;
+		if (type < InputEvent::FRAME || type >= InputEvent::TYPE_COUNT) return false;
+		e.type = (InputEvent::Type)type;
+		deltaMicros = (long long)delta;
+		switch (e.type) {
+		case InputEvent::FRAME: return getRaw(&e.deltaTime, sizeof(float));
+		case InputEvent::LATCH: return true;
+		case InputEvent::CHECK: return getRaw(&e.checksum, sizeof(uint32_t));
+		case InputEvent::KEY:
+			if (!getSigned(a) || !getSigned(b)) return false;
+			e.key = (int)a;
+			e.scancode = (int)b;
+			return getByte(e.action) && getByte(e.mods);
+		case InputEvent::MOUSE_BUTTON: return getByte(e.key) && getByte(e.action) && getByte(e.mods);
+		case InputEvent::CHAR:
+			if (!getVarint(u)) return false;
+			e.key = (int)u;
+			return true;
+		case InputEvent::CURSOR_ENTER:
+		case InputEvent::FOCUS: return getByte(e.key);
+		case InputEvent::FRAMEBUFFER_SIZE:
+		case InputEvent::WINDOW_SIZE:
+			if (!getVarint(u)) return false;
+			e.key = (int)u;
+			if (!getVarint(u)) return false;
+			e.scancode = (int)u;
+			return true;
+		default:
+			if (tag & INPUT_LOG_INTEGRAL) {
+				if (!getSigned(a) || !getSigned(b)) return false;
+				e.x = (double)a;
+				e.y = (double)b;
+				return true;
+			}
+			return getRaw(&e.x, sizeof(double)) && getRaw(&e.y, sizeof(double));
+		}
+	}
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+
+// Época de referencia J2000.0 (2000-01-01 12:00 TT) y época Unix en fecha juliana
+const double JD_J2000 = 2451545.0;
+const double JD_UNIX_EPOCH = 2440587.5;
+
+/**
+ * Fecha de calendario gregoriano con hora del día.
+ */
+struct CalendarDate {
+	int year;
+	int month;     // 1-12
+	int day;       // 1-31
+	double hours;  // 0-24 (fracción del día en horas)
+};
+
+/**
+ * Convierte una fecha gregoriana a fecha juliana (algoritmo de Meeus, cap. 7).
+ *
+ * @param date Fecha de calendario
+ * @return     Fecha juliana (días)
+ */
+inline double julianDateFromCalendar(const CalendarDate& date)
+{
+	int y = date.year;
+	int m = date.month;
+	if (m <= 2) { y -= 1; m += 12; }
+	int a = (int)std::floor(y / 100.0);
+	int b = 2 - a + (int)std::floor(a / 4.0);
+	return std::floor(365.25 * (y + 4716)) + std::floor(30.6001 * (m + 1)) + date.day + b - 1524.5 + date.hours / 24.0;
+}
+
+/**
+ * Convierte una fecha juliana a fecha gregoriana (algoritmo de Meeus, cap. 7).
+ *
+ * @param jd Fecha juliana (días)
+ * @return   Fecha de calendario
+ */
+inline CalendarDate calendarFromJulianDate(double jd)
+{
+	double z = std::floor(jd + 0.5);
+	double f = jd + 0.5 - z;
+	double a = z;
+	if (z >= 2299161.0) {
+		double alpha = std::floor((z - 1867216.25) / 36524.25);
+		a = z + 1 + alpha - std::floor(alpha / 4.0);
+	}
+	double b = a + 1524;
+	double c = std::floor((b - 122.1) / 365.25);
+	double d = std::floor(365.25 * c);
+	double e = std::floor((b - d) / 30.6001);
+
+	CalendarDate date;
+	date.day = (int)(b - d - std::floor(30.6001 * e));
+	date.month = (int)(e < 14 ? e - 1 : e - 13);
+	date.year = (int)(date.month > 2 ? c - 4716 : c - 4715);
+	date.hours = f * 24.0;
+	return date;
+}
+
+/** Fecha juliana del instante actual según el reloj del sistema (UTC). */
+inline double currentJulianDate()
+{
+	double unixSeconds = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+	return JD_UNIX_EPOCH + unixSeconds / 86400.0;
+}
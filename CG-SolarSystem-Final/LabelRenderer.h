@@ -0,0 +1,180 @@
+#pragma once
+
+#include <imgui.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// SSE está disponible en todas las plataformas x86/x64 que soporta el proyecto
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define LABELS_USE_SSE 1
+#endif
+
+/**
+ * Renderizador de etiquetas 3D escalable.
+ *
+ * Las etiquetas se acumulan durante el frame con add() y se procesan juntas en flush():
+ *  1. Proyección por lotes (4 anclas por instrucción SSE) con una sola matriz projection * view.
+ *  2. Descarte de las anclas detrás de la cámara o fuera de la pantalla.
+ *  3. Ordenamiento por prioridad (importancia del cuerpo y distancia a la cámara).
+ *  4. Eliminación de solapamientos con una grilla de ocupación en espacio de pantalla.
+ *  5. Dibujo de las sobrevivientes en una única lista de ImGui (un solo lote de glifos).
+ */
+class LabelRenderer
+{
+public:
+	// Tamaño de celda de la grilla de ocupación (píxeles)
+	static const int CELL_W = 16;
+	static const int CELL_H = 8;
+
+	/** Descarta las etiquetas del frame anterior. */
+	void begin() {
+		xs.clear(); ys.clear(); zs.clear();
+		importance.clear(); texts.clear();
+	}
+
+	/**
+	 * Encola una etiqueta para el frame actual.
+	 *
+	 * @param text      Texto a mostrar (debe seguir siendo válido hasta flush())
+	 * @param worldPos  Posición del ancla en coordenadas del mundo
+	 * @param priority  Importancia del cuerpo (mayor = se dibuja primero)
+	 */
+	void add(const char* text, const glm::vec3& worldPos, float priority) {
+		xs.push_back(worldPos.x);
+		ys.push_back(worldPos.y);
+		zs.push_back(worldPos.z);
+		importance.push_back(priority);
+		texts.push_back(text);
+	}
+
+	/**
+	 * Proyecta, descarta, ordena, despeja y dibuja todas las etiquetas encoladas.
+	 *
+	 * @param drawList  Lista de dibujo de ImGui de destino
+	 * @param viewProj  Matriz projection * view del frame
+	 * @param display_w Ancho del framebuffer en píxeles
+	 * @param display_h Alto del framebuffer en píxeles
+	 */
+	void flush(ImDrawList* drawList, const glm::mat4& viewProj, int display_w, int display_h) {
+		const size_t count = xs.size();
+		if (count == 0 || display_w <= 0 || display_h <= 0) return;
+
+		screenX.resize(count);
+		screenY.resize(count);
+		clipW.resize(count);
+
+		projectAll(viewProj, (float)display_w, (float)display_h);
+
+		// DESCARTE: detrás de la cámara o con el ancla fuera de la pantalla
+		order.clear();
+		for (size_t i = 0; i < count; ++i) {
+			if (clipW[i] <= 0.0f) continue;
+			if (screenX[i] < 0.0f || screenX[i] >= display_w) continue;
+			if (screenY[i] < 0.0f || screenY[i] >= display_h) continue;
+			order.push_back((uint32_t)i);
+		}
+
+		// PRIORIDAD: primero los cuerpos importantes, a igualdad el más cercano (w = distancia en vista)
+		std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+			if (importance[a] != importance[b]) return importance[a] > importance[b];
+			return clipW[a] < clipW[b];
+		});
+
+		// GRILLA DE OCUPACIÓN: se reutiliza entre frames usando un sello por frame
+		int gridW = (display_w + CELL_W - 1) / CELL_W;
+		int gridH = (display_h + CELL_H - 1) / CELL_H;
+		if (gridW * gridH != (int)grid.size()) {
+			grid.assign((size_t)gridW * gridH, 0);
+			stamp = 0;
+		}
+		if (++stamp == 0) {  // Desborde del sello: limpiar la grilla
+			std::fill(grid.begin(), grid.end(), 0);
+			stamp = 1;
+		}
+
+		const ImU32 color = IM_COL32(255, 255, 255, 255);
+		for (uint32_t i : order) {
+			ImVec2 size = ImGui::CalcTextSize(texts[i]);
+			float left = screenX[i] - size.x * 0.5f;
+			float top = screenY[i] - size.y;
+
+			int c0 = std::max(0, (int)(left / CELL_W));
+			int c1 = std::min(gridW - 1, (int)((left + size.x) / CELL_W));
+			int r0 = std::max(0, (int)(top / CELL_H));
+			int r1 = std::min(gridH - 1, (int)((top + size.y) / CELL_H));
+
+			bool free = true;
+			for (int r = r0; r <= r1 && free; ++r)
+				for (int c = c0; c <= c1; ++c)
+					if (grid[(size_t)r * gridW + c] == stamp) { free = false; break; }
+			if (!free) continue;  // Solapa con una etiqueta más prioritaria
+
+			for (int r = r0; r <= r1; ++r)
+				for (int c = c0; c <= c1; ++c)
+					grid[(size_t)r * gridW + c] = stamp;
+
+			drawList->AddText(ImVec2(left, top), color, texts[i]);
+		}
+	}
+
+private:
+	// Anclas en formato SoA para la proyección por lotes
+	std::vector<float> xs, ys, zs, importance;
+	std::vector<const char*> texts;
+
+	// Resultados de la proyección
+	std::vector<float> screenX, screenY, clipW;
+	std::vector<uint32_t> order;
+
+	// Grilla de ocupación en espacio de pantalla
+	std::vector<uint32_t> grid;
+	uint32_t stamp = 0;
+
+	/** Transforma todas las anclas a coordenadas de pantalla. */
+	void projectAll(const glm::mat4& m, float w, float h) {
+		const size_t count = xs.size();
+		size_t i = 0;
+		const float halfW = 0.5f * w, halfH = 0.5f * h;
+
+#ifdef LABELS_USE_SSE
+		const __m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]), m30 = _mm_set1_ps(m[3][0]);
+		const __m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]), m31 = _mm_set1_ps(m[3][1]);
+		const __m128 m03 = _mm_set1_ps(m[0][3]), m13 = _mm_set1_ps(m[1][3]), m23 = _mm_set1_ps(m[2][3]), m33 = _mm_set1_ps(m[3][3]);
+		const __m128 hw = _mm_set1_ps(halfW), hh = _mm_set1_ps(halfH);
+		const __m128 eps = _mm_set1_ps(1e-6f);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(&xs[i]);
+			__m128 y = _mm_loadu_ps(&ys[i]);
+			__m128 z = _mm_loadu_ps(&zs[i]);
+
+			__m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_add_ps(_mm_mul_ps(m20, z), m30));
+			__m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m21, z), m31));
+			__m128 cw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m03, x), _mm_mul_ps(m13, y)), _mm_add_ps(_mm_mul_ps(m23, z), m33));
+
+			// Evitar división por cero; los w <= 0 se descartan después
+			__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(cw, eps));
+			__m128 sx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cx, inv), _mm_set1_ps(1.0f)), hw);
+			__m128 sy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(cy, inv)), hh);  // Invertir Y
+
+			_mm_storeu_ps(&screenX[i], sx);
+			_mm_storeu_ps(&screenY[i], sy);
+			_mm_storeu_ps(&clipW[i], cw);
+		}
+#endif
+		// Resto (o camino escalar si no hay SSE)
+		for (; i < count; ++i) {
+			float cx = m[0][0] * xs[i] + m[1][0] * ys[i] + m[2][0] * zs[i] + m[3][0];
+			float cy = m[0][1] * xs[i] + m[1][1] * ys[i] + m[2][1] * zs[i] + m[3][1];
+			float cw = m[0][3] * xs[i] + m[1][3] * ys[i] + m[2][3] * zs[i] + m[3][3];
+			float inv = 1.0f / std::max(cw, 1e-6f);
+			screenX[i] = (cx * inv + 1.0f) * halfW;
+			screenY[i] = (1.0f - cy * inv) * halfH;
+			clipW[i] = cw;
+		}
+	}
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Archivo de solo lectura proyectado en memoria.
+ *
+ * El sistema operativo carga las páginas bajo demanda y las comparte entre procesos,
+ * por lo que abrir un archivo grande es instantáneo y solo se paga lo que se lee.
+ * No es copiable; se cierra al destruirse.
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { close(); }
+
+	/**
+	 * Proyecta un archivo completo.
+	 *
+	 * @param path Ruta del archivo
+	 * @return     true si se pudo abrir y proyectar (un archivo vacío se considera error)
+	 */
+	bool open(const char* path) {
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { close(); return false; }
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) { close(); return false; }
+		bytes = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!bytes) { close(); return false; }
+		length = (size_t)fileSize.QuadPart;
+#else
+		fd = ::open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) { close(); return false; }
+		void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) { close(); return false; }
+		bytes = p;
+		length = (size_t)st.st_size;
+#endif
+		return true;
+	}
+
+	/** Libera la proyección y el archivo. */
+	void close() {
+#ifdef _WIN32
+		if (bytes) UnmapViewOfFile(bytes);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (bytes) munmap(bytes, length);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		bytes = nullptr;
+		length = 0;
+	}
+
+	bool isOpen() const { return bytes != nullptr; }
+	const unsigned char* data() const { return (const unsigned char*)bytes; }
+	size_t size() const { return length; }
+
+private:
+	void* bytes = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+};
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Ephemeris.h"
+#include "JulianDate.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "TextScanner.h"
+
+// ===========================================
+// CATÁLOGO DE CUERPOS MENORES
+// ===========================================
+// Los catálogos de asteroides y cometas (MPCORB.DAT del Minor Planet Center o una exportación
+// CSV del Small-Body Database de JPL) tienen más de un millón de filas. Se importan una vez a
+// un binario que después se proyecta en memoria y se pasa directamente a Ephemeris.
+//
+// FORMATO BINARIO (little-endian), arreglos por campo para copiarlos sin reordenar:
+//   [MinorBodyFileHeader]
+//   [double] x bodyCount  por cada campo: a, e, i, node, peri, M, epoch
+//   [float]  x bodyCount  magnitud absoluta H (NaN si el catálogo no la trae)
+//   [char]   x bodyCount * MINOR_BODY_NAME_BYTES  designación terminada en '\0'
+// Elementos clásicos en grados y UA; la época es una fecha juliana.
+
+const char MINOR_BODY_MAGIC[8] = { 'C', 'G', 'M', 'I', 'N', 'O', 'R', '1' };
+const uint32_t MINOR_BODY_VERSION = 1;
+const int MINOR_BODY_NAME_BYTES = 16;
+const int MINOR_BODY_FIELDS = 7;    // a, e, i, node, peri, M, epoch
+
+struct MinorBodyFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t bodyCount;
+};
+
+static_assert(sizeof(MinorBodyFileHeader) == 16, "MinorBodyFileHeader debe ocupar 16 bytes");
+
+/** Bytes que ocupa cada cuerpo en el binario. */
+const size_t MINOR_BODY_RECORD_BYTES = MINOR_BODY_FIELDS * sizeof(double) + sizeof(float) + MINOR_BODY_NAME_BYTES;
+
+/**
+ * Catálogo de cuerpos menores leído desde el binario proyectado en memoria.
+ */
+class MinorBodyCatalog
+{
+public:
+	enum Field { A, E, I, NODE, PERI, M, EPOCH };
+
+	/**
+	 * Abre y valida un catálogo importado.
+	 *
+	 * @param path Ruta del binario
+	 * @return     true si el archivo existe y su tamaño corresponde a la cabecera
+	 */
+	bool open(const char* path) {
+		close();
+		if (!file.open(path) || file.size() < sizeof(MinorBodyFileHeader)) { close(); return false; }
+		header = (const MinorBodyFileHeader*)file.data();
+		if (std::memcmp(header->magic, MINOR_BODY_MAGIC, sizeof(MINOR_BODY_MAGIC)) != 0 ||
+			header->version != MINOR_BODY_VERSION ||
+			file.size() != sizeof(MinorBodyFileHeader) + (size_t)header->bodyCount * MINOR_BODY_RECORD_BYTES) {
+			close();
+			return false;
+		}
+		const unsigned char* p = file.data() + sizeof(MinorBodyFileHeader);
+		for (int f = 0; f < MINOR_BODY_FIELDS; ++f) {
+			fields[f] = (const double*)p;
+			p += (size_t)header->bodyCount * sizeof(double);
+		}
+		magnitudes = (const float*)p;
+		names = (const char*)(p + (size_t)header->bodyCount * sizeof(float));
+		return true;
+	}
+
+	void close() {
+		file.close();
+		header = nullptr;
+	}
+
+	bool isOpen() const { return header != nullptr; }
+	int bodyCount() const { return header ? (int)header->bodyCount : 0; }
+
+	/** Arreglo completo de un campo (bodyCount() elementos). */
+	const double* field(Field f) const { return fields[f]; }
+	double value(Field f, int i) const { return fields[f][i]; }
+	float magnitude(int i) const { return magnitudes[i]; }
+	const char* designation(int i) const { return names + (size_t)i * MINOR_BODY_NAME_BYTES; }
+
+	/** Elementos del cuerpo i en el formato de Ephemeris. */
+	KeplerElements elements(int i) const {
+		return KeplerElements::fromClassical(fields[A][i], fields[E][i], fields[I][i], fields[NODE][i],
+			fields[PERI][i], fields[M][i], fields[EPOCH][i]);
+	}
+
+	/**
+	 * Agrega los cuerpos del catálogo a unas efemérides.
+	 *
+	 * @param ephemeris Efemérides de destino
+	 * @param limit     Máximo de cuerpos a agregar (-1 = todos)
+	 * @return          Cuerpos agregados
+	 */
+	int addTo(Ephemeris& ephemeris, int limit = -1) const {
+		int n = limit < 0 ? bodyCount() : std::min(limit, bodyCount());
+		ephemeris.reserve(ephemeris.bodyCount() + n);
+		for (int i = 0; i < n; ++i) ephemeris.addBody(elements(i));
+		return n;
+	}
+
+private:
+	MappedFile file;
+	const MinorBodyFileHeader* header = nullptr;
+	const double* fields[MINOR_BODY_FIELDS] = {};
+	const float* magnitudes = nullptr;
+	const char* names = nullptr;
+};
+
+/**
+ * Resultado de la importación.
+ */
+struct MinorBodyImportReport {
+	const char* format = "";  // "MPCORB" o "CSV"
+	size_t rows = 0;          // Cuerpos escritos
+	size_t rejected = 0;      // Filas sin elementos completos u órbitas no elípticas
+	size_t bytes = 0;         // Tamaño del texto leído
+	int chunks = 0;           // Bloques parseados en paralelo
+	double seconds = 0.0;     // Tiempo total, incluida la escritura del binario
+};
+
+/**
+ * Cuerpos parseados de un bloque del texto, con la misma disposición por campo del binario.
+ */
+struct MinorBodyColumns {
+	std::vector<double> fields[MINOR_BODY_FIELDS];
+	std::vector<float> magnitudes;
+	std::vector<char> names;
+	size_t rejected = 0;
+
+	size_t size() const { return magnitudes.size(); }
+
+	void reserve(size_t n) {
+		for (std::vector<double>& f : fields) f.reserve(n);
+		magnitudes.reserve(n);
+		names.reserve(n * MINOR_BODY_NAME_BYTES);
+	}
+
+	/**
+	 * Agrega un cuerpo; las órbitas que Ephemeris no puede propagar (e >= 1, a <= 0) se descartan.
+	 *
+	 * @param values     a, e, i, node, peri, M, epoch
+	 * @param magnitude  Magnitud absoluta H (NaN si falta)
+	 * @param name       Designación (se recorta a MINOR_BODY_NAME_BYTES - 1 bytes)
+	 * @param nameLength Longitud de la designación
+	 */
+	void push(const double* values, float magnitude, const char* name, size_t nameLength) {
+		if (!(values[MinorBodyCatalog::A] > 0.0) || !(values[MinorBodyCatalog::E] >= 0.0 && values[MinorBodyCatalog::E] < 1.0)) {
+			++rejected;
+			return;
+		}
+		for (int f = 0; f < MINOR_BODY_FIELDS; ++f) fields[f].push_back(values[f]);
+		magnitudes.push_back(magnitude);
+		size_t at = names.size();
+		names.resize(at + MINOR_BODY_NAME_BYTES, '\0');
+		std::memcpy(&names[at], name, std::min(nameLength, (size_t)MINOR_BODY_NAME_BYTES - 1));
+	}
+};
+
+/**
+ * Lectura de filas de MPCORB y CSV del importador (sobre TextScanner).
+ */
+struct MinorBodyParser
+{
+	/**
+	 * Época empaquetada del MPC ("K2555" = 2025-05-05) a fecha juliana (0 h TT).
+	 *
+	 * @return false si el campo no tiene el formato empaquetado
+	 */
+	static bool parsePackedEpoch(const char* p, double& jd) {
+		auto code = [](char c) { return c >= '1' && c <= '9' ? c - '0' : c >= 'A' && c <= 'V' ? c - 'A' + 10 : -1; };
+		int century = p[0] == 'I' ? 18 : p[0] == 'J' ? 19 : p[0] == 'K' ? 20 : -1;
+		int month = code(p[3]);
+		int day = code(p[4]);
+		if (century < 0 || (unsigned)(p[1] - '0') > 9 || (unsigned)(p[2] - '0') > 9 || month < 1 || month > 12 || day < 1) return false;
+		int year = century * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+		jd = julianDateFromCalendar({ year, month, day, 0.0 });
+		return true;
+	}
+
+	/**
+	 * Parsea las filas de MPCORB.DAT (columnas fijas) de [p, end).
+	 * Columnas (desde 0): designación empaquetada 0-6, H 8-12, época 20-24, M 26-34, ω 37-45,
+	 * Ω 48-56, i 59-67, e 70-78, a 92-102 y designación legible 166-193. Las líneas cortas
+	 * (separadores entre secciones) se saltan.
+	 */
+	static void parseMpcorbChunk(const char* p, const char* end, MinorBodyColumns& out) {
+		const int MIN_LENGTH = 103;
+		static const int COLUMNS[MINOR_BODY_FIELDS - 1][2] = {
+			{ 92, 103 }, { 70, 79 }, { 59, 68 }, { 48, 57 }, { 37, 46 }, { 26, 35 } };  // a, e, i, Ω, ω, M
+		while (p < end) {
+			const char* eol = TextScanner::lineEnd(p, end);
+			const char* line = p;
+			p = eol < end ? eol + 1 : end;
+			size_t length = (size_t)(eol - line);
+			if (length > 0 && line[length - 1] == '\r') --length;
+			if (length < (size_t)MIN_LENGTH) continue;
+
+			double values[MINOR_BODY_FIELDS];
+			bool ok = parsePackedEpoch(line + 20, values[MinorBodyCatalog::EPOCH]);
+			for (int f = 0; ok && f < MINOR_BODY_FIELDS - 1; ++f) {
+				ok = TextScanner::parseNumber(line + COLUMNS[f][0], line + COLUMNS[f][1], values[f]);
+			}
+			if (!ok) { ++out.rejected; continue; }
+			double h;
+			float magnitude = TextScanner::parseNumber(line + 8, line + 13, h) ? (float)h : NAN;
+
+			const char* name = line;
+			const char* nameEnd = line + 7;
+			if (length > 166) {
+				const char* readable = line + 166;
+				const char* readableEnd = line + std::min(length, (size_t)194);
+				TextScanner::trimField(readable, readableEnd);
+				if (readable < readableEnd) { name = readable; nameEnd = readableEnd; }
+			}
+			TextScanner::trimField(name, nameEnd);
+			out.push(values, magnitude, name, (size_t)(nameEnd - name));
+		}
+	}
+
+	/** Columnas de una exportación CSV del SBDB que usa el importador (-1 = no está). */
+	struct CsvLayout {
+		int field[MINOR_BODY_FIELDS];
+		int perihelion = -1;      // q: define a = q / (1 - e) en los cometas sin a
+		int epochMjd = -1;        // epoch_mjd en lugar de epoch
+		int magnitude = -1;
+		int name = -1;
+		int columns = 0;
+	};
+
+	/**
+	 * Parsea las filas de un CSV del SBDB de [p, end).
+	 */
+	static void parseCsvChunk(const char* p, const char* end, const CsvLayout& layout, MinorBodyColumns& out) {
+		const int MAX_COLUMNS = 64;
+		const char* starts[MAX_COLUMNS];
+		const char* ends[MAX_COLUMNS];
+		while (p < end) {
+			int count;
+			const char* eol = TextScanner::splitLine(p, end, starts, ends, MAX_COLUMNS, count);
+			p = eol < end ? eol + 1 : end;
+			if (count < layout.columns) {
+				if (count > 1 || ends[0] - starts[0] > 1) ++out.rejected;  // Las líneas vacías no cuentan
+				continue;
+			}
+
+			double values[MINOR_BODY_FIELDS];
+			bool ok = true;
+			for (int f = 0; ok && f < MINOR_BODY_FIELDS; ++f) {
+				int c = f == MinorBodyCatalog::EPOCH && layout.epochMjd >= 0 ? layout.epochMjd : layout.field[f];
+				bool parsed = c >= 0 && TextScanner::parseNumber(starts[c], ends[c], values[f]);
+				if (f == MinorBodyCatalog::A && !parsed) values[f] = NAN;  // Los cometas parabólicos no traen a
+				else ok = parsed;
+			}
+			if (ok && layout.epochMjd >= 0) values[MinorBodyCatalog::EPOCH] += 2400000.5;
+			if (ok && !(values[MinorBodyCatalog::A] == values[MinorBodyCatalog::A])) {  // Sin a: se deduce de q
+				double q;
+				ok = layout.perihelion >= 0 && TextScanner::parseNumber(starts[layout.perihelion], ends[layout.perihelion], q);
+				if (ok) values[MinorBodyCatalog::A] = q / (1.0 - values[MinorBodyCatalog::E]);
+			}
+			if (!ok) { ++out.rejected; continue; }
+			double h;
+			float magnitude = layout.magnitude >= 0 && TextScanner::parseNumber(starts[layout.magnitude], ends[layout.magnitude], h) ? (float)h : NAN;
+
+			const char* name = layout.name >= 0 ? starts[layout.name] : eol;
+			const char* nameEnd = layout.name >= 0 ? ends[layout.name] : eol;
+			TextScanner::trimField(name, nameEnd);
+			out.push(values, magnitude, name, (size_t)(nameEnd - name));
+		}
+	}
+
+	/**
+	 * Interpreta la cabecera de un CSV del SBDB.
+	 *
+	 * @return false si faltan columnas obligatorias (error dice cuáles)
+	 */
+	static bool parseCsvHeader(const char* p, const char* end, CsvLayout& layout, std::string& error) {
+		const int MAX_COLUMNS = 64;
+		const char* starts[MAX_COLUMNS];
+		const char* ends[MAX_COLUMNS];
+		int count;
+		TextScanner::splitLine(p, end, starts, ends, MAX_COLUMNS, count);
+		static const char* const NAMES[MINOR_BODY_FIELDS] = { "a", "e", "i", "om", "w", "ma", "epoch" };
+		for (int& f : layout.field) f = -1;
+		int namePriority = 0;
+		for (int c = 0; c < count; ++c) {
+			const char* s = starts[c];
+			const char* e = ends[c];
+			TextScanner::trimField(s, e);
+			std::string column(s, e);
+			for (int f = 0; f < MINOR_BODY_FIELDS; ++f) if (column == NAMES[f]) layout.field[f] = c;
+			if (column == "q") layout.perihelion = c;
+			if (column == "epoch_mjd") layout.epochMjd = c;
+			if (column == "H") layout.magnitude = c;
+			// Designación: pdes, luego name, full_name o spkid
+			int priority = column == "pdes" ? 4 : column == "name" ? 3 : column == "full_name" ? 2 : column == "spkid" ? 1 : 0;
+			if (priority > namePriority) { namePriority = priority; layout.name = c; }
+		}
+		layout.columns = 0;
+		std::string missing;
+		for (int f = 0; f < MINOR_BODY_FIELDS; ++f) {
+			bool present = layout.field[f] >= 0 || (f == MinorBodyCatalog::EPOCH && layout.epochMjd >= 0) ||
+				(f == MinorBodyCatalog::A && layout.perihelion >= 0);
+			if (!present) missing += std::string(missing.empty() ? "" : ", ") + NAMES[f];
+			layout.columns = std::max(layout.columns, layout.field[f] + 1);
+		}
+		for (int c : { layout.perihelion, layout.epochMjd, layout.magnitude, layout.name }) layout.columns = std::max(layout.columns, c + 1);
+		if (!missing.empty()) {
+			error = "faltan columnas en la cabecera CSV: " + missing;
+			return false;
+		}
+		return true;
+	}
+};
+
+/**
+ * Importa un catálogo de texto (MPCORB.DAT o CSV del SBDB) al binario de MinorBodyCatalog.
+ *
+ * El texto se proyecta en memoria y se corta en bloques de CHUNK_BYTES en límites de línea;
+ * cada bloque se parsea en paralelo a sus propios arreglos por campo (sin memoria compartida
+ * entre hilos) y el binario se escribe bloque por bloque, en el orden del archivo. El formato
+ * se detecta solo: una primera línea con comas es la cabecera de un CSV; si no, es MPCORB
+ * (con su preámbulo opcional hasta la línea de guiones).
+ *
+ * @param textPath   Catálogo de texto
+ * @param binaryPath Binario a escribir
+ * @param error      Salida: motivo del fallo
+ * @param report     Salida opcional con estadísticas
+ * @return           true si el binario se escribió
+ */
+inline bool importMinorBodyCatalog(const char* textPath, const char* binaryPath, std::string& error,
+	MinorBodyImportReport* report = nullptr)
+{
+	typedef MinorBodyParser P;
+	const size_t CHUNK_BYTES = 1 << 20;
+	auto start = std::chrono::steady_clock::now();
+
+	MappedFile text;
+	if (!text.open(textPath)) {
+		error = std::string("no se pudo abrir ") + textPath;
+		return false;
+	}
+	const char* begin = (const char*)text.data();
+	const char* end = begin + text.size();
+
+	// Formato y comienzo de los datos
+	const char* firstEnd = TextScanner::lineEnd(begin, end);
+	bool csv = std::find(begin, firstEnd, ',') != firstEnd;
+	const char* data = begin;
+	P::CsvLayout layout;
+	if (csv) {
+		if (!P::parseCsvHeader(begin, firstEnd, layout, error)) return false;
+		data = firstEnd < end ? firstEnd + 1 : end;
+	}
+	else {
+		// El preámbulo de MPCORB.DAT termina en una línea de guiones
+		const char* limit = begin + std::min(text.size(), (size_t)(64 * 1024));
+		for (const char* line = begin; line < limit; ) {
+			const char* eol = TextScanner::lineEnd(line, end);
+			if (eol - line >= 5 && std::strncmp(line, "-----", 5) == 0) { data = eol < end ? eol + 1 : end; break; }
+			if (eol == end) break;
+			line = eol + 1;
+		}
+	}
+
+	// Bloques en límites de línea
+	size_t dataBytes = (size_t)(end - data);
+	int chunkCount = (int)std::max<size_t>(1, (dataBytes + CHUNK_BYTES - 1) / CHUNK_BYTES);
+	std::vector<const char*> bounds(chunkCount + 1, end);
+	bounds[0] = data;
+	for (int k = 1; k < chunkCount; ++k) {
+		const char* cut = std::max(data + dataBytes * k / chunkCount, bounds[k - 1]);
+		const char* eol = TextScanner::lineEnd(cut, end);
+		bounds[k] = eol < end ? eol + 1 : end;
+	}
+
+	std::vector<MinorBodyColumns> chunks(chunkCount);
+	parallelFor(0, chunkCount, 1, [&](int k) {
+		chunks[k].reserve((size_t)(bounds[k + 1] - bounds[k]) / (csv ? 80 : 200) + 16);
+		if (csv) P::parseCsvChunk(bounds[k], bounds[k + 1], layout, chunks[k]);
+		else P::parseMpcorbChunk(bounds[k], bounds[k + 1], chunks[k]);
+	});
+
+	size_t rows = 0, rejected = 0;
+	for (const MinorBodyColumns& c : chunks) {
+		rows += c.size();
+		rejected += c.rejected;
+	}
+	if (rows == 0) {
+		error = std::string("no se encontraron cuerpos en ") + textPath;
+		return false;
+	}
+
+	// Binario: cada campo completo, recorriendo los bloques en orden
+	MinorBodyFileHeader header = {};
+	std::memcpy(header.magic, MINOR_BODY_MAGIC, sizeof(MINOR_BODY_MAGIC));
+	header.version = MINOR_BODY_VERSION;
+	header.bodyCount = (uint32_t)rows;
+	std::ofstream out(binaryPath, std::ios::binary | std::ios::trunc);
+	if (out) {
+		out.write((const char*)&header, sizeof(header));
+		for (int f = 0; f < MINOR_BODY_FIELDS; ++f) {
+			for (const MinorBodyColumns& c : chunks) out.write((const char*)c.fields[f].data(), c.fields[f].size() * sizeof(double));
+		}
+		for (const MinorBodyColumns& c : chunks) out.write((const char*)c.magnitudes.data(), c.magnitudes.size() * sizeof(float));
+		for (const MinorBodyColumns& c : chunks) out.write(c.names.data(), c.names.size());
+		out.close();
+	}
+	if (!out) {
+		error = std::string("no se pudo escribir ") + binaryPath;
+		return false;
+	}
+
+	if (report) {
+		report->format = csv ? "CSV" : "MPCORB";
+		report->rows = rows;
+		report->rejected = rejected;
+		report->bytes = text.size();
+		report->chunks = chunkCount;
+		report->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	return true;
+}
@@ -0,0 +1,775 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Ephemeris.h"
+#include "Parallel.h"
+#include "SimdMath.h"
+
+// Unidades del sistema N-cuerpos: UA, días y masas solares.
+// G = k², con k la constante gravitacional de Gauss.
+const double GAUSS_K = 0.01720209895;
+const double GRAVITY = GAUSS_K * GAUSS_K;   // UA³ / (M☉ · día²)
+
+// Masas de los planetas en masas solares, en el orden de PLANET_ELEMENTS (Tierra = Tierra + Luna)
+const double PLANET_MASSES[8] = {
+	1.6601e-7, 2.4478e-6, 3.0404e-6, 3.2272e-7, 9.5479e-4, 2.8589e-4, 4.3662e-5, 5.1514e-5
+};
+
+/**
+ * Sistema gravitacional de N cuerpos con fuerzas de Barnes-Hut.
+ *
+ * Los cuerpos se guardan en formato SoA. En cada evaluación de fuerzas los cuerpos se
+ * ordenan por código de Morton, se construye un octree lineal sobre ese orden y los
+ * grupos de cuerpos cercanos (hasta GROUP_SIZE) recorren el árbol en paralelo: un nodo
+ * se aproxima por su centro de masa cuando está más lejos que size / theta (más el
+ * desplazamiento del centro de masa respecto del centro geométrico, lo que garantiza
+ * abrir siempre los nodos que contienen al cuerpo).
+ *
+ * Integradores de paso fijo: leapfrog kick-drift-kick (2.º orden) o la composición de
+ * Yoshida de tres leapfrogs (4.º orden), simplécticos y reversibles con dt negativo.
+ *
+ * Integrador adaptativo: Hermite de 4.º orden con pasos por bloques (Makino y Aarseth 1992).
+ * Cada cuerpo tiene su propio paso, una potencia de 2 de BLOCK_MAX_DT elegida con el
+ * criterio de Aarseth, así que una luna o un encuentro cercano dan pasos cortos mientras
+ * Neptuno avanza BLOCK_MAX_DT días por paso. En cada bloque se predicen todos los cuerpos
+ * y solo se evalúan las fuerzas (aceleración y su derivada) de los que terminan su paso.
+ *
+ * Cada cuerpo tiene su longitud de suavizado (núcleo de Plummer).
+ */
+class NBodySystem
+{
+public:
+	enum Integrator { LEAPFROG, YOSHIDA4, HERMITE_BLOCK };
+
+	static const int LEAF_SIZE = 8;                // Cuerpos máximos por hoja
+	static const int MAX_DEPTH = 21;               // Bits por eje del código de Morton
+	static const int GROUP_SIZE = 32;              // Cuerpos que comparten un recorrido del árbol
+	static constexpr double BLOCK_MAX_DT = 64.0;   // Paso máximo del integrador adaptativo (días, potencia de 2)
+	static const int BLOCK_LEVELS = 40;            // Paso mínimo = BLOCK_MAX_DT / 2^BLOCK_LEVELS
+	static constexpr double BLOCK_RESET = 65536.0; // Días tras los que se resincroniza la rejilla de bloques
+
+	double theta = 0.5;                // Ángulo de apertura (0 = suma directa, máximo 1)
+	Integrator integrator = YOSHIDA4;
+	double accuracy = 0.001;           // Parámetro eta del criterio de Aarseth (menor = pasos más cortos)
+	double time = 0.0;                 // Época del sistema (fecha juliana)
+
+	/** Elimina todos los cuerpos. */
+	void clear() {
+		for (std::vector<double>* v : arrays()) v->clear();
+		accelerationsValid = false;
+		blocksReady = false;
+	}
+
+	/**
+	 * Agrega un cuerpo. Con el integrador adaptativo en curso, antes se sincronizan
+	 * todos los cuerpos a la época actual.
+	 *
+	 * @param x, y, z    Posición (UA)
+	 * @param vx, vy, vz Velocidad (UA/día)
+	 * @param mass       Masa (masas solares; 0 = partícula de prueba)
+	 * @param softening  Longitud de suavizado (UA)
+	 * @return           Índice del cuerpo
+	 */
+	int addBody(double x, double y, double z, double vx, double vy, double vz, double mass, double softening) {
+		synchronize();
+		for (std::vector<double>* v : arrays()) v->push_back(0.0);
+		int i = size() - 1;
+		px[i] = x; py[i] = y; pz[i] = z;
+		vx_[i] = vx; vy_[i] = vy; vz_[i] = vz;
+		m[i] = mass;
+		eps[i] = softening;
+		accelerationsValid = false;
+		return i;
+	}
+
+	int size() const { return (int)px.size(); }
+
+	/** Posición en la época del sistema (predicha si el integrador adaptativo está en curso). */
+	void position(int i, double& x, double& y, double& z) const {
+		if (blocksReady) { x = xp[i]; y = yp[i]; z = zp[i]; }
+		else { x = px[i]; y = py[i]; z = pz[i]; }
+	}
+
+	/** Velocidad en la época del sistema (predicha si el integrador adaptativo está en curso). */
+	void velocity(int i, double& x, double& y, double& z) const {
+		if (blocksReady) { x = vxp[i]; y = vyp[i]; z = vzp[i]; }
+		else { x = vx_[i]; y = vy_[i]; z = vz_[i]; }
+	}
+
+	double mass(int i) const { return m[i]; }
+	double softening(int i) const { return eps[i]; }
+
+	/**
+	 * Reemplaza posición y velocidad del cuerpo i en la época actual. Con el integrador
+	 * adaptativo en curso, antes se sincronizan todos los cuerpos.
+	 */
+	void setBodyState(int i, double x, double y, double z, double vx, double vy, double vz) {
+		synchronize();
+		px[i] = x; py[i] = y; pz[i] = z;
+		vx_[i] = vx; vy_[i] = vy; vz_[i] = vz;
+		accelerationsValid = false;
+	}
+
+	/** Nodos del último octree construido. */
+	int nodeCount() const { return (int)nodes.size(); }
+
+	/** Paso actual del cuerpo i en el integrador adaptativo (días; 0 si no está en curso). */
+	double timestep(int i) const { return blocksReady ? dtb[i] : 0.0; }
+
+	/** Bloques integrados por el integrador adaptativo y evaluaciones de fuerza por cuerpo de todos los integradores (acumulados). */
+	long long blockSteps() const { return blockStepCount; }
+	long long bodyEvaluations() const { return bodyEvaluationCount; }
+
+	/**
+	 * Avanza el sistema un paso. Con el integrador adaptativo equivale a
+	 * advanceAdaptive(time + dt) sin límite de trabajo.
+	 *
+	 * @param dt Paso de tiempo en días (negativo = hacia atrás)
+	 */
+	void step(double dt) {
+		if (px.empty()) { time += dt; return; }
+		if (integrator == HERMITE_BLOCK) {
+			advanceAdaptive(time + dt, -1);
+			return;
+		}
+
+		synchronize();
+		if (integrator == LEAPFROG) {
+			leapfrog(dt);
+		}
+		else {
+			// Coeficientes de Yoshida (1990): w1, w0, w1
+			const double cbrt2 = std::cbrt(2.0);
+			const double w1 = 1.0 / (2.0 - cbrt2);
+			const double w0 = -cbrt2 / (2.0 - cbrt2);
+			leapfrog(w1 * dt);
+			leapfrog(w0 * dt);
+			leapfrog(w1 * dt);
+		}
+		time += dt;
+	}
+
+	/**
+	 * Avanza con el integrador Hermite por bloques hasta una fecha o hasta agotar el
+	 * presupuesto de trabajo. Las posiciones y velocidades públicas quedan predichas
+	 * en la nueva época.
+	 *
+	 * @param targetTime Fecha juliana de destino (anterior a time = hacia atrás)
+	 * @param maxWork    Trabajo máximo en evaluaciones de cuerpos; cada bloque cuenta además
+	 *                   size() / 8 por la predicción y el árbol (negativo = sin límite)
+	 * @return           true si se llegó a targetTime; si no, time queda en el último bloque
+	 */
+	bool advanceAdaptive(double targetTime, long long maxWork) {
+		if (px.empty() || targetTime == time) { time = targetTime; return true; }
+		const double direction = targetTime > time ? 1.0 : -1.0;
+		if (blocksReady && (direction != blockDirection || direction * (time - blockOrigin) > BLOCK_RESET)) {
+			synchronize();
+		}
+		if (!blocksReady) initializeBlocks(direction);
+
+		const int n = size();
+		const double goal = direction * (targetTime - blockOrigin);
+		long long work = 0;
+		bool reached = true;
+		for (;;) {
+			// Próximo bloque: el fin de paso más cercano
+			double next = tb[0] + dtb[0];
+			for (int i = 1; i < n; ++i) next = std::min(next, tb[i] + dtb[i]);
+			if (next > goal) break;
+			if (maxWork >= 0 && work >= maxWork) { reached = false; break; }
+
+			activeList.clear();
+			activeFlags.assign(n, 0);
+			for (int i = 0; i < n; ++i) {
+				if (tb[i] + dtb[i] == next) { activeFlags[i] = 1; activeList.push_back(i); }
+			}
+
+			predictAll(next);
+			ForcePass pass = hermitePass();
+			pass.active = activeFlags.data();
+			computeForces(pass);
+			parallelFor(0, (int)activeList.size(), 256, [&](int k) { correctBody(activeList[k], next, true); });
+
+			blockNow = next;
+			++blockStepCount;
+			bodyEvaluationCount += (long long)activeList.size();
+			work += (long long)activeList.size() + n / 8;
+		}
+
+		double now = reached ? goal : blockNow;
+		time = reached ? targetTime : blockOrigin + direction * now;
+		predictAll(now);
+		return reached;
+	}
+
+	/**
+	 * Lleva todos los cuerpos del integrador adaptativo a la época actual con un paso
+	 * final de cada uno, de modo que el estado deje de depender de la predicción.
+	 * No hace nada si el integrador adaptativo no está en curso.
+	 */
+	void synchronize() {
+		if (!blocksReady) return;
+		const double now = blockDirection * (time - blockOrigin);
+		predictAll(now);
+		computeForces(hermitePass());
+		bodyEvaluationCount += size();
+		parallelFor(0, size(), 256, [&](int i) { correctBody(i, now, false); });
+		blocksReady = false;
+		accelerationsValid = true;  // La aceleración en la época actual queda en ax
+	}
+
+	/** Calcula las aceleraciones de todos los cuerpos con el octree. */
+	void computeAccelerations() {
+		accelerationsValid = true;
+		if (px.empty()) return;
+		ForcePass pass = {};
+		pass.x = px.data(); pass.y = py.data(); pass.z = pz.data();
+		pass.ax = ax.data(); pass.ay = ay.data(); pass.az = az.data();
+		computeForces(pass);
+		bodyEvaluationCount += size();
+	}
+
+	/**
+	 * Aceleración por suma directa O(n²), para validar el octree.
+	 */
+	void computeAccelerationsDirect(std::vector<double>& outX, std::vector<double>& outY, std::vector<double>& outZ) const {
+		int n = size();
+		outX.assign(n, 0.0); outY.assign(n, 0.0); outZ.assign(n, 0.0);
+		parallelFor(0, n, 64, [&](int i) {
+			double sx = 0.0, sy = 0.0, sz = 0.0;
+			for (int j = 0; j < n; ++j) {
+				if (j == i) continue;
+				double dx = px[j] - px[i], dy = py[j] - py[i], dz = pz[j] - pz[i];
+				double r2 = dx * dx + dy * dy + dz * dz + 0.5 * (eps[i] * eps[i] + eps[j] * eps[j]);
+				double f = GRAVITY * m[j] / (r2 * std::sqrt(r2));
+				sx += f * dx; sy += f * dy; sz += f * dz;
+			}
+			outX[i] = sx; outY[i] = sy; outZ[i] = sz;
+		});
+	}
+
+	/** Aceleración del cuerpo i según la última evaluación. */
+	void acceleration(int i, double& x, double& y, double& z) const { x = ax[i]; y = ay[i]; z = az[i]; }
+
+	/**
+	 * Energía total (cinética + potencial suavizado), por suma directa O(n²).
+	 * Pensada para medir la deriva de energía en sistemas de tamaño moderado. Con el
+	 * integrador adaptativo en curso usa el estado predicho (synchronize() lo hace exacto).
+	 */
+	double totalEnergy() const {
+		int n = size();
+		const std::vector<double>& x = blocksReady ? xp : px;
+		const std::vector<double>& y = blocksReady ? yp : py;
+		const std::vector<double>& z = blocksReady ? zp : pz;
+		const std::vector<double>& vx = blocksReady ? vxp : vx_;
+		const std::vector<double>& vy = blocksReady ? vyp : vy_;
+		const std::vector<double>& vz = blocksReady ? vzp : vz_;
+		std::vector<double> partial(n, 0.0);
+		parallelFor(0, n, 64, [&](int i) {
+			double e = 0.5 * m[i] * (vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+			for (int j = i + 1; j < n; ++j) {
+				double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+				double r2 = dx * dx + dy * dy + dz * dz + 0.5 * (eps[i] * eps[i] + eps[j] * eps[j]);
+				e -= GRAVITY * m[i] * m[j] / std::sqrt(r2);
+			}
+			partial[i] = e;
+		});
+		double total = 0.0;
+		for (double e : partial) total += e;
+		return total;
+	}
+
+	/** Traslada posiciones y velocidades al sistema del baricentro. */
+	void toBarycentricFrame() {
+		synchronize();
+		double mt = 0.0, cx = 0.0, cy = 0.0, cz = 0.0, cvx = 0.0, cvy = 0.0, cvz = 0.0;
+		for (int i = 0; i < size(); ++i) {
+			mt += m[i];
+			cx += m[i] * px[i]; cy += m[i] * py[i]; cz += m[i] * pz[i];
+			cvx += m[i] * vx_[i]; cvy += m[i] * vy_[i]; cvz += m[i] * vz_[i];
+		}
+		if (mt <= 0.0) return;
+		for (int i = 0; i < size(); ++i) {
+			px[i] -= cx / mt; py[i] -= cy / mt; pz[i] -= cz / mt;
+			vx_[i] -= cvx / mt; vy_[i] -= cvy / mt; vz_[i] -= cvz / mt;
+		}
+	}
+
+private:
+	/**
+	 * Nodo del octree lineal. Los hijos de un nodo interno son consecutivos y cada nodo
+	 * cubre un rango contiguo de cuerpos en orden de Morton.
+	 */
+	struct OctreeNode {
+		double comX, comY, comZ;  // Centro de masa
+		double comVX, comVY, comVZ; // Velocidad del centro de masa (solo si se calcula la derivada)
+		double mass;
+		double eps2;              // Suavizado² medio ponderado por masa
+		double size;              // Lado del cubo
+		double offset;            // Distancia entre centro de masa y centro geométrico
+		double open2;             // Distancia² mínima para aproximar el nodo
+		int begin, end;           // Rango de cuerpos (orden de Morton)
+		int firstChild;           // -1 en las hojas
+		int childCount;
+	};
+
+	/**
+	 * Entradas y salidas de una evaluación de fuerzas. Las salidas se escriben solo
+	 * para los cuerpos activos, indexadas por el índice original.
+	 */
+	struct ForcePass {
+		const double *x, *y, *z;     // Posiciones de todos los cuerpos
+		const double *vx, *vy, *vz;  // Velocidades (solo si se calcula la derivada)
+		const char* active;          // Cuerpos a evaluar (nullptr = todos)
+		double *ax, *ay, *az;        // Salida: aceleración
+		double *jx, *jy, *jz;        // Salida: derivada de la aceleración (nullptr = no se calcula)
+	};
+
+	// Estado en formato SoA
+	std::vector<double> px, py, pz, vx_, vy_, vz_, ax, ay, az, m, eps;
+	bool accelerationsValid = false;
+
+	// Integrador adaptativo: px..az son el estado de cada cuerpo al inicio de su paso.
+	// Los tiempos de bloque se miden en días desde blockOrigin en la dirección de
+	// integración, así que son múltiplos exactos del paso mínimo.
+	std::vector<double> jx, jy, jz;              // Derivada de la aceleración al inicio del paso
+	std::vector<double> tb, dtb;                 // Inicio y duración del paso de cada cuerpo
+	std::vector<double> xp, yp, zp, vxp, vyp, vzp;  // Estado predicho en el bloque actual
+	std::vector<double> nax, nay, naz, njx, njy, njz;  // Fuerzas en el fin de paso
+	std::vector<int> activeList;
+	std::vector<char> activeFlags;
+	bool blocksReady = false;
+	double blockOrigin = 0.0, blockDirection = 1.0, blockNow = 0.0;
+	long long blockStepCount = 0, bodyEvaluationCount = 0;
+
+	// Datos del octree (reutilizados entre pasos)
+	std::vector<std::pair<uint64_t, int>> keys;   // (código de Morton, índice original)
+	std::vector<double> sx, sy, sz, sm, se2;      // Cuerpos en orden de Morton
+	std::vector<double> svx, svy, svz;            // Velocidades en orden de Morton (solo con derivada)
+	std::vector<char> sActive;                    // Cuerpos activos en orden de Morton
+	std::vector<OctreeNode> nodes;
+	std::vector<int> groups;                      // Nodos que recorren el árbol juntos
+	double rootX = 0.0, rootY = 0.0, rootZ = 0.0, rootSize = 1.0;
+
+	std::vector<std::vector<double>*> arrays() {
+		return { &px, &py, &pz, &vx_, &vy_, &vz_, &ax, &ay, &az, &m, &eps,
+			&jx, &jy, &jz, &tb, &dtb, &xp, &yp, &zp, &vxp, &vyp, &vzp, &nax, &nay, &naz, &njx, &njy, &njz };
+	}
+
+	void leapfrog(double dt) {
+		if (!accelerationsValid) computeAccelerations();
+		kick(0.5 * dt);
+		drift(dt);
+		computeAccelerations();
+		kick(0.5 * dt);
+	}
+
+	void kick(double dt) {
+		parallelFor(0, size(), 4096, [&](int i) {
+			vx_[i] += ax[i] * dt; vy_[i] += ay[i] * dt; vz_[i] += az[i] * dt;
+		});
+	}
+
+	void drift(double dt) {
+		parallelFor(0, size(), 4096, [&](int i) {
+			px[i] += vx_[i] * dt; py[i] += vy_[i] * dt; pz[i] += vz_[i] * dt;
+		});
+	}
+
+	// ===========================================
+	// HERMITE POR BLOQUES
+	// ===========================================
+
+	/** Evaluación con derivada sobre el estado predicho, hacia nax..njz. */
+	ForcePass hermitePass() {
+		ForcePass pass = {};
+		pass.x = xp.data(); pass.y = yp.data(); pass.z = zp.data();
+		pass.vx = vxp.data(); pass.vy = vyp.data(); pass.vz = vzp.data();
+		pass.ax = nax.data(); pass.ay = nay.data(); pass.az = naz.data();
+		pass.jx = njx.data(); pass.jy = njy.data(); pass.jz = njz.data();
+		return pass;
+	}
+
+	/**
+	 * Inicia la rejilla de bloques en la época actual con el estado sincronizado:
+	 * evalúa aceleración y derivada de todos los cuerpos y elige el paso inicial
+	 * 0.01 |a| / |j| (acotado por el criterio de Aarseth de los pasos siguientes).
+	 */
+	void initializeBlocks(double direction) {
+		const int n = size();
+		blockOrigin = time;
+		blockDirection = direction;
+		blockNow = 0.0;
+		for (int i = 0; i < n; ++i) {
+			xp[i] = px[i]; yp[i] = py[i]; zp[i] = pz[i];
+			vxp[i] = vx_[i]; vyp[i] = vy_[i]; vzp[i] = vz_[i];
+		}
+		computeForces(hermitePass());
+		bodyEvaluationCount += n;
+		for (int i = 0; i < n; ++i) {
+			ax[i] = nax[i]; ay[i] = nay[i]; az[i] = naz[i];
+			jx[i] = njx[i]; jy[i] = njy[i]; jz[i] = njz[i];
+			double a = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+			double j = std::sqrt(jx[i] * jx[i] + jy[i] * jy[i] + jz[i] * jz[i]);
+			tb[i] = 0.0;
+			dtb[i] = quantizeStep(j > 0.0 ? 0.01 * a / j : BLOCK_MAX_DT, 0.0, 0.0);
+		}
+		blocksReady = true;
+	}
+
+	/**
+	 * Redondea un paso deseado a la potencia de 2 inferior. Si el cuerpo ya tenía paso,
+	 * solo puede duplicarse, y solo cuando el nuevo paso queda alineado con la rejilla.
+	 */
+	static double quantizeStep(double desired, double start, double previous) {
+		double dt = BLOCK_MAX_DT;
+		for (int level = 0; level < BLOCK_LEVELS && dt > desired; ++level) dt *= 0.5;
+		if (previous > 0.0) {
+			dt = std::min(dt, 2.0 * previous);
+			while (dt > previous && std::fmod(start, dt) != 0.0) dt *= 0.5;
+		}
+		return dt;
+	}
+
+	/** Predice posición y velocidad de todos los cuerpos en el tiempo de bloque "at" (serie de Taylor de 3.er orden). */
+	void predictAll(double at) {
+		parallelFor(0, size(), 4096, [&](int i) {
+			double h = blockDirection * (at - tb[i]);
+			double h2 = h * h * 0.5, h3 = h * h * h / 6.0;
+			xp[i] = px[i] + h * vx_[i] + h2 * ax[i] + h3 * jx[i];
+			yp[i] = py[i] + h * vy_[i] + h2 * ay[i] + h3 * jy[i];
+			zp[i] = pz[i] + h * vz_[i] + h2 * az[i] + h3 * jz[i];
+			vxp[i] = vx_[i] + h * ax[i] + h2 * jx[i];
+			vyp[i] = vy_[i] + h * ay[i] + h2 * jy[i];
+			vzp[i] = vz_[i] + h * az[i] + h2 * jz[i];
+		});
+	}
+
+	/**
+	 * Corrector de Hermite del cuerpo i hasta el tiempo de bloque "at", con las fuerzas
+	 * ya evaluadas en nax..njz. Si chooseStep, elige el próximo paso con el criterio de Aarseth.
+	 */
+	void correctBody(int i, double at, bool chooseStep) {
+		const double h = blockDirection * (at - tb[i]);
+		const double a0[3] = { ax[i], ay[i], az[i] }, a1[3] = { nax[i], nay[i], naz[i] };
+		const double j0[3] = { jx[i], jy[i], jz[i] }, j1[3] = { njx[i], njy[i], njz[i] };
+		double* pos[3] = { &px[i], &py[i], &pz[i] };
+		double* vel[3] = { &vx_[i], &vy_[i], &vz_[i] };
+
+		double snap2 = 0.0, crackle2 = 0.0;  // |a''|² y |a'''|² al final del paso
+		for (int k = 0; k < 3; ++k) {
+			double v0 = *vel[k];
+			double v1 = v0 + 0.5 * h * (a0[k] + a1[k]) + h * h / 12.0 * (j0[k] - j1[k]);
+			*pos[k] += 0.5 * h * (v0 + v1) + h * h / 12.0 * (a0[k] - a1[k]);
+			*vel[k] = v1;
+			if (chooseStep) {
+				double a3 = (12.0 * (a0[k] - a1[k]) + 6.0 * h * (j0[k] + j1[k])) / (h * h * h);
+				double a2 = (-6.0 * (a0[k] - a1[k]) - h * (4.0 * j0[k] + 2.0 * j1[k])) / (h * h) + h * a3;
+				snap2 += a2 * a2;
+				crackle2 += a3 * a3;
+			}
+		}
+		ax[i] = a1[0]; ay[i] = a1[1]; az[i] = a1[2];
+		jx[i] = j1[0]; jy[i] = j1[1]; jz[i] = j1[2];
+
+		if (chooseStep) {
+			double a = std::sqrt(a1[0] * a1[0] + a1[1] * a1[1] + a1[2] * a1[2]);
+			double j = std::sqrt(j1[0] * j1[0] + j1[1] * j1[1] + j1[2] * j1[2]);
+			double snap = std::sqrt(snap2), crackle = std::sqrt(crackle2);
+			double den = j * crackle + snap2;
+			double desired = den > 0.0 ? std::sqrt(accuracy * (a * snap + j * j) / den) : BLOCK_MAX_DT;
+			dtb[i] = quantizeStep(desired, at, dtb[i]);
+		}
+		tb[i] = at;
+	}
+
+	// ===========================================
+	// OCTREE
+	// ===========================================
+
+	/** Construye el octree y evalúa las fuerzas de los cuerpos activos. */
+	void computeForces(const ForcePass& pass) {
+		buildTree(pass);
+
+		const double openScale = 1.0 / std::max(1e-3, std::min(theta, 1.0));
+		for (OctreeNode& node : nodes) {
+			double open = node.size * openScale + node.offset;
+			node.open2 = open * open;
+		}
+
+		groups.clear();
+		collectGroups(0);
+		parallelFor(0, (int)groups.size(), 4, [&](int g) { accelerateGroup(groups[g], pass); });
+	}
+
+	/** Intercala los 21 bits bajos de v con dos ceros entre cada bit. */
+	static uint64_t spreadBits(uint64_t v) {
+		v &= 0x1fffff;
+		v = (v | v << 32) & 0x1f00000000ffffULL;
+		v = (v | v << 16) & 0x1f0000ff0000ffULL;
+		v = (v | v << 8) & 0x100f00f00f00f00fULL;
+		v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+		v = (v | v << 2) & 0x1249249249249249ULL;
+		return v;
+	}
+
+	/** Ordena los cuerpos por código de Morton y construye el octree. */
+	void buildTree(const ForcePass& pass) {
+		int n = size();
+		const double *x = pass.x, *y = pass.y, *z = pass.z;
+
+		// Cubo que contiene a todos los cuerpos
+		double minX = x[0], minY = y[0], minZ = z[0], maxX = minX, maxY = minY, maxZ = minZ;
+		for (int i = 1; i < n; ++i) {
+			minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+			minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+			minZ = std::min(minZ, z[i]); maxZ = std::max(maxZ, z[i]);
+		}
+		rootSize = std::max({ maxX - minX, maxY - minY, maxZ - minZ, 1e-9 }) * 1.0001;
+		rootX = minX; rootY = minY; rootZ = minZ;
+
+		// Códigos de Morton y orden
+		keys.resize(n);
+		const double cells = (double)(1 << MAX_DEPTH);
+		const double scale = cells / rootSize;
+		parallelFor(0, n, 4096, [&](int i) {
+			uint64_t cx = (uint64_t)std::min(cells - 1.0, (x[i] - rootX) * scale);
+			uint64_t cy = (uint64_t)std::min(cells - 1.0, (y[i] - rootY) * scale);
+			uint64_t cz = (uint64_t)std::min(cells - 1.0, (z[i] - rootZ) * scale);
+			keys[i] = { spreadBits(cx) << 2 | spreadBits(cy) << 1 | spreadBits(cz), i };
+		});
+		std::sort(keys.begin(), keys.end());
+
+		const bool withVelocity = pass.jx != nullptr;
+		sx.resize(n); sy.resize(n); sz.resize(n); sm.resize(n); se2.resize(n); sActive.resize(n);
+		if (withVelocity) { svx.resize(n); svy.resize(n); svz.resize(n); }
+		parallelFor(0, n, 4096, [&](int s) {
+			int i = keys[s].second;
+			sx[s] = x[i]; sy[s] = y[i]; sz[s] = z[i]; sm[s] = m[i]; se2[s] = eps[i] * eps[i];
+			sActive[s] = pass.active ? pass.active[i] : 1;
+			if (withVelocity) { svx[s] = pass.vx[i]; svy[s] = pass.vy[i]; svz[s] = pass.vz[i]; }
+		});
+
+		nodes.clear();
+		nodes.push_back(OctreeNode());
+		buildNode(0, 0, n, 0, rootX, rootY, rootZ, withVelocity);
+	}
+
+	/** Llena el nodo con el rango [begin, end) y construye sus hijos recursivamente. */
+	void buildNode(int index, int begin, int end, int depth, double x0, double y0, double z0, bool withVelocity) {
+		double size = rootSize / (double)(1u << depth);
+		{
+			OctreeNode& node = nodes[index];
+			node.begin = begin;
+			node.end = end;
+			node.size = size;
+			node.firstChild = -1;
+			node.childCount = 0;
+		}
+
+		if (end - begin > LEAF_SIZE && depth < MAX_DEPTH) {
+			// Rangos de los octantes: los 3 bits del nivel en el código de Morton
+			int shift = 3 * (MAX_DEPTH - 1 - depth);
+			int bounds[9];
+			bounds[0] = begin;
+			for (int o = 1; o < 8; ++o) {
+				bounds[o] = (int)(std::partition_point(keys.begin() + bounds[o - 1], keys.begin() + end,
+					[&](const std::pair<uint64_t, int>& k) { return (int)((k.first >> shift) & 7) < o; }) - keys.begin());
+			}
+			bounds[8] = end;
+
+			int first = (int)nodes.size();
+			int count = 0;
+			for (int o = 0; o < 8; ++o) if (bounds[o + 1] > bounds[o]) ++count;
+			nodes.resize(nodes.size() + count);
+			nodes[index].firstChild = first;
+			nodes[index].childCount = count;
+
+			double half = size * 0.5;
+			int child = first;
+			for (int o = 0; o < 8; ++o) {
+				if (bounds[o + 1] == bounds[o]) continue;
+				buildNode(child++, bounds[o], bounds[o + 1], depth + 1,
+					x0 + ((o >> 2) & 1) * half, y0 + ((o >> 1) & 1) * half, z0 + (o & 1) * half, withVelocity);
+			}
+		}
+
+		// Centro de masa desde los cuerpos del rango (las partículas sin masa pesan por igual)
+		double mass = 0.0, cx = 0.0, cy = 0.0, cz = 0.0, e2 = 0.0, cvx = 0.0, cvy = 0.0, cvz = 0.0;
+		for (int s = begin; s < end; ++s) {
+			mass += sm[s];
+			cx += sm[s] * sx[s]; cy += sm[s] * sy[s]; cz += sm[s] * sz[s];
+			e2 += sm[s] * se2[s];
+			if (withVelocity) { cvx += sm[s] * svx[s]; cvy += sm[s] * svy[s]; cvz += sm[s] * svz[s]; }
+		}
+		OctreeNode& node = nodes[index];
+		if (mass > 0.0) {
+			node.comX = cx / mass; node.comY = cy / mass; node.comZ = cz / mass; node.eps2 = e2 / mass;
+			node.comVX = cvx / mass; node.comVY = cvy / mass; node.comVZ = cvz / mass;
+		}
+		else {
+			node.comX = x0 + size * 0.5; node.comY = y0 + size * 0.5; node.comZ = z0 + size * 0.5; node.eps2 = 0.0;
+			node.comVX = node.comVY = node.comVZ = 0.0;
+		}
+		node.mass = mass;
+		double ox = node.comX - (x0 + size * 0.5), oy = node.comY - (y0 + size * 0.5), oz = node.comZ - (z0 + size * 0.5);
+		node.offset = std::sqrt(ox * ox + oy * oy + oz * oz);
+	}
+
+	/** Reúne los grupos: los nodos más altos con a lo sumo GROUP_SIZE cuerpos. */
+	void collectGroups(int index) {
+		const OctreeNode& node = nodes[index];
+		if (node.firstChild < 0 || node.end - node.begin <= GROUP_SIZE) {
+			groups.push_back(index);
+			return;
+		}
+		for (int c = 0; c < node.childCount; ++c) collectGroups(node.firstChild + c);
+	}
+
+	/**
+	 * Recorre el octree una vez para todo el grupo y aplica la lista de interacciones a
+	 * cada uno de sus cuerpos activos. El criterio de apertura usa la distancia a la caja
+	 * del grupo, así que es al menos tan estricto como el de cada cuerpo por separado.
+	 * Monopolos y cuerpos cercanos forman una sola lista contigua que se recorre con VDouble.
+	 */
+	void accelerateGroup(int groupNode, const ForcePass& pass) {
+		const OctreeNode& group = nodes[groupNode];
+		bool anyActive = false;
+		for (int s = group.begin; s < group.end && !anyActive; ++s) anyActive = sActive[s] != 0;
+		if (!anyActive) return;
+
+		const bool withJerk = pass.jx != nullptr;
+		thread_local std::vector<double> srcX, srcY, srcZ, srcM, srcHalfE2;  // Fuentes de la lista de interacciones
+		thread_local std::vector<double> srcVX, srcVY, srcVZ;
+		srcX.clear(); srcY.clear(); srcZ.clear(); srcM.clear(); srcHalfE2.clear();
+		srcVX.clear(); srcVY.clear(); srcVZ.clear();
+		auto addSource = [withJerk](double x, double y, double z, double mass, double e2, double vx, double vy, double vz) {
+			srcX.push_back(x); srcY.push_back(y); srcZ.push_back(z); srcM.push_back(mass); srcHalfE2.push_back(0.5 * e2);
+			if (withJerk) { srcVX.push_back(vx); srcVY.push_back(vy); srcVZ.push_back(vz); }
+		};
+
+		double minX = sx[group.begin], maxX = minX, minY = sy[group.begin], maxY = minY, minZ = sz[group.begin], maxZ = minZ;
+		for (int s = group.begin + 1; s < group.end; ++s) {
+			minX = std::min(minX, sx[s]); maxX = std::max(maxX, sx[s]);
+			minY = std::min(minY, sy[s]); maxY = std::max(maxY, sy[s]);
+			minZ = std::min(minZ, sz[s]); maxZ = std::max(maxZ, sz[s]);
+		}
+		const double cx = 0.5 * (minX + maxX), cy = 0.5 * (minY + maxY), cz = 0.5 * (minZ + maxZ);
+		const double hx = 0.5 * (maxX - minX), hy = 0.5 * (maxY - minY), hz = 0.5 * (maxZ - minZ);
+
+		int stack[8 * MAX_DEPTH + 8];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			const OctreeNode& node = nodes[stack[--top]];
+			if (node.mass == 0.0) continue;
+			double dx = std::max(0.0, std::fabs(node.comX - cx) - hx);
+			double dy = std::max(0.0, std::fabs(node.comY - cy) - hy);
+			double dz = std::max(0.0, std::fabs(node.comZ - cz) - hz);
+			double d2 = dx * dx + dy * dy + dz * dz;
+
+			if (d2 > node.open2) {
+				// Monopolo lejano
+				addSource(node.comX, node.comY, node.comZ, node.mass, node.eps2, node.comVX, node.comVY, node.comVZ);
+			}
+			else if (node.firstChild < 0) {
+				for (int j = node.begin; j < node.end; ++j) {
+					if (sm[j] == 0.0) continue;
+					if (withJerk) addSource(sx[j], sy[j], sz[j], sm[j], se2[j], svx[j], svy[j], svz[j]);  // Suma directa
+					else addSource(sx[j], sy[j], sz[j], sm[j], se2[j], 0.0, 0.0, 0.0);
+				}
+			}
+			else {
+				for (int c = 0; c < node.childCount; ++c) stack[top++] = node.firstChild + c;
+			}
+		}
+
+		// Relleno sin masa hasta múltiplo del ancho del vector
+		while (srcM.size() % VDouble::WIDTH != 0) addSource(0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0);
+
+		const int count = (int)srcM.size();
+		const VDouble g = VDouble::set1(GRAVITY);
+		const VDouble three = VDouble::set1(3.0);
+		const VDouble tiny = VDouble::set1(1e-30);  // Evita 0/0 en la interacción de un cuerpo sin suavizado consigo mismo
+		for (int s = group.begin; s < group.end; ++s) {
+			if (!sActive[s]) continue;
+			const VDouble x = VDouble::set1(sx[s]), y = VDouble::set1(sy[s]), z = VDouble::set1(sz[s]);
+			const VDouble halfE2 = VDouble::set1(0.5 * se2[s]) + tiny;
+			VDouble accX = VDouble::set1(0.0), accY = accX, accZ = accX;
+			const int i = keys[s].second;
+
+			if (!withJerk) {
+				for (int k = 0; k < count; k += VDouble::WIDTH) {
+					VDouble rx = VDouble::load(&srcX[k]) - x;
+					VDouble ry = VDouble::load(&srcY[k]) - y;
+					VDouble rz = VDouble::load(&srcZ[k]) - z;
+					VDouble r2 = rx * rx + ry * ry + rz * rz + halfE2 + VDouble::load(&srcHalfE2[k]);
+					VDouble f = g * VDouble::load(&srcM[k]) / (r2 * sqrt(r2));
+					accX = accX + f * rx;
+					accY = accY + f * ry;
+					accZ = accZ + f * rz;
+				}
+			}
+			else {
+				// Derivada de G m r / r³: G m (w / r³ - 3 (r·w) r / r⁵), con w la velocidad relativa
+				const VDouble vx = VDouble::set1(svx[s]), vy = VDouble::set1(svy[s]), vz = VDouble::set1(svz[s]);
+				VDouble jerkX = accX, jerkY = accX, jerkZ = accX;
+				for (int k = 0; k < count; k += VDouble::WIDTH) {
+					VDouble rx = VDouble::load(&srcX[k]) - x;
+					VDouble ry = VDouble::load(&srcY[k]) - y;
+					VDouble rz = VDouble::load(&srcZ[k]) - z;
+					VDouble wx = VDouble::load(&srcVX[k]) - vx;
+					VDouble wy = VDouble::load(&srcVY[k]) - vy;
+					VDouble wz = VDouble::load(&srcVZ[k]) - vz;
+					VDouble r2 = rx * rx + ry * ry + rz * rz + halfE2 + VDouble::load(&srcHalfE2[k]);
+					VDouble f = g * VDouble::load(&srcM[k]) / (r2 * sqrt(r2));
+					VDouble rw = three * (rx * wx + ry * wy + rz * wz) / r2;
+					accX = accX + f * rx;
+					accY = accY + f * ry;
+					accZ = accZ + f * rz;
+					jerkX = jerkX + f * (wx - rw * rx);
+					jerkY = jerkY + f * (wy - rw * ry);
+					jerkZ = jerkZ + f * (wz - rw * rz);
+				}
+				pass.jx[i] = horizontalSum(jerkX);
+				pass.jy[i] = horizontalSum(jerkY);
+				pass.jz[i] = horizontalSum(jerkZ);
+			}
+
+			pass.ax[i] = horizontalSum(accX);
+			pass.ay[i] = horizontalSum(accY);
+			pass.az[i] = horizontalSum(accZ);
+		}
+	}
+};
+
+/**
+ * Carga el Sol y los planetas de las efemérides en el sistema, en el baricentro.
+ * Índice 0 = Sol, 1..8 = planetas. Las velocidades se obtienen por diferencias centradas.
+ *
+ * @param system     Sistema de destino (se vacía)
+ * @param ephemeris  Efemérides con los planetas en los primeros índices
+ * @param planets    Número de planetas a cargar
+ * @param julianDate Época inicial
+ */
+inline void loadPlanetsIntoNBody(NBodySystem& system, const Ephemeris& ephemeris, int planets, double julianDate)
+{
+	const double h = 0.01;  // Días para la derivada numérica
+	system.clear();
+	system.time = julianDate;
+	system.addBody(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);  // Sol
+	for (int i = 0; i < planets; ++i) {
+		double x, y, z, x0, y0, z0, x1, y1, z1;
+		ephemeris.evaluateBody(i, julianDate, x, y, z);
+		ephemeris.evaluateBody(i, julianDate - h, x0, y0, z0);
+		ephemeris.evaluateBody(i, julianDate + h, x1, y1, z1);
+		system.addBody(x, y, z, (x1 - x0) / (2.0 * h), (y1 - y0) / (2.0 * h), (z1 - z0) / (2.0 * h),
+			i < 8 ? PLANET_MASSES[i] : 0.0, 0.0);
+	}
+	system.toBarycentricFrame();
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Conjunto de hilos persistente para repartir bucles entre todos los núcleos.
+ *
+ * Los hilos se crean una sola vez y duermen en una variable de condición entre trabajos,
+ * así que parallelFor() se puede llamar en cada paso de la simulación sin el costo de
+ * crear hilos. El hilo que llama también trabaja. Los índices se reparten en bloques de
+ * "grain" mediante un contador atómico (balanceo dinámico).
+ *
+ * Las llamadas anidadas (desde dentro de un trabajo) se ejecutan en serie.
+ */
+class ThreadPool
+{
+public:
+	/** Instancia global, con un hilo por núcleo lógico (contando al que llama). */
+	static ThreadPool& instance() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& t : workers) t.join();
+	}
+
+	/** Número de hilos que participan en un parallelFor (incluido el que llama). */
+	int threadCount() const { return (int)workers.size() + 1; }
+
+	/**
+	 * Ejecuta fn(i) para todo i en [begin, end), repartido entre los hilos.
+	 * Vuelve cuando todas las iteraciones terminaron.
+	 *
+	 * @param begin Primer índice
+	 * @param end   Índice final (exclusivo)
+	 * @param grain Iteraciones por bloque (mayor = menos sincronización)
+	 * @param fn    Cuerpo del bucle, invocable como fn(int)
+	 */
+	template <class F>
+	void parallelFor(int begin, int end, int grain, F&& fn) {
+		using Fn = typename std::remove_reference<F>::type;
+		grain = std::max(1, grain);
+		if (end - begin <= grain || workers.empty() || insideJob()) {
+			for (int i = begin; i < end; ++i) fn(i);
+			return;
+		}
+
+		std::lock_guard<std::mutex> submit(submitMutex);  // Un trabajo a la vez
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobContext = (void*)&fn;
+			jobInvoke = [](void* context, int i0, int i1) {
+				Fn& f = *(Fn*)context;
+				for (int i = i0; i < i1; ++i) f(i);
+			};
+			jobEnd = end;
+			jobGrain = grain;
+			nextIndex = begin;
+			activeWorkers = (int)workers.size();
+			++generation;
+		}
+		wake.notify_all();
+
+		runChunks();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return activeWorkers == 0; });
+	}
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex submitMutex;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	bool stopping = false;
+	unsigned generation = 0;
+	int activeWorkers = 0;
+
+	// Trabajo actual (se publica bajo mutex al incrementar generation)
+	void* jobContext = nullptr;
+	void (*jobInvoke)(void*, int, int) = nullptr;
+	int jobEnd = 0;
+	int jobGrain = 1;
+	std::atomic<int> nextIndex{ 0 };
+
+	ThreadPool() {
+		unsigned n = std::thread::hardware_concurrency();
+		for (unsigned i = 1; i < n; ++i) {
+			workers.emplace_back(&ThreadPool::workerLoop, this);
+		}
+	}
+
+	static bool& insideJob() {
+		thread_local bool inside = false;
+		return inside;
+	}
+
+	/** Toma bloques del contador hasta agotar el rango. */
+	void runChunks() {
+		insideJob() = true;
+		for (;;) {
+			int i0 = nextIndex.fetch_add(jobGrain);
+			if (i0 >= jobEnd) break;
+			jobInvoke(jobContext, i0, std::min(i0 + jobGrain, jobEnd));
+		}
+		insideJob() = false;
+	}
+
+	void workerLoop() {
+		unsigned seen = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+			}
+			runChunks();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--activeWorkers == 0) finished.notify_one();
+			}
+		}
+	}
+};
+
+/**
+ * Atajo para ThreadPool::instance().parallelFor().
+ */
+template <class F>
+inline void parallelFor(int begin, int end, int grain, F&& fn)
+{
+	ThreadPool::instance().parallelFor(begin, end, grain, std::forward<F>(fn));
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+/**
+ * Tiempo de CPU consumido por el proceso (usuario + sistema), en segundos.
+ * Permite medir el uso real de CPU, por ejemplo cuando la aplicación está en reposo.
+ */
+inline double processCpuSeconds()
+{
+#ifdef _WIN32
+	FILETIME creation, exitTime, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) return 0.0;
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+	return (double)(k.QuadPart + u.QuadPart) * 1e-7;  // Unidades de 100 ns
+#else
+	timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+/**
+ * Estadísticas de rendimiento agregadas en ventanas de ~1 segundo.
+ * Se alimenta una vez por iteración del loop principal, se dibuje o no el frame.
+ */
+struct FrameStats
+{
+	float fps = 0.0f;             // Frames dibujados por segundo
+	float frameMs = 0.0f;         // Tiempo medio entre frames dibujados (ms)
+	float cpuPercent = 0.0f;      // Uso de CPU del proceso (% de un núcleo)
+	int idleWakeups = 0;          // Iteraciones sin dibujar en la última ventana
+
+	/**
+	 * Registra una iteración del loop principal.
+	 *
+	 * @param now      Tiempo actual (glfwGetTime)
+	 * @param rendered Indica si en esta iteración se dibujó un frame
+	 */
+	void update(double now, bool rendered)
+	{
+		if (windowStart < 0.0) {
+			windowStart = now;
+			cpuStart = processCpuSeconds();
+		}
+		if (rendered) ++frames; else ++skipped;
+
+		double elapsed = now - windowStart;
+		if (elapsed < 1.0) return;
+
+		double cpu = processCpuSeconds();
+		fps = (float)(frames / elapsed);
+		frameMs = frames > 0 ? (float)(elapsed * 1000.0 / frames) : 0.0f;
+		cpuPercent = (float)((cpu - cpuStart) / elapsed * 100.0);
+		idleWakeups = skipped;
+
+		windowStart = now;
+		cpuStart = cpu;
+		frames = 0;
+		skipped = 0;
+	}
+
+private:
+	double windowStart = -1.0;
+	double cpuStart = 0.0;
+	int frames = 0;
+	int skipped = 0;
+};
+
+/**
+ * Latencia medida una vez por frame (por ejemplo, de la entrada a la presentación):
+ * media y máximo sobre los últimos HISTORY valores.
+ */
+struct LatencyStats
+{
+	static const int HISTORY = 120;
+
+	/**
+	 * Agrega una medición.
+	 *
+	 * @param seconds Latencia del frame en segundos
+	 */
+	void record(double seconds)
+	{
+		last = seconds;
+		values[next] = seconds;
+		next = (next + 1) % HISTORY;
+		if (count < HISTORY) ++count;
+
+		double sum = 0.0, peak = 0.0;
+		for (int i = 0; i < count; ++i) {
+			sum += values[i];
+			if (values[i] > peak) peak = values[i];
+		}
+		mean = sum / count;
+		worst = peak;
+	}
+
+	float lastMs() const { return (float)(last * 1000.0); }
+	float meanMs() const { return (float)(mean * 1000.0); }
+	float maxMs() const { return (float)(worst * 1000.0); }
+	/** Media en segundos (0 sin mediciones). */
+	double meanSeconds() const { return mean; }
+
+private:
+	double values[HISTORY] = {};
+	int count = 0;
+	int next = 0;
+	double last = 0.0, mean = 0.0, worst = 0.0;
+};
+
+/**
+ * Todos los tiempos de frame de una corrida, para resumirlos al final con percentiles
+ * (la reproducción de una entrada grabada con --bench-replay).
+ */
+struct FrameTimeLog
+{
+	void record(double seconds) { values.push_back(seconds); }
+
+	/** Reserva lugar para n tiempos (así registrar no asigna memoria durante la corrida). */
+	void reserve(size_t n) { values.reserve(n); }
+
+	size_t count() const { return values.size(); }
+
+	double totalSeconds() const
+	{
+		double sum = 0.0;
+		for (double v : values) sum += v;
+		return sum;
+	}
+
+	double meanMs() const { return values.empty() ? 0.0 : totalSeconds() * 1000.0 / values.size(); }
+
+	/**
+	 * Percentil por el método del rango más cercano.
+	 *
+	 * @param p Percentil (0-100); 100 = el máximo
+	 */
+	double percentileMs(double p) const
+	{
+		if (values.empty()) return 0.0;
+		std::vector<double> sorted = values;
+		size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+		size_t index = rank > 0 ? std::min(rank, sorted.size()) - 1 : 0;
+		std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+		return sorted[index] * 1000.0;
+	}
+
+private:
+	std::vector<double> values;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Perfilador de utilización por hilo.
+ *
+ * Cada hilo registra el tiempo que pasa trabajando (no esperando ni durmiendo) con
+ * ProfileScope. El hilo de render llama a sample() una vez por frame y cada ~1 segundo
+ * se calcula la utilización de cada hilo como tiempo ocupado / tiempo real.
+ */
+class Profiler
+{
+public:
+	static const int MAX_THREADS = 8;
+
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Registra un hilo con un nombre para mostrar. Llamar antes de lanzar los hilos.
+	 *
+	 * @param name Nombre del hilo (cadena estática)
+	 * @return     Identificador a usar con addBusy / ProfileScope
+	 */
+	int registerThread(const char* name) {
+		if (count >= MAX_THREADS) return MAX_THREADS - 1;
+		names[count] = name;
+		busyNs[count].store(0);
+		utilization[count] = 0.0f;
+		return count++;
+	}
+
+	/** Suma tiempo ocupado al hilo indicado (seguro desde cualquier hilo). */
+	void addBusy(int id, Clock::duration busy) {
+		busyNs[id].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(), std::memory_order_relaxed);
+	}
+
+	/** Cierra la ventana de medición si pasó ~1 segundo (llamar desde un solo hilo). */
+	void sample() {
+		Clock::time_point now = Clock::now();
+		if (!started) { windowStart = now; started = true; return; }
+
+		double elapsed = std::chrono::duration<double>(now - windowStart).count();
+		if (elapsed < 1.0) return;
+
+		for (int i = 0; i < count; ++i) {
+			int64_t busy = busyNs[i].exchange(0, std::memory_order_relaxed);
+			utilization[i] = (float)(busy * 1e-9 / elapsed * 100.0);
+		}
+		windowStart = now;
+	}
+
+	int threadCount() const { return count; }
+	const char* threadName(int id) const { return names[id]; }
+	float threadUtilization(int id) const { return utilization[id]; }  // Porcentaje 0-100
+
+private:
+	int count = 0;
+	const char* names[MAX_THREADS] = {};
+	std::atomic<int64_t> busyNs[MAX_THREADS] = {};
+	float utilization[MAX_THREADS] = {};
+	bool started = false;
+	Clock::time_point windowStart;
+};
+
+/**
+ * Mide el tiempo ocupado de un bloque y lo acumula en el perfilador al salir del alcance.
+ */
+struct ProfileScope
+{
+	ProfileScope(Profiler& profiler, int threadId)
+		: profiler(profiler), threadId(threadId), start(Profiler::Clock::now()) {}
+
+	~ProfileScope() { profiler.addBusy(threadId, Profiler::Clock::now() - start); }
+
+	Profiler& profiler;
+	int threadId;
+	Profiler::Clock::time_point start;
+};
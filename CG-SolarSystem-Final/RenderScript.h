@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FrameEncoder.h"
+#include "JulianDate.h"
+#include "Simulation.h"
+
+/**
+ * Cuadro clave de la cámara de un guion de render.
+ */
+struct RenderKey {
+	long long frame = 0;
+	double pitch = 0.0;        // Grados
+	double yaw = 0.0;          // Grados
+	double distance = 0.05;    // Distancia al foco en escala real (UA)
+	std::string focus;         // Cuerpo seguido (vacío = el Sol en la vista esquemática)
+};
+
+/**
+ * Cámara de un cuadro, interpolada entre los cuadros clave.
+ */
+struct RenderCamera {
+	double pitch = 0.0;
+	double yaw = 0.0;
+	double distance = 0.05;
+	std::string focus;
+};
+
+/**
+ * Guion de un render por lotes (--render): duración, formato de salida, tiempo simulado y
+ * cuadros clave de la cámara.
+ *
+ * El texto usa la misma forma que scene.txt: propiedades "clave = valor", comentarios con '#'
+ * y un bloque [key N] por cuadro clave. Todo lo que muestra el cuadro N es función de N (la
+ * fecha avanza ticksPerFrame() pasos fijos por cuadro desde startJulianDate y la cámara se
+ * interpola entre claves), así que cualquier tramo de cuadros se puede renderizar por separado
+ * y da lo mismo que renderizar la animación entera.
+ */
+struct RenderScript
+{
+	std::string output = "render";                         // Prefijo de los PNG, archivo .y4m o "|comando"
+	FrameEncoder::Format format = FrameEncoder::PNG_SEQUENCE;
+	int width = 1920, height = 1080;
+	int fps = 30;                                          // Divisor de 1 / Simulation::FIXED_DT
+	long long frames = 0;
+	double startJulianDate = JD_J2000;                     // Fecha del cuadro 0
+	float daysPerSecond = (float)DEFAULT_DAYS_PER_SECOND;  // Días simulados por segundo de video
+	bool trueScale = false;
+	bool orbits = true;
+	bool minorBodies = true;
+	std::vector<RenderKey> keys;                           // Ordenados por cuadro
+
+	/**
+	 * Lee un guion.
+	 *
+	 * @param path  Ruta del guion
+	 * @param error Salida: mensaje con archivo y número de línea
+	 * @return false si no se pudo leer o es inválido
+	 */
+	bool load(const char* path, std::string& error) {
+		std::ifstream in(path, std::ios::binary);
+		if (!in) {
+			error = std::string("No se pudo abrir ") + path;
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		return parse(buffer.str(), path, error);
+	}
+
+	/** Interpreta el texto de un guion; los errores llevan archivo y número de línea. */
+	bool parse(const std::string& source, const char* path, std::string& error) {
+		*this = RenderScript();
+		double seconds = -1.0;
+		int lineNumber = 0;
+		auto fail = [&](int line, const std::string& message) {
+			error = std::string(path) + ":" + std::to_string(line) + ": " + message;
+			return false;
+		};
+
+		size_t pos = 0;
+		while (pos < source.size()) {
+			size_t end = source.find('\n', pos);
+			if (end == std::string::npos) end = source.size();
+			std::string line = trim(source.substr(pos, end - pos));
+			pos = end + 1;
+			++lineNumber;
+			if (line.empty() || line[0] == '#') continue;
+
+			// Cuadro clave: [key N]; hereda la cámara de la clave anterior
+			if (line[0] == '[') {
+				double frame;
+				if (line.back() != ']' || line.compare(0, 4, "[key") != 0 ||
+					!parseNumber(trim(line.substr(4, line.size() - 5)), frame) || frame < 0.0) {
+					return fail(lineNumber, "se esperaba [key cuadro]");
+				}
+				RenderKey key = keys.empty() ? RenderKey() : keys.back();
+				key.frame = (long long)frame;
+				if (!keys.empty() && key.frame <= keys.back().frame) return fail(lineNumber, "los cuadros clave deben ir en orden creciente");
+				keys.push_back(key);
+				continue;
+			}
+
+			size_t equals = line.find('=');
+			if (equals == std::string::npos) return fail(lineNumber, "se esperaba 'clave = valor'");
+			std::string key = trim(line.substr(0, equals));
+			std::string value = trim(line.substr(equals + 1));
+
+			// Propiedades de la clave actual
+			if (!keys.empty()) {
+				RenderKey& k = keys.back();
+				if (key == "focus") { k.focus = value; continue; }
+				double v;
+				if (!parseNumber(value, v)) return fail(lineNumber, "valor numerico invalido en '" + key + "'");
+				if (key == "pitch") k.pitch = v;
+				else if (key == "yaw") k.yaw = v;
+				else if (key == "distance" && v > 0.0) k.distance = v;
+				else return fail(lineNumber, "clave desconocida o invalida en [key]: '" + key + "'");
+				continue;
+			}
+
+			// Propiedades generales
+			if (key == "output") { output = value; continue; }
+			if (key == "format") {
+				if (value == "png") format = FrameEncoder::PNG_SEQUENCE;
+				else if (value == "y4m") format = FrameEncoder::Y4M_STREAM;
+				else return fail(lineNumber, "format debe ser png o y4m");
+				continue;
+			}
+			double numbers[3];
+			int count = 0;
+			std::istringstream values(value);
+			while (count < 3 && values >> numbers[count]) ++count;
+			if (count == 0 || !(values >> std::ws).eof()) return fail(lineNumber, "valor numerico invalido en '" + key + "'");
+			if (key == "size" && count == 2) {
+				width = (int)numbers[0];
+				height = (int)numbers[1];
+			}
+			else if (key == "date" && count == 3) {
+				startJulianDate = julianDateFromCalendar({ (int)numbers[0], (int)numbers[1], (int)numbers[2], 0.0 });
+			}
+			else if (count != 1) return fail(lineNumber, "cantidad de valores invalida en '" + key + "'");
+			else if (key == "fps") fps = (int)numbers[0];
+			else if (key == "frames") frames = (long long)numbers[0];
+			else if (key == "seconds") seconds = numbers[0];
+			else if (key == "julian_date") startJulianDate = numbers[0];
+			else if (key == "days_per_second") daysPerSecond = (float)numbers[0];
+			else if (key == "true_scale") trueScale = numbers[0] != 0.0;
+			else if (key == "orbits") orbits = numbers[0] != 0.0;
+			else if (key == "minor_bodies") minorBodies = numbers[0] != 0.0;
+			else return fail(lineNumber, "clave desconocida '" + key + "'");
+		}
+
+		// Valores derivados y validación
+		if (fps < 1 || fps > 120 || ticksPerFrame() * fps != 120) return fail(lineNumber, "fps debe dividir a 120 (24, 30, 40, 60, 120...)");
+		if (seconds >= 0.0) frames = (long long)std::llround(seconds * fps);
+		if (frames < 1) return fail(lineNumber, "el guion necesita frames o seconds");
+		if (width < 16 || height < 16 || width > 16384 || height > 16384) return fail(lineNumber, "size fuera de rango");
+		if (format == FrameEncoder::Y4M_STREAM && ((width | height) & 1)) return fail(lineNumber, "Y4M 4:2:0 requiere ancho y alto pares");
+		if (output.empty()) return fail(lineNumber, "output vacio");
+		if (keys.empty()) keys.push_back(RenderKey());
+		return true;
+	}
+
+	/** Pasos fijos de simulación por cuadro. */
+	int ticksPerFrame() const {
+		return (int)std::lround(1.0 / (fps * Simulation::FIXED_DT));
+	}
+
+	/**
+	 * Cámara del cuadro: interpolación lineal de los ángulos y geométrica de la distancia entre
+	 * las claves vecinas; el foco es el de la clave anterior.
+	 *
+	 * @param frame Número de cuadro
+	 */
+	RenderCamera cameraAt(long long frame) const {
+		RenderCamera camera;
+		size_t next = 0;
+		while (next < keys.size() && keys[next].frame <= frame) ++next;
+		const RenderKey& a = keys[next > 0 ? next - 1 : 0];
+		const RenderKey& b = keys[next < keys.size() ? next : keys.size() - 1];
+		double t = b.frame > a.frame ? (double)(frame - a.frame) / (double)(b.frame - a.frame) : 0.0;
+		if (t < 0.0) t = 0.0;
+		camera.pitch = a.pitch + (b.pitch - a.pitch) * t;
+		camera.yaw = a.yaw + (b.yaw - a.yaw) * t;
+		camera.distance = a.distance * std::pow(b.distance / a.distance, t);
+		camera.focus = a.focus;
+		return camera;
+	}
+
+private:
+	/** Quita espacios y retornos de carro en los extremos. */
+	static std::string trim(const std::string& s) {
+		size_t first = s.find_first_not_of(" \t\r");
+		if (first == std::string::npos) return "";
+		size_t last = s.find_last_not_of(" \t\r");
+		return s.substr(first, last - first + 1);
+	}
+
+	/** Lee un único número; false si está vacío o sobra texto. */
+	static bool parseNumber(const std::string& value, double& out) {
+		char* end;
+		out = std::strtod(value.c_str(), &end);
+		return end != value.c_str() && *end == '\0';
+	}
+};
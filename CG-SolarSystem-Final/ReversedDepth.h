@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "FloatingOrigin.h"
+
+/**
+ * Buffer de profundidad invertido (reversed-Z) con plano lejano en el infinito.
+ *
+ * La escena 3D se dibuja en un framebuffer propio con profundidad GL_DEPTH_COMPONENT32F (el
+ * de la ventana suele ser de 24 bits enteros) y luego se copia el color a la ventana. La
+ * profundidad se guarda como near / distancia, en [0, 1] gracias a glClipControl; así una
+ * sola pasada resuelve desde la Luna hasta Neptuno sin z-fighting.
+ *
+ * glad.h se generó para OpenGL 3.3 y no incluye glClipControl (4.5 o GL_ARB_clip_control):
+ * se carga con glfwGetProcAddress. Si falta, o si el framebuffer de profundidad flotante no
+ * se puede crear, se usa la profundidad convencional con un plano cercano adaptativo.
+ */
+class ReversedDepth {
+public:
+	/**
+	 * Carga glClipControl y crea el framebuffer de la escena.
+	 *
+	 * @param width  Ancho del framebuffer de la ventana
+	 * @param height Alto del framebuffer de la ventana
+	 * @return true si la profundidad invertida está activa
+	 */
+	bool init(int width, int height) {
+		bool core45 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 5);
+		if (core45 || glfwExtensionSupported("GL_ARB_clip_control")) {
+			clipControl = (ClipControlProc)glfwGetProcAddress("glClipControl");
+		}
+		resize(width, height);
+		reversed = clipControl != nullptr && fbo != 0;
+		if (reversed) clipControl(GL_LOWER_LEFT_VALUE, GL_ZERO_TO_ONE_VALUE);
+		return reversed;
+	}
+
+	/** true si la escena usa profundidad invertida en [0, 1]. */
+	bool isReversed() const { return reversed; }
+
+	/** Framebuffer de la escena (0 si se dibuja directamente en la ventana). */
+	GLuint framebuffer() const { return fbo; }
+
+	/**
+	 * Plano cercano para la proyección. Con profundidad invertida la precisión relativa es
+	 * casi constante y basta el mínimo; con la convencional se acerca al objeto más próximo.
+	 *
+	 * @param minimum        Plano cercano mínimo (unidades de la escena)
+	 * @param nearestSurface Distancia de la cámara a la superficie más cercana
+	 */
+	float nearPlane(float minimum, float nearestSurface) const {
+		if (reversed) return minimum;
+		return glm::max(minimum, nearestSurface * 0.5f);
+	}
+
+	/** Proyección en perspectiva con plano lejano infinito (invertida si está disponible). */
+	glm::mat4 projection(float fovy, float aspect, float nearPlane) const {
+		if (reversed) return reversedInfinitePerspective(fovy, aspect, nearPlane);
+		return glm::infinitePerspective(fovy, aspect, nearPlane);
+	}
+
+	/**
+	 * Empieza la escena 3D: vincula el framebuffer propio (si existe) y limpia color y profundidad.
+	 * Profundidad invertida: se limpia a 0 (infinito) y pasa el fragmento más cercano (GL_GREATER).
+	 */
+	void beginScene(int width, int height, const glm::vec3& clearColor) {
+		if (width != fboWidth || height != fboHeight) resize(width, height);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glViewport(0, 0, width, height);
+		glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
+		glClearDepth(reversed ? 0.0 : 1.0);
+		glDepthFunc(reversed ? GL_GREATER : GL_LESS);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	/**
+	 * Termina la escena 3D: copia el color a la ventana, donde luego dibuja ImGui. Si la escena
+	 * tiene otro tamaño (grabación a otra resolución) se escala conservando la proporción.
+	 *
+	 * @param windowWidth  Ancho del framebuffer de la ventana
+	 * @param windowHeight Alto del framebuffer de la ventana
+	 */
+	void endScene(int windowWidth, int windowHeight) {
+		if (fbo == 0) return;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		if (fboWidth == windowWidth && fboHeight == windowHeight) {
+			glBlitFramebuffer(0, 0, fboWidth, fboHeight, 0, 0, fboWidth, fboHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		}
+		else {
+			float scale = glm::min((float)windowWidth / fboWidth, (float)windowHeight / fboHeight);
+			int w = (int)(fboWidth * scale), h = (int)(fboHeight * scale);
+			int x = (windowWidth - w) / 2, y = (windowHeight - h) / 2;
+			glViewport(0, 0, windowWidth, windowHeight);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);  // Franjas fuera de la imagen escalada
+			glBlitFramebuffer(0, 0, fboWidth, fboHeight, x, y, x + w, y + h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	/** Libera el framebuffer (antes de destruir el contexto). */
+	void destroy() {
+		if (fbo) glDeleteFramebuffers(1, &fbo);
+		if (colorBuffer) glDeleteRenderbuffers(1, &colorBuffer);
+		if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+		fbo = colorBuffer = depthBuffer = 0;
+	}
+
+private:
+	typedef void (APIENTRYP ClipControlProc)(GLenum origin, GLenum depth);
+	static constexpr GLenum GL_LOWER_LEFT_VALUE = 0x8CA1;    // GL_LOWER_LEFT
+	static constexpr GLenum GL_ZERO_TO_ONE_VALUE = 0x935F;   // GL_ZERO_TO_ONE
+	static constexpr GLenum GL_NEGATIVE_ONE_TO_ONE_VALUE = 0x935E;  // GL_NEGATIVE_ONE_TO_ONE
+
+	ClipControlProc clipControl = nullptr;
+	bool reversed = false;
+	GLuint fbo = 0, colorBuffer = 0, depthBuffer = 0;
+	int fboWidth = 0, fboHeight = 0;
+
+	/** (Re)crea los renderbuffers al tamaño de la ventana; si el framebuffer no es completo se descarta. */
+	void resize(int width, int height) {
+		destroy();
+		fboWidth = width > 0 ? width : 1;
+		fboHeight = height > 0 ? height : 1;
+
+		glGenRenderbuffers(1, &colorBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, fboWidth, fboHeight);
+		glGenRenderbuffers(1, &depthBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, fboWidth, fboHeight);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+		bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!complete) {
+			destroy();
+			if (reversed) clipControl(GL_LOWER_LEFT_VALUE, GL_NEGATIVE_ONE_TO_ONE_VALUE);  // Volver a la convención de OpenGL
+			reversed = false;
+		}
+	}
+};
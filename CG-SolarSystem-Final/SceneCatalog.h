@@ -0,0 +1,476 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "MappedFile.h"
+#include "BodyStore.h"
+
+// ===========================================
+// ARCHIVO DE ESCENA
+// ===========================================
+// La escena (cuerpos, lunas, anillos, texturas y tabla educativa) se describe en un texto
+// editable, scene.txt, con un bloque por cuerpo:
+//
+//   [planet Tierra]        tipo (star, planet o satellite) y nombre
+//   ephemeris = 2          clave = valor; el valor es el resto de la línea
+//   # comentario
+//
+// El texto se compila a una forma binaria (scene.bin) que se proyecta en memoria y se usa
+// sin parsear: cabecera, registros de tamaño fijo y una tabla de cadenas. El binario guarda
+// la fecha y el tamaño del texto del que salió; si el texto cambia se vuelve a compilar.
+//
+// FORMATO BINARIO (little-endian):
+//   [SceneFileHeader]
+//   [SceneBodyRecord] x bodyCount     (el padre siempre antes que el hijo)
+//   [char] x stringBytes              (cadenas terminadas en '\0'; el desplazamiento 0 es "")
+
+const char SCENE_MAGIC[8] = { 'C', 'G', 'S', 'C', 'E', 'N', 'E', '1' };
+const uint32_t SCENE_VERSION = 1;
+
+struct SceneFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t bodyCount;
+	uint32_t stringBytes;
+	uint32_t reserved;
+	int64_t sourceTime;       // Fecha de modificación del texto fuente (segundos)
+	uint64_t sourceSize;      // Tamaño del texto fuente (bytes)
+};
+
+struct SceneBodyRecord {
+	uint32_t name;            // Cadenas: desplazamientos en la tabla de cadenas
+	uint32_t texture;
+	uint32_t ringTexture;     // 0 = sin anillos
+	uint32_t kind;            // BodyKind
+	int32_t parent;           // Registro del cuerpo alrededor del que orbita (-1 = ninguno)
+	int32_t ephemeris;        // Planetas: índice en las efemérides (-1 = no es planeta)
+	float orbitRadius;        // Planetas: radio de la órbita en la escena
+	float rotationSpeed;      // Rotación propia (grados/segundo)
+	float size;               // Radio en la vista esquemática
+	float axialTilt;          // Inclinación del eje (grados)
+	float ringRadius;         // Radio de los anillos relativo al del cuerpo
+	float ringThickness;      // Grosor de los anillos relativo al radio del cuerpo
+	float orbitDistance;      // Satélites: distancia al padre en la escena
+	float orbitSpeed;         // Satélites: velocidad orbital (grados/segundo)
+	double radiusAU;          // Radio real (UA)
+	double orbitDistanceAU;   // Satélites: distancia real al padre (UA)
+
+	// Fila de la tabla educativa (hasData = 0: el cuerpo no aparece en la tabla)
+	uint32_t hasData;
+	uint32_t dataName;        // Nombre en la tabla (puede llevar acentos)
+	uint32_t planetType;
+	uint32_t atmosphere;
+	uint32_t funFact;
+	float distanceFromSunAU;
+	float distanceFromSunKM;  // Millones de kilómetros
+	float orbitPeriodDays;
+	float rotationPeriodHours;
+	float diameterKM;
+	float massEarths;
+	float mass;
+	float color[4];
+};
+
+static_assert(sizeof(SceneFileHeader) == 40, "SceneFileHeader debe ocupar 40 bytes");
+static_assert(sizeof(SceneBodyRecord) == 136, "SceneBodyRecord debe ocupar 136 bytes");
+
+/**
+ * Catálogo de la escena leído desde el binario proyectado en memoria.
+ *
+ * load() compila el texto si el binario falta o quedó viejo y lo abre; buildBodies() llena un
+ * BodyStore directamente desde los registros. sourceChanged() permite recargar en caliente:
+ * se consulta de vez en cuando y, si el texto cambió, se vuelve a llamar a load().
+ */
+class SceneCatalog
+{
+public:
+	/**
+	 * Abre la escena: usa el binario si corresponde al texto y si no lo recompila.
+	 * Sin texto fuente se usa el binario tal cual.
+	 *
+	 * @param textPath    Ruta del texto editable
+	 * @param binaryPath  Ruta del binario compilado
+	 * @param planetCount Planetas de las efemérides (límite de los índices "ephemeris")
+	 * @param error       Salida: motivo del fallo
+	 * @return            true si la escena quedó abierta
+	 */
+	bool load(const char* textPath, const char* binaryPath, int planetCount, std::string& error) {
+		close();
+		bool hasSource = fileStamp(textPath, seenTime, seenSize);
+		if (open(binaryPath, planetCount) &&
+			(!hasSource || (header->sourceTime == seenTime && header->sourceSize == seenSize))) {
+			return true;
+		}
+		close();  // En Windows no se puede sobrescribir un archivo proyectado
+		if (!hasSource) {
+			error = std::string("no existe ") + textPath + " ni un " + binaryPath + " valido";
+			return false;
+		}
+		if (!compile(textPath, binaryPath, planetCount, error)) return false;
+		if (!open(binaryPath, planetCount)) {
+			error = std::string("no se pudo abrir ") + binaryPath;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * true si el texto fuente cambió desde el último load() (recarga en caliente).
+	 *
+	 * @param textPath Ruta del texto editable
+	 */
+	bool sourceChanged(const char* textPath) const {
+		int64_t time;
+		uint64_t size;
+		return fileStamp(textPath, time, size) && (time != seenTime || size != seenSize);
+	}
+
+	/** Cierra la proyección del binario. */
+	void close() {
+		file.close();
+		header = nullptr;
+		records = nullptr;
+		strings = nullptr;
+	}
+
+	bool isOpen() const { return header != nullptr; }
+	int bodyCount() const { return header ? (int)header->bodyCount : 0; }
+	const SceneBodyRecord& body(int i) const { return records[i]; }
+
+	/** Cadena de la tabla de cadenas ("" para el desplazamiento 0). */
+	const char* text(uint32_t offset) const { return strings + offset; }
+
+	/**
+	 * Llena un almacén de cuerpos con la escena; el cuerpo i es el registro i.
+	 * Las filas de la tabla educativa se numeran en el orden del archivo.
+	 *
+	 * @param bodies      Almacén vacío
+	 * @param loadTexture Función const char* ruta -> unsigned int textura
+	 */
+	template <class TextureLoader>
+	void buildBodies(BodyStore& bodies, TextureLoader&& loadTexture) const {
+		bodies.reserve(bodyCount());
+		int dataIndex = 0;
+		for (int i = 0; i < bodyCount(); ++i) {
+			const SceneBodyRecord& r = records[i];
+			unsigned int texture = loadTexture(text(r.texture));
+			int row = r.hasData ? dataIndex++ : -1;
+			int b;
+			if (r.kind == BODY_PLANET) {
+				b = bodies.addPlanet(text(r.name), r.ephemeris, r.orbitRadius, r.rotationSpeed, r.size, r.radiusAU, texture, row);
+			}
+			else if (r.kind == BODY_SATELLITE) {
+				b = bodies.addSatellite(text(r.name), r.parent, r.orbitDistance, r.orbitDistanceAU, r.orbitSpeed, r.size, r.radiusAU, texture);
+			}
+			else {
+				b = bodies.addStar(text(r.name), r.size, r.radiusAU, r.rotationSpeed, texture);
+			}
+			bodies.metadata.dataIndex[b] = row;
+			bodies.setAxialTilt(b, r.axialTilt);
+			if (r.ringTexture != 0) bodies.setRing(b, loadTexture(text(r.ringTexture)), r.ringRadius, r.ringThickness);
+		}
+	}
+
+	/**
+	 * Compila el texto de la escena al formato binario.
+	 *
+	 * @param textPath    Ruta del texto editable
+	 * @param binaryPath  Ruta del binario a escribir
+	 * @param planetCount Planetas de las efemérides (límite de los índices "ephemeris")
+	 * @param error       Salida: "archivo:línea: motivo" del primer error
+	 * @return            true si el binario se escribió
+	 */
+	static bool compile(const char* textPath, const char* binaryPath, int planetCount, std::string& error) {
+		std::ifstream in(textPath, std::ios::binary);
+		if (!in) {
+			error = std::string("no se pudo leer ") + textPath;
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		std::vector<Source> sources;
+		if (!parse(buffer.str(), textPath, planetCount, sources, error)) return false;
+
+		// Tabla de cadenas (las repetidas, como las texturas compartidas, se guardan una vez)
+		std::vector<char> table(1, '\0');
+		std::unordered_map<std::string, uint32_t> offsets;
+		auto intern = [&](const std::string& s) -> uint32_t {
+			if (s.empty()) return 0;
+			auto found = offsets.find(s);
+			if (found != offsets.end()) return found->second;
+			uint32_t offset = (uint32_t)table.size();
+			table.insert(table.end(), s.begin(), s.end());
+			table.push_back('\0');
+			offsets[s] = offset;
+			return offset;
+		};
+		std::vector<SceneBodyRecord> out(sources.size());
+		for (size_t i = 0; i < sources.size(); ++i) {
+			const Source& s = sources[i];
+			out[i] = s.record;
+			out[i].name = intern(s.name);
+			out[i].texture = intern(s.texture);
+			out[i].ringTexture = intern(s.ringTexture);
+			out[i].dataName = intern(s.dataName.empty() ? s.name : s.dataName);
+			out[i].planetType = intern(s.planetType);
+			out[i].atmosphere = intern(s.atmosphere);
+			out[i].funFact = intern(s.funFact);
+		}
+
+		SceneFileHeader h = {};
+		std::memcpy(h.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC));
+		h.version = SCENE_VERSION;
+		h.bodyCount = (uint32_t)out.size();
+		h.stringBytes = (uint32_t)table.size();
+		fileStamp(textPath, h.sourceTime, h.sourceSize);
+
+		std::ofstream bin(binaryPath, std::ios::binary | std::ios::trunc);
+		if (bin) {
+			bin.write((const char*)&h, sizeof(h));
+			bin.write((const char*)out.data(), out.size() * sizeof(SceneBodyRecord));
+			bin.write(table.data(), table.size());
+		}
+		if (!bin) {
+			error = std::string("no se pudo escribir ") + binaryPath;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Fecha de modificación y tamaño de un archivo.
+	 *
+	 * @return false si el archivo no existe
+	 */
+	static bool fileStamp(const char* path, int64_t& time, uint64_t& size) {
+		struct stat st;
+		if (stat(path, &st) != 0) return false;
+		time = (int64_t)st.st_mtime;
+		size = (uint64_t)st.st_size;
+		return true;
+	}
+
+private:
+	MappedFile file;
+	const SceneFileHeader* header = nullptr;
+	const SceneBodyRecord* records = nullptr;
+	const char* strings = nullptr;
+	int64_t seenTime = 0;     // Estado del texto fuente en el último load()
+	uint64_t seenSize = 0;
+
+	/** Cuerpo leído del texto, antes de pasar las cadenas a la tabla. */
+	struct Source {
+		SceneBodyRecord record;
+		std::string name, texture, ringTexture, dataName, planetType, atmosphere, funFact;
+	};
+
+	/** Proyecta el binario y valida su estructura (desplazamientos, padres, índices). */
+	bool open(const char* path, int planetCount) {
+		close();
+		if (!file.open(path) || file.size() < sizeof(SceneFileHeader)) { close(); return false; }
+		const SceneFileHeader* h = (const SceneFileHeader*)file.data();
+		size_t stringsStart = sizeof(SceneFileHeader) + (size_t)h->bodyCount * sizeof(SceneBodyRecord);
+		if (std::memcmp(h->magic, SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0 || h->version != SCENE_VERSION ||
+			h->stringBytes == 0 || file.size() != stringsStart + h->stringBytes) {
+			close();
+			return false;
+		}
+		const SceneBodyRecord* r = (const SceneBodyRecord*)(file.data() + sizeof(SceneFileHeader));
+		const char* s = (const char*)file.data() + stringsStart;
+		if (s[0] != '\0' || s[h->stringBytes - 1] != '\0') { close(); return false; }
+		for (uint32_t i = 0; i < h->bodyCount; ++i) {
+			const SceneBodyRecord& b = r[i];
+			for (uint32_t offset : { b.name, b.texture, b.ringTexture, b.dataName, b.planetType, b.atmosphere, b.funFact }) {
+				if (offset >= h->stringBytes) { close(); return false; }
+			}
+			bool valid = b.kind <= BODY_SATELLITE && b.parent < (int32_t)i &&
+				(b.kind != BODY_SATELLITE || b.parent >= 0) &&
+				(b.kind != BODY_PLANET || (b.ephemeris >= 0 && b.ephemeris < planetCount));
+			if (!valid) { close(); return false; }
+		}
+		header = h;
+		records = r;
+		strings = s;
+		return true;
+	}
+
+	/** Interpreta el texto; los errores llevan archivo y número de línea. */
+	static bool parse(const std::string& source, const char* path, int planetCount,
+		std::vector<Source>& bodies, std::string& error) {
+		std::unordered_map<std::string, int> byName;
+		std::vector<int> firstLine;
+		std::vector<std::string> parentNames;
+		std::vector<double> radiusKM, distanceKM, periodDays, orbitSpeed;
+		int lineNumber = 0;
+		auto fail = [&](int line, const std::string& message) {
+			error = std::string(path) + ":" + std::to_string(line) + ": " + message;
+			return false;
+		};
+
+		size_t pos = 0;
+		while (pos < source.size()) {
+			size_t end = source.find('\n', pos);
+			if (end == std::string::npos) end = source.size();
+			std::string line = trim(source.substr(pos, end - pos));
+			pos = end + 1;
+			++lineNumber;
+			if (line.empty() || line[0] == '#') continue;
+
+			// Cabecera de bloque: [tipo Nombre]
+			if (line[0] == '[') {
+				if (line.back() != ']') return fail(lineNumber, "falta ']'");
+				std::string inside = trim(line.substr(1, line.size() - 2));
+				size_t space = inside.find(' ');
+				if (space == std::string::npos) return fail(lineNumber, "se esperaba [tipo Nombre]");
+				std::string kind = inside.substr(0, space);
+				Source b = {};
+				b.name = trim(inside.substr(space + 1));
+				b.record.parent = -1;
+				b.record.ephemeris = -1;
+				b.record.color[0] = b.record.color[1] = b.record.color[2] = b.record.color[3] = 1.0f;
+				if (kind == "star") b.record.kind = BODY_STAR;
+				else if (kind == "planet") b.record.kind = BODY_PLANET;
+				else if (kind == "satellite") b.record.kind = BODY_SATELLITE;
+				else return fail(lineNumber, "tipo desconocido '" + kind + "' (star, planet o satellite)");
+				if (byName.count(b.name)) return fail(lineNumber, "cuerpo repetido '" + b.name + "'");
+				byName[b.name] = (int)bodies.size();
+				bodies.push_back(b);
+				firstLine.push_back(lineNumber);
+				parentNames.push_back("");
+				radiusKM.push_back(-1.0);
+				distanceKM.push_back(0.0);
+				periodDays.push_back(0.0);
+				orbitSpeed.push_back(-1.0);
+				continue;
+			}
+
+			// Propiedad: clave = valor
+			size_t equals = line.find('=');
+			if (equals == std::string::npos) return fail(lineNumber, "se esperaba 'clave = valor'");
+			if (bodies.empty()) return fail(lineNumber, "propiedad fuera de un bloque [tipo Nombre]");
+			std::string key = trim(line.substr(0, equals));
+			std::string value = trim(line.substr(equals + 1));
+			const size_t i = bodies.size() - 1;
+			Source& b = bodies[i];
+			SceneBodyRecord& r = b.record;
+
+			// Propiedades de texto
+			std::string* textField = key == "texture" ? &b.texture : key == "ring_texture" ? &b.ringTexture :
+				key == "table_name" ? &b.dataName : key == "type" ? &b.planetType :
+				key == "atmosphere" ? &b.atmosphere : key == "fact" ? &b.funFact :
+				key == "parent" ? &parentNames[i] : nullptr;
+			if (textField) {
+				*textField = value;
+				if (key != "texture" && key != "ring_texture" && key != "parent") r.hasData = 1;
+				continue;
+			}
+
+			// Propiedades numéricas
+			double numbers[4];
+			int count = parseNumbers(value, numbers, 4);
+			if (count == 0) return fail(lineNumber, "valor numerico invalido en '" + key + "'");
+			if (key == "color") {
+				if (count < 3) return fail(lineNumber, "color necesita 3 o 4 componentes");
+				for (int c = 0; c < count; ++c) r.color[c] = (float)numbers[c];
+				r.hasData = 1;
+				continue;
+			}
+			if (count != 1) return fail(lineNumber, "'" + key + "' lleva un solo numero");
+			double v = numbers[0];
+			bool educational = true;
+			if (key == "distance_au") r.distanceFromSunAU = (float)v;
+			else if (key == "distance_mkm") r.distanceFromSunKM = (float)v;
+			else if (key == "day_hours") r.rotationPeriodHours = (float)v;
+			else if (key == "diameter_km") r.diameterKM = (float)v;
+			else if (key == "mass_earths") r.massEarths = (float)v;
+			else if (key == "mass") r.mass = (float)v;
+			else {
+				educational = false;
+				if (key == "ephemeris") r.ephemeris = (int32_t)v;
+				else if (key == "orbit") r.orbitRadius = (float)v;
+				else if (key == "rotation") r.rotationSpeed = (float)v;
+				else if (key == "size") r.size = (float)v;
+				else if (key == "tilt") r.axialTilt = (float)v;
+				else if (key == "ring_radius") r.ringRadius = (float)v;
+				else if (key == "ring_thickness") r.ringThickness = (float)v;
+				else if (key == "distance") r.orbitDistance = (float)v;
+				else if (key == "radius_km") radiusKM[i] = v;
+				else if (key == "distance_km") distanceKM[i] = v;
+				else if (key == "orbit_speed") orbitSpeed[i] = v;
+				else if (key == "period_days") { periodDays[i] = v; r.orbitPeriodDays = (float)v; }
+				else return fail(lineNumber, "clave desconocida '" + key + "'");
+			}
+			if (educational) r.hasData = 1;
+		}
+
+		// Valores derivados y referencias entre cuerpos
+		const double KM_PER_AU = 149597870.7;
+		std::vector<bool> ephemerisUsed(planetCount > 0 ? planetCount : 0, false);
+		for (size_t i = 0; i < bodies.size(); ++i) {
+			SceneBodyRecord& r = bodies[i].record;
+			int line = firstLine[i];
+			double radius = radiusKM[i] >= 0.0 ? radiusKM[i] : r.diameterKM * 0.5;
+			if (!(radius > 0.0)) return fail(line, "'" + bodies[i].name + "' necesita radius_km o diameter_km");
+			r.radiusAU = radius / KM_PER_AU;
+			if (bodies[i].texture.empty()) return fail(line, "'" + bodies[i].name + "' necesita texture");
+
+			if (r.kind == BODY_PLANET) {
+				if (r.ephemeris < 0 || r.ephemeris >= planetCount) {
+					return fail(line, "'" + bodies[i].name + "': ephemeris debe estar entre 0 y " + std::to_string(planetCount - 1));
+				}
+				if (ephemerisUsed[r.ephemeris]) return fail(line, "ephemeris " + std::to_string(r.ephemeris) + " repetido");
+				ephemerisUsed[r.ephemeris] = true;
+			}
+			if (r.kind == BODY_SATELLITE) {
+				auto parent = byName.find(parentNames[i]);
+				if (parentNames[i].empty() || parent == byName.end() || parent->second >= (int)i) {
+					return fail(line, "'" + bodies[i].name + "': parent debe nombrar un cuerpo definido antes");
+				}
+				r.parent = parent->second;
+				r.orbitDistanceAU = distanceKM[i] / KM_PER_AU;
+				if (orbitSpeed[i] >= 0.0) r.orbitSpeed = (float)orbitSpeed[i];
+				else if (periodDays[i] > 0.0) r.orbitSpeed = (float)(360.0 / periodDays[i] * DEFAULT_DAYS_PER_SECOND);
+				else return fail(line, "'" + bodies[i].name + "' necesita period_days u orbit_speed");
+			}
+		}
+		if (bodies.empty()) return fail(lineNumber, "la escena no tiene cuerpos");
+		return true;
+	}
+
+	/** Quita espacios y retornos de carro en los extremos. */
+	static std::string trim(const std::string& s) {
+		size_t first = s.find_first_not_of(" \t\r");
+		if (first == std::string::npos) return "";
+		size_t last = s.find_last_not_of(" \t\r");
+		return s.substr(first, last - first + 1);
+	}
+
+	/**
+	 * Lee hasta maxCount números separados por espacios.
+	 *
+	 * @return Cantidad leída, o 0 si sobra texto que no es un número
+	 */
+	static int parseNumbers(const std::string& value, double* out, int maxCount) {
+		const char* p = value.c_str();
+		int count = 0;
+		while (*p) {
+			char* end;
+			double v = std::strtod(p, &end);
+			if (end == p || count == maxCount) return 0;
+			out[count++] = v;
+			p = end;
+			while (*p == ' ' || *p == '\t') ++p;
+		}
+		return count;
+	}
+};
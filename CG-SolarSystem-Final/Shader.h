@@ -60,12 +60,23 @@ public:
 
 	void use() { glUseProgram(ID); }
 
-	void setMat4(const std::string& name, const glm::mat4& mat) const {
-		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	// Los nombres se pasan como const char*: con literales no se construye un std::string por llamada
+	void setMat4(const char* name, const glm::mat4& mat) const {
+		glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &mat[0][0]);
 	}
 
-	void setVec3(const std::string& name, const glm::vec3& value) const {
-		glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	void setVec3(const char* name, const glm::vec3& value) const {
+		glUniform3fv(glGetUniformLocation(ID, name), 1, &value[0]);
+	}
+
+	void setFloat(const char* name, float value) const {
+		glUniform1f(glGetUniformLocation(ID, name), value);
+	}
+
+	/** Vincula un bloque de uniforms a un punto de enlace (si el shader lo declara). */
+	void setUniformBlock(const char* name, unsigned int binding) const {
+		unsigned int index = glGetUniformBlockIndex(ID, name);
+		if (index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, binding);
 	}
 
 private:
@@ -0,0 +1,598 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+#include "JulianDate.h"
+#include "Ephemeris.h"
+#include "ChebyshevEphemeris.h"
+#include "NBody.h"
+#include "SnapshotTimeline.h"
+
+// Factor de tiempo por defecto (días simulados por segundo real): un año terrestre en 12 segundos.
+// Las velocidades de rotación en grados/segundo de BodyStore están expresadas para este factor.
+const double DEFAULT_DAYS_PER_SECOND = 365.25 / 12.0;
+
+/**
+ * Parámetros de un planeta para la simulación (constantes durante la simulación).
+ * Las rotaciones y los satélites son animación del render: los resuelve BodyStore.
+ */
+struct BodyMotion {
+	float orbitRadius;     // Radio de la órbita en la escena: el semieje real se escala a este valor
+};
+
+/**
+ * Estado animado de un cuerpo en un instante de la simulación.
+ */
+struct BodyState {
+	glm::vec3 position = glm::vec3(0.0f);  // Posición en la escena (efemérides escaladas a orbitRadius)
+	glm::dvec3 heliocentric = glm::dvec3(0.0);  // Posición real (UA, ejes de la escena) para la escala real
+};
+
+/**
+ * Estructura que representa un meteorito en el sistema de partículas.
+ * Los meteoritos se mueven diagonalmente a través de la pantalla para efectos visuales.
+ */
+struct Meteorite {
+	glm::vec3 position;     // Posición actual en coordenadas normalizadas (-1 a 1)
+	glm::vec3 velocity;     // Vector de velocidad y dirección del movimiento
+	bool isVisible;         // Estado de visibilidad actual
+	float timeToAppear;     // Tiempo futuro en el que aparecerá (no usado actualmente)
+	float initialDelay;     // Retraso inicial antes de la primera aparición
+};
+
+/**
+ * Estado completo de la simulación en un paso fijo.
+ * Los cuerpos son una función cerrada de julianDate (ver Simulation::evaluateBodies).
+ */
+struct SimulationState {
+	double time = 0.0;                   // Tiempo real simulado acumulado (segundos, para los meteoritos)
+	double julianDate = JD_J2000;        // Época de la simulación (fecha juliana, doble precisión)
+	std::vector<BodyState> bodies;       // Un estado por planeta (mismo orden que BodyMotion)
+	bool nbody = false;                  // Posiciones calculadas por el sistema N-cuerpos
+	std::vector<glm::dvec3> particles;   // Cuerpos agregados en modo N-cuerpos (heliocéntricos, UA, ejes de la escena)
+	TimelineInfo timeline;               // Instantáneas registradas en modo N-cuerpos
+	std::vector<Meteorite> meteorites;   // Partículas de la lluvia de meteoritos
+};
+
+/**
+ * Controles de la interfaz que afectan a la simulación.
+ */
+struct SimulationControls {
+	bool paused = false;          // Congelar órbitas y rotaciones (los meteoritos siguen)
+	bool meteoritesEnabled = false;
+	int meteoriteCount = 3;
+};
+
+/**
+ * Parámetros del modo gravitacional N-cuerpos.
+ */
+struct NBodySettings {
+	bool enabled = false;
+	double theta = 0.5;                                       // Ángulo de apertura de Barnes-Hut
+	NBodySystem::Integrator integrator = NBodySystem::HERMITE_BLOCK;
+};
+
+/**
+ * Simulación con paso de tiempo fijo, separada del renderizado.
+ *
+ * El tiempo real de cada frame se acumula y se consume en pasos de FIXED_DT
+ * (varios sub-pasos si el frame fue lento, hasta MAX_SUBSTEPS). Se conservan los
+ * dos últimos estados para que el renderizado interpole entre ellos con alpha().
+ *
+ * La época avanza como ancla + pasos * FIXED_DT * factor de tiempo, sin acumular
+ * errores de redondeo; los ángulos de los cuerpos se evalúan en forma cerrada a partir
+ * de la época, por lo que saltar a cualquier fecha cuesta O(1) por cuerpo.
+ * Las posiciones orbitales salen de las efemérides precalculadas (ChebyshevEphemeris) si
+ * hay un archivo que cubra la fecha, o si no de las efemérides keplerianas (Ephemeris), y
+ * se escalan por cuerpo para conservar las distancias de la escena.
+ *
+ * En modo N-cuerpos los planetas dejan de seguir las efemérides: se integran con
+ * NBodySystem a partir de la época en que se activó el modo, junto con los cuerpos que
+ * agregue el usuario. La época pasa a ser la del sistema N-cuerpos. Mientras avanza se
+ * registran instantáneas en un SnapshotTimeline, cada SNAPSHOT_SECONDS de reproducción o
+ * cada SNAPSHOT_MAX_WORK evaluaciones de fuerza (lo que ocurra antes), y un salto dentro
+ * del tramo registrado restaura la instantánea anterior y reintegra hasta la fecha.
+ */
+class Simulation
+{
+public:
+	static constexpr double FIXED_DT = 1.0 / 120.0;  // Paso de simulación (segundos)
+	static const int MAX_SUBSTEPS = 8;               // Límite de sub-pasos por frame
+	static constexpr double NBODY_DT = 0.5;          // Paso máximo del integrador N-cuerpos (días)
+	static const int NBODY_MAX_STEPS = 64;           // Pasos N-cuerpos por paso fijo (limita el factor de tiempo)
+	static const long long NBODY_MAX_WORK = 8000;    // Trabajo del integrador adaptativo por paso fijo (ver advanceAdaptive)
+	static constexpr double SNAPSHOT_SECONDS = 0.25; // Segundos reales de reproducción entre instantáneas
+	static const long long SNAPSHOT_MAX_WORK = 200000;  // Evaluaciones de fuerza máximas entre instantáneas (acota el costo de un salto)
+
+	/**
+	 * Inicializa los estados y el sistema de partículas.
+	 *
+	 * @param bodyMotions     Parámetros de movimiento de cada planeta
+	 * @param bodyEphemeris   Efemérides con un cuerpo por planeta, en el mismo orden
+	 * @param maxMeteorites   Número máximo de meteoritos simultáneos
+	 * @param startJulianDate Época inicial (fecha juliana)
+	 */
+	void init(const std::vector<BodyMotion>& bodyMotions, const Ephemeris& bodyEphemeris, int maxMeteorites, double startJulianDate) {
+		motions = bodyMotions;
+		ephemeris = bodyEphemeris;
+		displayScale.resize(motions.size());
+		for (size_t i = 0; i < motions.size(); ++i) {
+			displayScale[i] = motions[i].orbitRadius / ephemeris.elements((int)i).a;
+		}
+		// Tramos de la escala radial: el Sol y cada planeta, ordenados por semieje
+		std::vector<std::pair<double, double>> radial = { { 0.0, 0.0 } };
+		for (size_t i = 0; i < motions.size(); ++i) radial.push_back({ ephemeris.elements((int)i).a, motions[i].orbitRadius });
+		std::sort(radial.begin(), radial.end());
+		radialAU.clear();
+		radialScene.clear();
+		for (const auto& p : radial) {
+			radialAU.push_back(p.first);
+			radialScene.push_back(p.second);
+		}
+		current = SimulationState();
+		current.bodies.resize(motions.size());
+		anchorJulianDate = startJulianDate;
+		anchorTicks = 0;
+		current.julianDate = startJulianDate;
+		evaluateBodies(current);
+
+		for (int i = 0; i < maxMeteorites; ++i) {
+			Meteorite m;
+			m.isVisible = false;                                            // Inicialmente invisible
+			m.timeToAppear = 0.0f;
+			m.initialDelay = (float)(rand() % 5000) / 1000.0f;            // Retraso aleatorio 0-5 segundos
+			float randomX = -1.2f - (float)(rand() % 100) / 200.0f;       // Posición inicial X aleatoria
+			float randomY = 1.2f + (float)(rand() % 100) / 200.0f;        // Posición inicial Y aleatoria
+			m.position = glm::vec3(randomX, randomY, 0.0f);
+			float velX = 0.4f + (float)(rand() % 40) / 100.0f;            // Velocidad X aleatoria
+			float velY = -0.4f - (float)(rand() % 40) / 100.0f;           // Velocidad Y aleatoria (hacia abajo)
+			m.velocity = glm::vec3(velX, velY, 0.0f);
+			current.meteorites.push_back(m);
+		}
+		previous = current;
+		accumulator = 0.0;
+	}
+
+	/**
+	 * Consume el tiempo real del frame en pasos fijos.
+	 *
+	 * @param frameDt  Tiempo real transcurrido desde el frame anterior
+	 * @param controls Estado de los controles de la interfaz
+	 * @return         Número de pasos ejecutados
+	 */
+	int advance(double frameDt, const SimulationControls& controls) {
+		accumulator += frameDt;
+		// Protección contra la "espiral de la muerte": descartar el tiempo que no se alcanza a simular
+		if (accumulator > MAX_SUBSTEPS * FIXED_DT) accumulator = MAX_SUBSTEPS * FIXED_DT;
+
+		int steps = 0;
+		while (accumulator >= FIXED_DT) {
+			previous = current;
+			step(current, FIXED_DT, controls);
+			accumulator -= FIXED_DT;
+			++steps;
+		}
+		lastSubsteps = steps;
+		return steps;
+	}
+
+	/** Fracción [0, 1) del siguiente paso ya transcurrida, usada para interpolar. */
+	float alpha() const { return (float)(accumulator / FIXED_DT); }
+
+	/** Pasos ejecutados en el último advance(). */
+	int substeps() const { return lastSubsteps; }
+
+	/** Penúltimo y último estado de paso fijo. */
+	const SimulationState& previousState() const { return previous; }
+	const SimulationState& currentState() const { return current; }
+
+	/**
+	 * Cambia el factor de tiempo. La época actual pasa a ser la nueva ancla.
+	 *
+	 * @param daysPerSecond Días simulados por segundo real (negativo = hacia atrás)
+	 */
+	void setTimeWarp(double daysPerSecond) {
+		if (daysPerSecond == timeWarp) return;
+		anchorJulianDate = current.julianDate;
+		anchorTicks = 0;
+		timeWarp = daysPerSecond;
+	}
+
+	double getTimeWarp() const { return timeWarp; }
+
+	/**
+	 * Salta a una fecha arbitraria en O(1): no hay que integrar el tiempo intermedio.
+	 * En modo N-cuerpos, dentro del tramo registrado se restaura la instantánea anterior y
+	 * se reintegra de forma determinista hasta la fecha (a lo sumo SNAPSHOT_MAX_WORK
+	 * evaluaciones); fuera de él el sistema se reinicia desde las efemérides.
+	 * Ambos estados quedan en la nueva época para que no se interpole a través del salto.
+	 *
+	 * @param julianDate Época de destino (fecha juliana)
+	 */
+	void seek(double julianDate) {
+		anchorJulianDate = julianDate;
+		anchorTicks = 0;
+		current.julianDate = julianDate;
+		if (current.nbody) {
+			if (timeline.covers(julianDate) && timeline.restore(julianDate, nbody)) {
+				integrateTo(julianDate);
+				current.julianDate = nbody.time;
+			}
+			else {
+				// Se reinicia el sistema desde las efemérides: los cuerpos agregados se descartan
+				loadPlanetsIntoNBody(nbody, ephemeris, (int)motions.size(), julianDate);
+				timeline.clear();
+				captureSnapshot();
+			}
+		}
+		evaluateBodies(current);
+		previous = current;
+	}
+
+	/**
+	 * Sitúa la simulación en el paso ticks contado desde startJulianDate, con la misma aritmética
+	 * que step(): la fecha es idéntica a la que se alcanzaría avanzando paso a paso desde la
+	 * época, así que los procesos de un render por lotes coinciden al bit en los bordes de sus
+	 * tramos. Solo fuera del modo N-cuerpos, cuyo estado depende de la historia integrada.
+	 *
+	 * @param startJulianDate Época del paso 0
+	 * @param ticks           Pasos fijos desde la época (puede ser negativo)
+	 */
+	void setEpoch(double startJulianDate, int64_t ticks) {
+		if (current.nbody) return;
+		anchorJulianDate = startJulianDate;
+		anchorTicks = ticks;
+		current.time = (double)ticks * FIXED_DT;
+		current.julianDate = anchorJulianDate + (double)anchorTicks * FIXED_DT * timeWarp;
+		evaluateBodies(current);
+		previous = current;
+		accumulator = 0.0;
+	}
+
+	/**
+	 * Activa o desactiva el modo N-cuerpos. Al activarlo los planetas parten de sus
+	 * posiciones y velocidades de efemérides en la época actual.
+	 *
+	 * @param settings Parámetros del modo
+	 */
+	void setNBodySettings(const NBodySettings& settings) {
+		nbody.theta = settings.theta;
+		nbody.integrator = settings.integrator;
+		if (settings.enabled == current.nbody) return;
+
+		timeline.clear();
+		if (settings.enabled) {
+			loadPlanetsIntoNBody(nbody, ephemeris, (int)motions.size(), current.julianDate);
+			captureSnapshot();
+		}
+		else {
+			nbody.clear();
+			current.timeline = TimelineInfo();
+			anchorJulianDate = current.julianDate;  // Volver a las efemérides desde la época alcanzada
+			anchorTicks = 0;
+		}
+		current.nbody = settings.enabled;
+		evaluateBodies(current);
+		previous = current;
+	}
+
+	bool nbodyEnabled() const { return current.nbody; }
+
+	/**
+	 * Agrega un planeta errante de masa joviana que entra al sistema desde 40 UA
+	 * en una dirección aleatoria. Solo en modo N-cuerpos.
+	 */
+	void addRoguePlanet() {
+		if (!current.nbody) return;
+		const double DISTANCE = 40.0;
+		const double SPEED = 0.005;  // UA/día (~8.7 km/s)
+		double angle = randomUnit() * 2.0 * PI;
+		double aim = (randomUnit() - 0.5) * 10.0;  // Parámetro de impacto (UA)
+		double sunX, sunY, sunZ, sunVX, sunVY, sunVZ;
+		nbody.position(0, sunX, sunY, sunZ);
+		nbody.velocity(0, sunVX, sunVY, sunVZ);
+		double dirX = std::cos(angle), dirY = std::sin(angle);
+		timeline.truncateFrom(nbody.time);  // El futuro registrado ya no corresponde
+		nbody.addBody(sunX + dirX * DISTANCE, sunY + dirY * DISTANCE, sunZ + (randomUnit() - 0.5) * 2.0,
+			sunVX - SPEED * dirX - SPEED * dirY * aim / DISTANCE, sunVY - SPEED * dirY + SPEED * dirX * aim / DISTANCE, sunVZ,
+			1e-3, 1e-3);
+		captureSnapshot();
+		evaluateBodies(current);
+		previous = current;
+	}
+
+	/**
+	 * Agrega partículas de prueba sin masa en órbitas casi circulares del cinturón
+	 * de asteroides (2.2-3.3 UA). Solo en modo N-cuerpos.
+	 *
+	 * @param count Número de asteroides
+	 */
+	void addAsteroids(int count) {
+		if (!current.nbody) return;
+		double sunX, sunY, sunZ, sunVX, sunVY, sunVZ;
+		nbody.position(0, sunX, sunY, sunZ);
+		nbody.velocity(0, sunVX, sunVY, sunVZ);
+		timeline.truncateFrom(nbody.time);
+		for (int i = 0; i < count; ++i) {
+			double r = 2.2 + 1.1 * randomUnit();
+			double angle = randomUnit() * 2.0 * PI;
+			double v = std::sqrt(GRAVITY / r) * (0.95 + 0.1 * randomUnit());
+			double c = std::cos(angle), sn = std::sin(angle);
+			nbody.addBody(sunX + r * c, sunY + r * sn, sunZ + (randomUnit() - 0.5) * 0.2 * r,
+				sunVX - v * sn, sunVY + v * c, sunVZ, 0.0, 1e-4);
+		}
+		captureSnapshot();
+		evaluateBodies(current);
+		previous = current;
+	}
+
+	/** Número de cuerpos del sistema N-cuerpos (Sol, planetas y agregados). */
+	int nbodyCount() const { return nbody.size(); }
+
+	/**
+	 * Interpola entre los dos últimos estados para el renderizado.
+	 *
+	 * @param out Estado de salida (se reutiliza su memoria entre frames)
+	 */
+	void interpolate(SimulationState& out) const {
+		interpolateStates(previous, current, alpha(), out);
+	}
+
+	/**
+	 * Usa un archivo de efemérides precalculadas dentro de su cobertura. Debe contener los
+	 * cuerpos en el mismo orden que las efemérides de init(). Llamar antes de lanzar el hilo.
+	 *
+	 * @param table Archivo abierto, o nullptr para volver a las efemérides keplerianas
+	 */
+	void setPrecomputedEphemeris(const ChebyshevEphemeris* table) {
+		precomputed = table;
+		evaluateBodies(current);
+		previous = current;
+	}
+
+	/** Efemérides de los cuerpos (constantes tras init()). */
+	const Ephemeris& bodyEphemeris() const { return ephemeris; }
+
+	/**
+	 * Convierte una posición heliocéntrica eclíptica (UA) de un cuerpo cualquiera a la escena.
+	 * La distancia al Sol se interpola linealmente entre los semiejes de los planetas y sus
+	 * radios en la escena, así un cuerpo agregado se ve en la zona del planeta más cercano.
+	 */
+	glm::vec3 toSceneRadial(double x, double y, double z) const {
+		return toSceneRadial(toHeliocentric(x, y, z));
+	}
+
+	/** Igual que toSceneRadial(x, y, z) para una posición heliocéntrica ya en ejes de la escena (UA). */
+	glm::vec3 toSceneRadial(const glm::dvec3& p) const {
+		double r = glm::length(p);
+		if (r <= 0.0) return glm::vec3(0.0f);
+		size_t k = 0;
+		while (k + 2 < radialAU.size() && r > radialAU[k + 1]) ++k;  // Tramo [k, k+1]; el último se extrapola
+		double sceneR = radialScene[k] + (r - radialAU[k]) * (radialScene[k + 1] - radialScene[k]) / (radialAU[k + 1] - radialAU[k]);
+		return glm::vec3(p * (sceneR / r));
+	}
+
+	/**
+	 * Pasa una posición heliocéntrica eclíptica (UA) a los ejes de la escena sin escalar:
+	 * eclíptica en el plano XZ con el norte hacia +Y. Es la posición del modo de escala real.
+	 */
+	static glm::dvec3 toHeliocentric(double x, double y, double z) {
+		return glm::dvec3(x, z, -y);
+	}
+
+	/**
+	 * Convierte una posición heliocéntrica eclíptica (UA) del cuerpo i a la escena:
+	 * escala por cuerpo y eclíptica en el plano XZ con el norte hacia +Y.
+	 */
+	glm::vec3 toScene(int i, double x, double y, double z) const {
+		double k = displayScale[i];
+		return glm::vec3((float)(x * k), (float)(z * k), (float)(-y * k));
+	}
+
+	/**
+	 * Interpola entre dos estados arbitrarios. Se interpola la época y los cuerpos se
+	 * evalúan en ella, por lo que el resultado es exacto para cualquier t.
+	 * Solo lee datos constantes tras init(): es seguro llamarla desde el hilo de render.
+	 *
+	 * @param a   Estado anterior
+	 * @param b   Estado siguiente
+	 * @param t   Factor de mezcla [0, 1]
+	 * @param out Estado de salida
+	 */
+	void interpolateStates(const SimulationState& a, const SimulationState& b, float t, SimulationState& out) const {
+		out.time = a.time + (b.time - a.time) * t;
+		out.julianDate = a.julianDate + (b.julianDate - a.julianDate) * t;
+		out.bodies.resize(b.bodies.size());
+		out.nbody = b.nbody;
+		out.timeline = b.timeline;
+		if (b.nbody) {
+			// Las posiciones N-cuerpos no son función de la época: se interpolan las publicadas
+			bool blend = a.nbody;
+			for (size_t i = 0; i < b.bodies.size(); ++i) {
+				out.bodies[i].position = blend ? glm::mix(a.bodies[i].position, b.bodies[i].position, t) : b.bodies[i].position;
+				out.bodies[i].heliocentric = blend ? glm::mix(a.bodies[i].heliocentric, b.bodies[i].heliocentric, (double)t) : b.bodies[i].heliocentric;
+			}
+			out.particles.resize(b.particles.size());
+			for (size_t i = 0; i < b.particles.size(); ++i) {
+				out.particles[i] = blend && i < a.particles.size() ? glm::mix(a.particles[i], b.particles[i], (double)t) : b.particles[i];
+			}
+		}
+		else {
+			out.particles.clear();
+			evaluateBodies(out);
+		}
+
+		out.meteorites.resize(b.meteorites.size());
+		for (size_t i = 0; i < b.meteorites.size(); ++i) {
+			out.meteorites[i] = b.meteorites[i];
+			// Solo interpolar si el meteorito ya era visible (no al reaparecer en la zona de inicio)
+			if (a.meteorites[i].isVisible && b.meteorites[i].isVisible) {
+				out.meteorites[i].position = glm::mix(a.meteorites[i].position, b.meteorites[i].position, t);
+			}
+		}
+	}
+
+private:
+	std::vector<BodyMotion> motions;
+	Ephemeris ephemeris;
+	const ChebyshevEphemeris* precomputed = nullptr;  // Archivo precalculado opcional (no se posee)
+	std::vector<double> displayScale;  // Unidades de escena por UA, por cuerpo
+	std::vector<double> radialAU, radialScene;  // Escala radial por tramos para cuerpos sin escala propia
+	NBodySystem nbody;                 // Sistema gravitacional del modo N-cuerpos (índice 0 = Sol)
+	SnapshotTimeline timeline;         // Instantáneas del sistema N-cuerpos para rebobinar
+	long long snapshotEvaluations = 0; // Evaluaciones de fuerza acumuladas en la última instantánea
+	static constexpr double PI = 3.14159265358979323846;
+	SimulationState previous, current;
+	double accumulator = 0.0;
+	int lastSubsteps = 0;
+
+	double timeWarp = DEFAULT_DAYS_PER_SECOND;  // Días simulados por segundo real
+	double anchorJulianDate = JD_J2000;         // Época al último cambio de factor o salto
+	int64_t anchorTicks = 0;                    // Pasos no pausados desde el ancla
+
+	/**
+	 * Evalúa en forma cerrada las posiciones de todos los planetas en s.julianDate
+	 * (de las efemérides, o del sistema N-cuerpos en ese modo).
+	 * Se llama desde el hilo de simulación y desde el de render: cada uno usa sus propios buffers.
+	 */
+	void evaluateBodies(SimulationState& s) const {
+		thread_local std::vector<double> x, y, z;
+		x.resize(ephemeris.paddedCount());
+		y.resize(ephemeris.paddedCount());
+		z.resize(ephemeris.paddedCount());
+		if (s.nbody) {
+			// Posiciones heliocéntricas del sistema N-cuerpos. Solo el hilo de simulación llega
+			// aquí: el render interpola las posiciones publicadas (ver interpolateStates).
+			int planets = (int)motions.size();
+			s.timeline = timeline.info();
+			s.particles.resize(std::max(0, nbody.size() - 1 - planets));
+			double sunX, sunY, sunZ;
+			nbody.position(0, sunX, sunY, sunZ);
+			for (int i = 1; i < nbody.size(); ++i) {
+				double bx, by, bz;
+				nbody.position(i, bx, by, bz);
+				bx -= sunX; by -= sunY; bz -= sunZ;
+				if (i <= planets) {
+					x[i - 1] = bx; y[i - 1] = by; z[i - 1] = bz;
+				}
+				else {
+					s.particles[i - 1 - planets] = toHeliocentric(bx, by, bz);
+				}
+			}
+		}
+		else if (precomputed && precomputed->covers(s.julianDate)) {
+			for (size_t i = 0; i < motions.size(); ++i) precomputed->position((int)i, s.julianDate, x[i], y[i], z[i]);
+		}
+		else {
+			ephemeris.evaluate(s.julianDate, x.data(), y.data(), z.data());
+		}
+
+		for (size_t i = 0; i < motions.size(); ++i) {
+			s.bodies[i].position = toScene((int)i, x[i], y[i], z[i]);  // Traslación alrededor del Sol
+			s.bodies[i].heliocentric = toHeliocentric(x[i], y[i], z[i]);
+		}
+	}
+
+	/** Registra el estado actual del sistema N-cuerpos en la línea de tiempo. */
+	void captureSnapshot() {
+		timeline.capture(nbody);
+		snapshotEvaluations = nbody.bodyEvaluations();
+	}
+
+	/**
+	 * Indica si toca registrar una instantánea: solo al avanzar más allá de la última (al
+	 * reproducir un tramo ya registrado no se graba) y cuando pasaron SNAPSHOT_SECONDS de
+	 * reproducción al factor de tiempo actual o SNAPSHOT_MAX_WORK evaluaciones de fuerza.
+	 */
+	bool shouldCaptureSnapshot() const {
+		double last = timeline.lastCaptureJulianDate();
+		if (nbody.time <= last) return false;
+		return nbody.time - last >= std::fabs(timeWarp) * SNAPSHOT_SECONDS ||
+			nbody.bodyEvaluations() - snapshotEvaluations >= SNAPSHOT_MAX_WORK;
+	}
+
+	/** Integra el sistema N-cuerpos hasta una fecha sin límite de trabajo, con un esquema determinista. */
+	void integrateTo(double julianDate) {
+		if (nbody.integrator == NBodySystem::HERMITE_BLOCK) {
+			nbody.advanceAdaptive(julianDate, -1);
+			return;
+		}
+		double span = julianDate - nbody.time;
+		int steps = std::max(1, (int)std::ceil(std::fabs(span) / NBODY_DT));
+		for (int i = 0; i < steps; ++i) nbody.step(span / steps);
+	}
+
+	/** Número pseudoaleatorio en [0, 1]. */
+	static double randomUnit() {
+		return (double)rand() / RAND_MAX;
+	}
+
+	/** Avanza el estado un paso fijo dt. */
+	void step(SimulationState& s, double dt, const SimulationControls& controls) {
+		float fdt = (float)dt;
+		s.time += dt;
+
+		// AVANZAR LA ÉPOCA Y EVALUAR LOS CUERPOS
+		if (!controls.paused && s.nbody) {
+			double days = dt * timeWarp;
+			if (nbody.integrator == NBodySystem::HERMITE_BLOCK) {
+				// Pasos por cuerpo; con factores de tiempo extremos la época se atrasa en vez de perder precisión
+				nbody.advanceAdaptive(nbody.time + days, NBODY_MAX_WORK);
+			}
+			else {
+				// Integración numérica con pasos de hasta NBODY_DT días
+				int steps = std::min((int)NBODY_MAX_STEPS, std::max(1, (int)std::ceil(std::fabs(days) / NBODY_DT)));
+				double h = std::max(-NBODY_DT, std::min((double)NBODY_DT, days / steps));
+				for (int i = 0; i < steps; ++i) nbody.step(h);
+			}
+			if (shouldCaptureSnapshot()) captureSnapshot();
+			s.julianDate = nbody.time;
+			evaluateBodies(s);
+		}
+		else if (!controls.paused) {
+			++anchorTicks;
+			s.julianDate = anchorJulianDate + (double)anchorTicks * dt * timeWarp;
+			evaluateBodies(s);
+		}
+
+		// ACTUALIZACIÓN DE METEORITOS
+		float totalTime = (float)s.time;
+		if (controls.meteoritesEnabled) {
+			int count = controls.meteoriteCount < (int)s.meteorites.size() ? controls.meteoriteCount : (int)s.meteorites.size();
+			for (int i = 0; i < count; ++i) {
+				Meteorite& m = s.meteorites[i];
+				if (!m.isVisible) {
+					// Verificar si es momento de hacer aparecer el meteorito
+					if (totalTime > m.initialDelay) {
+						m.isVisible = true;
+						// Reposicionar en zona de aparición
+						float randomX = -1.2f - (float)(rand() % 100) / 200.0f;
+						float randomY = 1.2f + (float)(rand() % 100) / 200.0f;
+						m.position = glm::vec3(randomX, randomY, 0.0f);
+						// Programar próxima aparición
+						m.initialDelay = totalTime + 3.0f + (float)(rand() % 3000) / 1000.0f;
+					}
+				}
+				else {
+					// Mover meteorito según su velocidad
+					m.position += m.velocity * fdt;
+					// Verificar si salió de pantalla (ocultar para reciclaje)
+					if (m.position.x > 1.2f || m.position.y < -1.2f) {
+						m.isVisible = false;
+					}
+				}
+			}
+		}
+		else {
+			// Si los meteoritos están desactivados, ocultar todos
+			for (Meteorite& m : s.meteorites) m.isVisible = false;
+		}
+	}
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+#include "Simulation.h"
+#include "TripleBuffer.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+/**
+ * Instantánea publicada por el hilo de simulación: los dos últimos pasos fijos
+ * y el instante en que se produjo el último, para que el render interpole.
+ */
+struct SimulationSnapshot {
+	SimulationState previous;   // Penúltimo paso
+	SimulationState current;    // Último paso
+	double publishTime = 0.0;   // Instante de publicación (segundos de steady_clock)
+	int substeps = 0;           // Pasos ejecutados en el último tick
+};
+
+/**
+ * Ejecuta la simulación de paso fijo en un hilo dedicado.
+ *
+ * El hilo despierta cada Simulation::FIXED_DT, avanza la simulación y publica una
+ * instantánea en un TripleBuffer. El hilo de render nunca se bloquea: toma la última
+ * instantánea completa con latestSnapshot(). Con la animación pausada y sin meteoritos
+ * el hilo duerme hasta que cambien los controles o se pida un salto de fecha.
+ *
+ * En el modo de paso fijo (grabación, entrada grabada) el reloj no cuenta: el render pide con stepFixed()
+ * una cantidad exacta de pasos por cuadro y dibuja el último, sin interpolar.
+ */
+class SimulationThread
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Se llama (desde el hilo de simulación) al publicar un estado que la escena en reposo
+	// no esperaba, p. ej. tras un salto de fecha en pausa. Debe ser seguro entre hilos.
+	void (*onUnexpectedPublish)() = nullptr;
+
+	/** Segundos de steady_clock, la base de tiempo común entre hilos. */
+	static double now() {
+		return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	 * Lanza el hilo. La simulación ya debe estar inicializada y deja de tocarse desde
+	 * el hilo que llama hasta stop().
+	 *
+	 * @param sim       Simulación a ejecutar
+	 * @param prof      Perfilador donde registrar la utilización
+	 * @param profileId Identificador del hilo en el perfilador
+	 */
+	void start(Simulation& sim, Profiler& prof, int profileId) {
+		simulation = &sim;
+		profiler = &prof;
+		profilerId = profileId;
+
+		// Instantánea inicial para que el render tenga algo que dibujar desde el primer frame
+		publish(0);
+		snapshots.consume();
+
+		running = true;
+		worker = std::thread(&SimulationThread::run, this);
+	}
+
+	/** Detiene y espera al hilo. */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			running = false;
+		}
+		wake.notify_one();
+		if (worker.joinable()) worker.join();
+	}
+
+	/** Actualiza los controles (desde el hilo de render); despierta al hilo si cambiaron. */
+	void setControls(const SimulationControls& controls) {
+		bool changed = controls.paused != paused.load() ||
+			controls.meteoritesEnabled != meteoritesEnabled.load() ||
+			controls.meteoriteCount != meteoriteCount.load();
+		if (!changed) return;
+
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			paused = controls.paused;
+			meteoritesEnabled = controls.meteoritesEnabled;
+			meteoriteCount = controls.meteoriteCount;
+		}
+		wake.notify_one();
+	}
+
+	/**
+	 * Pide saltar a una fecha. Se aplica en el próximo tick del hilo, incluso en pausa.
+	 *
+	 * @param julianDate Época de destino (fecha juliana)
+	 */
+	void requestSeek(double julianDate) {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			seekTarget = julianDate;
+			seekPending = true;
+		}
+		wake.notify_one();
+	}
+
+	/**
+	 * Actualiza los parámetros del modo N-cuerpos. El cambio de modo se aplica en el
+	 * próximo tick del hilo, incluso en pausa.
+	 */
+	void setNBodySettings(const NBodySettings& settings) {
+		nbodyTheta = settings.theta;
+		nbodyIntegrator = (int)settings.integrator;
+		if (settings.enabled == nbodyEnabled.load()) return;
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			nbodyEnabled = settings.enabled;
+		}
+		wake.notify_one();
+	}
+
+	/**
+	 * Pide agregar cuerpos al sistema N-cuerpos.
+	 *
+	 * @param rogues    Planetas errantes
+	 * @param asteroids Asteroides (partículas de prueba)
+	 */
+	void requestBodies(int rogues, int asteroids) {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			pendingRogues += rogues;
+			pendingAsteroids += asteroids;
+		}
+		wake.notify_one();
+	}
+
+	/** Cambia el factor de tiempo (días simulados por segundo real). */
+	void setTimeWarp(double daysPerSecond) {
+		timeWarp = daysPerSecond;
+	}
+
+	/**
+	 * Activa o desactiva el modo de paso fijo. Al desactivarlo la simulación sigue desde el
+	 * estado alcanzado, en tiempo real.
+	 */
+	void setFixedStep(bool enabled) {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			fixedStep = enabled;
+			pendingTicks = 0;
+			requestedTicks = completedTicks = 0;
+		}
+		wake.notify_one();
+	}
+
+	bool isFixedStep() const { return fixedStep; }
+
+	/**
+	 * Modo de paso fijo: avanza ticks pasos de Simulation::FIXED_DT y espera a que se publiquen.
+	 *
+	 * @param ticks Pasos a simular
+	 */
+	void stepFixed(int ticks) {
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		pendingTicks += ticks;
+		long long target = requestedTicks += ticks;
+		wake.notify_one();
+		stepped.wait(lock, [&] { return completedTicks >= target || !running || !fixedStep; });
+	}
+
+	/** Última instantánea completa (solo hilo de render; nunca bloquea). */
+	const SimulationSnapshot& latestSnapshot() {
+		snapshots.consume();
+		return snapshots.readBuffer();
+	}
+
+	/**
+	 * Interpola la instantánea más reciente según el tiempo transcurrido desde su publicación.
+	 *
+	 * @param out Estado de salida para el renderizado
+	 */
+	void interpolate(SimulationState& out) {
+		const SimulationSnapshot& snap = latestSnapshot();
+		float alpha = (float)((now() - snap.publishTime) / Simulation::FIXED_DT);
+		alpha = fixedStep ? 1.0f : std::min(1.0f, std::max(0.0f, alpha));  // Paso fijo: el último estado exacto
+		simulation->interpolateStates(snap.previous, snap.current, alpha, out);
+	}
+
+private:
+	Simulation* simulation = nullptr;
+	Profiler* profiler = nullptr;
+	int profilerId = 0;
+
+	std::thread worker;
+	std::atomic<bool> running{ false };
+	TripleBuffer<SimulationSnapshot> snapshots;
+
+	// Controles compartidos con el hilo de render
+	std::atomic<bool> paused{ false };
+	std::atomic<bool> meteoritesEnabled{ false };
+	std::atomic<int> meteoriteCount{ 3 };
+	std::atomic<double> timeWarp{ DEFAULT_DAYS_PER_SECOND };
+	std::atomic<bool> seekPending{ false };
+	std::atomic<double> seekTarget{ JD_J2000 };
+	std::atomic<bool> nbodyEnabled{ false };
+	std::atomic<double> nbodyTheta{ 0.5 };
+	std::atomic<int> nbodyIntegrator{ (int)NBodySystem::HERMITE_BLOCK };
+	std::atomic<int> pendingRogues{ 0 };
+	std::atomic<int> pendingAsteroids{ 0 };
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+
+	// Modo de paso fijo (contadores protegidos por wakeMutex)
+	std::atomic<bool> fixedStep{ false };
+	int pendingTicks = 0;
+	long long requestedTicks = 0, completedTicks = 0;
+	std::condition_variable stepped;
+
+	/** Copia los dos últimos estados al buffer del productor y lo publica. */
+	void publish(int substeps) {
+		SimulationSnapshot& snap = snapshots.writeBuffer();
+		snap.previous = simulation->previousState();  // Asignación sin realocar tras el primer uso
+		snap.current = simulation->currentState();
+		snap.publishTime = now();
+		snap.substeps = substeps;
+		snapshots.publish();
+	}
+
+	/** Bucle del hilo de simulación. */
+	void run() {
+		const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(Simulation::FIXED_DT));
+		Clock::time_point last = Clock::now();
+		Clock::time_point next = last;
+
+		while (running) {
+			// Paso fijo: los controles, el factor de tiempo y los pedidos se leen recién cuando
+			// llegan los pasos del cuadro, así cada cuadro ve exactamente lo que el render envió
+			// antes de pedirlo (no lo que alcanzó a llegar) y dos corridas iguales dan lo mismo
+			if (fixedStep) {
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wake.wait(lock, [this] { return !running || !fixedStep || pendingTicks > 0; });
+			}
+
+			SimulationControls controls;
+			controls.paused = paused;
+			controls.meteoritesEnabled = meteoritesEnabled;
+			controls.meteoriteCount = meteoriteCount;
+
+			// Cambios pedidos desde la interfaz: se publican de inmediato, incluso en pausa
+			simulation->setTimeWarp(timeWarp);
+			bool changed = false;
+			{
+				ProfileScope scope(*profiler, profilerId);
+				NBodySettings settings;
+				settings.enabled = nbodyEnabled;
+				settings.theta = nbodyTheta;
+				settings.integrator = (NBodySystem::Integrator)nbodyIntegrator.load();
+				changed = settings.enabled != simulation->nbodyEnabled();
+				simulation->setNBodySettings(settings);
+
+				if (seekPending.exchange(false)) {
+					simulation->seek(seekTarget);
+					changed = true;
+				}
+				int rogues = pendingRogues.exchange(0);
+				int asteroids = pendingAsteroids.exchange(0);
+				for (int i = 0; i < rogues; ++i) simulation->addRoguePlanet();
+				if (asteroids > 0) simulation->addAsteroids(asteroids);
+				changed = changed || rogues > 0 || asteroids > 0;
+			}
+			if (changed) {
+				publish(0);
+				if (onUnexpectedPublish) onUnexpectedPublish();
+			}
+
+			// Paso fijo: simular exactamente los pasos pedidos por el render, sin mirar el reloj
+			if (fixedStep) {
+				int ticks;
+				{
+					std::lock_guard<std::mutex> lock(wakeMutex);
+					ticks = pendingTicks;
+					pendingTicks = 0;
+				}
+				if (ticks > 0) {
+					int steps = 0;
+					{
+						ProfileScope scope(*profiler, profilerId);
+						for (int i = 0; i < ticks; ++i) steps += simulation->advance(Simulation::FIXED_DT, controls);
+					}
+					publish(steps);
+					{
+						std::lock_guard<std::mutex> lock(wakeMutex);
+						completedTicks += ticks;
+					}
+					stepped.notify_all();
+				}
+				last = Clock::now();
+				next = last;
+				continue;
+			}
+
+			// Nada que simular: dormir hasta que cambien los controles o se pida un salto
+			if (controls.paused && !controls.meteoritesEnabled) {
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wake.wait(lock, [this] {
+					return !running || !paused || meteoritesEnabled || seekPending || fixedStep ||
+						nbodyEnabled != simulation->nbodyEnabled() || pendingRogues > 0 || pendingAsteroids > 0;
+				});
+				last = Clock::now();
+				next = last;
+				continue;
+			}
+
+			next += period;
+			Clock::time_point nowTime = Clock::now();
+			if (nowTime - next > period * (int)Simulation::MAX_SUBSTEPS) next = nowTime;  // Atraso grande: resincronizar
+			std::this_thread::sleep_until(next);
+
+			nowTime = Clock::now();
+			double dt = std::chrono::duration<double>(nowTime - last).count();
+			last = nowTime;
+
+			ProfileScope scope(*profiler, profilerId);
+			int steps = simulation->advance(dt, controls);
+			if (steps > 0) publish(steps);
+		}
+	}
+};
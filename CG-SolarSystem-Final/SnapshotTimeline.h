@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "NBody.h"
+
+/**
+ * Resumen de la línea de tiempo para la interfaz.
+ */
+struct TimelineInfo {
+	double startJulianDate = 0.0;  // Primera instantánea
+	double endJulianDate = 0.0;    // Última instantánea
+	int snapshots = 0;
+	int keyframes = 0;             // Instantáneas completas (el resto son diferencias)
+	size_t bytes = 0;              // Memoria de las instantáneas codificadas
+	size_t rawBytes = 0;           // Memoria que ocuparían como doubles sin comprimir
+};
+
+/**
+ * Historial de instantáneas del sistema N-cuerpos para rebobinar una simulación que
+ * no tiene forma cerrada.
+ *
+ * capture() cuantiza posiciones y velocidades a una rejilla fija (2^-44 UA y 2^-56 UA/día)
+ * y escribe los valores cuantizados de vuelta en el sistema, así que restaurar una
+ * instantánea reproduce exactamente el estado del que siguió la simulación. La
+ * codificación se hace en un hilo aparte: cada KEYFRAME_INTERVAL instantáneas hay una
+ * completa y las demás guardan en enteros de longitud variable la diferencia con la
+ * anterior (las posiciones, respecto de la predicción con la velocidad media).
+ *
+ * Las instantáneas forman un buffer circular acotado por budgetBytes: al llenarse se
+ * descarta el grupo más antiguo (una completa y sus diferencias).
+ */
+class SnapshotTimeline
+{
+public:
+	static constexpr double POSITION_STEP = 1.0 / 17592186044416.0;      // 2^-44 UA (~8.5 mm)
+	static constexpr double VELOCITY_STEP = 1.0 / 72057594037927936.0;   // 2^-56 UA/día
+	static const int KEYFRAME_INTERVAL = 32;
+
+	size_t budgetBytes = 64u << 20;  // Memoria máxima de las instantáneas
+
+	SnapshotTimeline() = default;
+	SnapshotTimeline(const SnapshotTimeline&) = delete;
+	SnapshotTimeline& operator=(const SnapshotTimeline&) = delete;
+
+	~SnapshotTimeline() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		if (encoder.joinable()) encoder.join();
+	}
+
+	/**
+	 * Registra el estado actual del sistema (sincronizado y cuantizado en el lugar).
+	 * Debe ser posterior a la última instantánea; la codificación es asíncrona.
+	 *
+	 * @param system Sistema a registrar; su estado queda en la rejilla de cuantización
+	 */
+	void capture(NBodySystem& system) {
+		system.synchronize();
+		RawSnapshot raw;
+		raw.julianDate = system.time;
+		raw.values.resize((size_t)system.size() * 6);
+		raw.constants.resize((size_t)system.size() * 2);
+		for (int i = 0; i < system.size(); ++i) {
+			double p[3], v[3];
+			system.position(i, p[0], p[1], p[2]);
+			system.velocity(i, v[0], v[1], v[2]);
+			int64_t* q = &raw.values[(size_t)i * 6];
+			for (int k = 0; k < 3; ++k) {
+				q[k] = quantize(p[k], POSITION_STEP, POSITION_LIMIT);
+				q[3 + k] = quantize(v[k], VELOCITY_STEP, VELOCITY_LIMIT);
+			}
+			system.setBodyState(i, q[0] * POSITION_STEP, q[1] * POSITION_STEP, q[2] * POSITION_STEP,
+				q[3] * VELOCITY_STEP, q[4] * VELOCITY_STEP, q[5] * VELOCITY_STEP);
+			raw.constants[(size_t)i * 2] = system.mass(i);
+			raw.constants[(size_t)i * 2 + 1] = system.softening(i);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!encoder.joinable()) encoder = std::thread(&SnapshotTimeline::encoderLoop, this);
+			pending.push_back(std::move(raw));
+			lastCapture = system.time;
+			anyCapture = true;
+		}
+		wake.notify_all();
+	}
+
+	/**
+	 * Restaura la instantánea más reciente con fecha menor o igual a julianDate.
+	 * El sistema conserva sus parámetros (integrador, theta) y queda en la fecha de la
+	 * instantánea: para llegar a julianDate hay que integrar desde ahí.
+	 *
+	 * @return false si no hay ninguna instantánea anterior a la fecha
+	 */
+	bool restore(double julianDate, NBodySystem& system) {
+		std::unique_lock<std::mutex> lock(mutex);
+		waitIdle(lock);
+		auto it = std::upper_bound(ring.begin(), ring.end(), julianDate,
+			[](double jd, const EncodedSnapshot& s) { return jd < s.julianDate; });
+		if (it == ring.begin()) return false;
+		size_t target = (size_t)(it - ring.begin()) - 1;
+		size_t key = target;
+		while (!ring[key].keyframe) --key;
+
+		RawSnapshot raw;
+		for (size_t k = key; k <= target; ++k) decode(ring[k], raw);
+
+		system.clear();
+		system.time = raw.julianDate;
+		const size_t count = raw.constants.size() / 2;
+		for (size_t i = 0; i < count; ++i) {
+			const int64_t* q = &raw.values[i * 6];
+			system.addBody(q[0] * POSITION_STEP, q[1] * POSITION_STEP, q[2] * POSITION_STEP,
+				q[3] * VELOCITY_STEP, q[4] * VELOCITY_STEP, q[5] * VELOCITY_STEP,
+				raw.constants[i * 2], raw.constants[i * 2 + 1]);
+		}
+		return true;
+	}
+
+	/** Descarta las instantáneas con fecha mayor o igual a julianDate. */
+	void truncateFrom(double julianDate) {
+		std::unique_lock<std::mutex> lock(mutex);
+		waitIdle(lock);
+		while (!ring.empty() && ring.back().julianDate >= julianDate) popBack();
+		anyCapture = !ring.empty();
+		lastCapture = anyCapture ? ring.back().julianDate : 0.0;
+		baseValid = false;  // La próxima instantánea es completa
+	}
+
+	/** Descarta todas las instantáneas. */
+	void clear() {
+		std::unique_lock<std::mutex> lock(mutex);
+		waitIdle(lock);
+		ring.clear();
+		usedBytes = 0;
+		usedRawBytes = 0;
+		keyframeCount = 0;
+		anyCapture = false;
+		lastCapture = 0.0;
+		baseValid = false;
+	}
+
+	/** Indica si hay instantáneas y la fecha está entre la primera y la última capturada. */
+	bool covers(double julianDate) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		double first = ring.empty() ? (pending.empty() ? 0.0 : pending.front().julianDate) : ring.front().julianDate;
+		return anyCapture && julianDate >= first && julianDate <= lastCapture;
+	}
+
+	bool hasCaptures() const { std::lock_guard<std::mutex> lock(mutex); return anyCapture; }
+
+	/** Fecha de la última captura (incluidas las pendientes de codificar). */
+	double lastCaptureJulianDate() const { std::lock_guard<std::mutex> lock(mutex); return lastCapture; }
+
+	/** Resumen de las instantáneas ya codificadas. */
+	TimelineInfo info() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		TimelineInfo out;
+		if (!ring.empty()) {
+			out.startJulianDate = ring.front().julianDate;
+			out.endJulianDate = ring.back().julianDate;
+		}
+		out.snapshots = (int)ring.size();
+		out.keyframes = keyframeCount;
+		out.bytes = usedBytes;
+		out.rawBytes = usedRawBytes;
+		return out;
+	}
+
+private:
+	static constexpr double POSITION_LIMIT = 262144.0;  // UA; fuera de este rango las posiciones se saturan
+	static constexpr double VELOCITY_LIMIT = 64.0;      // UA/día
+
+	/** Estado cuantizado: 6 enteros (posición y velocidad) y 2 doubles (masa y suavizado) por cuerpo. */
+	struct RawSnapshot {
+		double julianDate = 0.0;
+		std::vector<int64_t> values;
+		std::vector<double> constants;
+	};
+
+	struct EncodedSnapshot {
+		double julianDate;
+		uint32_t bodyCount;
+		bool keyframe;
+		std::vector<uint8_t> data;
+	};
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;   // Hay trabajo pendiente o hay que terminar
+	std::condition_variable idle;   // El codificador terminó todo lo pendiente
+	std::thread encoder;
+	bool stopping = false;
+	bool busy = false;
+	std::deque<RawSnapshot> pending;
+	std::deque<EncodedSnapshot> ring;
+	size_t usedBytes = 0, usedRawBytes = 0;
+	int keyframeCount = 0;
+	double lastCapture = 0.0;
+	bool anyCapture = false;
+
+	// Base de las diferencias (solo la usa el codificador, o los demás con el codificador ocioso)
+	RawSnapshot base;
+	bool baseValid = false;
+	int sinceKeyframe = 0;
+
+	static int64_t quantize(double value, double step, double limit) {
+		return (int64_t)std::llround(std::max(-limit, std::min(limit, value)) / step);
+	}
+
+	/** Predicción de la posición cuantizada con la velocidad media entre instantáneas. */
+	static int64_t predictPosition(int64_t x0, int64_t v0, int64_t v1, double days) {
+		return x0 + (int64_t)std::llround(0.5 * (double)(v0 + v1) * days * (VELOCITY_STEP / POSITION_STEP));
+	}
+
+	static void writeVarint(std::vector<uint8_t>& out, int64_t value) {
+		uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+		while (zigzag >= 0x80) {
+			out.push_back((uint8_t)(zigzag | 0x80));
+			zigzag >>= 7;
+		}
+		out.push_back((uint8_t)zigzag);
+	}
+
+	static int64_t readVarint(const uint8_t*& p) {
+		uint64_t zigzag = 0;
+		int shift = 0;
+		for (;;) {
+			uint8_t b = *p++;
+			zigzag |= (uint64_t)(b & 0x7f) << shift;
+			if (!(b & 0x80)) break;
+			shift += 7;
+		}
+		return (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+	}
+
+	/** Codifica una instantánea completa o como diferencia con base. */
+	static void encode(const RawSnapshot& raw, const RawSnapshot* base, std::vector<uint8_t>& out) {
+		const size_t count = raw.constants.size() / 2;
+		out.clear();
+		out.reserve(count * (base ? 30 : 64));
+		for (size_t i = 0; i < count; ++i) {
+			const int64_t* q = &raw.values[i * 6];
+			if (!base) {
+				for (int k = 0; k < 6; ++k) writeVarint(out, q[k]);
+				const uint8_t* c = (const uint8_t*)&raw.constants[i * 2];
+				out.insert(out.end(), c, c + 2 * sizeof(double));
+				continue;
+			}
+			const int64_t* b = &base->values[i * 6];
+			double days = raw.julianDate - base->julianDate;
+			for (int k = 0; k < 3; ++k) writeVarint(out, q[3 + k] - b[3 + k]);
+			for (int k = 0; k < 3; ++k) writeVarint(out, q[k] - predictPosition(b[k], b[3 + k], q[3 + k], days));
+		}
+	}
+
+	/** Decodifica sobre raw, que debe contener la instantánea anterior si es una diferencia. */
+	static void decode(const EncodedSnapshot& snap, RawSnapshot& raw) {
+		const uint8_t* p = snap.data.data();
+		const double days = snap.julianDate - raw.julianDate;
+		if (snap.keyframe) {
+			raw.values.resize((size_t)snap.bodyCount * 6);
+			raw.constants.resize((size_t)snap.bodyCount * 2);
+		}
+		for (size_t i = 0; i < snap.bodyCount; ++i) {
+			int64_t* q = &raw.values[i * 6];
+			if (snap.keyframe) {
+				for (int k = 0; k < 6; ++k) q[k] = readVarint(p);
+				std::memcpy(&raw.constants[i * 2], p, 2 * sizeof(double));
+				p += 2 * sizeof(double);
+				continue;
+			}
+			int64_t v0[3] = { q[3], q[4], q[5] };
+			for (int k = 0; k < 3; ++k) q[3 + k] += readVarint(p);
+			for (int k = 0; k < 3; ++k) q[k] = predictPosition(q[k], v0[k], q[3 + k], days) + readVarint(p);
+		}
+		raw.julianDate = snap.julianDate;
+	}
+
+	/** Espera a que el codificador vacíe la cola (con el mutex tomado). */
+	void waitIdle(std::unique_lock<std::mutex>& lock) {
+		idle.wait(lock, [this] { return pending.empty() && !busy; });
+	}
+
+	size_t snapshotBytes(const EncodedSnapshot& s) const { return s.data.capacity() + sizeof(EncodedSnapshot); }
+	static size_t rawBytes(uint32_t bodyCount) { return (size_t)bodyCount * 8 * sizeof(double); }
+
+	void popFront() {
+		usedBytes -= snapshotBytes(ring.front());
+		usedRawBytes -= rawBytes(ring.front().bodyCount);
+		if (ring.front().keyframe) --keyframeCount;
+		ring.pop_front();
+	}
+
+	void popBack() {
+		usedBytes -= snapshotBytes(ring.back());
+		usedRawBytes -= rawBytes(ring.back().bodyCount);
+		if (ring.back().keyframe) --keyframeCount;
+		ring.pop_back();
+	}
+
+	void encoderLoop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			wake.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (stopping) return;
+			RawSnapshot raw = std::move(pending.front());
+			pending.pop_front();
+			busy = true;
+			bool keyframe = !baseValid || sinceKeyframe + 1 >= KEYFRAME_INTERVAL ||
+				base.constants.size() != raw.constants.size();
+			lock.unlock();
+
+			EncodedSnapshot snap;
+			snap.julianDate = raw.julianDate;
+			snap.bodyCount = (uint32_t)(raw.constants.size() / 2);
+			snap.keyframe = keyframe;
+			encode(raw, keyframe ? nullptr : &base, snap.data);
+			snap.data.shrink_to_fit();
+			base = std::move(raw);
+
+			lock.lock();
+			baseValid = true;
+			sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+			usedBytes += snapshotBytes(snap);
+			usedRawBytes += rawBytes(snap.bodyCount);
+			if (keyframe) ++keyframeCount;
+			ring.push_back(std::move(snap));
+
+			// Descartar grupos completos del principio, conservando siempre el último
+			while (usedBytes > budgetBytes && keyframeCount > 1) {
+				popFront();
+				while (!ring.front().keyframe) popFront();
+			}
+
+			busy = false;
+			if (pending.empty()) idle.notify_all();
+		}
+	}
+};
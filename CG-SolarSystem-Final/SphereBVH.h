@@ -0,0 +1,399 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "Parallel.h"
+
+/**
+ * Jerarquía de volúmenes envolventes (BVH) sobre esferas, en doble precisión.
+ *
+ * Cada cuerpo es una esfera (centro y radio, incluidos los anillos) y el árbol agrupa cajas
+ * alineadas a los ejes, así una consulta de rayo, de segmento o de frustum descarta ramas
+ * enteras en lugar de probar todos los cuerpos. La usan la selección con el mouse y puede
+ * usarla cualquier consulta espacial (descarte de cuerpos fuera de la vista, oclusión de
+ * etiquetas, colisión de la cámara).
+ *
+ * El árbol se guarda en un arreglo en preorden: el hijo izquierdo de un nodo interno es el
+ * nodo siguiente y el derecho está en "right". Cada nodo parte sus esferas por la mediana del
+ * eje más largo de sus centros, así la cantidad de nodos de un subárbol depende solo de la
+ * cantidad de esferas y se conoce antes de construirlo:
+ *  - build(): parte los niveles superiores en serie y construye los subárboles en paralelo,
+ *    cada uno en su tramo ya reservado del arreglo. Solo hace falta cuando cambia la cantidad
+ *    de cuerpos (escena recargada) o cuando el árbol se degradó.
+ *  - refit(): en cada frame recalcula las cajas con las posiciones nuevas sin tocar la
+ *    topología (hojas en paralelo, nodos internos de atrás hacia adelante: los hijos siempre
+ *    están después del padre). Informa si la suma de áreas de las cajas creció tanto respecto
+ *    de la construcción que conviene reconstruir.
+ */
+class SphereBVH
+{
+public:
+	static const int LEAF_SIZE = 4;                   // Esferas por hoja como máximo
+	static constexpr double REBUILD_COST_RATIO = 2.0; // Crecimiento del área total que pide reconstruir
+
+	/** Nodo: caja envolvente y, en las hojas, el tramo de esferas. */
+	struct Node {
+		double lower[3];
+		double upper[3];
+		int right;      // Nodo interno: hijo derecho (el izquierdo es el siguiente); hoja: -1
+		int first;      // Hoja: primera esfera en el orden del árbol
+		int count;      // Hoja: cantidad de esferas; nodo interno: 0
+		int reserved;
+	};
+
+	/** Esfera en el orden del árbol (copia de la última llamada a build() o refit()). */
+	struct Sphere {
+		double x, y, z, radius;
+	};
+
+	int primitiveCount() const { return (int)order.size(); }
+	int nodeCount() const { return (int)nodes.size(); }
+
+	/**
+	 * Construye el árbol y calcula sus cajas.
+	 *
+	 * @param x, y, z Centros de las esferas
+	 * @param radius  Radios
+	 * @param count   Cantidad de esferas
+	 */
+	void build(const double* x, const double* y, const double* z, const float* radius, int count) {
+		clear();
+		if (count == 0) return;
+		order.resize(count);
+		std::iota(order.begin(), order.end(), 0);
+		nodes.assign(subtreeNodes(count), Node());
+
+		// Niveles superiores en serie hasta tener unas cuantas tareas por hilo
+		std::vector<Task> tasks;
+		int taskSize = count / (4 * ThreadPool::instance().threadCount());
+		if (taskSize < LEAF_SIZE) taskSize = LEAF_SIZE;
+		splitTop(x, y, z, 0, 0, count, taskSize, tasks);
+		parallelFor(0, (int)tasks.size(), 1, [&](int t) {
+			buildSubtree(x, y, z, tasks[t].node, tasks[t].first, tasks[t].count);
+		});
+
+		refit(x, y, z, radius);
+		builtCost = lastCost;
+	}
+
+	/** Vacía el árbol (el próximo uso debe llamar a build()). */
+	void clear() {
+		nodes.clear();
+		order.clear();
+		spheres.clear();
+		builtCost = lastCost = 0.0;
+	}
+
+	/**
+	 * Recalcula las cajas con posiciones y radios nuevos de las mismas esferas.
+	 *
+	 * @return true si el árbol se degradó y conviene llamar a build()
+	 */
+	bool refit(const double* x, const double* y, const double* z, const float* radius) {
+		const int n = nodeCount();
+		spheres.resize(order.size());
+		parallelFor(0, n, 1024, [&](int i) {
+			Node& node = nodes[i];
+			if (node.count == 0) return;
+			double lo[3] = { INF, INF, INF }, hi[3] = { -INF, -INF, -INF };
+			for (int k = node.first; k < node.first + node.count; ++k) {
+				int p = order[k];
+				Sphere s = { x[p], y[p], z[p], (double)radius[p] };
+				spheres[k] = s;
+				const double c[3] = { s.x, s.y, s.z };
+				for (int a = 0; a < 3; ++a) {
+					lo[a] = std::min(lo[a], c[a] - s.radius);
+					hi[a] = std::max(hi[a], c[a] + s.radius);
+				}
+			}
+			for (int a = 0; a < 3; ++a) { node.lower[a] = lo[a]; node.upper[a] = hi[a]; }
+		});
+
+		double cost = 0.0;
+		for (int i = n - 1; i >= 0; --i) {
+			Node& node = nodes[i];
+			if (node.count == 0) {
+				const Node& l = nodes[i + 1];
+				const Node& r = nodes[node.right];
+				for (int a = 0; a < 3; ++a) {
+					node.lower[a] = std::min(l.lower[a], r.lower[a]);
+					node.upper[a] = std::max(l.upper[a], r.upper[a]);
+				}
+			}
+			if (i > 0) cost += area(node);
+		}
+		lastCost = n > 0 && area(nodes[0]) > 0.0 ? cost / area(nodes[0]) : 0.0;
+		return lastCost > REBUILD_COST_RATIO * builtCost;
+	}
+
+	/**
+	 * Esfera más cercana que atraviesa un rayo. Las esferas que contienen al origen del rayo
+	 * no cuentan (la cámara nunca está dentro de un cuerpo que se pueda elegir).
+	 *
+	 * @param origin      Origen del rayo
+	 * @param direction   Dirección (unitaria: las distancias salen en las mismas unidades)
+	 * @param distance    Salida: distancia hasta la esfera encontrada
+	 * @param maxDistance Distancia máxima
+	 * @param ignore      Esfera que no se considera (-1 = ninguna)
+	 * @return            Índice de la esfera (el de build()) o -1
+	 */
+	int raycast(const glm::dvec3& origin, const glm::dvec3& direction, double& distance,
+		double maxDistance = std::numeric_limits<double>::infinity(), int ignore = -1) const {
+		return traverse(origin, direction, maxDistance, ignore, false, distance);
+	}
+
+	/**
+	 * Indica si alguna esfera corta el segmento entre dos puntos (p. ej. un cuerpo tapa a otro).
+	 *
+	 * @param from   Punto de partida (la cámara)
+	 * @param to     Punto de llegada
+	 * @param ignore Esfera que no se considera (la del punto de llegada)
+	 */
+	bool occluded(const glm::dvec3& from, const glm::dvec3& to, int ignore = -1) const {
+		glm::dvec3 d = to - from;
+		double length = glm::length(d);
+		double distance;
+		return length > 0.0 && traverse(from, d / length, length, ignore, true, distance) >= 0;
+	}
+
+	/**
+	 * Llama a fn(i) para cada esfera que toca el volumen formado por un conjunto de planos
+	 * (normal y desplazamiento; dentro = dot(n, p) + w >= 0). Si una caja queda entera dentro,
+	 * su subárbol se recorre sin más pruebas.
+	 *
+	 * @param planes     Planos (ver frustumPlanes)
+	 * @param planeCount Cantidad de planos
+	 * @param fn         Invocable como fn(int índice)
+	 */
+	template <class F>
+	void forEachInFrustum(const glm::dvec4* planes, int planeCount, F&& fn) const {
+		if (nodes.empty()) return;
+		int stack[STACK_SIZE];
+		bool inside[STACK_SIZE];
+		int top = 0;
+		stack[top] = 0;
+		inside[top++] = false;
+		while (top > 0) {
+			--top;
+			const Node& node = nodes[stack[top]];
+			bool contained = inside[top];
+			if (!contained) {
+				contained = true;
+				bool outside = false;
+				for (int p = 0; p < planeCount && !outside; ++p) {
+					const glm::dvec4& pl = planes[p];
+					// Vértice de la caja más adentro y más afuera respecto del plano
+					double nearest = pl.w, farthest = pl.w;
+					for (int a = 0; a < 3; ++a) {
+						nearest += pl[a] * (pl[a] >= 0.0 ? node.upper[a] : node.lower[a]);
+						farthest += pl[a] * (pl[a] >= 0.0 ? node.lower[a] : node.upper[a]);
+					}
+					outside = nearest < 0.0;
+					contained = contained && farthest >= 0.0;
+				}
+				if (outside) continue;
+			}
+			if (node.count > 0) {
+				for (int k = node.first; k < node.first + node.count; ++k) {
+					const Sphere& s = spheres[k];
+					bool visible = true;
+					for (int p = 0; p < planeCount && visible && !contained; ++p) {
+						visible = planes[p].x * s.x + planes[p].y * s.y + planes[p].z * s.z + planes[p].w >= -s.radius;
+					}
+					if (visible) fn(order[k]);
+				}
+				continue;
+			}
+			int self = (int)(&node - nodes.data());
+			stack[top] = node.right; inside[top++] = contained;
+			stack[top] = self + 1; inside[top++] = contained;
+		}
+	}
+
+	/**
+	 * Planos del frustum de una cámara en perspectiva (cuatro laterales y el cercano; el lejano
+	 * está en el infinito). Independiente de la convención de profundidad de la proyección.
+	 *
+	 * @param origin       Posición de la cámara
+	 * @param forward      Dirección de la vista (unitaria)
+	 * @param up           Vector arriba aproximado
+	 * @param fovy         Campo de visión vertical (radianes)
+	 * @param aspect       Ancho / alto
+	 * @param nearDistance Distancia al plano cercano
+	 * @param planes       Salida: 5 planos con la normal hacia adentro
+	 */
+	static void frustumPlanes(const glm::dvec3& origin, const glm::dvec3& forward, const glm::dvec3& up,
+		double fovy, double aspect, double nearDistance, glm::dvec4 planes[5]) {
+		glm::dvec3 right = glm::normalize(glm::cross(forward, up));
+		glm::dvec3 trueUp = glm::cross(right, forward);
+		double tanV = std::tan(fovy * 0.5);
+		double tanH = tanV * aspect;
+		const glm::dvec3 normals[4] = {
+			glm::cross(forward - right * tanH, trueUp),   // Izquierdo
+			glm::cross(trueUp, forward + right * tanH),   // Derecho
+			glm::cross(right, forward - trueUp * tanV),   // Inferior
+			glm::cross(forward + trueUp * tanV, right),   // Superior
+		};
+		for (int p = 0; p < 4; ++p) {
+			glm::dvec3 n = glm::normalize(normals[p]);
+			planes[p] = glm::dvec4(n, -glm::dot(n, origin));
+		}
+		planes[4] = glm::dvec4(forward, -glm::dot(forward, origin) - nearDistance);
+	}
+
+	/** Suma de áreas de las cajas relativa a la raíz en el último refit() (menor = árbol más ajustado). */
+	double cost() const { return lastCost; }
+
+private:
+	static constexpr double INF = std::numeric_limits<double>::infinity();
+	static const int STACK_SIZE = 128;  // Profundidad máxima: log2(esferas) + 1 con partición por mediana
+
+	/** Subárbol que se construye en paralelo. */
+	struct Task {
+		int node, first, count;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> order;        // Esfera de build() en cada posición del árbol
+	std::vector<Sphere> spheres;   // Esferas en el orden del árbol (localidad en las consultas)
+	double builtCost = 0.0;
+	double lastCost = 0.0;
+
+	/** Nodos de un subárbol de n esferas (partición por mediana hasta LEAF_SIZE). */
+	static int subtreeNodes(int n) {
+		return n <= LEAF_SIZE ? 1 : 1 + subtreeNodes(n / 2) + subtreeNodes(n - n / 2);
+	}
+
+	static double area(const Node& node) {
+		double dx = node.upper[0] - node.lower[0];
+		double dy = node.upper[1] - node.lower[1];
+		double dz = node.upper[2] - node.lower[2];
+		return dx * dy + dy * dz + dz * dx;
+	}
+
+	/**
+	 * Parte [first, first + count) por la mediana del eje más largo de sus centros.
+	 *
+	 * @return Cantidad de esferas de la mitad izquierda
+	 */
+	int partition(const double* x, const double* y, const double* z, int first, int count) {
+		double lo[3] = { INF, INF, INF }, hi[3] = { -INF, -INF, -INF };
+		for (int k = first; k < first + count; ++k) {
+			int p = order[k];
+			const double c[3] = { x[p], y[p], z[p] };
+			for (int a = 0; a < 3; ++a) { lo[a] = std::min(lo[a], c[a]); hi[a] = std::max(hi[a], c[a]); }
+		}
+		int axis = 0;
+		for (int a = 1; a < 3; ++a) if (hi[a] - lo[a] > hi[axis] - lo[axis]) axis = a;
+		const double* key = axis == 0 ? x : (axis == 1 ? y : z);
+		int half = count / 2;
+		std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+			[key](int a, int b) { return key[a] < key[b]; });
+		return half;
+	}
+
+	/** Nodo interno con sus dos hijos ya ubicados en el arreglo. */
+	int makeInternal(int node, int leftCount) {
+		nodes[node].right = node + 1 + subtreeNodes(leftCount);
+		nodes[node].count = 0;
+		return nodes[node].right;
+	}
+
+	void makeLeaf(int node, int first, int count) {
+		nodes[node].right = -1;
+		nodes[node].first = first;
+		nodes[node].count = count;
+	}
+
+	/** Niveles superiores: parte en serie y deja como tareas los subárboles de hasta taskSize esferas. */
+	void splitTop(const double* x, const double* y, const double* z, int node, int first, int count,
+		int taskSize, std::vector<Task>& tasks) {
+		if (count <= taskSize) {
+			tasks.push_back({ node, first, count });
+			return;
+		}
+		int half = partition(x, y, z, first, count);
+		int right = makeInternal(node, half);
+		splitTop(x, y, z, node + 1, first, half, taskSize, tasks);
+		splitTop(x, y, z, right, first + half, count - half, taskSize, tasks);
+	}
+
+	void buildSubtree(const double* x, const double* y, const double* z, int node, int first, int count) {
+		if (count <= LEAF_SIZE) {
+			makeLeaf(node, first, count);
+			return;
+		}
+		int half = partition(x, y, z, first, count);
+		int right = makeInternal(node, half);
+		buildSubtree(x, y, z, node + 1, first, half);
+		buildSubtree(x, y, z, right, first + half, count - half);
+	}
+
+	/** Entrada del rayo en una caja (prueba de placas); INF si no la toca antes de maxDistance. */
+	static double enterBox(const Node& node, const glm::dvec3& origin, const glm::dvec3& inverse, double maxDistance) {
+		double t0 = 0.0, t1 = maxDistance;
+		for (int a = 0; a < 3; ++a) {
+			double ta = (node.lower[a] - origin[a]) * inverse[a];
+			double tb = (node.upper[a] - origin[a]) * inverse[a];
+			if (ta > tb) std::swap(ta, tb);
+			t0 = ta > t0 ? ta : t0;  // Así un NaN (origen sobre la cara con dirección paralela) no descarta
+			t1 = tb < t1 ? tb : t1;
+			if (t0 > t1) return INF;
+		}
+		return t0;
+	}
+
+	/** Recorrido del rayo: el hijo más cercano primero y poda por la mejor distancia hallada. */
+	int traverse(const glm::dvec3& origin, const glm::dvec3& direction, double maxDistance, int ignore,
+		bool anyHit, double& distance) const {
+		if (nodes.empty()) return -1;
+		const glm::dvec3 inverse = 1.0 / direction;
+		double best = maxDistance;
+		int hit = -1;
+		int stack[STACK_SIZE];
+		double entry[STACK_SIZE];  // Entrada del rayo en cada caja apilada
+		int top = 0;
+		entry[top] = enterBox(nodes[0], origin, inverse, best);
+		if (entry[top] == INF) return -1;
+		stack[top++] = 0;
+		while (top > 0) {
+			--top;
+			if (entry[top] > best) continue;  // Ya se halló algo más cerca
+			const Node& node = nodes[stack[top]];
+			if (node.count > 0) {
+				for (int k = node.first; k < node.first + node.count; ++k) {
+					if (order[k] == ignore) continue;
+					const Sphere& s = spheres[k];
+					glm::dvec3 oc = glm::dvec3(s.x, s.y, s.z) - origin;
+					double b = glm::dot(oc, direction);
+					double c = glm::dot(oc, oc) - s.radius * s.radius;
+					if (c <= 0.0) continue;  // El origen está dentro
+					double disc = b * b - c;
+					if (b <= 0.0 || disc < 0.0) continue;
+					double t = b - std::sqrt(disc);
+					if (t < best) {
+						best = t;
+						hit = order[k];
+						if (anyHit) { distance = t; return hit; }
+					}
+				}
+				continue;
+			}
+			int self = (int)(&node - nodes.data());
+			int closer = self + 1, farther = node.right;
+			double tCloser = enterBox(nodes[closer], origin, inverse, best);
+			double tFarther = enterBox(nodes[farther], origin, inverse, best);
+			if (tFarther < tCloser) { std::swap(closer, farther); std::swap(tCloser, tFarther); }
+			if (tFarther != INF) { stack[top] = farther; entry[top++] = tFarther; }
+			if (tCloser != INF) { stack[top] = closer; entry[top++] = tCloser; }
+		}
+		distance = best;
+		return hit;
+	}
+};
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TextScanner.h"
+
+// ===========================================
+// CATÁLOGO DE ESTRELLAS
+// ===========================================
+// El cielo de fondo sale de un catálogo de estrellas (Hipparcos, HYG o un subconjunto de Gaia)
+// convertido a un binario que se proyecta en memoria y se sube a la GPU sin copias.
+//
+// Las estrellas se agrupan en celdas HEALPix (esquema anidado: 12 * nside² celdas de igual
+// área) y dentro de cada celda se ordenan de la más brillante a la más débil. Así el
+// renderizado descarta celdas enteras fuera del campo de visión y, en las visibles, dibuja
+// solo el prefijo de estrellas más brillantes que la magnitud límite.
+//
+// FORMATO BINARIO (little-endian):
+//   [StarFileHeader]
+//   [StarCell] x cellCount     (celda k = píxel HEALPix anidado k)
+//   [StarRecord] x starCount   (por celda, de first a first + count, por magnitud creciente)
+// Direcciones unitarias en los ejes de la escena (eclíptica en el plano XZ, norte hacia +Y).
+
+const char STAR_CATALOG_MAGIC[8] = { 'C', 'G', 'S', 'T', 'A', 'R', 'S', '1' };
+const uint32_t STAR_CATALOG_VERSION = 1;
+
+struct StarFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nside;             // Resolución HEALPix (potencia de 2)
+	uint32_t cellCount;         // 12 * nside²
+	uint32_t starCount;
+	float faintestMagnitude;
+	uint32_t reserved;
+};
+
+struct StarCell {
+	float center[3];            // Dirección media de las estrellas de la celda
+	float radius;               // Ángulo máximo entre el centro y una estrella de la celda (radianes)
+	uint32_t first;             // Primera estrella de la celda
+	uint32_t count;
+	float brightest;            // Magnitud de la primera estrella
+	uint32_t reserved;
+};
+
+struct StarRecord {
+	float direction[3];         // Vector unitario hacia la estrella
+	float magnitude;            // Magnitud aparente
+	uint32_t color;             // RGBA8 según el índice de color B-V
+};
+
+static_assert(sizeof(StarFileHeader) == 32, "StarFileHeader debe ocupar 32 bytes");
+static_assert(sizeof(StarCell) == 32, "StarCell debe ocupar 32 bytes");
+static_assert(sizeof(StarRecord) == 20, "StarRecord debe ocupar 20 bytes");
+
+/**
+ * Estrella de entrada para construir el catálogo (coordenadas ecuatoriales J2000).
+ */
+struct StarSource {
+	double rightAscension;      // Radianes
+	double declination;         // Radianes
+	float magnitude;
+	float colorIndex;           // B-V (0.65 si no se conoce: color solar)
+};
+
+/**
+ * Catálogo de estrellas leído desde el binario proyectado en memoria.
+ */
+class StarCatalog
+{
+public:
+	/**
+	 * Abre y valida un catálogo.
+	 *
+	 * @param path Ruta del binario
+	 * @return     true si el archivo existe y sus celdas cubren exactamente sus estrellas
+	 */
+	bool open(const char* path) {
+		close();
+		if (!file.open(path) || file.size() < sizeof(StarFileHeader)) { close(); return false; }
+		const StarFileHeader* h = (const StarFileHeader*)file.data();
+		size_t starsStart = sizeof(StarFileHeader) + (size_t)h->cellCount * sizeof(StarCell);
+		if (std::memcmp(h->magic, STAR_CATALOG_MAGIC, sizeof(STAR_CATALOG_MAGIC)) != 0 ||
+			h->version != STAR_CATALOG_VERSION || h->nside == 0 || (h->nside & (h->nside - 1)) != 0 ||
+			h->cellCount != 12 * h->nside * h->nside ||
+			file.size() != starsStart + (size_t)h->starCount * sizeof(StarRecord)) {
+			close();
+			return false;
+		}
+		const StarCell* c = (const StarCell*)(file.data() + sizeof(StarFileHeader));
+		uint32_t next = 0;
+		for (uint32_t k = 0; k < h->cellCount; ++k) {
+			if (c[k].first != next) { close(); return false; }
+			next += c[k].count;
+		}
+		if (next != h->starCount) { close(); return false; }
+		header = h;
+		cells = c;
+		records = (const StarRecord*)(file.data() + starsStart);
+		return true;
+	}
+
+	void close() {
+		file.close();
+		header = nullptr;
+		cells = nullptr;
+		records = nullptr;
+	}
+
+	bool isOpen() const { return header != nullptr; }
+	int starCount() const { return header ? (int)header->starCount : 0; }
+	int cellCount() const { return header ? (int)header->cellCount : 0; }
+	int nside() const { return header ? (int)header->nside : 0; }
+	float faintestMagnitude() const { return header ? header->faintestMagnitude : 0.0f; }
+	const StarCell& cell(int k) const { return cells[k]; }
+
+	/** Estrellas en el orden del archivo (para subirlas a la GPU directamente desde la proyección). */
+	const StarRecord* stars() const { return records; }
+
+	/** Estrellas de la celda k con magnitud <= limit (un prefijo de la celda). */
+	int countBrighterThan(int k, float limit) const {
+		const StarRecord* begin = records + cells[k].first;
+		const StarRecord* end = begin + cells[k].count;
+		return (int)(std::upper_bound(begin, end, limit,
+			[](float m, const StarRecord& s) { return m < s.magnitude; }) - begin);
+	}
+
+	/**
+	 * Rangos de estrellas a dibujar: celdas que tocan el cono de visión y, en cada una, las
+	 * estrellas más brillantes que el límite. Los rangos contiguos se unen.
+	 *
+	 * @param forward        Dirección de la vista (unitaria, ejes de la escena)
+	 * @param halfAngle      Semiángulo del cono que contiene el frustum (radianes)
+	 * @param limitMagnitude Magnitud límite
+	 * @param firsts         Salida: primera estrella de cada rango (lugar para cellCount() valores)
+	 * @param counts         Salida: estrellas de cada rango (lugar para cellCount() valores)
+	 * @param rangeCount     Salida: cantidad de rangos
+	 * @return               Estrellas a dibujar
+	 */
+	int visibleRanges(const glm::vec3& forward, float halfAngle, float limitMagnitude,
+		int* firsts, int* counts, int& rangeCount) const {
+		int ranges = 0;
+		int total = 0;
+		for (int k = 0; k < cellCount(); ++k) {
+			const StarCell& c = cells[k];
+			if (c.count == 0 || c.brightest > limitMagnitude) continue;
+			float angle = halfAngle + c.radius;
+			if (angle < 3.14159265f && glm::dot(forward, glm::vec3(c.center[0], c.center[1], c.center[2])) < std::cos(angle)) continue;
+			int n = countBrighterThan(k, limitMagnitude);
+			if (ranges > 0 && firsts[ranges - 1] + counts[ranges - 1] == (int)c.first) counts[ranges - 1] += n;
+			else { firsts[ranges] = (int)c.first; counts[ranges] = n; ++ranges; }
+			total += n;
+		}
+		rangeCount = ranges;
+		return total;
+	}
+
+	/** Igual que la anterior, con la salida en vectores (conservan su capacidad entre llamadas). */
+	int visibleRanges(const glm::vec3& forward, float halfAngle, float limitMagnitude,
+		std::vector<int>& firsts, std::vector<int>& counts) const {
+		firsts.resize(cellCount());
+		counts.resize(cellCount());
+		int ranges;
+		int total = visibleRanges(forward, halfAngle, limitMagnitude, firsts.data(), counts.data(), ranges);
+		firsts.resize(ranges);
+		counts.resize(ranges);
+		return total;
+	}
+
+	/**
+	 * Píxel HEALPix en el esquema anidado (Górski et al. 2005, ang2pix_nest).
+	 *
+	 * @param nside Resolución (potencia de 2)
+	 * @param z     Coseno de la colatitud (seno de la declinación)
+	 * @param phi   Longitud (ascensión recta) en radianes
+	 */
+	static int healpixNest(int nside, double z, double phi) {
+		const double PI = 3.14159265358979323846;
+		double za = std::fabs(z);
+		double tt = std::fmod(phi, 2.0 * PI);
+		if (tt < 0.0) tt += 2.0 * PI;
+		tt *= 2.0 / PI;  // En [0, 4)
+		if (tt >= 4.0) tt -= 4.0;
+		int face, ix, iy;
+		if (za <= 2.0 / 3.0) {
+			// Zona ecuatorial
+			double t1 = nside * (0.5 + tt);
+			double t2 = nside * (z * 0.75);
+			int jp = (int)(t1 - t2);  // Línea de borde ascendente
+			int jm = (int)(t1 + t2);  // Línea de borde descendente
+			int ifp = jp / nside;
+			int ifm = jm / nside;
+			face = ifp == ifm ? (ifp | 4) : (ifp < ifm ? ifp : ifm + 8);
+			ix = jm & (nside - 1);
+			iy = nside - (jp & (nside - 1)) - 1;
+		}
+		else {
+			// Casquetes polares
+			int ntt = std::min((int)tt, 3);
+			double tp = tt - ntt;
+			double tmp = nside * std::sqrt(3.0 * (1.0 - za));
+			int jp = std::min((int)(tp * tmp), nside - 1);
+			int jm = std::min((int)((1.0 - tp) * tmp), nside - 1);
+			if (z >= 0.0) { face = ntt; ix = nside - jm - 1; iy = nside - jp - 1; }
+			else { face = ntt + 8; ix = jp; iy = jm; }
+		}
+		return face * nside * nside + (int)(spreadBits((uint32_t)ix) | (spreadBits((uint32_t)iy) << 1));
+	}
+
+	/**
+	 * Color aproximado de una estrella según su índice B-V (temperatura de Ballesteros y
+	 * color de cuerpo negro simplificado), empaquetado como RGBA8.
+	 */
+	static uint32_t colorFromIndex(float bv) {
+		bv = std::min(std::max(bv, -0.4f), 2.0f);
+		float t = 4600.0f * (1.0f / (0.92f * bv + 1.7f) + 1.0f / (0.92f * bv + 0.62f));  // Kelvin
+		float r, g, b;
+		if (t >= 6600.0f) {
+			r = 1.0f - 0.3f * std::min(1.0f, (t - 6600.0f) / 20000.0f);
+			g = 0.9f - 0.1f * std::min(1.0f, (t - 6600.0f) / 20000.0f);
+			b = 1.0f;
+		}
+		else {
+			r = 1.0f;
+			g = 0.55f + 0.4f * (t - 2500.0f) / 4100.0f;
+			b = 0.2f + 0.75f * (t - 2500.0f) / 4100.0f;
+		}
+		auto byte = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return byte(r) | (byte(g) << 8) | (byte(b) << 16) | (255u << 24);
+	}
+
+private:
+	MappedFile file;
+	const StarFileHeader* header = nullptr;
+	const StarCell* cells = nullptr;
+	const StarRecord* records = nullptr;
+
+	/** Intercala los bits de v con ceros (bit k -> bit 2k). */
+	static uint32_t spreadBits(uint32_t v) {
+		v &= 0xffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	}
+};
+
+/**
+ * Resultado de la construcción.
+ */
+struct StarCatalogBuildReport {
+	size_t stars = 0;           // Estrellas escritas
+	size_t bytes = 0;           // Tamaño del archivo
+	int usedCells = 0;          // Celdas con al menos una estrella
+};
+
+/**
+ * Agrupa las estrellas en celdas HEALPix, las ordena por magnitud y escribe el catálogo.
+ *
+ * @param path   Ruta del binario de salida
+ * @param stars  Estrellas (coordenadas ecuatoriales J2000)
+ * @param nside  Resolución HEALPix (potencia de 2; 32 = 12 288 celdas de 3.4 grados²)
+ * @param report Salida opcional con estadísticas
+ * @return       true si el archivo se escribió
+ */
+inline bool buildStarCatalog(const char* path, const std::vector<StarSource>& stars, int nside,
+	StarCatalogBuildReport* report = nullptr)
+{
+	const double OBLIQUITY = 23.4392911 * 3.14159265358979323846 / 180.0;  // Oblicuidad de la eclíptica en J2000
+	const double ce = std::cos(OBLIQUITY), se = std::sin(OBLIQUITY);
+	if (nside <= 0 || (nside & (nside - 1)) != 0) return false;
+	const int cellCount = 12 * nside * nside;
+
+	// Celda y dirección en la escena: ecuatorial -> eclíptica -> ejes de la escena (x, z, -y)
+	std::vector<int> cellOf(stars.size());
+	std::vector<StarRecord> records(stars.size());
+	for (size_t i = 0; i < stars.size(); ++i) {
+		const StarSource& s = stars[i];
+		double cd = std::cos(s.declination), sd = std::sin(s.declination);
+		double xq = cd * std::cos(s.rightAscension), yq = cd * std::sin(s.rightAscension), zq = sd;
+		double y = ce * yq + se * zq;
+		double z = -se * yq + ce * zq;
+		records[i] = { { (float)xq, (float)z, (float)-y }, s.magnitude, StarCatalog::colorFromIndex(s.colorIndex) };
+		cellOf[i] = StarCatalog::healpixNest(nside, sd, s.rightAscension);
+	}
+
+	// Por celda y, dentro de cada una, de la más brillante a la más débil
+	std::vector<uint32_t> order(stars.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return cellOf[a] != cellOf[b] ? cellOf[a] < cellOf[b] : records[a].magnitude < records[b].magnitude;
+	});
+
+	std::vector<StarCell> cells(cellCount);
+	std::vector<StarRecord> sorted(stars.size());
+	float faintest = -100.0f;
+	size_t i = 0;
+	int usedCells = 0;
+	for (int k = 0; k < cellCount; ++k) {
+		StarCell& c = cells[k];
+		c = {};
+		c.first = (uint32_t)i;
+		glm::dvec3 sum(0.0);
+		size_t begin = i;
+		for (; i < order.size() && cellOf[order[i]] == k; ++i) {
+			sorted[i] = records[order[i]];
+			sum += glm::dvec3(sorted[i].direction[0], sorted[i].direction[1], sorted[i].direction[2]);
+			faintest = std::max(faintest, sorted[i].magnitude);
+		}
+		c.count = (uint32_t)(i - begin);
+		if (c.count == 0) continue;
+		++usedCells;
+		glm::dvec3 center = glm::length(sum) > 0.0 ? glm::normalize(sum) : glm::dvec3(sorted[begin].direction[0], sorted[begin].direction[1], sorted[begin].direction[2]);
+		double radius = 0.0;
+		for (size_t j = begin; j < i; ++j) {
+			double d = glm::dot(center, glm::dvec3(sorted[j].direction[0], sorted[j].direction[1], sorted[j].direction[2]));
+			radius = std::max(radius, std::acos(std::min(1.0, std::max(-1.0, d))));
+		}
+		c.center[0] = (float)center.x;
+		c.center[1] = (float)center.y;
+		c.center[2] = (float)center.z;
+		c.radius = (float)radius + 1e-5f;  // Margen por el redondeo a float
+		c.brightest = sorted[begin].magnitude;
+	}
+
+	StarFileHeader header = {};
+	std::memcpy(header.magic, STAR_CATALOG_MAGIC, sizeof(STAR_CATALOG_MAGIC));
+	header.version = STAR_CATALOG_VERSION;
+	header.nside = (uint32_t)nside;
+	header.cellCount = (uint32_t)cellCount;
+	header.starCount = (uint32_t)stars.size();
+	header.faintestMagnitude = stars.empty() ? 0.0f : faintest;
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)cells.data(), cells.size() * sizeof(StarCell));
+	out.write((const char*)sorted.data(), sorted.size() * sizeof(StarRecord));
+	if (!out) return false;
+
+	if (report) {
+		report->stars = stars.size();
+		report->bytes = sizeof(header) + cells.size() * sizeof(StarCell) + sorted.size() * sizeof(StarRecord);
+		report->usedCells = usedCells;
+	}
+	return true;
+}
+
+/**
+ * Lee estrellas de un CSV con cabecera (HYG, Hipparcos o una consulta de Gaia).
+ *
+ * Columnas reconocidas: posición en radianes (rarad, decrad) o en grados (ra y dec, RAdeg y
+ * DEdeg, ra_deg y dec_deg); magnitud (mag, Vmag o phot_g_mean_mag); índice de color opcional
+ * (ci, B-V o bv). Las filas más brillantes que magnitud -5 (el Sol en HYG) se descartan.
+ *
+ * @param path  Ruta del CSV
+ * @param stars Salida: estrellas leídas (se agregan)
+ * @param error Salida: motivo del fallo
+ * @return      true si el archivo tenía las columnas necesarias
+ */
+inline bool readStarCsv(const char* path, std::vector<StarSource>& stars, std::string& error)
+{
+	const double DEG = 3.14159265358979323846 / 180.0;
+	const float MIN_MAGNITUDE = -5.0f;
+	MappedFile text;
+	if (!text.open(path)) {
+		error = std::string("no se pudo abrir ") + path;
+		return false;
+	}
+	const char* p = (const char*)text.data();
+	const char* end = p + text.size();
+
+	const int MAX_COLUMNS = 64;
+	const char* starts[MAX_COLUMNS];
+	const char* ends[MAX_COLUMNS];
+	int count;
+	const char* eol = TextScanner::splitLine(p, end, starts, ends, MAX_COLUMNS, count);
+	int raRad = -1, decRad = -1, raDeg = -1, decDeg = -1, magnitude = -1, color = -1;
+	for (int c = 0; c < count; ++c) {
+		const char* s = starts[c];
+		const char* e = ends[c];
+		TextScanner::trimField(s, e);
+		std::string column(s, e);
+		if (column == "rarad") raRad = c;
+		else if (column == "decrad") decRad = c;
+		else if (column == "ra" || column == "RAdeg" || column == "ra_deg") raDeg = c;
+		else if (column == "dec" || column == "DEdeg" || column == "dec_deg") decDeg = c;
+		else if (column == "mag" || column == "Vmag" || column == "phot_g_mean_mag") magnitude = c;
+		else if (column == "ci" || column == "B-V" || column == "bv") color = c;
+	}
+	// HYG trae ra en horas además de rarad: si están las columnas en radianes se usan esas
+	bool radians = raRad >= 0 && decRad >= 0;
+	int ra = radians ? raRad : raDeg;
+	int dec = radians ? decRad : decDeg;
+	double angleScale = radians ? 1.0 : DEG;
+	if (ra < 0 || dec < 0 || magnitude < 0) {
+		error = std::string(path) + ": la cabecera necesita ra/dec (o rarad/decrad) y mag";
+		return false;
+	}
+	int needed = std::max(std::max(ra, dec), std::max(magnitude, color)) + 1;
+
+	for (p = eol < end ? eol + 1 : end; p < end; ) {
+		eol = TextScanner::splitLine(p, end, starts, ends, MAX_COLUMNS, count);
+		p = eol < end ? eol + 1 : end;
+		double a, d, m, bv = 0.65;
+		if (count < needed || !TextScanner::parseNumber(starts[ra], ends[ra], a) ||
+			!TextScanner::parseNumber(starts[dec], ends[dec], d) ||
+			!TextScanner::parseNumber(starts[magnitude], ends[magnitude], m) || m < MIN_MAGNITUDE) {
+			continue;
+		}
+		if (color >= 0 && !TextScanner::parseNumber(starts[color], ends[color], bv)) bv = 0.65;
+		stars.push_back({ a * angleScale, d * angleScale, (float)m, (float)bv });
+	}
+	return true;
+}
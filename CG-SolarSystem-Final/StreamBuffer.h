@@ -0,0 +1,194 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Buffer de los datos que cambian en cada frame (bloques de uniforms del frame y de cada draw,
+ * vértices de partículas y meteoritos, y los que vengan: instancias, trazas).
+ *
+ * Está dividido en una región por frame en vuelo (ver FramesInFlight): el frame de la ranura i
+ * escribe solo en la región i, y FramesInFlight ya esperó el fence del frame que la usó antes,
+ * así que se escribe sin sincronizar nada más. Cada dato se escribe una sola vez, directamente
+ * en la memoria del buffer, y se usa desde su desplazamiento (glBindBufferRange o el offset del
+ * atributo); no hay glBufferSubData ni copias del driver. Dos caminos según el contexto:
+ *  - Persistente (OpenGL 4.4 o GL_ARB_buffer_storage): glBufferStorage con mapeo persistente y
+ *    coherente, mapeado una sola vez.
+ *  - Compatible (OpenGL 3.3): cada escritura mapea su rango con GL_MAP_UNSYNCHRONIZED_BIT.
+ * Si lo que escribe un frame no entra en su región, el buffer se reemplaza por uno con regiones
+ * del doble de tamaño; el anterior se borra al terminar el frame, así los rangos ya vinculados
+ * siguen siendo válidos.
+ *
+ * glad.h se generó para OpenGL 3.3 y no incluye glBufferStorage: se carga con glfwGetProcAddress,
+ * igual que glClipControl en ReversedDepth.
+ */
+class StreamBuffer
+{
+public:
+	/**
+	 * Crea el buffer.
+	 *
+	 * @param frameCapacity Tamaño inicial de la región de cada frame, en bytes
+	 * @param frameCount    Frames en vuelo (una región por cada uno)
+	 * @return true si se usa el camino persistente
+	 */
+	bool init(GLsizeiptr frameCapacity, int frameCount) {
+		bool core44 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+		if (core44 || glfwExtensionSupported("GL_ARB_buffer_storage")) {
+			bufferStorage = (BufferStorageProc)glfwGetProcAddress("glBufferStorage");
+		}
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		uniformAlignment = alignment > 0 ? alignment : 256;
+		regionCount = frameCount < 1 ? 1 : frameCount;
+		create(frameCapacity);
+		return isPersistent();
+	}
+
+	/** true si el buffer está mapeado de forma persistente (glBufferStorage). */
+	bool isPersistent() const { return persistent != nullptr; }
+
+	/** Buffer actual (cambia si crece: se consulta en cada uso). */
+	GLuint buffer() const { return name; }
+
+	/** Alineación que exige glBindBufferRange(GL_UNIFORM_BUFFER, ...). */
+	GLsizeiptr uniformOffsetAlignment() const { return uniformAlignment; }
+
+	/** Tamaño total (todas las regiones). */
+	GLsizeiptr size() const { return regionSize * regionCount; }
+
+	/** Bytes escritos en el último frame terminado. */
+	size_t lastFrameBytes() const { return lastBytes; }
+
+	/**
+	 * Empieza a escribir en la región de un frame. El fence del frame anterior que la usó ya
+	 * tiene que haber pasado (FramesInFlight::beginFrame).
+	 *
+	 * @param slot Ranura del frame (FramesInFlight::slot)
+	 */
+	void beginFrame(int slot) {
+		region = slot % regionCount;
+		head = region * regionSize;
+		frameBytes = 0;
+	}
+
+	/**
+	 * Reserva bytes en la región del frame y devuelve dónde escribirlos. El puntero vale hasta unmap().
+	 *
+	 * @param bytes     Bytes a escribir
+	 * @param alignment Alineación del desplazamiento (el tamaño de un vértice, o la de los uniforms)
+	 * @param offset    Salida: desplazamiento dentro de buffer()
+	 * @return          Memoria mapeada de solo escritura
+	 */
+	void* map(GLsizeiptr bytes, GLsizeiptr alignment, GLintptr& offset) {
+		GLintptr start = alignUp(head, alignment);
+		if (start + bytes > (region + 1) * regionSize) {
+			grow(frameBytes + bytes + alignment);
+			start = alignUp(head, alignment);
+		}
+		head = start + bytes;
+		frameBytes += (size_t)bytes;
+		offset = start;
+		if (isPersistent()) return persistent + start;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+		return glMapBufferRange(GL_COPY_WRITE_BUFFER, start, bytes,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	}
+
+	/** Termina la escritura de map(): desmapea en el camino compatible; con mapeo coherente no hace nada. */
+	void unmap() {
+		if (isPersistent()) return;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	}
+
+	/** Termina el frame: borra los buffers reemplazados y guarda las estadísticas. */
+	void endFrame() {
+		if (!retired.empty()) {
+			glDeleteBuffers((GLsizei)retired.size(), retired.data());  // El driver los libera cuando la GPU termina
+			retired.clear();
+		}
+		lastBytes = frameBytes;
+	}
+
+	/** Libera los buffers (antes de destruir el contexto). */
+	void destroy() {
+		release();
+		if (!retired.empty()) glDeleteBuffers((GLsizei)retired.size(), retired.data());
+		retired.clear();
+	}
+
+private:
+	typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	static constexpr GLbitfield GL_MAP_PERSISTENT_BIT_VALUE = 0x0040;  // GL_MAP_PERSISTENT_BIT
+	static constexpr GLbitfield GL_MAP_COHERENT_BIT_VALUE = 0x0080;    // GL_MAP_COHERENT_BIT
+
+	BufferStorageProc bufferStorage = nullptr;
+	GLuint name = 0;
+	char* persistent = nullptr;    // Mapeo persistente (nullptr en el camino compatible)
+	GLsizeiptr regionSize = 0;     // Bytes de la región de cada frame
+	int regionCount = 1;
+	int region = 0;                // Región del frame actual
+	GLsizeiptr uniformAlignment = 256;
+	GLintptr head = 0;             // Próximo byte libre
+	std::vector<GLuint> retired;   // Buffers reemplazados en este frame
+	size_t frameBytes = 0, lastBytes = 0;
+
+	static GLintptr alignUp(GLintptr value, GLsizeiptr alignment) {
+		return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+	}
+
+	/** Crea el buffer (persistente si se puede) con regiones de size bytes. */
+	void create(GLsizeiptr size) {
+		regionSize = alignUp(size, uniformAlignment);
+		GLsizeiptr capacity = regionSize * regionCount;
+		glGenBuffers(1, &name);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+		if (bufferStorage) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_VALUE | GL_MAP_COHERENT_BIT_VALUE;
+			bufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, flags);
+			persistent = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, flags);
+			if (persistent) return;
+			// El driver anunció la extensión pero no mapeó: buffer nuevo por el camino compatible
+			glDeleteBuffers(1, &name);
+			bufferStorage = nullptr;
+			glGenBuffers(1, &name);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+		}
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+	}
+
+	/** Suelta el buffer actual. */
+	void release() {
+		if (name) {
+			if (isPersistent()) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+				glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			}
+			glDeleteBuffers(1, &name);
+		}
+		name = 0;
+		persistent = nullptr;
+	}
+
+	/**
+	 * Pasa a un buffer nuevo cuyas regiones admitan bytes; el actual se borra al terminar el
+	 * frame. Las regiones del buffer nuevo no las usó ningún frame, no hay nada que esperar.
+	 */
+	void grow(size_t bytes) {
+		GLsizeiptr size = regionSize;
+		while ((size_t)size < 2 * bytes) size *= 2;
+		if (isPersistent()) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		}
+		retired.push_back(name);
+		name = 0;
+		persistent = nullptr;
+		create(size);
+		head = region * regionSize;
+	}
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "SimdMath.h"
+
+/**
+ * Lectura rápida de texto tabular (catálogos de cuerpos menores y de estrellas) directamente
+ * desde un archivo proyectado en memoria: búsqueda de delimitadores con SIMD y conversión de
+ * números sin copias ni locale.
+ */
+struct TextScanner
+{
+	// Bytes que compara cada instrucción al buscar delimitadores
+#if defined(SIMD_AVX2)
+	static const int SCAN_WIDTH = 32;
+#else
+	static const int SCAN_WIDTH = 16;
+#endif
+
+	/**
+	 * Máscara de los bytes de [p, p + SCAN_WIDTH) iguales a c0, c1 o c2 (bit k = byte k).
+	 * Con AVX2 o SSE2 se comparan todos los bytes con una instrucción por carácter.
+	 */
+	static uint32_t matchMask(const char* p, char c0, char c1, char c2) {
+#if defined(SIMD_AVX2)
+		__m256i v = _mm256_loadu_si256((const __m256i*)p);
+		__m256i m = _mm256_or_si256(_mm256_or_si256(
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c0)),
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c1))),
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c2)));
+		return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(SIMD_SSE2)
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		__m128i m = _mm_or_si128(_mm_or_si128(
+			_mm_cmpeq_epi8(v, _mm_set1_epi8(c0)),
+			_mm_cmpeq_epi8(v, _mm_set1_epi8(c1))),
+			_mm_cmpeq_epi8(v, _mm_set1_epi8(c2)));
+		return (uint32_t)_mm_movemask_epi8(m);
+#else
+		uint32_t mask = 0;
+		for (int k = 0; k < SCAN_WIDTH; ++k) {
+			if (p[k] == c0 || p[k] == c1 || p[k] == c2) mask |= 1u << k;
+		}
+		return mask;
+#endif
+	}
+
+	/** Igual que matchMask() para los últimos bytes del texto (menos de SCAN_WIDTH). */
+	static uint32_t matchMaskTail(const char* p, const char* end, char c0, char c1, char c2) {
+		uint32_t mask = 0;
+		for (int k = 0; p + k < end; ++k) {
+			if (p[k] == c0 || p[k] == c1 || p[k] == c2) mask |= 1u << k;
+		}
+		return mask;
+	}
+
+	/** Posición del bit más bajo (mask != 0). */
+	static int lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (int)index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	/** Fin de la línea que empieza en p (el '\n' o end). */
+	static const char* lineEnd(const char* p, const char* end) {
+		for (; end - p >= SCAN_WIDTH; p += SCAN_WIDTH) {
+			uint32_t mask = matchMask(p, '\n', '\n', '\n');
+			if (mask) return p + lowestBit(mask);
+		}
+		uint32_t mask = matchMaskTail(p, end, '\n', '\n', '\n');
+		return mask ? p + lowestBit(mask) : end;
+	}
+
+	/**
+	 * Separa una línea CSV en campos en una sola pasada: cada bloque de SCAN_WIDTH bytes da una
+	 * máscara de comas, comillas y saltos de línea, y solo se visitan los bits encendidos.
+	 * Las comas entre comillas no separan campos.
+	 *
+	 * @param p         Inicio de la línea
+	 * @param end       Fin del texto
+	 * @param starts    Salida: inicio de cada campo
+	 * @param ends      Salida: fin de cada campo
+	 * @param maxFields Capacidad de starts y ends (los campos de más se ignoran)
+	 * @param count     Salida: campos encontrados
+	 * @return          Fin de la línea (el '\n' o end)
+	 */
+	static const char* splitLine(const char* p, const char* end, const char** starts, const char** ends, int maxFields, int& count) {
+		count = 0;
+		const char* fieldStart = p;
+		bool quoted = false;
+		for (const char* q = p; q < end; q += SCAN_WIDTH) {
+			uint32_t mask = end - q >= SCAN_WIDTH ? matchMask(q, ',', '\n', '"') : matchMaskTail(q, end, ',', '\n', '"');
+			while (mask) {
+				const char* d = q + lowestBit(mask);
+				mask &= mask - 1;
+				if (*d == '"') { quoted = !quoted; continue; }
+				if (*d == ',' && quoted) continue;
+				if (count < maxFields) { starts[count] = fieldStart; ends[count] = d; ++count; }
+				fieldStart = d + 1;
+				if (*d == '\n') return d;
+			}
+		}
+		if (count < maxFields) { starts[count] = fieldStart; ends[count] = end; ++count; }
+		return end;
+	}
+
+	/** Quita espacios, retornos de carro y comillas de los extremos de [p, end). */
+	static void trimField(const char*& p, const char*& end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '"')) ++p;
+		while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '"')) --end;
+	}
+
+	/**
+	 * Convierte texto decimal a double sin copiarlo ni pasar por el locale.
+	 *
+	 * Camino rápido (Clinger): con una mantisa de hasta 2^53 y un exponente decimal de hasta
+	 * ±22, mantisa y potencia de 10 son exactas en double y una sola multiplicación o división
+	 * redondea igual que strtod. El resto (mantisas más largas, exponentes grandes) usa strtod
+	 * sobre una copia, así el resultado es siempre idéntico al de la biblioteca estándar.
+	 *
+	 * @param p   Inicio del texto
+	 * @param end Fin del texto (se ignoran espacios en los extremos)
+	 * @param out Salida
+	 * @return    false si el campo está vacío o no es un número
+	 */
+	static bool parseNumber(const char* p, const char* end, double& out) {
+		static const double POW10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		trimField(p, end);
+		if (p == end) return false;
+		const char* start = p;
+		bool negative = *p == '-';
+		if (*p == '-' || *p == '+') ++p;
+
+		uint64_t mantissa = 0;
+		int significant = 0;   // Dígitos acumulados desde el primero distinto de cero
+		int exponent = 0;
+		bool digits = false, truncated = false;
+		for (; p < end && (unsigned)(*p - '0') < 10; ++p) {
+			digits = true;
+			if (significant < 19) { mantissa = mantissa * 10 + (unsigned)(*p - '0'); if (mantissa) ++significant; }
+			else { ++exponent; truncated |= *p != '0'; }
+		}
+		if (p < end && *p == '.') {
+			for (++p; p < end && (unsigned)(*p - '0') < 10; ++p) {
+				digits = true;
+				if (significant < 19) { mantissa = mantissa * 10 + (unsigned)(*p - '0'); if (mantissa) ++significant; --exponent; }
+				else truncated |= *p != '0';
+			}
+		}
+		if (!digits) return false;
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			++p;
+			bool negativeExponent = p < end && *p == '-';
+			if (p < end && (*p == '-' || *p == '+')) ++p;
+			if (p == end) return false;
+			int e = 0;
+			for (; p < end && (unsigned)(*p - '0') < 10; ++p) e = std::min(e * 10 + (*p - '0'), 100000);
+			exponent += negativeExponent ? -e : e;
+		}
+		if (p != end) return false;
+
+		if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+			double v = (double)mantissa;
+			v = exponent < 0 ? v / POW10[-exponent] : v * POW10[exponent];
+			out = negative ? -v : v;
+			return true;
+		}
+
+		// Camino lento: strtod sobre una copia terminada en '\0'
+		char buffer[64];
+		size_t length = (size_t)(end - start);
+		if (length >= sizeof(buffer)) return false;
+		std::memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		char* parsed;
+		out = std::strtod(buffer, &parsed);
+		return parsed == buffer + length;
+	}
+};
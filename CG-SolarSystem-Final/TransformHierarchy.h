@@ -0,0 +1,346 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "SimdMath.h"
+
+/**
+ * Jerarquía de transformaciones con caché por nodo.
+ *
+ * Cada nodo tiene una transformación local T · Rx(inclinación) · Ry(giro) · S(escala) relativa
+ * a su padre, y la del mundo se obtiene como mundo(padre) · local. La parte lineal (rotación y
+ * escala) se guarda en float y la traslación en doble precisión, para usarla con el origen
+ * flotante (ver FloatingOrigin).
+ *
+ * Los nodos se agregan con el padre antes que los hijos. Internamente se guardan por niveles
+ * (cada profundidad es un tramo contiguo, en el orden en que se agregaron, así quien recorre
+ * sus nodos en ese orden escribe en forma secuencial), con un arreglo propio por campo, y
+ * update() recorre los niveles en orden:
+ *  1. La traslación del mundo (Tw = Tp + Wp · T) se compone de a VDouble::WIDTH nodos por
+ *     instrucción; si los nodos del lote son hermanos, la matriz del padre se difunde a todos
+ *     los carriles sin cargas dispersas.
+ *  2. La parte lineal del mundo solo se guarda en los nodos con hijos, que la necesitan para
+ *     componer a los suyos. La de una hoja (la esfera de un cuerpo, un satélite sin lunas) se
+ *     compone recién al pedir su matriz de modelo, así que en cada frame solo se calcula para
+ *     lo que se dibuja.
+ *  3. Un lote se salta entero si no cambió ninguno de sus nodos ni sus padres; con la
+ *     animación en pausa update() ni siquiera recorre los niveles.
+ */
+class TransformHierarchy {
+public:
+	int size() const { return (int)slotOf.size(); }
+
+	/** Nodos recompuestos en el último update() (para las estadísticas). */
+	int updatedNodes() const { return lastUpdated; }
+
+	/**
+	 * Agrega un nodo con la transformación identidad.
+	 *
+	 * @param parentNode Nodo padre (debe ser anterior) o -1 para una raíz
+	 * @return Índice del nodo
+	 */
+	int add(int parentNode) {
+		int i = size();
+		parentOf.push_back(parentNode < i ? parentNode : -1);
+		slotOf.push_back(i);  // Al final hasta el próximo reordenamiento por niveles
+		parentSlot.push_back(-1);
+		hasChildren.push_back(0);
+		for (std::vector<double>* v : { &tx, &ty, &tz, &tilt, &spin, &wx, &wy, &wz }) v->push_back(0.0);
+		for (std::vector<float>* v : { &sx, &sy, &sz }) v->push_back(1.0f);
+		Basis identity = { { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f } };
+		world.push_back(identity);
+		localDirty.push_back(LOCAL_MOVED | LOCAL_LINEAR);  // Se compone con el padre en el próximo update()
+		worldDirty.push_back(0);
+		layoutDirty = true;
+		anyDirty = true;
+		return i;
+	}
+
+	/** Elimina todos los nodos. */
+	void clear() {
+		parentOf.clear();
+		slotOf.clear();
+		parentSlot.clear();
+		hasChildren.clear();
+		for (std::vector<double>* v : { &tx, &ty, &tz, &tilt, &spin, &wx, &wy, &wz }) v->clear();
+		for (std::vector<float>* v : { &sx, &sy, &sz }) v->clear();
+		world.clear();
+		localDirty.clear();
+		worldDirty.clear();
+		levelStart.clear();
+		layoutDirty = false;
+		anyDirty = false;
+		lastUpdated = 0;
+	}
+
+	/** Reserva memoria para n nodos. */
+	void reserve(size_t n) {
+		parentOf.reserve(n);
+		slotOf.reserve(n);
+		parentSlot.reserve(n);
+		hasChildren.reserve(n);
+		for (std::vector<double>* v : { &tx, &ty, &tz, &tilt, &spin, &wx, &wy, &wz }) v->reserve(n);
+		for (std::vector<float>* v : { &sx, &sy, &sz }) v->reserve(n);
+		world.reserve(n);
+		localDirty.reserve(n);
+		worldDirty.reserve(n);
+	}
+
+	/**
+	 * Cambia los parámetros locales de un nodo; si no cambian, el nodo sigue limpio.
+	 *
+	 * @param i           Índice del nodo
+	 * @param position    Traslación en el sistema del padre
+	 * @param tiltDegrees Inclinación sobre el eje X (grados)
+	 * @param spinDegrees Giro sobre el eje Y ya inclinado (grados)
+	 * @param nodeScale   Escala por eje
+	 */
+	void setLocal(int i, const glm::dvec3& position, double tiltDegrees, double spinDegrees, const glm::vec3& nodeScale) {
+		int s = slotOf[i];
+		uint8_t changed = 0;
+		if (tilt[s] != tiltDegrees || spin[s] != spinDegrees || sx[s] != nodeScale.x || sy[s] != nodeScale.y || sz[s] != nodeScale.z) {
+			tilt[s] = tiltDegrees;
+			spin[s] = spinDegrees;
+			sx[s] = nodeScale.x;
+			sy[s] = nodeScale.y;
+			sz[s] = nodeScale.z;
+			changed = LOCAL_MOVED | LOCAL_LINEAR;  // Hay que rehacer la parte lineal
+		}
+		if (tx[s] != position.x || ty[s] != position.y || tz[s] != position.z) {
+			tx[s] = position.x;
+			ty[s] = position.y;
+			tz[s] = position.z;
+			changed |= LOCAL_MOVED;                 // Solo cambia la traslación: la parte lineal sirve
+		}
+		if (changed) {
+			localDirty[s] |= changed;
+			anyDirty = true;
+		}
+	}
+
+	/** Recalcula las matrices del mundo de los nodos sucios (ver la descripción de la clase). */
+	void update() {
+		lastUpdated = 0;
+		if (layoutDirty) relayout();
+		if (!anyDirty) return;  // Nada cambió desde el último update()
+		anyDirty = false;
+
+		int updated = 0;
+		const int levels = (int)levelStart.size() - 1;
+		for (int level = 0; level < levels; ++level) {
+			const int begin = levelStart[level], end = levelStart[level + 1];
+			int s = begin;
+			if (level > 0) {
+				for (; s + VDouble::WIDTH <= end; s += VDouble::WIDTH) updated += composeBatch(s);
+			}
+			for (; s < end; ++s) updated += composeNode(s);  // Raíces y resto del nivel
+		}
+		lastUpdated = updated;
+	}
+
+	/** Posición del nodo en el mundo (doble precisión). */
+	glm::dvec3 worldPosition(int i) const {
+		int s = slotOf[i];
+		return glm::dvec3(wx[s], wy[s], wz[s]);
+	}
+
+	/**
+	 * Matriz de modelo del nodo con la traslación relativa a un origen (la cámara):
+	 * la resta se hace en doble precisión antes de pasar a float.
+	 *
+	 * @param i      Índice del nodo
+	 * @param origin Posición de la cámara en el mundo
+	 */
+	glm::mat4 modelMatrix(int i, const glm::dvec3& origin) const {
+		int s = slotOf[i];
+		Basis w;
+		if (hasChildren[s]) w = world[s];
+		else worldLinear(s, w);  // Hoja: se compone aquí
+		glm::mat4 m(1.0f);
+		for (int c = 0; c < 3; ++c) {
+			for (int r = 0; r < 3; ++r) m[c][r] = w.m[c * 3 + r];
+		}
+		m[3] = glm::vec4(glm::vec3(glm::dvec3(wx[s], wy[s], wz[s]) - origin), 1.0f);
+		return m;
+	}
+
+private:
+	static constexpr uint8_t LOCAL_MOVED = 1;   // Cambió algún parámetro local
+	static constexpr uint8_t LOCAL_LINEAR = 2;  // Cambió inclinación, giro o escala
+	static constexpr uint8_t WORLD_MOVED = 1;   // Cambió la traslación del mundo
+	static constexpr uint8_t WORLD_LINEAR = 2;  // Cambió la parte lineal del mundo
+
+	/** Parte lineal (rotación y escala) 3x3 por columnas. */
+	struct Basis {
+		float m[9];
+	};
+
+	// Por nodo, en el orden en que se agregaron
+	std::vector<int> parentOf;             // Nodo padre (-1 = raíz)
+	std::vector<int> slotOf;               // Posición del nodo en los arreglos por niveles
+	// Por posición (ordenados por niveles)
+	std::vector<int> parentSlot;           // Posición del padre (-1 = raíz)
+	std::vector<uint8_t> hasChildren;      // Guarda la parte lineal del mundo (la leen sus hijos)
+	std::vector<double> tx, ty, tz;        // Traslación en el sistema del padre
+	std::vector<double> tilt, spin;        // Inclinación y giro (grados)
+	std::vector<float> sx, sy, sz;         // Escala por eje
+	std::vector<double> wx, wy, wz;        // Traslación del mundo
+	std::vector<Basis> world;              // Parte lineal del mundo (solo nodos con hijos)
+	std::vector<uint8_t> localDirty;       // LOCAL_*: qué cambió desde el último update()
+	std::vector<uint8_t> worldDirty;       // WORLD_*: qué se recompuso en el último update() (lo heredan los hijos)
+	std::vector<int> levelStart;           // Primera posición de cada nivel (más una al final)
+	bool layoutDirty = false;
+	bool anyDirty = false;
+	int lastUpdated = 0;
+
+	/** Parte lineal local en forma cerrada: R = Rx(a) · Ry(b), columnas escaladas por S. */
+	void localLinear(int s, Basis& out) const {
+		const double deg = 3.14159265358979323846 / 180.0;
+		double sa = 0.0, ca = 1.0;
+		if (tilt[s] != 0.0) { sa = std::sin(tilt[s] * deg); ca = std::cos(tilt[s] * deg); }  // Lo común es girar sin inclinar
+		double sb = std::sin(spin[s] * deg), cb = std::cos(spin[s] * deg);
+		float* m = out.m;
+		// Columna 0 = (cb, sa·sb, -ca·sb)·sx; columna 1 = (0, ca, sa)·sy; columna 2 = (sb, -sa·cb, ca·cb)·sz
+		m[0] = (float)cb * sx[s];
+		m[1] = (float)(sa * sb) * sx[s];
+		m[2] = (float)(-ca * sb) * sx[s];
+		m[3] = 0.0f;
+		m[4] = (float)ca * sy[s];
+		m[5] = (float)sa * sy[s];
+		m[6] = (float)sb * sz[s];
+		m[7] = (float)(-sa * cb) * sz[s];
+		m[8] = (float)(ca * cb) * sz[s];
+	}
+
+	/** Parte lineal del mundo: W = Wp · L (por columnas: elemento k = columna k/3, fila k%3). */
+	void worldLinear(int s, Basis& out) const {
+		Basis local;
+		localLinear(s, local);
+		int p = parentSlot[s];
+		if (p < 0) { out = local; return; }
+		const float* P = world[p].m;
+		const float* L = local.m;
+		for (int c = 0; c < 3; ++c) {
+			for (int r = 0; r < 3; ++r) {
+				out.m[c * 3 + r] = P[r] * L[c * 3] + P[3 + r] * L[c * 3 + 1] + P[6 + r] * L[c * 3 + 2];
+			}
+		}
+	}
+
+	/** Banderas del nodo para este update(); devuelve si hay que recomponerlo. */
+	bool takeFlags(int s) {
+		int p = parentSlot[s];
+		uint8_t inherited = p >= 0 ? worldDirty[p] : 0;
+		uint8_t local = localDirty[s];
+		localDirty[s] = 0;
+		bool linear = (local & LOCAL_LINEAR) || (inherited & WORLD_LINEAR);
+		bool dirty = local || inherited;
+		worldDirty[s] = (dirty ? WORLD_MOVED : 0) | (linear ? WORLD_LINEAR : 0);
+		if (linear && hasChildren[s]) worldLinear(s, world[s]);  // Los hijos la leen en el nivel siguiente
+		return dirty;
+	}
+
+	/** Compone un nodo suelto (raíces y resto de cada nivel). */
+	int composeNode(int s) {
+		if (!takeFlags(s)) return 0;
+		int p = parentSlot[s];
+		if (p < 0) {
+			wx[s] = tx[s]; wy[s] = ty[s]; wz[s] = tz[s];
+			return 1;
+		}
+		// Traslación: Tw = Tp + Wp · T (en doble precisión)
+		const float* P = world[p].m;
+		wx[s] = wx[p] + (P[0] * tx[s] + P[3] * ty[s] + P[6] * tz[s]);
+		wy[s] = wy[p] + (P[1] * tx[s] + P[4] * ty[s] + P[7] * tz[s]);
+		wz[s] = wz[p] + (P[2] * tx[s] + P[5] * ty[s] + P[8] * tz[s]);
+		return 1;
+	}
+
+	/** Compone VDouble::WIDTH nodos seguidos de un mismo nivel (ninguno es raíz). */
+	int composeBatch(int s) {
+		const int W = VDouble::WIDTH;
+		int dirty = 0;
+		for (int l = 0; l < W; ++l) dirty += takeFlags(s + l);
+		if (dirty == 0) return 0;  // Lote sin cambios: se conserva lo del frame anterior
+
+		VDouble P[9], px, py, pz;
+		int first = parentSlot[s];
+		bool siblings = true;
+		for (int l = 1; l < W; ++l) siblings = siblings && parentSlot[s + l] == first;
+		if (siblings) {
+			// Hermanos agregados seguidos: un solo padre para todos los carriles
+			const float* m = world[first].m;
+			for (int k = 0; k < 9; ++k) P[k] = VDouble::set1(m[k]);
+			px = VDouble::set1(wx[first]);
+			py = VDouble::set1(wy[first]);
+			pz = VDouble::set1(wz[first]);
+		}
+		else {
+			double lanes[12][W];
+			for (int l = 0; l < W; ++l) {
+				int p = parentSlot[s + l];
+				const float* m = world[p].m;
+				for (int k = 0; k < 9; ++k) lanes[k][l] = m[k];
+				lanes[9][l] = wx[p];
+				lanes[10][l] = wy[p];
+				lanes[11][l] = wz[p];
+			}
+			for (int k = 0; k < 9; ++k) P[k] = VDouble::load(lanes[k]);
+			px = VDouble::load(lanes[9]);
+			py = VDouble::load(lanes[10]);
+			pz = VDouble::load(lanes[11]);
+		}
+		// Los carriles sin cambios vuelven a dar exactamente el mismo valor
+		VDouble x = VDouble::load(&tx[s]), y = VDouble::load(&ty[s]), z = VDouble::load(&tz[s]);
+		(px + (P[0] * x + P[3] * y + P[6] * z)).store(&wx[s]);
+		(py + (P[1] * x + P[4] * y + P[7] * z)).store(&wy[s]);
+		(pz + (P[2] * x + P[5] * y + P[8] * z)).store(&wz[s]);
+		return dirty;
+	}
+
+	/**
+	 * Reordena los arreglos por niveles (orden estable por profundidad). Solo ocurre después de
+	 * agregar nodos; todos quedan sucios.
+	 */
+	void relayout() {
+		layoutDirty = false;
+		anyDirty = true;
+		const int n = size();
+		// Profundidad de cada nodo (el padre siempre es anterior) y orden estable por niveles
+		std::vector<int> depth(n), hasChild(n, 0);
+		int levels = 0;
+		for (int i = 0; i < n; ++i) {
+			int p = parentOf[i];
+			depth[i] = p >= 0 ? depth[p] + 1 : 0;
+			if (p >= 0) hasChild[p] = 1;
+			levels = std::max(levels, depth[i] + 1);
+		}
+		levelStart.assign(levels + 1, 0);
+		for (int i = 0; i < n; ++i) ++levelStart[depth[i] + 1];
+		for (int l = 0; l < levels; ++l) levelStart[l + 1] += levelStart[l];
+		std::vector<int> newSlot(n), fill(levelStart.begin(), levelStart.end() - 1);
+		for (int i = 0; i < n; ++i) newSlot[i] = fill[depth[i]]++;
+
+		// Mover los datos a sus posiciones nuevas
+		auto permute = [&](auto& v) {
+			auto old = v;
+			for (int i = 0; i < n; ++i) v[newSlot[i]] = old[slotOf[i]];
+		};
+		for (std::vector<double>* v : { &tx, &ty, &tz, &tilt, &spin, &wx, &wy, &wz }) permute(*v);
+		for (std::vector<float>* v : { &sx, &sy, &sz }) permute(*v);
+		permute(world);
+		slotOf = newSlot;
+		for (int i = 0; i < n; ++i) {
+			int s = slotOf[i];
+			parentSlot[s] = parentOf[i] >= 0 ? slotOf[parentOf[i]] : -1;
+			hasChildren[s] = (uint8_t)hasChild[i];
+			localDirty[s] = LOCAL_MOVED | LOCAL_LINEAR;
+			worldDirty[s] = 0;
+		}
+	}
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Triple buffer sin bloqueos para pasar datos de un productor a un consumidor.
+ *
+ * El productor escribe siempre en su propio buffer y lo publica intercambiándolo
+ * atómicamente con el buffer intermedio. El consumidor toma el intermedio solo si
+ * hay uno nuevo. Ninguno de los dos hilos espera al otro y el consumidor siempre
+ * ve la última publicación completa.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+	/** Buffer propio del productor (solo lo toca el hilo productor). */
+	T& writeBuffer() { return buffers[writeIndex]; }
+
+	/** Publica el buffer escrito y toma el intermedio para la próxima escritura. */
+	void publish() {
+		uint8_t previous = middle.exchange((uint8_t)(writeIndex | NEW_FLAG), std::memory_order_acq_rel);
+		writeIndex = previous & INDEX_MASK;
+	}
+
+	/**
+	 * Toma la última publicación si existe (solo lo llama el hilo consumidor).
+	 *
+	 * @return true si readBuffer() cambió
+	 */
+	bool consume() {
+		if (!(middle.load(std::memory_order_acquire) & NEW_FLAG)) return false;
+		uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previous & INDEX_MASK;
+		return true;
+	}
+
+	/** Último buffer tomado por el consumidor. */
+	const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+	static const uint8_t INDEX_MASK = 0x3;
+	static const uint8_t NEW_FLAG = 0x4;
+
+	T buffers[3];
+	std::atomic<uint8_t> middle;  // Índice del buffer intermedio + bandera de "nuevo"
+	uint8_t writeIndex;           // Solo productor
+	uint8_t readIndex;            // Solo consumidor
+};
@@ -29,9 +29,39 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cfloat>
+#include <fstream>
+#include <atomic>
+#include <unordered_map>
 
 // Librerías personalizadas del proyecto
 #include "Shader.h"        // Clase personalizada para manejo de shaders
+#include "LabelRenderer.h" // Etiquetas 3D con proyección por lotes y anti-solapamiento
+#include "PerfStats.h"     // Medición de FPS y uso de CPU
+#include "FramePacer.h"    // Limitador de FPS, V-Sync y medición de pacing
+#include "Simulation.h"    // Simulación de paso fijo separada del renderizado
+#include "BodyStore.h"     // Cuerpos de la escena en arreglos por componente
+#include "SimulationThread.h" // Hilo de simulación con triple buffer
+#include "Profiler.h"      // Utilización por hilo
+#include "JulianDate.h"    // Conversión entre fechas de calendario y fechas julianas
+#include "Ephemeris.h"     // Posiciones planetarias a partir de elementos keplerianos
+#include "ChebyshevEphemeris.h" // Efemérides precalculadas en archivo (polinomios de Chebyshev)
+#define FRAME_ARENA_IMPLEMENTATION  // Reemplazo de operator new con contador (implementación única)
+#include "FrameArena.h"    // Arena por frame y contador de asignaciones
+#include "Benchmark.h"     // Validaciones y mediciones del modo --bench
+#include "FloatingOrigin.h" // Posiciones relativas a la cámara para la escala real
+#include "ReversedDepth.h" // Profundidad invertida con plano lejano infinito
+#include "SceneCatalog.h"  // Escena cargada desde scene.txt (compilada a binario)
+#include "MinorBodyCatalog.h" // Catálogos de asteroides y cometas importados a binario
+#include "StarCatalog.h"   // Estrellas de fondo agrupadas en celdas HEALPix
+#include "SphereBVH.h"     // Jerarquía de volúmenes envolventes para consultas de rayo y de vista
+#include "StreamBuffer.h"  // Buffer mapeado para los datos de cada frame
+#include "FramesInFlight.h"  // Fences por frame y frames en vuelo
+#include "FrameRecorder.h"  // Grabación a PNG o Y4M con lectura asíncrona y codificación en paralelo
+#include "BatchRender.h"   // Render por lotes de un guion en varios procesos
+#include "InputLog.h"      // Grabación y reproducción determinista de la entrada
 
 // Librería para cargar texturas (implementación única)
 #define STB_IMAGE_IMPLEMENTATION
@@ -54,47 +84,124 @@ const float minPitch = -90.0f; // Límite inferior de inclinación
 // Configuración de meteoritos
 const int MAX_METEORITES = 6; // Número máximo de meteoritos simultáneos
 
+// Renderizado bajo demanda
+const int REDRAW_FRAMES_AFTER_EVENT = 3;   // Frames extra tras un evento (ImGui necesita asentar hover/click)
+const double IDLE_WAIT_TIMEOUT = 0.5;      // Tiempo máximo bloqueado esperando eventos (segundos)
+
+// Efemérides precalculadas (se generan con --build-ephemeris)
+const char* const EPHEMERIS_FILE = "planets.eph";
+const int EPHEMERIS_START_YEAR = 1800;     // Cobertura del archivo y rango de la barra de años
+const int EPHEMERIS_END_YEAR = 2200;
+
+// Catálogo de cuerpos menores (se importa con --import-minor-bodies desde MPCORB.DAT o un CSV del SBDB)
+const char* const MINOR_BODY_FILE = "minor_bodies.cat";
+const int MINOR_BODY_BLOCKS_PER_TASK = 256;  // Bloques de Ephemeris por tarea al evaluar en paralelo
+
+// Catálogo de estrellas del fondo (se genera con --build-star-catalog desde un CSV de HYG, Hipparcos o Gaia)
+const char* const STAR_CATALOG_FILE = "stars.cat";
+const int STAR_CATALOG_NSIDE = 32;           // Resolución HEALPix: 12 288 celdas de unos 3.4 grados cuadrados
+const float FIELD_OF_VIEW = 45.0f;           // Campo de visión vertical (grados)
+
+// Escena: texto editable y su forma compilada (se recompila y recarga al guardar el texto)
+const char* const SCENE_FILE = "scene.txt";
+const char* const SCENE_BINARY_FILE = "scene.bin";
+const double SCENE_RELOAD_INTERVAL = 1.0;  // Cada cuánto se consulta si el texto cambió (segundos)
+
+// Escala real: en ese modo la unidad de la escena es la UA
+const double KM_PER_AU = 149597870.7;
+const double TRUE_SCALE_MAX_DISTANCE = 100.0;           // Distancia máxima de la cámara al foco (UA)
+const float SCHEMATIC_CAMERA_DISTANCE = 22.0f;          // Distancia fija de la cámara al Sol (vista esquemática)
+const float SCHEMATIC_NEAR = 0.1f;                      // Plano cercano de la vista esquemática
+const float TRUE_SCALE_NEAR = 1.0e-7f;                  // Plano cercano en escala real (UA, unos 15 km)
+
+// Datos de cada frame (uniforms compartidos y de cada draw, partículas, meteoritos) escritos una vez en la región del frame (ver FramesInFlight)
+const int FRAMES_IN_FLIGHT = 3;                         // Frames que la CPU puede preparar por delante de la GPU
+const GLsizeiptr FRAME_STREAM_SIZE = 1 << 20;           // Bytes iniciales por frame del buffer de streaming (crece si no entra)
+const unsigned int FRAME_DATA_BINDING = 0;              // Punto de enlace del bloque FrameData
+const unsigned int DRAW_DATA_BINDING = 1;               // Punto de enlace del bloque DrawData
+const float STAR_POINT_SCALE = 1.5f;                    // Tamaño en píxeles de una estrella en la magnitud límite
+
+// Grabación: cuadros por segundo ofrecidos, divisores de 1 / FIXED_DT para simular pasos enteros por cuadro
+const int RECORD_FPS_OPTIONS[] = { 24, 30, 60, 120 };
+const int RECORD_MAX_SIZE = 8192;                       // Lado máximo de la grabación (píxeles)
+
 // ===========================================
 // 3. ESTRUCTURAS DE DATOS
 // ===========================================
 
 /**
- * Estructura que representa un cuerpo celeste (planeta) en el sistema solar.
- * Contiene todas las propiedades necesarias para renderizado y animación.
+ * Bloque de uniforms del frame (uniform FrameData, layout std140, en todos los shaders).
+ * Se escribe una vez por pasada en el buffer de streaming en lugar de un glUniform por shader.
+ */
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 sky;          // Radio del cielo, magnitud límite y STAR_POINT_SCALE (estrellas)
+};
+
+/**
+ * Bloque de uniforms de un draw (uniform DrawData, layout std140, en los shaders de objetos y de
+ * órbitas). Los de una pasada se escriben juntos en el buffer de streaming y cada draw vincula el
+ * suyo con glBindBufferRange, sin glGetUniformLocation ni glUniform.
+ */
+struct DrawData {
+    glm::mat4 model;
+    glm::vec4 color;        // Color de órbitas y puntos (rgb)
+    glm::vec4 cameraHigh;   // Cámara partida en dos floats (origen flotante, xyz); 0 si los vértices
+    glm::vec4 cameraLow;    // ya son relativos a la cámara
+};
+
+/**
+ * Bloques DrawData de una pasada, seguidos en el buffer de streaming (ver mapDrawData).
+ */
+struct DrawDataBatch {
+    GLuint buffer = 0;          // Buffer donde quedaron (StreamBuffer cambia de buffer si crece)
+    GLintptr offset = 0;        // Desplazamiento del primero
+    GLsizeiptr stride = 0;      // Distancia entre bloques, alineada como exige glBindBufferRange
+
+    /** Vincula el bloque k para los draws que siguen. */
+    void bind(int k) const {
+        glBindBufferRange(GL_UNIFORM_BUFFER, DRAW_DATA_BINDING, buffer, offset + k * stride, sizeof(DrawData));
+    }
+};
+
+/**
+ * Tramo de un render por lotes que dibuja este proceso (--render-worker): sin ventana visible,
+ * graba los cuadros [first, first + count) del guion y termina.
  */
-struct Planet {
-    // Propiedades básicas
-    string name;           // Nombre del planeta para mostrar en pantalla
-    float orbitRadius;     // Radio de la órbita alrededor del sol (unidades arbitrarias)
-    float orbitSpeed;      // Velocidad de traslación orbital (grados/segundo)
-    float orbitAngle;      // Ángulo actual en la órbita (0-360 grados)
-    float rotationSpeed;   // Velocidad de rotación sobre su propio eje (grados/segundo)
-    float rotationAngle;   // Ángulo actual de rotación (0-360 grados)
-    float size;            // Tamaño relativo del planeta (factor de escala)
-    GLuint texture;        // ID de la textura OpenGL para la superficie del planeta
-
-    // Propiedades de Luna
-    bool hasMoon;          // Indica si el planeta tiene luna
-    float moonDistance;    // Distancia de la luna al planeta (unidades relativas)
-    float moonSpeed;       // Velocidad orbital de la luna (grados/segundo)
-    float moonAngle;       // Ángulo actual de la luna en su órbita
-    GLuint moonTexture;    // ID de la textura para la luna
-
-    // Propiedades de anillos (Saturno)
-    bool hasRing;          // Indica si el planeta tiene anillos
-    GLuint ringTexture;    // ID de la textura para los anillos
+struct BatchJob {
+    bool active = false;
+    RenderScript script;
+    long long first = 0;        // Primer cuadro del tramo
+    long long count = 0;        // Cuadros del tramo
+    int part = 0;               // Número de tramo (nombre de sus archivos)
+    int cores = 1;              // Núcleos asignados al proceso
+    double loopStart = 0.0;     // Instante (glfwGetTime) del primer cuadro
 };
 
 /**
- * Estructura que representa un meteorito en el sistema de partículas.
- * Los meteoritos se mueven diagonalmente a través de la pantalla para efectos visuales.
+ * Sesión con la entrada grabada (--record-input) o reproducida (--replay-input, --bench-replay).
+ * La simulación avanza con el deltaTime de cada frame, no con el reloj, y la reproducción compara
+ * la suma de control de cada frame con la grabada.
  */
-struct Meteorite {
-    glm::vec3 position;     // Posición actual en coordenadas normalizadas (-1 a 1)
-    glm::vec3 velocity;     // Vector de velocidad y dirección del movimiento
-    bool isVisible;         // Estado de visibilidad actual
-    float timeToAppear;     // Tiempo futuro en el que aparecerá (no usado actualmente)
-    float initialDelay;     // Retraso inicial antes de la primera aparición
+struct InputSession {
+    bool enabled = false;       // Grabar o reproducir desde el arranque
+    bool replaying = false;     // Reproducción en curso (hasta informar el final)
+    bool benchmark = false;     // --bench-replay: sin V-Sync ni limitador, informe y salida al terminar
+    std::string path;           // Archivo del registro
+    std::string resultsPath;    // CSV donde --bench-replay agrega una fila por corrida
+    std::string error;          // Motivo por el que la reproducción terminó antes
+    double pendingTime = 0.0;   // deltaTime acumulado que todavía no completa un paso fijo
+    int mismatches = 0;         // Frames cuya suma de control difiere de la grabada
+    long long firstMismatch = -1;
+    double lastSwap = -1.0;     // Para el intervalo entre frames reproducidos
+    FrameTimeLog frameTimes;    // Intervalo entre swaps
+    FrameTimeLog workTimes;     // Trabajo del hilo de render por frame
+    uint64_t allocations = 0;   // Asignaciones al heap del hilo de render durante la reproducción
+    uint64_t peakAllocations = 0;       // Máximo de asignaciones en un frame
+    uint32_t allocatingFrames = 0;      // Frames con alguna asignación
+    long long lastAllocatingFrame = -1; // Último frame reproducido que asignó (el resto es régimen estable)
+    int exitCode = 0;
 };
 
 /**
@@ -124,7 +231,6 @@ struct PlanetData {
 float cameraPitch = 0.0f;                          // Ángulo de inclinación actual (grados) - PITCH
 float cameraYaw = 0.0f;                            // Ángulo de rotación horizontal (grados) - YAW
 float pitchSpeed = 30.0f;                          // Velocidad de rotación de la cámara (grados/segundo)
-const float pitchIncrement = pitchSpeed * 0.016f;  // Incremento por frame (asumiendo ~60 FPS)
 
 // Variables para control con mouse
 bool firstMouse = true;                            // Primera vez que se mueve el mouse (evita salto inicial)
@@ -133,10 +239,23 @@ float lastMouseY = SCR_HEIGHT / 2.0f;             // Última posición Y del mou
 float lastMouseX = SCR_WIDTH / 2.0f;              // Última posición X del mouse
 float mouseSensitivity = 0.5f;                    // Sensibilidad del movimiento del mouse
 
+// Latch tardío de la cámara: la entrada se vuelve a leer justo antes de escribir la vista
+bool lateLatchInput = true;                        // Releer eventos y cursor antes de calcular la vista
+bool predictCameraInput = false;                   // Extrapolar el giro del mouse hasta la presentación
+double cameraInputTime = -1.0;                     // Instante (glfwGetTime) de la última entrada que movió la cámara
+double latchTime = -1.0;                           // Instante del último latch (y sus ángulos, para la velocidad)
+double latchClock = -1.0;                          // Reloj del último latch para la velocidad (con entrada grabada, el del registro)
+float latchPitch = 0.0f, latchYaw = 0.0f;
+float pitchRate = 0.0f, yawRate = 0.0f;            // Velocidad angular medida entre latches (grados/segundo)
+LatencyStats inputLatency;                         // De la entrada que movió la cámara hasta el swap
+LatencyStats latchLatency;                         // Del latch hasta el swap (lo que se predice)
+
 // Variables de estado de la interfaz y efectos visuales
 bool showNames = false;                            // Mostrar/ocultar nombres de planetas
 bool animationPaused = false;                      // Pausar/reanudar animación del sistema solar
 bool showOrbits = true;                            // Mostrar/ocultar líneas de órbita
+bool showMinorBodies = true;                       // Mostrar/ocultar asteroides y cometas del catálogo
+float starLimitMagnitude = 6.5f;                   // Las estrellas más débiles no se dibujan (6.5 = a simple vista)
 bool showMeteorites = false;                       // Activar/desactivar lluvia de meteoritos
 int meteoriteCount = 3;                            // Cantidad de meteoritos activos simultáneamente
 
@@ -149,134 +268,65 @@ bool highlightEarthComparisons = false;            // Resaltar comparaciones con
 int selectedPlanetForComparison = 2;               // Planeta seleccionado para comparación (2 = Tierra)
 bool showFunFacts = false;                         // Mostrar datos curiosos en la tabla
 
+// Etiquetas de nombres acumuladas durante el frame y dibujadas en un solo lote
+LabelRenderer labelRenderer;
+
+// Variables de renderizado bajo demanda y estadísticas
+bool onDemandRendering = true;                     // Reposar cuando la escena no cambia
+std::atomic<int> pendingRedrawFrames(REDRAW_FRAMES_AFTER_EVENT);  // Frames que aún deben dibujarse
+bool showStats = false;                            // Mostrar panel de estadísticas
+FrameStats frameStats;                             // FPS y uso de CPU medidos
+FramePacer framePacer;                             // Limitador de frames y estadísticas de pacing
+int vsyncMode = FramePacer::VSYNC_ON;              // Modo de V-Sync seleccionado en la interfaz
+Profiler profiler;                                 // Utilización de los hilos de render y simulación
+FrameArena frameArena;                             // Datos que viven un solo frame (se vacía al comenzar cada uno)
+FrameAllocationStats frameAllocations;             // Asignaciones al heap del hilo de render por frame
+
+// Variables de control del tiempo simulado
+float timeWarpDaysPerSecond = (float)DEFAULT_DAYS_PER_SECOND;  // Días simulados por segundo real
+bool timeReversed = false;                         // Avanzar el tiempo hacia atrás
+int targetYear = 2000, targetMonth = 1, targetDay = 1;  // Fecha de destino para "Ir a la fecha"
+NBodySettings nbodySettings;                       // Modo gravitacional N-cuerpos
+
+// Variables de grabación de video (resolución y paso de simulación fijos)
+int recordWidth = 1920, recordHeight = 1080;       // Resolución de la grabación
+int recordFpsIndex = 1;                            // Índice en RECORD_FPS_OPTIONS (30 FPS)
+int recordFormat = FrameEncoder::PNG_SEQUENCE;     // Secuencia PNG o flujo Y4M
+char recordTarget[256] = "captura";                // Prefijo de los PNG, archivo .y4m o "|comando"
+std::string recordStatus;                          // Resultado de la última grabación
+BatchJob batchJob;                                 // Tramo de render por lotes de este proceso (inactivo en modo interactivo)
+
+// Registro de entrada: sesiones que se repiten frame por frame
+InputLog inputLog;                                 // Eventos, deltaTime y sumas de control grabados o reproducidos
+InputState inputState;                             // Teclas, cursor y tamaños según los eventos aplicados
+InputSession inputSession;                         // Modo de la sesión y resultados de la reproducción
+
+// Variables de escala real (origen flotante y profundidad invertida)
+bool trueScale = false;                            // Distancias y radios reales en UA
+int cameraFocus = 3;                               // Índice en BodyStore del cuerpo que sigue la cámara en escala real (3 = Tierra)
+double trueScaleDistance = 0.05;                   // Distancia de la cámara al foco en escala real (UA)
+FloatingOrigin floatingOrigin;                     // Posición de la cámara (doble precisión) = origen del frame
+ReversedDepth reversedDepth;                       // Framebuffer de la escena con profundidad invertida
+
+// Selección de cuerpos con el mouse (rayo desde el cursor contra la BVH de los cuerpos)
+SphereBVH bodyBounds;                              // Esferas envolventes de los cuerpos, reajustadas en cada frame
+glm::mat4 pickProjection(1.0f), pickView(1.0f);    // Matrices del último frame dibujado (lo que ve el usuario)
+int hoveredBody = -1;                              // Cuerpo bajo el cursor (-1 = ninguno)
+int clickedBody = -1;                              // Cuerpo pulsado; se aplica en el loop, donde están los cuerpos
+bool followSelection = false;                      // Vista esquemática: la cámara sigue al cuerpo elegido y no al Sol
+
 // ===========================================
 // 5. BASE DE DATOS EDUCATIVA
 // ===========================================
 
 /**
- * Array con datos astronómicos reales de todos los planetas del sistema solar.
- * Fuentes: 
- * NASA Planetary Fact Sheet  https://nssdc.gsfc.nasa.gov/planetary/factsheet/index.html
- * JPL https://ssd.jpl.nasa.gov/planets/phys_par.html
- * ESA https://www.esa.int/kids/es/Aprende/Nuestro_Universo/Planetas_y_lunas/El_Sistema_Solar
+ * Filas de la tabla educativa con datos astronómicos reales, en el orden del archivo de escena.
+ * Se llenan desde scene.txt (claves table_name, distance_au, period_days, ...; ver loadScene),
+ * donde también están las fuentes de los datos.
  * Incluye información educativa para estudiantes de nivel primario/secundario.
  */
-PlanetData planetEducationalData[] = {
-    {
-        "Mercurio",
-        0.39f,                          // 0.4 UA del Sol
-        57.9f,                         // 57.9 millones de km
-        88.0f,                         // 88 días terrestres por órbita
-        1407.6f,                       // 1407.6 horas por día (58.6 días terrestres)
-        4879.0f,                       // 4,879 km de diámetro
-        0.055f,                        // 5.5% de la masa terrestre
-        0.330f,                        // masa del planeta
-        "Rocoso",
-        "Sin atmósfera",
-        "Un día dura más que un año",
-        ImVec4(0.8f, 0.7f, 0.6f, 1.0f) // Color gris-dorado
-    },
-    {
-        "Venus",
-        0.72f,                         // 0.72 UA del Sol
-        108.2f,                        // 108.2 millones de km
-        225.0f,                        // 225 días terrestres
-        5832.5f,                       // 5832.5 horas (243 días terrestres)
-        12104.0f,                      // 12,104 km de diámetro
-        0.815f,                        // 81.5% de la masa terrestre
-        4.87f,                        // masa del planeta
-        "Rocoso",
-        "Dióxido de carbono denso (96%), Nitrógeno (3%)",
-        "Rota al revés (retrógrado)",
-        ImVec4(1.0f, 0.8f, 0.4f, 1.0f) // Color amarillo-naranja
-    },
-    {
-        "Tierra",
-        1.0f,                          // 1.0 UA del Sol (definición de UA)
-        149.6f,                        // 149.6 millones de km
-        365.25f,                       // 365.25 días (año terrestre)
-        24.0f,                         // 24 horas (día terrestre)
-        12756.0f,                      // 12,756 km de diámetro
-        1.0f,                          // 100% masa terrestre (referencia)
-        5.97f,                        // masa del planeta
-        "Rocoso",
-        "Nitrógeno (78%), Óxígeno (21%)",
-        "Único planeta con vida conocida",
-        ImVec4(0.4f, 0.8f, 1.0f, 1.0f) // Color azul terrestre
-    },
-    {
-        "Marte",
-        1.52f,                         // 1.52 UA del Sol
-        227.9f,                        // 227.9 millones de km
-        687.0f,                        // 687 días terrestres
-        24.6f,                         // 24.6 horas (similar a la Tierra)
-        6792.0f,                       // 6,792 km de diámetro
-        0.107f,                        // 10.7% de la masa terrestre
-        0.642f,                        // masa del planeta
-        "Rocoso",
-        "Dióxido de carbono (95%), Nitrógeno (3%)",
-        "Tiene las montañas más altas del sistema solar",
-        ImVec4(1.0f, 0.5f, 0.3f, 1.0f) // Color rojizo
-    },
-    {
-        "Júpiter",
-        5.20f,                         // 5.20 UA del Sol
-        778.5f,                        // 778.5 millones de km
-        4333.0f,                       // 4,333 días terrestres (11.9 años)
-        9.9f,                          // 9.9 horas (día más corto)
-        142984.0f,                     // 142,984 km de diámetro
-        317.8f,                        // 317.8 veces la masa terrestre
-        1898.0f,                        // masa del planeta
-        "Gaseoso",
-        "Hidrógeno (89%), Helio (10%)",
-        "Tiene más masa que todos los otros planetas juntos (aprox 2.5 veces)",
-        ImVec4(0.9f, 0.7f, 0.5f, 1.0f) // Color marrón-naranja
-    },
-    {
-        "Saturno",
-        9.58f,                         // 9.58 UA del Sol
-        1432.0f,                       // 1,432 millones de km
-        10747.0f,                      // 10,747 días terrestres (29.4 años)
-        10.7f,                         // 10.7 horas
-        120536.0f,                     // 120,536 km de diámetro
-        95.2f,                         // 95.2 veces la masa terrestre
-        568.0f,                        // masa del planeta
-        "Gaseoso",
-        "Hidrógeno (96%), Helio (3%)",
-        "Flotaría en agua (densidad < 1 g/cm³)",
-        ImVec4(1.0f, 0.9f, 0.7f, 1.0f) // Color dorado claro
-    },
-    {
-        "Urano",
-        19.20f,                        // 19.20 UA del Sol
-        2867.0f,                       // 2,867 millones de km
-        30589.0f,                      // 30,589 días terrestres (83.7 años)
-        17.2f,                         // 17.2 horas
-        51118.0f,                      // 51,118 km de diámetro
-        14.5f,                         // 14.5 veces la masa terrestre
-        86.8f,                        // masa del planeta
-        "Gigante de hielo",
-        "Hidrógeno (83%), Helio (15%), Metano (2%)",
-        "Rota de lado (inclinación 98°)",
-        ImVec4(0.4f, 0.8f, 0.9f, 1.0f) // Color azul-verde
-    },
-    {
-        "Neptuno",
-        30.05f,                        // 30.05 UA del Sol
-        4515.0f,                       // 4,515 millones de km
-        59800.0f,                      // 59,800 días terrestres (163.7 años)
-        16.1f,                         // 16.1 horas
-        49528.0f,                      // 49,528 km de diámetro
-        17.1f,                         // 17.1 veces la masa terrestre
-        102.0f,                 // masa del planeta
-        "Gigante de hielo",
-        "Higrógeno (80%), Helio (19%), Metano (1%)",
-        "Vientos más rápidos del sistema solar (2,100 km/h)",
-        ImVec4(0.2f, 0.4f, 1.0f, 1.0f) // Color azul profundo
-    }
-    //Pluton no se considera planeta desde el 2006, debido a que no cumple con los criterios de La Unión Astronómica Internacional UAI
-
-};
+std::vector<PlanetData> planetEducationalData;
+int earthDataIndex = 2;  // Fila de la Tierra, referencia de todas las comparaciones
 
 // ===========================================
 // 6. DECLARACIONES DE FUNCIONES
@@ -284,32 +334,84 @@ PlanetData planetEducationalData[] = {
 
 // Funciones de geometría y utilidades OpenGL
 void createSphere(vector<float>& vertices, vector<unsigned int>& indices);
-void createCircle(std::vector<float>& vertices, int numSegments);
+void createOrbitPath(const Simulation& simulation, int body, double julianDate, int numSegments, bool realScale, std::vector<float>& vertices);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 // Funciones de carga y manejo de recursos
 GLuint loadTexture(const char* path, GLuint fallbackTextureID);
+int buildEphemerisFile(const char* path);
+bool loadEphemerisFile(ChebyshevEphemeris& table, const char* path, size_t bodyCount);
+int importMinorBodyFile(const char* textPath, const char* binaryPath);
+int buildStarCatalogFile(const char* csvPath, const char* binaryPath);
 
 // Funciones de renderizado
-void renderPlanet(Shader& shader, Planet& planet, unsigned int sphereVAO,
-    const vector<unsigned int>& sphereIndices, float deltaTime,
-    const glm::mat4& view, const glm::mat4& projection);
-void renderTextIn3DSpace(const std::string& text, glm::vec3 worldPos,
-    const glm::mat4& view, const glm::mat4& projection);
+int prepareBodyDraws(const BodyStore& bodies, const FloatingOrigin& origin, StreamBuffer& stream, DrawDataBatch& draws);
+void renderBody(const BodyStore& bodies, int i, const DrawDataBatch& draws, int& draw,
+    unsigned int sphereVAO, const vector<unsigned int>& sphereIndices);
+glm::dvec3 cameraFocusPosition(const BodyStore& bodies, double& radius);
+int pickBody(double xpos, double ypos);
+void createMinorBodyVertices(const Ephemeris& ephemeris, const Simulation& simulation, double julianDate, bool realScale,
+    std::vector<double>& scratch, float* vertices);
+int renderStarField(Shader& shader, const StarCatalog& catalog, unsigned int starVAO, const glm::vec3& forward,
+    float aspect);
+void bindFrameData(StreamBuffer& stream, const glm::mat4& projection, const glm::mat4& view, float skyRadius);
+char* mapDrawData(StreamBuffer& stream, int count, DrawDataBatch& batch);
+void bindDrawData(StreamBuffer& stream, const glm::mat4& model, const glm::vec3& color,
+    const glm::vec3& cameraHigh, const glm::vec3& cameraLow);
+float nearestSurfaceDistance(const BodyStore& bodies, const FloatingOrigin& origin);
 
 // Funciones de interfaz educativa - Tabla informativa
 void renderEducationalInterface();
 void renderPlanetDataTable();
 void renderPlanetComparisonInfo();
+void renderTimeControls(SimulationThread& simulationThread, double julianDate);
+void renderGravityControls(SimulationThread& simulationThread, const SimulationState& state);
+void renderRecordingControls(FrameRecorder& recorder, SimulationThread& simulationThread, int frameSlots, bool offscreen);
+void stopRecording(FrameRecorder& recorder, SimulationThread& simulationThread);
+bool startBatchJob(BatchJob& job, Simulation& simulation, SimulationThread& simulationThread, FrameRecorder& recorder,
+    int frameSlots, bool offscreen);
+void applyBatchCamera(const BatchJob& job, const BodyStore& bodies, long long frame);
+int finishBatchJob(const BatchJob& job, const FrameRecorder& recorder);
 
 // Funciones de entrada y control - Teclado y Mouse 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void window_refresh_callback(GLFWwindow* window);
+void processCameraInput(float deltaTime);
+void applyMouseLook(double xpos, double ypos);
+void latchCameraInput(GLFWwindow* window);
+
+// Funciones de renderizado bajo demanda
+void requestRedraw();
+
+// Funciones del registro de entrada (grabación y reproducción)
+void routeInput(GLFWwindow* window, InputEvent e);
+void dispatchInput(GLFWwindow* window, const InputEvent& e);
+void installInputCallbacks(GLFWwindow* window);
+bool replayInputTo(GLFWwindow* window, InputEvent::Type marker, InputEvent& out);
+void syncInputFrame(GLFWwindow* window, float& deltaTime);
+double syncInputLatch(GLFWwindow* window);
+void syncInputCheck(GLFWwindow* window, uint32_t checksum);
+uint32_t frameChecksum(const BodyStore& bodies, const SimulationState& state, float viewPitch, float viewYaw);
+void finishInputReplay();
+double todayJulianDate();
 
 // ===========================================
 // 7. FUNCIONES DE ENTRADA Y CONTROL
 // ===========================================
 
+/**
+ * Solicita que se dibujen los próximos frames aunque la escena esté en reposo.
+ * Es seguro llamarla desde cualquier hilo (por ejemplo, al terminar una carga en segundo plano):
+ * despierta al loop principal si está bloqueado en glfwWaitEventsTimeout.
+ */
+void requestRedraw() {
+    pendingRedrawFrames.store(REDRAW_FRAMES_AFTER_EVENT);
+    glfwPostEmptyEvent();
+}
+
 /**
  * Callback para manejar eventos de teclado.
  * Controla la inclinación y rotación de la cámara usando las teclas de flecha y funciones especiales.
@@ -322,25 +424,17 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
  * @param mods     Modificadores activos (Shift, Ctrl, Alt)
  */
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    requestRedraw();  // Cualquier tecla puede cambiar la escena o la interfaz
+
     // Solo procesar eventos de presión o repetición de tecla
+    // (las flechas se leen de forma continua en processCameraInput)
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
-        if (key == GLFW_KEY_UP) {
-            // Tecla flecha hacia arriba: Inclinar cámara hacia arriba (aumentar pitch)
-            cameraPitch += pitchIncrement;
-            // Limitar el ángulo máximo para evitar gimbal lock
-            if (cameraPitch > maxPitch) cameraPitch = maxPitch;
-        }
-        else if (key == GLFW_KEY_DOWN) {
-            // Tecla flecha hacia abajo: Inclinar cámara hacia abajo (disminuir pitch)
-            cameraPitch -= pitchIncrement;
-            // Limitar el ángulo mínimo
-            if (cameraPitch < minPitch) cameraPitch = minPitch;
-        }
-        else if (key == GLFW_KEY_R) {
+        if (key == GLFW_KEY_R) {
             // Tecla R: Resetear la vista a la posición horizontal por defecto
             cameraPitch = 0.0f;
             cameraYaw = 0.0f;
             firstMouse = true;  // Reinicializar mouse para evitar saltos
+            followSelection = false;  // La vista esquemática vuelve a mirar al Sol
         }
         else if (key == GLFW_KEY_M) {
             // Tecla M: Toggle (activar/desactivar) control con mouse
@@ -349,9 +443,35 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
 }
 
+/**
+ * Control continuo de la cámara con las flechas ↑↓.
+ * Mientras la tecla esté presionada el pitch avanza a pitchSpeed grados/segundo,
+ * independientemente de los FPS y de la repetición de teclado del sistema.
+ *
+ * @param deltaTime Tiempo transcurrido desde el último frame
+ */
+void processCameraInput(float deltaTime) {
+    bool up = inputState.keyDown(GLFW_KEY_UP);
+    bool down = inputState.keyDown(GLFW_KEY_DOWN);
+
+    if (up) cameraPitch += pitchSpeed * deltaTime;     // Inclinar cámara hacia arriba
+    if (down) cameraPitch -= pitchSpeed * deltaTime;   // Inclinar cámara hacia abajo
+
+    // Limitar el ángulo para evitar gimbal lock
+    if (cameraPitch > maxPitch) cameraPitch = maxPitch;
+    if (cameraPitch < minPitch) cameraPitch = minPitch;
+
+    // Tecla mantenida: seguir dibujando aunque la escena esté en reposo
+    if (up || down) {
+        cameraInputTime = glfwGetTime();
+        requestRedraw();
+    }
+}
+
 /**
  * Callback para manejar movimiento del mouse.
  * Implementa control de cámara con pitch y yaw usando coordenadas esféricas.
+ * Con el control desactivado el cursor está libre y se busca el cuerpo que apunta.
  * Referencia: https://www.glfw.org/docs/3.3/input_guide.html#input_mouse
  *
  * @param window Ventana GLFW que recibió el evento
@@ -359,9 +479,25 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
  * @param ypos   Posición Y actual del cursor
  */
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
-    // Si el control de mouse está desactivado, no procesar movimiento
-    if (!mouseControleEnabled) return;
+    requestRedraw();  // El movimiento afecta al hover de ImGui aunque la cámara no se mueva
 
+    // Si el control de mouse está desactivado, el cursor solo apunta: rayo contra los cuerpos
+    if (!mouseControleEnabled) {
+        hoveredBody = ImGui::GetIO().WantCaptureMouse ? -1 : pickBody(xpos, ypos);
+        return;
+    }
+
+    applyMouseLook(xpos, ypos);
+}
+
+/**
+ * Gira la cámara según el desplazamiento del cursor desde la última posición aplicada.
+ * La usan el callback del mouse y el latch tardío, que lee el cursor sin esperar un evento.
+ *
+ * @param xpos Posición X del cursor
+ * @param ypos Posición Y del cursor
+ */
+void applyMouseLook(double xpos, double ypos) {
     // Primera vez: inicializar posición para evitar salto brusco al activar
     if (firstMouse) {
         lastMouseY = ypos;
@@ -373,6 +509,8 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     // Calcular offset de movimiento desde la última posición
     float yoffset = lastMouseY - ypos;  // Invertido: mover arriba = pitch positivo
     float xoffset = lastMouseX - xpos;  // Movimiento horizontal para yaw
+    if (xoffset == 0.0f && yoffset == 0.0f) return;
+    cameraInputTime = glfwGetTime();
 
     // Actualizar últimas posiciones
     lastMouseY = ypos;
@@ -394,6 +532,394 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     if (cameraYaw < 0.0f) cameraYaw += 360.0f;
 }
 
+/**
+ * Latch tardío: procesa los eventos que llegaron mientras se armaba el frame y lee la posición
+ * actual del cursor, justo antes de calcular la vista. Con la entrada leída solo al comienzo,
+ * en frames lentos la vista mostraba el mouse de hace un frame entero.
+ * También mide la velocidad angular entre latches para la predicción.
+ *
+ * @param window Ventana GLFW a consultar
+ */
+void latchCameraInput(GLFWwindow* window) {
+    glfwPollEvents();  // ImGui encola los suyos para el próximo frame
+    double now = glfwGetTime();
+    double clock = inputLog.isActive() ? syncInputLatch(window) : now;  // Entrada grabada: el reloj del registro
+    if (mouseControleEnabled) applyMouseLook(inputState.cursorX, inputState.cursorY);
+
+    if (latchClock >= 0.0 && clock > latchClock) {
+        float yawStep = cameraYaw - latchYaw;
+        if (yawStep > 180.0f) yawStep -= 360.0f;   // El yaw se mantiene en 0°-360°
+        if (yawStep < -180.0f) yawStep += 360.0f;
+        float dt = (float)(clock - latchClock);
+        pitchRate = 0.5f * pitchRate + 0.5f * (cameraPitch - latchPitch) / dt;  // Suavizado de medio frame
+        yawRate = 0.5f * yawRate + 0.5f * yawStep / dt;
+    }
+    latchTime = now;
+    latchClock = clock;
+    latchPitch = cameraPitch;
+    latchYaw = cameraYaw;
+}
+
+/**
+ * Callback para botones del mouse. La interacción con la interfaz la procesa ImGui (callbacks
+ * encadenados); un clic izquierdo fuera de ella selecciona el cuerpo bajo el cursor.
+ */
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !mouseControleEnabled &&
+        !ImGui::GetIO().WantCaptureMouse) {
+        clickedBody = pickBody(inputState.cursorX, inputState.cursorY);
+    }
+    requestRedraw();
+}
+
+/**
+ * Callback para la rueda del mouse (scroll de la tabla educativa).
+ * En escala real, fuera de la interfaz, acerca o aleja la cámara del cuerpo seguido.
+ */
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    if (trueScale && !ImGui::GetIO().WantCaptureMouse) {
+        trueScaleDistance *= std::pow(0.8, yoffset);  // Zoom multiplicativo: igual de ágil cerca de la Luna y lejos de Neptuno
+    }
+    requestRedraw();
+}
+
+/**
+ * Callback de refresco de ventana: el sistema pide redibujar (ventana descubierta, restaurada, etc.).
+ */
+void window_refresh_callback(GLFWwindow* window) {
+    requestRedraw();
+}
+
+// REGISTRO DE ENTRADA (GRABACIÓN Y REPRODUCCIÓN)
+// Toda la entrada pasa por routeInput: se graba si corresponde y se reparte a los callbacks de la
+// aplicación y a ImGui. Al reproducir la entrada real se descarta y los mismos eventos salen del
+// registro, en los mismos puntos del frame. ImGui recibe los eventos directamente (sin los
+// callbacks del backend de GLFW, que consultan el teclado y el cursor reales).
+
+/**
+ * Traduce una tecla de GLFW a ImGui.
+ *
+ * @param key Código GLFW_KEY_*
+ * @return    Tecla de ImGui o ImGuiKey_None
+ */
+ImGuiKey imguiKeyFromGlfw(int key) {
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) return (ImGuiKey)(ImGuiKey_A + (key - GLFW_KEY_A));
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) return (ImGuiKey)(ImGuiKey_0 + (key - GLFW_KEY_0));
+    if (key >= GLFW_KEY_KP_0 && key <= GLFW_KEY_KP_9) return (ImGuiKey)(ImGuiKey_Keypad0 + (key - GLFW_KEY_KP_0));
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F24) return (ImGuiKey)(ImGuiKey_F1 + (key - GLFW_KEY_F1));
+    static const int keys[][2] = {
+        { GLFW_KEY_TAB, ImGuiKey_Tab }, { GLFW_KEY_LEFT, ImGuiKey_LeftArrow }, { GLFW_KEY_RIGHT, ImGuiKey_RightArrow },
+        { GLFW_KEY_UP, ImGuiKey_UpArrow }, { GLFW_KEY_DOWN, ImGuiKey_DownArrow }, { GLFW_KEY_PAGE_UP, ImGuiKey_PageUp },
+        { GLFW_KEY_PAGE_DOWN, ImGuiKey_PageDown }, { GLFW_KEY_HOME, ImGuiKey_Home }, { GLFW_KEY_END, ImGuiKey_End },
+        { GLFW_KEY_INSERT, ImGuiKey_Insert }, { GLFW_KEY_DELETE, ImGuiKey_Delete }, { GLFW_KEY_BACKSPACE, ImGuiKey_Backspace },
+        { GLFW_KEY_SPACE, ImGuiKey_Space }, { GLFW_KEY_ENTER, ImGuiKey_Enter }, { GLFW_KEY_ESCAPE, ImGuiKey_Escape },
+        { GLFW_KEY_APOSTROPHE, ImGuiKey_Apostrophe }, { GLFW_KEY_COMMA, ImGuiKey_Comma }, { GLFW_KEY_MINUS, ImGuiKey_Minus },
+        { GLFW_KEY_PERIOD, ImGuiKey_Period }, { GLFW_KEY_SLASH, ImGuiKey_Slash }, { GLFW_KEY_SEMICOLON, ImGuiKey_Semicolon },
+        { GLFW_KEY_EQUAL, ImGuiKey_Equal }, { GLFW_KEY_LEFT_BRACKET, ImGuiKey_LeftBracket },
+        { GLFW_KEY_BACKSLASH, ImGuiKey_Backslash }, { GLFW_KEY_RIGHT_BRACKET, ImGuiKey_RightBracket },
+        { GLFW_KEY_GRAVE_ACCENT, ImGuiKey_GraveAccent }, { GLFW_KEY_CAPS_LOCK, ImGuiKey_CapsLock },
+        { GLFW_KEY_SCROLL_LOCK, ImGuiKey_ScrollLock }, { GLFW_KEY_NUM_LOCK, ImGuiKey_NumLock },
+        { GLFW_KEY_PRINT_SCREEN, ImGuiKey_PrintScreen }, { GLFW_KEY_PAUSE, ImGuiKey_Pause },
+        { GLFW_KEY_KP_DECIMAL, ImGuiKey_KeypadDecimal }, { GLFW_KEY_KP_DIVIDE, ImGuiKey_KeypadDivide },
+        { GLFW_KEY_KP_MULTIPLY, ImGuiKey_KeypadMultiply }, { GLFW_KEY_KP_SUBTRACT, ImGuiKey_KeypadSubtract },
+        { GLFW_KEY_KP_ADD, ImGuiKey_KeypadAdd }, { GLFW_KEY_KP_ENTER, ImGuiKey_KeypadEnter },
+        { GLFW_KEY_KP_EQUAL, ImGuiKey_KeypadEqual }, { GLFW_KEY_LEFT_SHIFT, ImGuiKey_LeftShift },
+        { GLFW_KEY_LEFT_CONTROL, ImGuiKey_LeftCtrl }, { GLFW_KEY_LEFT_ALT, ImGuiKey_LeftAlt },
+        { GLFW_KEY_LEFT_SUPER, ImGuiKey_LeftSuper }, { GLFW_KEY_RIGHT_SHIFT, ImGuiKey_RightShift },
+        { GLFW_KEY_RIGHT_CONTROL, ImGuiKey_RightCtrl }, { GLFW_KEY_RIGHT_ALT, ImGuiKey_RightAlt },
+        { GLFW_KEY_RIGHT_SUPER, ImGuiKey_RightSuper }, { GLFW_KEY_MENU, ImGuiKey_Menu },
+    };
+    for (const auto& k : keys) {
+        if (k[0] == key) return (ImGuiKey)k[1];
+    }
+    return ImGuiKey_None;
+}
+
+/**
+ * Modificadores de ImGui según las teclas presionadas (en X11 los mods del evento no incluyen
+ * la tecla modificadora que se acaba de presionar).
+ */
+void updateImGuiModifiers(ImGuiIO& io) {
+    io.AddKeyEvent(ImGuiMod_Ctrl, inputState.keyDown(GLFW_KEY_LEFT_CONTROL) || inputState.keyDown(GLFW_KEY_RIGHT_CONTROL));
+    io.AddKeyEvent(ImGuiMod_Shift, inputState.keyDown(GLFW_KEY_LEFT_SHIFT) || inputState.keyDown(GLFW_KEY_RIGHT_SHIFT));
+    io.AddKeyEvent(ImGuiMod_Alt, inputState.keyDown(GLFW_KEY_LEFT_ALT) || inputState.keyDown(GLFW_KEY_RIGHT_ALT));
+    io.AddKeyEvent(ImGuiMod_Super, inputState.keyDown(GLFW_KEY_LEFT_SUPER) || inputState.keyDown(GLFW_KEY_RIGHT_SUPER));
+}
+
+/**
+ * Aplica un evento (real o reproducido): estado de la entrada, callbacks de la aplicación e ImGui.
+ *
+ * @param window Ventana principal
+ * @param e      Evento de entrada
+ */
+void dispatchInput(GLFWwindow* window, const InputEvent& e) {
+    inputState.apply(e);
+    ImGuiIO& io = ImGui::GetIO();
+    switch (e.type) {
+    case InputEvent::KEY:
+        key_callback(window, e.key, e.scancode, e.action, e.mods);
+        if (e.action == GLFW_REPEAT) break;  // ImGui genera sus propias repeticiones
+        updateImGuiModifiers(io);
+        io.AddKeyEvent(imguiKeyFromGlfw(e.key), e.action == GLFW_PRESS);
+        break;
+    case InputEvent::CHAR:
+        io.AddInputCharacter((unsigned int)e.key);
+        requestRedraw();
+        break;
+    case InputEvent::CURSOR_POS:
+        mouse_callback(window, e.x, e.y);
+        io.AddMousePosEvent((float)e.x, (float)e.y);
+        break;
+    case InputEvent::CURSOR_ENTER:
+        // Fuera de la ventana ImGui no ve el mouse; al volver, la última posición conocida
+        if (e.key) io.AddMousePosEvent((float)inputState.cursorX, (float)inputState.cursorY);
+        else io.AddMousePosEvent(-FLT_MAX, -FLT_MAX);
+        requestRedraw();
+        break;
+    case InputEvent::MOUSE_BUTTON:
+        mouse_button_callback(window, e.key, e.action, e.mods);
+        updateImGuiModifiers(io);
+        if (e.key >= 0 && e.key < ImGuiMouseButton_COUNT) io.AddMouseButtonEvent(e.key, e.action == GLFW_PRESS);
+        break;
+    case InputEvent::SCROLL:
+        scroll_callback(window, e.x, e.y);
+        io.AddMouseWheelEvent((float)e.x, (float)e.y);
+        break;
+    case InputEvent::FOCUS:
+        io.AddFocusEvent(e.key != 0);
+        requestRedraw();
+        break;
+    case InputEvent::FRAMEBUFFER_SIZE:
+        framebuffer_size_callback(window, e.key, e.scancode);
+        break;
+    case InputEvent::WINDOW_SIZE:
+        requestRedraw();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Entrada real: se graba (si hay grabación) y se aplica. Mientras se reproduce se descarta.
+ */
+void routeInput(GLFWwindow* window, InputEvent e) {
+    if (inputLog.isReplaying()) return;
+    inputLog.record(e, glfwGetTime());
+    dispatchInput(window, e);
+}
+
+void input_key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    routeInput(window, InputEvent::keyEvent(key, scancode, action, mods));
+}
+void input_char_callback(GLFWwindow* window, unsigned int codepoint) {
+    routeInput(window, InputEvent::valueEvent(InputEvent::CHAR, (int)codepoint));
+}
+void input_cursor_pos_callback(GLFWwindow* window, double xpos, double ypos) {
+    routeInput(window, InputEvent::pointEvent(InputEvent::CURSOR_POS, xpos, ypos));
+}
+void input_cursor_enter_callback(GLFWwindow* window, int entered) {
+    routeInput(window, InputEvent::valueEvent(InputEvent::CURSOR_ENTER, entered));
+}
+void input_mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    routeInput(window, InputEvent::buttonEvent(button, action, mods));
+}
+void input_scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    routeInput(window, InputEvent::pointEvent(InputEvent::SCROLL, xoffset, yoffset));
+}
+void input_focus_callback(GLFWwindow* window, int focused) {
+    routeInput(window, InputEvent::valueEvent(InputEvent::FOCUS, focused));
+}
+void input_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    routeInput(window, InputEvent::valueEvent(InputEvent::FRAMEBUFFER_SIZE, width, height));
+}
+void input_window_size_callback(GLFWwindow* window, int width, int height) {
+    routeInput(window, InputEvent::valueEvent(InputEvent::WINDOW_SIZE, width, height));
+}
+
+/**
+ * Registra los callbacks de entrada (después de crear el contexto de ImGui) y aplica el estado
+ * inicial de la ventana y el cursor como eventos, para que también quede en la grabación.
+ *
+ * @param window Ventana principal
+ */
+void installInputCallbacks(GLFWwindow* window) {
+    glfwSetKeyCallback(window, input_key_callback);                         // Teclado
+    glfwSetCharCallback(window, input_char_callback);                       // Texto (campos de ImGui)
+    glfwSetCursorPosCallback(window, input_cursor_pos_callback);            // Mouse
+    glfwSetCursorEnterCallback(window, input_cursor_enter_callback);
+    glfwSetMouseButtonCallback(window, input_mouse_button_callback);        // Botones del mouse
+    glfwSetScrollCallback(window, input_scroll_callback);                   // Rueda del mouse
+    glfwSetWindowFocusCallback(window, input_focus_callback);
+    glfwSetFramebufferSizeCallback(window, input_framebuffer_size_callback);  // Redimensionamiento
+    glfwSetWindowSizeCallback(window, input_window_size_callback);
+
+    // El backend de ImGui lee el cursor real en cada frame si cree que el mouse está fuera de la
+    // ventana; se le indica que está dentro y la posición le llega siempre por los eventos
+    ImGui_ImplGlfw_CursorEnterCallback(window, GLFW_TRUE);
+
+    if (inputLog.isReplaying()) return;  // El estado inicial grabado es lo primero del registro
+    int width, height;
+    double xpos, ypos;
+    glfwGetWindowSize(window, &width, &height);
+    routeInput(window, InputEvent::valueEvent(InputEvent::WINDOW_SIZE, width, height));
+    glfwGetFramebufferSize(window, &width, &height);
+    routeInput(window, InputEvent::valueEvent(InputEvent::FRAMEBUFFER_SIZE, width, height));
+    routeInput(window, InputEvent::valueEvent(InputEvent::FOCUS, glfwGetWindowAttrib(window, GLFW_FOCUSED)));
+    glfwGetCursorPos(window, &xpos, &ypos);
+    routeInput(window, InputEvent::pointEvent(InputEvent::CURSOR_POS, xpos, ypos));
+    routeInput(window, InputEvent::valueEvent(InputEvent::CURSOR_ENTER, glfwGetWindowAttrib(window, GLFW_HOVERED)));
+}
+
+/**
+ * Reproduce los eventos grabados hasta la próxima marca, que debe ser del tipo pedido.
+ * Si el registro terminó, está dañado o la marca es otra (la sesión se apartó de la grabación),
+ * la reproducción se detiene.
+ *
+ * @param window Ventana principal
+ * @param marker Marca esperada (FRAME, LATCH o CHECK)
+ * @param out    Salida: la marca leída
+ * @return false si la reproducción terminó
+ */
+bool replayInputTo(GLFWwindow* window, InputEvent::Type marker, InputEvent& out) {
+    InputEvent e;
+    while (inputLog.next(e)) {
+        if (!e.isMarker()) {
+            dispatchInput(window, e);
+            continue;
+        }
+        if (e.type == marker) {
+            out = e;
+            return true;
+        }
+        inputSession.error = "marca inesperada en el frame " + to_string(inputLog.replayedFrameCount());
+        break;
+    }
+    if (inputSession.error.empty()) inputSession.error = inputLog.error();
+    inputLog.stop();
+    return false;
+}
+
+/**
+ * Comienzo del frame: graba su deltaTime o, al reproducir, aplica los eventos del frame y usa el
+ * deltaTime grabado.
+ *
+ * @param window    Ventana principal
+ * @param deltaTime Tiempo del frame (se reemplaza al reproducir)
+ */
+void syncInputFrame(GLFWwindow* window, float& deltaTime) {
+    InputEvent frame = InputEvent::make(InputEvent::FRAME);
+    if (inputLog.isRecording()) {
+        frame.deltaTime = deltaTime;
+        inputLog.record(frame, glfwGetTime());
+    }
+    else if (replayInputTo(window, InputEvent::FRAME, frame)) {
+        deltaTime = frame.deltaTime;
+    }
+}
+
+/**
+ * Latch tardío con entrada grabada: marca (o eventos reproducidos hasta la marca) y reloj del
+ * registro en ese punto.
+ *
+ * @return Segundos desde el comienzo de la grabación
+ */
+double syncInputLatch(GLFWwindow* window) {
+    InputEvent latch = InputEvent::make(InputEvent::LATCH);
+    if (inputLog.isRecording()) inputLog.record(latch, glfwGetTime());
+    else replayInputTo(window, InputEvent::LATCH, latch);
+    return inputLog.time();
+}
+
+/**
+ * Final del frame: graba la suma de control del estado o la compara con la grabada.
+ */
+void syncInputCheck(GLFWwindow* window, uint32_t checksum) {
+    InputEvent check = InputEvent::make(InputEvent::CHECK);
+    if (inputLog.isRecording()) {
+        check.checksum = checksum;
+        inputLog.record(check, glfwGetTime());
+    }
+    else if (replayInputTo(window, InputEvent::CHECK, check) && check.checksum != checksum) {
+        if (inputSession.mismatches++ == 0) {
+            inputSession.firstMismatch = (long long)inputLog.replayedFrameCount() - 1;
+            cout << "La reproduccion se aparta de la grabacion en el frame " << inputSession.firstMismatch << endl;
+        }
+    }
+}
+
+/**
+ * Suma de control de lo que muestra el frame: fecha, cuerpos, meteoritos, cámara y opciones de
+ * la interfaz que cambian la escena.
+ */
+uint32_t frameChecksum(const BodyStore& bodies, const SimulationState& state, float viewPitch, float viewYaw) {
+    const BodyStore::TransformChunk& t = bodies.transforms;
+    uint32_t h = InputLog::hash(&state.julianDate, sizeof(double));
+    h = InputLog::hash(t.x.data(), t.x.size() * sizeof(double), h);
+    h = InputLog::hash(t.y.data(), t.y.size() * sizeof(double), h);
+    h = InputLog::hash(t.z.data(), t.z.size() * sizeof(double), h);
+    for (const Meteorite& m : state.meteorites) {
+        float p[4] = { m.position.x, m.position.y, m.position.z, m.isVisible ? 1.0f : 0.0f };
+        h = InputLog::hash(p, sizeof(p), h);
+    }
+    float camera[3] = { viewPitch, viewYaw, timeWarpDaysPerSecond };
+    double distance = trueScale ? trueScaleDistance : 0.0;
+    int flags[] = { trueScale, cameraFocus, followSelection, hoveredBody, selectedPlanetForComparison, showNames,
+        showOrbits, showMinorBodies, showMeteorites, meteoriteCount, animationPaused, timeReversed, mouseControleEnabled };
+    h = InputLog::hash(camera, sizeof(camera), h);
+    h = InputLog::hash(&distance, sizeof(distance), h);
+    return InputLog::hash(flags, sizeof(flags), h);
+}
+
+/**
+ * Fin de la reproducción: resumen de tiempos, de asignaciones al heap por frame y de diferencias
+ * con la grabación. Con --bench-replay agrega una fila al CSV de resultados para comparar
+ * compilaciones.
+ */
+void finishInputReplay() {
+    InputSession& s = inputSession;
+    uint32_t frames = inputLog.replayedFrameCount();
+    bool complete = s.error.empty() && frames == inputLog.frameCount();
+    double seconds = s.frameTimes.totalSeconds();
+    cout << "Reproduccion de " << s.path << ": " << frames << " de " << inputLog.frameCount() << " frames"
+        << (complete ? "" : " (incompleta: " + s.error + ")") << endl;
+    if (s.mismatches == 0) cout << "  Todos los frames coinciden con la grabacion" << endl;
+    else cout << "  Frames distintos de la grabacion: " << s.mismatches << " (el primero, " << s.firstMismatch << ")" << endl;
+    printf("  Intervalo entre frames: media %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f (%.1f FPS)\n",
+        s.frameTimes.meanMs(), s.frameTimes.percentileMs(50), s.frameTimes.percentileMs(95),
+        s.frameTimes.percentileMs(99), s.frameTimes.percentileMs(100), seconds > 0.0 ? s.frameTimes.count() / seconds : 0.0);
+    printf("  Trabajo del hilo de render: media %.3f ms, p95 %.3f, max %.3f\n",
+        s.workTimes.meanMs(), s.workTimes.percentileMs(95), s.workTimes.percentileMs(100));
+    if (s.allocatingFrames == 0) printf("  Asignaciones al heap por frame: ninguna en %u frames\n", frames);
+    else printf("  Asignaciones al heap por frame: %llu en %u de %u frames (max %llu), la ultima en el frame %lld\n",
+        (unsigned long long)s.allocations, s.allocatingFrames, frames, (unsigned long long)s.peakAllocations, s.lastAllocatingFrame);
+
+    if (s.benchmark && !s.resultsPath.empty()) {
+        bool exists = std::ifstream(s.resultsPath).good();
+        std::ofstream csv(s.resultsPath, std::ios::app);
+        if (!exists) csv << "compilacion,registro,frames,coinciden,fps,media_ms,p50_ms,p95_ms,p99_ms,max_ms,render_ms,"
+            "asignaciones,frames_con_asignaciones,max_asignaciones_frame,ultimo_frame_con_asignaciones" << endl;
+        char row[512];
+        snprintf(row, sizeof(row), "%s %s,%s,%u,%d,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%llu,%u,%llu,%lld", __DATE__, __TIME__,
+            s.path.c_str(), frames, s.mismatches == 0 && complete ? 1 : 0, seconds > 0.0 ? s.frameTimes.count() / seconds : 0.0,
+            s.frameTimes.meanMs(), s.frameTimes.percentileMs(50), s.frameTimes.percentileMs(95),
+            s.frameTimes.percentileMs(99), s.frameTimes.percentileMs(100), s.workTimes.meanMs(),
+            (unsigned long long)s.allocations, s.allocatingFrames, (unsigned long long)s.peakAllocations, s.lastAllocatingFrame);
+        csv << row << endl;
+        cout << (csv ? "  Resultados agregados a " : "  No se pudo escribir ") << s.resultsPath << endl;
+    }
+    s.exitCode = complete && s.mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * Fecha juliana de "hoy". Con entrada grabada es la fecha al comenzar la grabación más el tiempo
+ * del registro, para que el botón "Hoy" salte a la misma fecha al reproducir.
+ */
+double todayJulianDate() {
+    if (!inputLog.isActive()) return currentJulianDate();
+    return inputLog.header().startJulianDate + inputLog.time() / 86400.0;
+}
+
 // ===========================================
 // 8. FUNCIONES DE INTERFAZ EDUCATIVA
 // ===========================================
@@ -441,15 +967,16 @@ void renderEducationalInterface() {
     ImGui::Checkbox("Resaltar comparaciones con la Tierra", &highlightEarthComparisons);
 
     // Selector de planeta para comparación detallada
-    const char* planetNames[] = { "Mercurio", "Venus", "Tierra", "Marte", "Júpiter", "Saturno", "Urano", "Neptuno" };
+    const int planetCount = (int)planetEducationalData.size();
     ImGui::SetNextItemWidth(150);
-    ImGui::Combo("Comparar con", &selectedPlanetForComparison, planetNames, 8);
+    ImGui::Combo("Comparar con", &selectedPlanetForComparison,
+        [](void*, int i) { return planetEducationalData[i].name.c_str(); }, nullptr, planetCount);
 
     // Renderizar la tabla principal con datos
     renderPlanetDataTable();
 
     // Mostrar información detallada del planeta seleccionado
-    if (selectedPlanetForComparison >= 0 && selectedPlanetForComparison < 8) {
+    if (selectedPlanetForComparison >= 0 && selectedPlanetForComparison < planetCount) {
         renderPlanetComparisonInfo();
     }
 }
@@ -498,7 +1025,7 @@ void renderPlanetDataTable() {
         ImGui::TableHeadersRow();
 
         // RENDERIZAR DATOS DE CADA PLANETA
-        for (int i = 0; i < 8; i++) {
+        for (int i = 0; i < (int)planetEducationalData.size(); i++) {
             auto& planet = planetEducationalData[i];
 
             // APLICAR FILTROS DE TIPO DE PLANETA
@@ -521,8 +1048,8 @@ void renderPlanetDataTable() {
             ImGui::Text("%.2f UA", planet.distanceFromSunAU);
             ImGui::TextDisabled("(%.0f M km)", planet.distanceFromSunKM);
             // Mostrar comparación con la Tierra si está activada
-            if (highlightEarthComparisons && i != 2) { // No comparar Tierra consigo misma
-                float ratio = planet.distanceFromSunAU / planetEducationalData[2].distanceFromSunAU;
+            if (highlightEarthComparisons && i != earthDataIndex) { // No comparar Tierra consigo misma
+                float ratio = planet.distanceFromSunAU / planetEducationalData[earthDataIndex].distanceFromSunAU;
                 ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "%.1fx", ratio);
             }
 
@@ -535,8 +1062,8 @@ void renderPlanetDataTable() {
                 ImGui::TextDisabled("(%.1f años)", years);
             }
             // Comparación con la Tierra
-            if (highlightEarthComparisons && i != 2) {
-                float ratio = planet.orbitPeriodDays / planetEducationalData[2].orbitPeriodDays;
+            if (highlightEarthComparisons && i != earthDataIndex) {
+                float ratio = planet.orbitPeriodDays / planetEducationalData[earthDataIndex].orbitPeriodDays;
                 ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "%.1fx", ratio);
             }
 
@@ -549,8 +1076,8 @@ void renderPlanetDataTable() {
                 ImGui::TextDisabled("(%.1f días)", days);
             }
             // Comparación con la Tierra
-            if (highlightEarthComparisons && i != 2) {
-                float ratio = planet.rotationPeriodHours / planetEducationalData[2].rotationPeriodHours;
+            if (highlightEarthComparisons && i != earthDataIndex) {
+                float ratio = planet.rotationPeriodHours / planetEducationalData[earthDataIndex].rotationPeriodHours;
                 ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "%.1fx", ratio);
             }
 
@@ -558,8 +1085,8 @@ void renderPlanetDataTable() {
             ImGui::TableNextColumn();
             ImGui::Text("%.2f", planet.mass);
             //Comparacion con la tierra
-            if (highlightEarthComparisons && i != 2) {
-                //float ratio = planet.mass / planetEducationalData[2].mass;
+            if (highlightEarthComparisons && i != earthDataIndex) {
+                //float ratio = planet.mass / planetEducationalData[earthDataIndex].mass;
                 float ratio = planet.massEarths;
                 ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "%.2fx", ratio);
             }
@@ -570,8 +1097,8 @@ void renderPlanetDataTable() {
                 // COLUMNA 5: DIÁMETRO
                 ImGui::TableNextColumn();
                 ImGui::Text("%.0f km", planet.diameterKM);
-                if (highlightEarthComparisons && i != 2) {
-                    float ratio = planet.diameterKM / planetEducationalData[2].diameterKM;
+                if (highlightEarthComparisons && i != earthDataIndex) {
+                    float ratio = planet.diameterKM / planetEducationalData[earthDataIndex].diameterKM;
                     ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "%.1fx", ratio);
                 }
 
@@ -604,11 +1131,11 @@ void renderPlanetDataTable() {
  */
 void renderPlanetComparisonInfo() {
     // Validar índice de selección
-    if (selectedPlanetForComparison < 0 || selectedPlanetForComparison >= 8) return;
+    if (selectedPlanetForComparison < 0 || selectedPlanetForComparison >= (int)planetEducationalData.size()) return;
 
     // referencias para facilitar el acceso a los datos
     auto& planet = planetEducationalData[selectedPlanetForComparison];
-    auto& earth = planetEducationalData[2]; // Tierra como referencia constante
+    auto& earth = planetEducationalData[earthDataIndex]; // Tierra como referencia constante
 
     ImGui::SeparatorText("Información Detallada");
 
@@ -631,7 +1158,7 @@ void renderPlanetComparisonInfo() {
         ImGui::TableNextColumn();
         ImGui::Text("%.2f UA (%.0f millones de km)", planet.distanceFromSunAU, planet.distanceFromSunKM);
         // Agregar comparación con la Tierra (excepto si ES la Tierra)
-        if (selectedPlanetForComparison != 2) {
+        if (selectedPlanetForComparison != earthDataIndex) {
             float ratio = planet.distanceFromSunAU / earth.distanceFromSunAU;
             ImGui::SameLine();
             ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), " → %.1fx más %s que la Tierra",
@@ -644,7 +1171,7 @@ void renderPlanetComparisonInfo() {
         ImGui::Text("Tamaño");
         ImGui::TableNextColumn();
         ImGui::Text("%.0f km de diámetro", planet.diameterKM);
-        if (selectedPlanetForComparison != 2) {
+        if (selectedPlanetForComparison != earthDataIndex) {
             float ratio = planet.diameterKM / earth.diameterKM;
             ImGui::SameLine();
             ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), " → %.1fx %s que la Tierra",
@@ -681,6 +1208,267 @@ void renderPlanetComparisonInfo() {
     ImGui::TextWrapped("%s", planet.funFact.c_str());
 }
 
+/**
+ * Controles del tiempo simulado: fecha actual, factor de tiempo y saltos a cualquier fecha.
+ * Como los cuerpos son una función cerrada de la época, cualquier salto es inmediato.
+ *
+ * @param simulationThread Hilo de simulación que recibe los cambios
+ * @param julianDate       Época que se está mostrando
+ */
+void renderTimeControls(SimulationThread& simulationThread, double julianDate) {
+    ImGui::SeparatorText("Tiempo");
+
+    CalendarDate date = calendarFromJulianDate(julianDate);
+    int hour = (int)date.hours;
+    int minute = (int)((date.hours - hour) * 60.0);
+    ImGui::Text("Fecha: %04d-%02d-%02d %02d:%02d", date.year, date.month, date.day, hour, minute);
+    ImGui::TextDisabled("(dia juliano %.4f)", julianDate);
+
+    // Factor de tiempo en escala logarítmica (de minutos a siglos por segundo)
+    ImGui::SetNextItemWidth(150);
+    ImGui::SliderFloat("Dias/segundo", &timeWarpDaysPerSecond, 0.001f, 100000.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    ImGui::Checkbox("Atras", &timeReversed);
+    simulationThread.setTimeWarp(timeReversed ? -timeWarpDaysPerSecond : timeWarpDaysPerSecond);
+
+    // Barra de desplazamiento por año: salta continuamente mientras se arrastra
+    float year = (float)(2000.0 + (julianDate - JD_J2000) / 365.25);
+    ImGui::SetNextItemWidth(150);
+    if (ImGui::SliderFloat("Año", &year, (float)EPHEMERIS_START_YEAR, (float)EPHEMERIS_END_YEAR, "%.2f")) {
+        simulationThread.requestSeek(JD_J2000 + (year - 2000.0) * 365.25);
+    }
+
+    // Salto a una fecha exacta
+    ImGui::PushItemWidth(60);
+    ImGui::InputInt("##anio", &targetYear, 0);
+    ImGui::SameLine();
+    ImGui::InputInt("##mes", &targetMonth, 0);
+    ImGui::SameLine();
+    ImGui::InputInt("##dia", &targetDay, 0);
+    ImGui::PopItemWidth();
+    if (targetMonth < 1) targetMonth = 1;
+    if (targetMonth > 12) targetMonth = 12;
+    if (targetDay < 1) targetDay = 1;
+    if (targetDay > 31) targetDay = 31;
+    ImGui::SameLine();
+    if (ImGui::Button("Ir a la fecha")) {
+        simulationThread.requestSeek(julianDateFromCalendar({ targetYear, targetMonth, targetDay, 0.0 }));
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Hoy")) {
+        simulationThread.requestSeek(todayJulianDate());
+    }
+}
+
+/**
+ * Controles del modo gravitacional N-cuerpos: activación, parámetros de Barnes-Hut e
+ * integrador, botones para agregar cuerpos al sistema y línea de tiempo para rebobinar.
+ *
+ * @param simulationThread Hilo de simulación que recibe los cambios
+ * @param state            Último estado mostrado (cuerpos agregados e instantáneas)
+ */
+void renderGravityControls(SimulationThread& simulationThread, const SimulationState& state) {
+    ImGui::SeparatorText("Gravitacion");
+    ImGui::Checkbox("Simular N cuerpos", &nbodySettings.enabled);
+
+    if (nbodySettings.enabled) {
+        float theta = (float)nbodySettings.theta;
+        ImGui::SetNextItemWidth(100);
+        if (ImGui::SliderFloat("Apertura (theta)", &theta, 0.1f, 1.0f, "%.2f")) {
+            nbodySettings.theta = theta;
+        }
+
+        int integrator = (int)nbodySettings.integrator;
+        const char* integrators[] = { "Leapfrog (2do orden)", "Yoshida (4to orden)", "Hermite adaptativo" };
+        ImGui::SetNextItemWidth(150);
+        if (ImGui::Combo("Integrador", &integrator, integrators, 3)) {
+            nbodySettings.integrator = (NBodySystem::Integrator)integrator;
+        }
+
+        if (ImGui::Button("Planeta errante")) simulationThread.requestBodies(1, 0);
+        ImGui::SameLine();
+        if (ImGui::Button("+1000 asteroides")) simulationThread.requestBodies(0, 1000);
+        ImGui::Text("Cuerpos agregados: %d", (int)state.particles.size());
+
+        // Línea de tiempo: un salto restaura la instantánea anterior y reintegra hasta la fecha
+        const TimelineInfo& timeline = state.timeline;
+        if (timeline.snapshots > 1) {
+            float day = (float)(state.julianDate - timeline.startJulianDate);
+            float span = (float)(timeline.endJulianDate - timeline.startJulianDate);
+            ImGui::SetNextItemWidth(150);
+            if (ImGui::SliderFloat("Rebobinar (dias)", &day, 0.0f, span, "%.1f")) {
+                simulationThread.requestSeek(timeline.startJulianDate + day);
+            }
+            ImGui::Text("Instantaneas: %d (%d completas)", timeline.snapshots, timeline.keyframes);
+            ImGui::Text("Memoria: %.1f KB (%.0f%% de %.1f KB sin comprimir)", timeline.bytes / 1024.0,
+                timeline.rawBytes > 0 ? 100.0 * timeline.bytes / timeline.rawBytes : 0.0, timeline.rawBytes / 1024.0);
+        }
+    }
+    simulationThread.setNBodySettings(nbodySettings);
+}
+
+/**
+ * Controles de grabación: resolución, cuadros por segundo, formato y destino. Mientras se graba
+ * la simulación avanza un paso fijo por cuadro (el video no depende de lo que tarde cada frame)
+ * y se muestran el avance y las esperas.
+ *
+ * @param recorder         Grabador de la escena
+ * @param simulationThread Hilo de simulación (pasa a paso fijo mientras se graba)
+ * @param frameSlots       Frames en vuelo (un PBO por cada uno)
+ * @param offscreen        true si la escena se dibuja en un framebuffer propio
+ */
+void renderRecordingControls(FrameRecorder& recorder, SimulationThread& simulationThread, int frameSlots, bool offscreen) {
+    ImGui::SeparatorText("Grabacion");
+
+    if (recorder.isRecording()) {
+        const FrameEncoder& output = recorder.output();
+        long long frames = recorder.capturedFrames();
+        ImGui::Text("Grabando %dx%d a %d FPS", recorder.width(), recorder.height(), recorder.fps());
+        ImGui::Text("Cuadros: %lld (%.1f s de video), en cola: %lld", frames, (double)frames / recorder.fps(), output.pending());
+        ImGui::Text("Copia desde PBO: %.2f ms por cuadro", recorder.copyMs());
+        ImGui::Text("Esperas al codificador: %d (%.0f ms)", output.stallCount(), output.stallSeconds() * 1000.0);
+        if (ImGui::Button("Detener grabacion", ImVec2(-1, 0))) stopRecording(recorder, simulationThread);
+        return;
+    }
+
+    ImGui::PushItemWidth(70);
+    ImGui::InputInt("##ancho", &recordWidth, 0);
+    ImGui::SameLine();
+    ImGui::InputInt("Resolucion", &recordHeight, 0);
+    ImGui::PopItemWidth();
+    // Pares para el submuestreo 4:2:0 del Y4M
+    recordWidth = std::min(std::max(recordWidth, 16), RECORD_MAX_SIZE) & ~1;
+    recordHeight = std::min(std::max(recordHeight, 16), RECORD_MAX_SIZE) & ~1;
+
+    const char* fpsNames[] = { "24", "30", "60", "120" };
+    const char* formats[] = { "Secuencia PNG", "Flujo Y4M" };
+    ImGui::SetNextItemWidth(70);
+    ImGui::Combo("FPS", &recordFpsIndex, fpsNames, 4);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(120);
+    ImGui::Combo("##formato", &recordFormat, formats, 2);
+    ImGui::SetNextItemWidth(180);
+    ImGui::InputText("Destino", recordTarget, sizeof(recordTarget));
+    ImGui::TextDisabled(recordFormat == FrameEncoder::PNG_SEQUENCE ? "destino_000001.png, destino_000002.png..."
+                                                                   : "archivo.y4m o |comando (|ffmpeg -i - video.mp4)");
+
+    if (!offscreen) {
+        ImGui::TextDisabled("Sin framebuffer propio de la escena: no se puede grabar");
+    }
+    else if (ImGui::Button("Grabar", ImVec2(-1, 0))) {
+        int fps = RECORD_FPS_OPTIONS[recordFpsIndex];
+        if (recorder.start((FrameEncoder::Format)recordFormat, recordTarget, recordWidth, recordHeight, fps, frameSlots)) {
+            simulationThread.setFixedStep(true);
+            recordStatus.clear();
+            cout << "Grabando " << recordWidth << "x" << recordHeight << " a " << fps << " FPS en " << recordTarget << endl;
+        }
+        else {
+            recordStatus = recorder.error();
+        }
+    }
+    if (!recordStatus.empty()) ImGui::TextWrapped("%s", recordStatus.c_str());
+}
+
+/**
+ * Termina la grabación en curso: entrega los cuadros pendientes, espera a los codificadores y
+ * devuelve la simulación al tiempo real.
+ */
+void stopRecording(FrameRecorder& recorder, SimulationThread& simulationThread) {
+    long long frames = recorder.capturedFrames();
+    bool ok = recorder.stop();
+    simulationThread.setFixedStep(inputLog.isActive());  // Con entrada grabada la simulación sigue al deltaTime
+    recordStatus = ok ? "Grabados " + to_string(frames) + " cuadros" : recorder.error();
+    cout << recordStatus << endl;
+}
+
+/**
+ * Prepara el tramo de un render por lotes: estado determinista de la simulación en el primer
+ * cuadro, escena del guion y grabación de los cuadros del tramo.
+ *
+ * @param job              Tramo del proceso
+ * @param simulation       Simulación, todavía sin hilo
+ * @param simulationThread Hilo de simulación, todavía sin lanzar
+ * @param recorder         Grabador de la escena
+ * @param frameSlots       Frames en vuelo
+ * @param offscreen        true si la escena se dibuja en un framebuffer propio
+ * @return false si no se puede grabar
+ */
+bool startBatchJob(BatchJob& job, Simulation& simulation, SimulationThread& simulationThread, FrameRecorder& recorder,
+    int frameSlots, bool offscreen) {
+    const RenderScript& script = job.script;
+    if (!offscreen) {
+        cout << "Sin framebuffer propio de la escena: no se puede grabar" << endl;
+        return false;
+    }
+
+    // La simulación queda un cuadro antes del primero: el loop avanza ticksPerFrame pasos por
+    // cuadro, así el cuadro N muestra siempre el paso N * ticksPerFrame desde la fecha del guion.
+    // El factor de tiempo es el mismo valor float que luego envían los controles (no mueve el ancla)
+    timeReversed = script.daysPerSecond < 0.0f;
+    timeWarpDaysPerSecond = std::fabs(script.daysPerSecond);
+    simulation.setTimeWarp(script.daysPerSecond);
+    simulation.setEpoch(script.startJulianDate, (job.first - 1) * script.ticksPerFrame());
+    simulationThread.setTimeWarp(script.daysPerSecond);
+    simulationThread.setFixedStep(true);  // Antes de lanzar el hilo: ningún paso en tiempo real
+
+    // Escena del guion, sin nada que dependa del reloj o de la entrada
+    trueScale = script.trueScale;
+    showOrbits = script.orbits;
+    showMinorBodies = script.minorBodies;
+    showMeteorites = false;
+    animationPaused = false;
+    lateLatchInput = false;
+    mouseControleEnabled = false;
+
+    std::string target = script.format == FrameEncoder::Y4M_STREAM ? batchPartPath(script, job.part) + ".y4m" : script.output;
+    if (!recorder.start(script.format, target, script.width, script.height, script.fps, frameSlots,
+        std::max(1, job.cores / 2), job.first + 1)) {
+        cout << recorder.error() << endl;
+        return false;
+    }
+    cout << "Tramo " << job.part << ": cuadros " << job.first << "-" << job.first + job.count - 1
+        << " en " << target << " (" << job.cores << " nucleos)" << endl;
+    return true;
+}
+
+/**
+ * Cámara del cuadro según el guion (ángulos, distancia en escala real y cuerpo seguido).
+ *
+ * @param job    Tramo del proceso
+ * @param bodies Cuerpos de la escena (para buscar el foco por nombre)
+ * @param frame  Número de cuadro global
+ */
+void applyBatchCamera(const BatchJob& job, const BodyStore& bodies, long long frame) {
+    RenderCamera camera = job.script.cameraAt(frame);
+    cameraPitch = glm::clamp((float)camera.pitch, minPitch, maxPitch);
+    cameraYaw = (float)camera.yaw;
+    trueScaleDistance = camera.distance;
+    cameraFocus = 0;
+    followSelection = false;
+    for (int i = 0; i < bodies.size(); ++i) {
+        if (bodies.metadata.name[i] == camera.focus) {
+            cameraFocus = i;
+            followSelection = true;
+        }
+    }
+}
+
+/**
+ * Deja los tiempos del tramo para el proceso que lanzó el render.
+ *
+ * @return Código de salida del proceso (0 si se grabaron todos los cuadros)
+ */
+int finishBatchJob(const BatchJob& job, const FrameRecorder& recorder) {
+    RenderWorkerStats stats;
+    stats.frames = recorder.capturedFrames();
+    stats.startupSeconds = job.loopStart;
+    stats.renderSeconds = glfwGetTime() - job.loopStart;
+    bool ok = recorder.error().empty() && stats.frames == job.count;
+    if (!stats.write(batchPartPath(job.script, job.part) + ".txt")) ok = false;
+    cout << "Tramo " << job.part << ": " << stats.frames << " cuadros en " << stats.renderSeconds << " s" << endl;
+    return ok ? 0 : 1;
+}
+
 // ===========================================
 // 9. FUNCIONES DE GEOMETRÍA Y UTILIDADES
 // ===========================================
@@ -761,22 +1549,27 @@ void createSphere(vector<float>& vertices, vector<unsigned int>& indices) {
 }
 
 /**
- * Genera vértices para un círculo en el plano XZ (Y=0).
- * Utilizado para renderizar las órbitas planetarias como líneas circulares.
+ * Agrega los vértices de la órbita elíptica de un cuerpo, en coordenadas de la escena.
+ * Utilizado para renderizar las órbitas planetarias como líneas (GL_LINE_STRIP).
  *
- * @param vertices    Vector de salida con posiciones de vértices
- * @param numSegments Número de segmentos del círculo (más = más suave)
+ * @param simulation  Simulación con las efemérides y la escala de la escena
+ * @param body        Índice del cuerpo
+ * @param julianDate  Fecha de los elementos orbitales
+ * @param numSegments Número de segmentos de la elipse (más = más suave)
+ * @param realScale   true = posiciones reales en UA; false = escaladas a orbitRadius
+ * @param vertices    Vector al que se agregan numSegments + 1 vértices (parte alta y baja, 6 floats)
  */
-void createCircle(std::vector<float>& vertices, int numSegments) {
-    vertices.clear();
-    float angleStep = 2.0f * 3.1415926535f / numSegments;
-
-    // Generar puntos del círculo
-    for (int i = 0; i <= numSegments; ++i) {
-        float angle = i * angleStep;
-        vertices.push_back(cos(angle));  // X
-        vertices.push_back(0.0f);        // Y (siempre 0 para órbitas horizontales)
-        vertices.push_back(sin(angle));  // Z
+void createOrbitPath(const Simulation& simulation, int body, double julianDate, int numSegments, bool realScale, std::vector<float>& vertices) {
+    std::vector<double> path;
+    simulation.bodyEphemeris().orbitPath(body, julianDate, numSegments, path);
+
+    for (size_t i = 0; i + 2 < path.size(); i += 3) {
+        glm::dvec3 p = realScale ? Simulation::toHeliocentric(path[i], path[i + 1], path[i + 2])
+                                 : glm::dvec3(simulation.toScene(body, path[i], path[i + 1], path[i + 2]));
+        // Parte alta y baja del double: el shader resta la cámara en cada mitad (ver FloatingOrigin)
+        glm::vec3 high, low;
+        FloatingOrigin::split(p, high, low);
+        vertices.insert(vertices.end(), { high.x, high.y, high.z, low.x, low.y, low.z });
     }
 }
 
@@ -791,6 +1584,7 @@ void createCircle(std::vector<float>& vertices, int numSegments) {
  */
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    requestRedraw();
 }
 
 // ===========================================
@@ -851,138 +1645,192 @@ GLuint loadTexture(const char* path, GLuint fallbackTextureID) {
 // ===========================================
 
 /**
- * Renderiza texto en el espacio 3D proyectándolo a coordenadas de pantalla.
- * Utiliza ImGui para dibujar texto 2D sobre la escena 3D.
+ * Posición del cuerpo que sigue la cámara. La vista esquemática mira al Sol salvo que se haya
+ * elegido un cuerpo con el mouse.
  *
- * @param text       Texto a mostrar
- * @param worldPos   Posición en coordenadas del mundo 3D
- * @param view       Matriz de vista actual
- * @param projection Matriz de proyección actual
+ * @param bodies  Cuerpos de la escena (ya actualizados en este frame)
+ * @param radius  Salida: radio del cuerpo seguido (límite para acercar la cámara)
  */
-void renderTextIn3DSpace(const std::string& text, glm::vec3 worldPos, const glm::mat4& view, const glm::mat4& projection) {
-    // Obtener dimensiones actuales del framebuffer
-    int display_w, display_h;
-    glfwGetFramebufferSize(glfwGetCurrentContext(), &display_w, &display_h);
+glm::dvec3 cameraFocusPosition(const BodyStore& bodies, double& radius) {
+    int focus = (trueScale || followSelection) && cameraFocus < bodies.size() ? cameraFocus : 0;
+    radius = bodies.transforms.scale[focus];
+    return bodies.position(focus);
+}
 
-    // Transformar posición 3D a coordenadas de clip
-    glm::vec4 clipPos = projection * view * glm::vec4(worldPos, 1.0f);
+/**
+ * Cuerpo bajo el cursor: rayo desde la cámara a través del píxel, contra la BVH de los cuerpos.
+ * Usa las matrices del último frame dibujado, así coincide con lo que se ve en pantalla.
+ *
+ * El cursor está en coordenadas de la ventana (no del framebuffer), con el tamaño de inputState.
+ *
+ * @param xpos   Posición X del cursor
+ * @param ypos   Posición Y del cursor
+ * @return       Índice en BodyStore o -1 si el rayo no toca ningún cuerpo
+ */
+int pickBody(double xpos, double ypos) {
+    int width = inputState.windowWidth, height = inputState.windowHeight;
+    if (width <= 0 || height <= 0) return -1;
+
+    // Dirección en el espacio de la vista: la perspectiva solo escala x e y (vale con cualquier profundidad)
+    double ndcX = 2.0 * xpos / width - 1.0;
+    double ndcY = 1.0 - 2.0 * ypos / height;
+    glm::dvec3 viewDir(ndcX / pickProjection[0][0], ndcY / pickProjection[1][1], -1.0);
+
+    // La vista no tiene traslación y su rotación es ortonormal: la inversa es la transpuesta
+    glm::dvec3 direction = glm::normalize(glm::transpose(glm::dmat3(glm::mat3(pickView))) * viewDir);
+    double distance;
+    return bodyBounds.raycast(floatingOrigin.position(), direction, distance);
+}
 
-    // Verificar si el punto está detrás de la cámara
-    if (clipPos.w < 0.0f) return;
+/**
+ * Escribe el bloque FrameData en el buffer de streaming y lo vincula para los draws que siguen.
+ * Una escritura por pasada reemplaza los glUniform de proyección y vista de cada shader.
+ *
+ * @param stream     Buffer de streaming del frame
+ * @param projection Matriz de proyección
+ * @param view       Matriz de vista
+ * @param skyRadius  Radio de la esfera del cielo (0 en las pasadas sin estrellas)
+ */
+void bindFrameData(StreamBuffer& stream, const glm::mat4& projection, const glm::mat4& view, float skyRadius) {
+    GLintptr offset;
+    FrameData* data = (FrameData*)stream.map(sizeof(FrameData), stream.uniformOffsetAlignment(), offset);
+    data->projection = projection;
+    data->view = view;
+    data->sky = glm::vec4(skyRadius, starLimitMagnitude, STAR_POINT_SCALE, 0.0f);
+    stream.unmap();
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, stream.buffer(), offset, sizeof(FrameData));
+}
 
-    // Convertir a coordenadas normalizadas de dispositivo (NDC)
-    glm::vec3 ndcPos = glm::vec3(clipPos) / clipPos.w;
+/**
+ * Reserva count bloques DrawData seguidos en el buffer de streaming y devuelve dónde escribirlos
+ * (el bloque k empieza en k * batch.stride). Antes de dibujar se cierra la escritura con
+ * stream.unmap().
+ *
+ * @param stream Buffer de streaming del frame
+ * @param count  Bloques a reservar (al menos uno)
+ * @param batch  Salida: dónde quedaron, para vincularlos con DrawDataBatch::bind
+ */
+char* mapDrawData(StreamBuffer& stream, int count, DrawDataBatch& batch) {
+    GLsizeiptr alignment = stream.uniformOffsetAlignment();
+    batch.stride = ((GLsizeiptr)sizeof(DrawData) + alignment - 1) / alignment * alignment;
+    char* data = (char*)stream.map(batch.stride * count, alignment, batch.offset);
+    batch.buffer = stream.buffer();  // Después de map(): si el buffer creció, los bloques están en el nuevo
+    return data;
+}
 
-    // Convertir NDC a coordenadas de pantalla
-    float screenX = (ndcPos.x + 1.0f) / 2.0f * display_w;
-    float screenY = (1.0f - ndcPos.y) / 2.0f * display_h;  // Invertir Y
+/**
+ * Escribe el bloque DrawData de un draw suelto (fondo, órbitas, puntos) y lo vincula.
+ *
+ * @param stream     Buffer de streaming del frame
+ * @param model      Matriz de modelo
+ * @param color      Color de las líneas o puntos (shader de órbitas)
+ * @param cameraHigh Parte alta de la cámara, si los vértices están en coordenadas del mundo (si no, 0)
+ * @param cameraLow  Parte baja de la cámara
+ */
+void bindDrawData(StreamBuffer& stream, const glm::mat4& model, const glm::vec3& color,
+    const glm::vec3& cameraHigh, const glm::vec3& cameraLow) {
+    DrawDataBatch batch;
+    DrawData* data = (DrawData*)mapDrawData(stream, 1, batch);
+    data->model = model;
+    data->color = glm::vec4(color, 1.0f);
+    data->cameraHigh = glm::vec4(cameraHigh, 0.0f);
+    data->cameraLow = glm::vec4(cameraLow, 0.0f);
+    stream.unmap();
+    batch.bind(0);
+}
 
-    // Dibujar texto usando ImGui
-    ImGui::GetBackgroundDrawList()->AddText(ImVec2(screenX, screenY), IM_COL32(255, 255, 255, 255), text.c_str());
+/**
+ * Distancia de la cámara a la superficie más cercana (incluidos los anillos).
+ * Solo la usa el plano cercano adaptativo de la profundidad convencional.
+ */
+float nearestSurfaceDistance(const BodyStore& bodies, const FloatingOrigin& origin) {
+    const glm::dvec3& camera = origin.position();
+    const BodyStore::TransformChunk& t = bodies.transforms;
+    double nearest = 1.0e30;
+    for (int i = 0; i < bodies.size(); ++i) {
+        double reach = t.scale[i] * std::max(1.0f, bodies.render.ringRadius[i]);
+        double dx = t.x[i] - camera.x, dy = t.y[i] - camera.y, dz = t.z[i] - camera.z;
+        nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy + dz * dz) - reach);
+    }
+    return (float)std::max(nearest, 0.0);
 }
 
 /**
- * Renderiza un planeta completo con sus componentes (planeta, luna, anillos).
- * Maneja animaciones orbitales, rotaciones y efectos visuales específicos.
+ * Escribe las matrices de modelo de todos los cuerpos (esfera y, si tiene, anillos, en ese orden)
+ * como bloques DrawData del buffer de streaming, con un solo mapeo, y encola sus nombres.
+ * La jerarquía de BodyStore ya compuso las matrices del mundo; las traslaciones se calculan en
+ * doble precisión relativas a la cámara (origen flotante).
  *
- * @param shader       Shader a usar para el renderizado
- * @param planet       Estructura con datos del planeta
- * @param sphereVAO    VAO de la geometría esférica
+ * @param bodies Cuerpos de la escena
+ * @param origin Posición de la cámara en el mundo
+ * @param stream Buffer de streaming del frame
+ * @param draws  Salida: los bloques escritos, para renderBody
+ * @return       Bloques escritos
+ */
+int prepareBodyDraws(const BodyStore& bodies, const FloatingOrigin& origin, StreamBuffer& stream, DrawDataBatch& draws) {
+    int count = bodies.size();
+    for (int i = 0; i < bodies.size(); ++i) {
+        if (bodies.render.ringTexture[i] != 0) ++count;
+    }
+    if (count == 0) return 0;
+    char* data = mapDrawData(stream, count, draws);
+    DrawData block = { glm::mat4(1.0f), glm::vec4(1.0f), glm::vec4(0.0f), glm::vec4(0.0f) };  // Solo cambia el modelo
+    int draw = 0;
+    for (int i = 0; i < bodies.size(); ++i) {
+        // ESFERA (marco orbital inclinado, rotación propia y radio)
+        glm::mat4 bodyModel = bodies.modelMatrix(bodies.nodes.body[i], origin.position());
+        block.model = bodyModel;
+        *(DrawData*)(data + draw++ * draws.stride) = block;  // Memoria mapeada: solo se escribe
+
+        // ANILLOS (esfera aplastada en el plano ecuatorial)
+        if (bodies.render.ringTexture[i] != 0) {
+            block.model = bodies.modelMatrix(bodies.nodes.ring[i], origin.position());
+            *(DrawData*)(data + draw++ * draws.stride) = block;
+        }
+
+        // ENCOLAR NOMBRE (si está activado; se dibuja en LabelRenderer::flush)
+        if (showNames) {
+            glm::vec3 labelPos = glm::vec3(bodyModel[3]);       // Extraer posición del cuerpo
+            labelPos.y += bodies.transforms.scale[i] * 1.5f;    // Elevar texto sobre el cuerpo
+            float priority = bodies.metadata.kind[i] == BODY_STAR ? 100.0f : bodies.orbits.size[i];  // El Sol siempre gana
+            labelRenderer.add(bodies.metadata.name[i].c_str(), labelPos, priority);  // Cuerpos grandes = más prioridad
+        }
+    }
+    stream.unmap();
+    return count;
+}
+
+/**
+ * Renderiza un cuerpo completo (esfera y anillos) con los bloques que escribió prepareBodyDraws.
+ *
+ * @param bodies        Cuerpos de la escena
+ * @param i             Índice del cuerpo
+ * @param draws         Bloques DrawData de los cuerpos
+ * @param draw          Próximo bloque de draws (avanza uno por draw)
+ * @param sphereVAO     VAO de la geometría esférica
  * @param sphereIndices Índices de la esfera
- * @param deltaTime    Tiempo transcurrido desde el último frame
- * @param view         Matriz de vista actual
- * @param projection   Matriz de proyección actual
  */
-void renderPlanet(Shader& shader, Planet& planet, unsigned int sphereVAO,
-    const vector<unsigned int>& sphereIndices, float deltaTime,
-    const glm::mat4& view, const glm::mat4& projection) {
-
-    // ACTUALIZAR ANIMACIONES DEL PLANETA
-    // Avanzar ángulo orbital (traslación alrededor del Sol)
-    planet.orbitAngle = std::fmod(planet.orbitAngle + planet.orbitSpeed * deltaTime, 360.0f);
-    // Avanzar ángulo de rotación (rotación sobre su propio eje)
-    planet.rotationAngle = std::fmod(planet.rotationAngle + planet.rotationSpeed * deltaTime, 360.0f);
-
-    // Actualizar ángulo de la luna si el planeta tiene una
-    if (planet.hasMoon) {
-        planet.moonAngle = std::fmod(planet.moonAngle + planet.moonSpeed * deltaTime, 360.0f);
-    }
-
-    // CALCULAR SISTEMA DE COORDENADAS DEL PLANETA
-    // 1. Crear transformación orbital (posición del planeta en su órbita)
-    glm::mat4 planetSystem = glm::rotate(glm::mat4(1.0f),
-        glm::radians(planet.orbitAngle),
-        glm::vec3(0.0f, 1.0f, 0.0f));  // Rotar alrededor del eje Y
-    planetSystem = glm::translate(planetSystem, glm::vec3(planet.orbitRadius, 0.0f, 0.0f));  // Mover a distancia orbital
-
-    // 2. Crear modelo del planeta (incluye rotación propia)
-    glm::mat4 planetModel = glm::rotate(planetSystem,
-        glm::radians(planet.rotationAngle),
-        glm::vec3(0.0f, 1.0f, 0.0f));  // Rotación sobre su eje
-    planetModel = glm::scale(planetModel, glm::vec3(planet.size));    // Escalar al tamaño apropiado
-
-    // RENDERIZAR EL PLANETA PRINCIPAL
-    shader.setMat4("model", planetModel);
-    glBindTexture(GL_TEXTURE_2D, planet.texture);
+void renderBody(const BodyStore& bodies, int i, const DrawDataBatch& draws, int& draw,
+    unsigned int sphereVAO, const vector<unsigned int>& sphereIndices) {
+
+    // RENDERIZAR LA ESFERA
+    draws.bind(draw++);
+    glBindTexture(GL_TEXTURE_2D, bodies.render.texture[i]);
     glBindVertexArray(sphereVAO);
     glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
 
-    // RENDERIZAR NOMBRE DEL PLANETA (si está activado)
-    if (showNames) {
-        glm::vec3 planetWorldPos = glm::vec3(planetSystem[3]);  // Extraer posición del planeta
-        planetWorldPos.y += planet.size * 1.5f;                // Elevar texto sobre el planeta
-        renderTextIn3DSpace(planet.name, planetWorldPos, view, projection);
-    }
-
-    // RENDERIZAR ANILLOS (solo Saturno)
-    if (planet.hasRing && planet.ringTexture != 0) {
+    // RENDERIZAR ANILLOS
+    if (bodies.render.ringTexture[i] != 0) {
         // Activar transparencia para los anillos
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        // Crear modelo de anillos (esfera aplastada e inclinada)
-        glm::mat4 ringModel = planetSystem;
-
-        // CONFIGURACIONES ESPECÍFICAS POR PLANETA
-        if (planet.name == "Saturno") {
-            // Configuración actual de Saturno (mantener igual)
-            ringModel = glm::rotate(ringModel, glm::radians(23.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-            ringModel = glm::scale(ringModel, glm::vec3(planet.size * 1.7f, planet.size * 0.05f, planet.size * 1.7f));
-        }
-        else if (planet.name == "Jupiter") {
-            // Júpiter: anillos muy sutiles y delgados
-            ringModel = glm::rotate(ringModel, glm::radians(3.0f), glm::vec3(1.0f, 0.0f, 0.0f));  // Poca inclinación
-            ringModel = glm::scale(ringModel, glm::vec3(planet.size * 1.4f, planet.size * 0.02f, planet.size * 1.4f));  // Más pequeños y delgados
-        }
-        else if (planet.name == "Urano") {
-            // Urano: anillos verticales (rotación de 90°)
-            ringModel = glm::rotate(ringModel, glm::radians(98.0f), glm::vec3(1.0f, 0.0f, 0.0f));  // Casi vertical
-            ringModel = glm::scale(ringModel, glm::vec3(planet.size * 1.3f, planet.size * 0.03f, planet.size * 1.3f));  // Delgados
-        }
-        else if (planet.name == "Neptuno") {
-            // Neptuno: anillos débiles
-            ringModel = glm::rotate(ringModel, glm::radians(29.0f), glm::vec3(1.0f, 0.0f, 0.0f));  // Inclinación moderada
-            ringModel = glm::scale(ringModel, glm::vec3(planet.size * 1.5f, planet.size * 0.025f, planet.size * 1.5f));  // Tamaño medio
-        }
-        shader.setMat4("model", ringModel);
-        glBindTexture(GL_TEXTURE_2D, planet.ringTexture);
+        draws.bind(draw++);
+        glBindTexture(GL_TEXTURE_2D, bodies.render.ringTexture[i]);
         glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
 
         glDisable(GL_BLEND);  // Desactivar transparencia
     }
-
-    // RENDERIZAR LUNA (solo la Tierra)
-    if (planet.hasMoon && planet.moonTexture != 0) {
-        // Crear modelo de la luna (orbita alrededor del planeta)
-        glm::mat4 moonModel = planetSystem;  // Empezar desde la posición del planeta
-        moonModel = glm::rotate(moonModel, glm::radians(planet.moonAngle), glm::vec3(0.0f, 1.0f, 0.0f));  // Órbita lunar
-        moonModel = glm::translate(moonModel, glm::vec3(planet.moonDistance, 0.0f, 0.0f));  // Distancia de la luna
-        moonModel = glm::scale(moonModel, glm::vec3(planet.size * 0.3f));  // Tamaño de la luna (30% del planeta)
-
-        shader.setMat4("model", moonModel);
-        glBindTexture(GL_TEXTURE_2D, planet.moonTexture);
-        glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
-    }
 }
 
 
@@ -991,17 +1839,17 @@ void renderPlanet(Shader& shader, Planet& planet, unsigned int sphereVAO,
 // ===========================================
 
 /**
- * Estructura para organizar todas las texturas del sistema solar
+ * Estructura para organizar todas las texturas del sistema solar.
+ * Las de los cuerpos se piden por ruta desde el archivo de escena y se cargan una sola vez.
  */
 struct SolarSystemTextures {
-    GLuint error, galaxy, sun, mercury, venus, earth, moon, mars;
-    GLuint jupiter, jupiterRing, saturn, saturnRing;
-    GLuint uranus, uranusRing, neptune, neptuneRing;
+    GLuint error, galaxy;
+    std::unordered_map<std::string, GLuint> byPath;  // Texturas de los cuerpos ya cargadas
 };
 
 /**
- * Carga todas las texturas del sistema solar
- * Incluye textura de error como fallback y todas las texturas planetarias
+ * Carga la textura de error (fallback) y la del fondo.
+ * Las texturas de los cuerpos se cargan al leer la escena (ver sceneTexture)
  */
 SolarSystemTextures loadAllSolarSystemTextures() {
     SolarSystemTextures textures;
@@ -1014,26 +1862,257 @@ SolarSystemTextures loadAllSolarSystemTextures() {
         return textures;
     }
 
-    // Cargar todas las texturas del sistema solar usando la textura de error como fallback
     textures.galaxy = loadTexture("textures/galaxy.jpg", textures.error);
-    textures.sun = loadTexture("textures/sun.jpg", textures.error);
-    textures.mercury = loadTexture("textures/mercury.jpg", textures.error);
-    textures.venus = loadTexture("textures/venus.jpg", textures.error);
-    textures.earth = loadTexture("textures/earth.jpg", textures.error);
-    textures.moon = loadTexture("textures/moon.jpg", textures.error);
-    textures.mars = loadTexture("textures/mars.jpg", textures.error);
-    textures.jupiter = loadTexture("textures/jupiter.jpg", textures.error);
-    textures.jupiterRing = loadTexture("textures/jupiter_ring.png", textures.error);
-    textures.saturn = loadTexture("textures/saturn.jpg", textures.error);
-    textures.saturnRing = loadTexture("textures/saturn_ring.png", textures.error);
-    textures.uranus = loadTexture("textures/uranus.jpg", textures.error);
-    textures.uranusRing = loadTexture("textures/uranus_ring.png", textures.error);
-    textures.neptune = loadTexture("textures/neptune.jpg", textures.error);
-    textures.neptuneRing = loadTexture("textures/neptune_ring.png", textures.error);
-
     return textures;
 }
 
+/**
+ * Textura de un cuerpo por ruta; la primera vez se carga y después se reutiliza
+ * (miles de lunas pueden compartir la misma imagen).
+ *
+ * @param textures Texturas cargadas
+ * @param path     Ruta de la imagen, tal como aparece en el archivo de escena
+ * @return         ID de la textura (o la de error si no se pudo cargar)
+ */
+GLuint sceneTexture(SolarSystemTextures& textures, const char* path) {
+    auto found = textures.byPath.find(path);
+    if (found != textures.byPath.end()) return found->second;
+    GLuint texture = loadTexture(path, textures.error);
+    textures.byPath[path] = texture;
+    return texture;
+}
+
+
+// ===========================================
+// FUNCIONES DE EFEMÉRIDES PRECALCULADAS
+// ===========================================
+
+/**
+ * Genera el archivo de efemérides de los planetas para EPHEMERIS_START_YEAR..EPHEMERIS_END_YEAR.
+ * La fuente del ajuste es el modelo kepleriano (Ephemeris).
+ *
+ * @param path Ruta del archivo de salida
+ * @return     Código de salida del proceso (0 si se escribió)
+ */
+int buildEphemerisFile(const char* path) {
+    Ephemeris source;
+    source.addPlanets();
+
+    std::vector<ChebyshevBodySpec> bodies;
+    for (int i = 0; i < source.bodyCount(); ++i) {
+        bodies.push_back(ChebyshevBodySpec::forOrbit(PLANET_NAMES[i], source.elements(i).a));
+    }
+
+    double startJD = julianDateFromCalendar({ EPHEMERIS_START_YEAR, 1, 1, 0.0 });
+    double endJD = julianDateFromCalendar({ EPHEMERIS_END_YEAR, 1, 1, 0.0 });
+    ChebyshevBuildReport report;
+    bool ok = buildChebyshevEphemeris(path, bodies, startJD, endJD,
+        [&source](int body, double jd, double& x, double& y, double& z) { source.evaluateBody(body, jd, x, y, z); },
+        &report);
+    if (!ok) {
+        cout << "No se pudo escribir el archivo de efemerides: " << path << endl;
+        return 1;
+    }
+    cout << "Efemerides escritas en " << path << ": " << report.intervals << " intervalos, "
+        << report.bytes / 1024 << " KB, error maximo del ajuste " << report.maxError << " UA" << endl;
+    return 0;
+}
+
+/**
+ * Abre el archivo de efemérides y comprueba que tenga los planetas en el orden esperado.
+ *
+ * @param table     Efemérides a abrir
+ * @param path      Ruta del archivo
+ * @param bodyCount Número de planetas de la escena
+ * @return          true si el archivo se puede usar
+ */
+bool loadEphemerisFile(ChebyshevEphemeris& table, const char* path, size_t bodyCount) {
+    if (!table.open(path)) {
+        cout << "Efemerides precalculadas no disponibles (" << path << "); se usa el modelo kepleriano. "
+            << "Generar con --build-ephemeris" << endl;
+        return false;
+    }
+    bool matches = table.bodyCount() >= (int)bodyCount;
+    for (size_t i = 0; matches && i < bodyCount; ++i) {
+        matches = string(table.bodyName((int)i)) == PLANET_NAMES[i];
+    }
+    if (!matches) {
+        cout << "El archivo de efemerides no corresponde a los planetas de la escena: " << path << endl;
+        table.close();
+        return false;
+    }
+    cout << "Efemerides precalculadas cargadas: " << path << endl;
+    return true;
+}
+
+
+// ===========================================
+// FUNCIONES DE CUERPOS MENORES
+// ===========================================
+
+/**
+ * Importa un catálogo de asteroides y cometas (MPCORB.DAT o CSV del SBDB) al binario que
+ * se carga al iniciar.
+ *
+ * @param textPath   Catálogo de texto
+ * @param binaryPath Ruta del binario de salida
+ * @return           Código de salida del proceso (0 si se escribió)
+ */
+int importMinorBodyFile(const char* textPath, const char* binaryPath) {
+    std::string error;
+    MinorBodyImportReport report;
+    if (!importMinorBodyCatalog(textPath, binaryPath, error, &report)) {
+        cout << "No se pudo importar el catalogo de cuerpos menores: " << error << endl;
+        return 1;
+    }
+    cout << "Cuerpos menores importados en " << binaryPath << ": " << report.rows << " (" << report.format << ", "
+        << report.rejected << " filas descartadas) en " << report.seconds << " s" << endl;
+    return 0;
+}
+
+/**
+ * Posiciones de todos los cuerpos menores en una fecha, como vértices de puntos.
+ * Los bloques del núcleo de Ephemeris se reparten entre los hilos.
+ *
+ * @param ephemeris  Efemérides del catálogo
+ * @param simulation Simulación (escala radial de la vista esquemática)
+ * @param julianDate Fecha
+ * @param realScale  true = posiciones reales en UA; false = escala de la escena
+ * @param scratch    Memoria auxiliar para x, y, z (se reutiliza entre llamadas)
+ * @param vertices   Salida: 6 floats por cuerpo (parte alta y baja, ver FloatingOrigin); puede
+ *                   ser el VBO mapeado, cada hilo escribe solo sus cuerpos
+ */
+void createMinorBodyVertices(const Ephemeris& ephemeris, const Simulation& simulation, double julianDate, bool realScale,
+    std::vector<double>& scratch, float* vertices) {
+    const size_t padded = ephemeris.paddedCount();
+    const int count = ephemeris.bodyCount();
+    const int blocks = (int)(padded / Ephemeris::BLOCK);
+    scratch.resize(3 * padded);
+    double* x = scratch.data();
+    double* y = x + padded;
+    double* z = y + padded;
+    int tasks = (blocks + MINOR_BODY_BLOCKS_PER_TASK - 1) / MINOR_BODY_BLOCKS_PER_TASK;
+    parallelFor(0, tasks, 1, [&](int t) {
+        int first = t * MINOR_BODY_BLOCKS_PER_TASK;
+        int last = std::min(blocks, first + MINOR_BODY_BLOCKS_PER_TASK);
+        ephemeris.evaluateBlocks(julianDate, first, last, x, y, z);
+        for (int i = first * Ephemeris::BLOCK; i < std::min(count, last * Ephemeris::BLOCK); ++i) {
+            glm::dvec3 p = Simulation::toHeliocentric(x[i], y[i], z[i]);
+            if (!realScale) p = glm::dvec3(simulation.toSceneRadial(p));
+            glm::vec3 high, low;
+            FloatingOrigin::split(p, high, low);
+            float* v = vertices + 6 * (size_t)i;
+            v[0] = high.x; v[1] = high.y; v[2] = high.z;
+            v[3] = low.x; v[4] = low.y; v[5] = low.z;
+        }
+    });
+}
+
+
+// ===========================================
+// FUNCIONES DEL CATÁLOGO DE ESTRELLAS
+// ===========================================
+
+/**
+ * Genera el catálogo binario de estrellas a partir de un CSV.
+ *
+ * @param csvPath    CSV con cabecera (columnas aceptadas en readStarCsv)
+ * @param binaryPath Ruta del binario de salida
+ * @return           Código de salida del proceso (0 si se escribió)
+ */
+int buildStarCatalogFile(const char* csvPath, const char* binaryPath) {
+    std::string error;
+    std::vector<StarSource> stars;
+    if (!readStarCsv(csvPath, stars, error)) {
+        cout << "No se pudo leer el catalogo de estrellas: " << error << endl;
+        return 1;
+    }
+    StarCatalogBuildReport report;
+    if (!buildStarCatalog(binaryPath, stars, STAR_CATALOG_NSIDE, &report)) {
+        cout << "No se pudo escribir el catalogo de estrellas: " << binaryPath << endl;
+        return 1;
+    }
+    cout << "Catalogo de estrellas escrito en " << binaryPath << ": " << report.stars << " estrellas en "
+        << report.usedCells << " celdas (" << report.bytes / 1024 << " KB)" << endl;
+    return 0;
+}
+
+/**
+ * Dibuja las estrellas visibles como puntos con tamaño según la magnitud.
+ * Solo entran las celdas que tocan el cono de visión y, de cada una, el prefijo de estrellas
+ * más brillantes que la magnitud límite; todos los rangos van en una sola llamada.
+ *
+ * @param shader     Shader de estrellas
+ * @param catalog    Catálogo abierto
+ * @param starVAO    VAO con todas las estrellas del catálogo
+ * @param forward    Dirección de la vista en ejes de la escena
+ * @param aspect     Relación de aspecto del framebuffer
+ * @return           Estrellas dibujadas
+ */
+int renderStarField(Shader& shader, const StarCatalog& catalog, unsigned int starVAO, const glm::vec3& forward,
+    float aspect) {
+    // Los rangos viven hasta el final del frame: salen de la arena (a lo sumo uno por celda)
+    int* firsts = frameArena.allocateArray<int>(catalog.cellCount());
+    int* counts = frameArena.allocateArray<int>(catalog.cellCount());
+    int ranges;
+    float halfFov = glm::radians(FIELD_OF_VIEW) * 0.5f;
+    float halfAngle = std::atan(std::tan(halfFov) * std::sqrt(1.0f + aspect * aspect));  // Cono que cubre las esquinas
+    int drawn = catalog.visibleRanges(forward, halfAngle, starLimitMagnitude, firsts, counts, ranges);
+    if (drawn == 0) return 0;
+
+    shader.use();  // Proyección, vista, radio del cielo y magnitud límite vienen del bloque FrameData
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);  // Aditiva: las estrellas que se solapan se suman
+    glBindVertexArray(starVAO);
+    glMultiDrawArrays(GL_POINTS, firsts, counts, (GLsizei)ranges);
+    glDisable(GL_BLEND);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    return drawn;
+}
+
+
+/**
+ * Carga la escena (compilando scene.txt si cambió) y reconstruye los cuerpos y la tabla educativa.
+ * Si falla se conservan los cuerpos y la tabla actuales, así un error al editar no cierra el programa.
+ *
+ * @param catalog     Catálogo de la escena
+ * @param planetCount Planetas de las efemérides
+ * @param textures    Texturas (se cargan las nuevas rutas)
+ * @param bodies      Salida: cuerpos de la escena
+ * @return            true si la escena se cargó
+ */
+bool loadScene(SceneCatalog& catalog, int planetCount, SolarSystemTextures& textures, BodyStore& bodies) {
+    std::string error;
+    if (!catalog.load(SCENE_FILE, SCENE_BINARY_FILE, planetCount, error)) {
+        cout << "No se pudo cargar la escena: " << error << endl;
+        return false;
+    }
+
+    // Cuerpos directamente desde los registros proyectados en memoria
+    BodyStore loaded;
+    catalog.buildBodies(loaded, [&](const char* path) { return sceneTexture(textures, path); });
+
+    // Filas de la tabla educativa, en el orden del archivo
+    std::vector<PlanetData> data;
+    int earthRow = 0;
+    for (int i = 0; i < catalog.bodyCount(); ++i) {
+        const SceneBodyRecord& r = catalog.body(i);
+        if (!r.hasData) continue;
+        if (r.ephemeris == 2) earthRow = (int)data.size();  // Tierra en el orden de las efemérides
+        data.push_back({ catalog.text(r.dataName), r.distanceFromSunAU, r.distanceFromSunKM, r.orbitPeriodDays,
+            r.rotationPeriodHours, r.diameterKM, r.massEarths, r.mass, catalog.text(r.planetType),
+            catalog.text(r.atmosphere), catalog.text(r.funFact), ImVec4(r.color[0], r.color[1], r.color[2], r.color[3]) });
+    }
+
+    bodies = std::move(loaded);
+    planetEducationalData = std::move(data);
+    earthDataIndex = earthRow;
+    if (selectedPlanetForComparison >= (int)planetEducationalData.size()) selectedPlanetForComparison = earthDataIndex;
+    if (cameraFocus >= bodies.size()) cameraFocus = 0;
+    cout << "Escena cargada: " << bodies.size() << " cuerpos (" << SCENE_FILE << ")" << endl;
+    return true;
+}
 
 
 // ===========================================
@@ -1044,13 +2123,76 @@ SolarSystemTextures loadAllSolarSystemTextures() {
  * Función principal del programa.
  * Inicializa OpenGL, crea recursos, configura la escena y ejecuta el loop principal.
  * Maneja la simulación completa del sistema solar con controles interactivos.
+ * Con el argumento --bench ejecuta las validaciones y mediciones sin abrir ventana;
+ * con --build-ephemeris [ruta] genera el archivo de efemérides precalculadas y con
+ * --import-minor-bodies catalogo [ruta] importa asteroides y cometas; con
+ * --build-star-catalog estrellas.csv [ruta] genera el catálogo de estrellas del fondo.
+ * Con --render guion.txt [procesos] [cuadros de calibración] renderiza un guion en varios
+ * procesos; cada uno se lanza con --render-worker y dibuja su tramo sin ventana visible.
+ * Con --record-input registro.bin graba la entrada de la sesión; --replay-input registro.bin
+ * la reproduce frame por frame y --bench-replay registro.bin [resultados.csv] la reproduce sin
+ * límite de FPS, informa los tiempos de frame y agrega una fila al CSV para comparar compilaciones.
  */
-int main() {
+int main(int argc, char** argv) {
+    // MODOS DE LÍNEA DE COMANDOS
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return runBenchmarks();
+    }
+    if (argc > 1 && string(argv[1]) == "--build-ephemeris") {
+        return buildEphemerisFile(argc > 2 ? argv[2] : EPHEMERIS_FILE);
+    }
+    if (argc > 2 && string(argv[1]) == "--import-minor-bodies") {
+        return importMinorBodyFile(argv[2], argc > 3 ? argv[3] : MINOR_BODY_FILE);
+    }
+    if (argc > 2 && string(argv[1]) == "--build-star-catalog") {
+        return buildStarCatalogFile(argv[2], argc > 3 ? argv[3] : STAR_CATALOG_FILE);
+    }
+    if (argc > 2 && string(argv[1]) == "--render") {
+        return runBatchRender(argv[0], argv[2], argc > 3 ? atoi(argv[3]) : 0, argc > 4 ? atoll(argv[4]) : -1);
+    }
+    if (argc > 6 && string(argv[1]) == "--render-worker") {
+        // Proceso de un render por lotes: guion, tramo, número de tramo y núcleos asignados
+        string error;
+        if (!batchJob.script.load(argv[2], error)) {
+            cout << error << endl;
+            return 1;
+        }
+        batchJob.first = atoll(argv[3]);
+        batchJob.count = atoll(argv[4]);
+        batchJob.part = atoi(argv[5]);
+        batchJob.cores = std::max(1, atoi(argv[6]));
+        batchJob.active = true;
+        // La consola de todos los procesos iría mezclada: cada uno escribe en su registro
+        freopen((batchPartPath(batchJob.script, batchJob.part) + ".log").c_str(), "w", stdout);
+    }
+    if (argc > 2 && (string(argv[1]) == "--record-input" || string(argv[1]) == "--replay-input" ||
+        string(argv[1]) == "--bench-replay")) {
+        // Sesión repetible: se graba la entrada o se reproduce una grabada (--bench-replay: sin
+        // V-Sync ni limitador, con informe de tiempos y una fila en el CSV opcional)
+        inputSession.enabled = true;
+        inputSession.path = argv[2];
+        inputSession.benchmark = string(argv[1]) == "--bench-replay";
+        if (inputSession.benchmark && argc > 3) inputSession.resultsPath = argv[3];
+        if (string(argv[1]) != "--record-input") {
+            string error;
+            if (!inputLog.load(argv[2], error)) {
+                cout << error << endl;
+                return 1;
+            }
+            inputSession.replaying = true;
+            inputSession.frameTimes.reserve(inputLog.frameCount());
+            inputSession.workTimes.reserve(inputLog.frameCount());
+            cout << "Reproduciendo " << inputLog.frameCount() << " frames de " << argv[2] << endl;
+        }
+    }
+
     // INICIALIZACIÓN DE GLFW Y OPENGL
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);  // OpenGL 3.3
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // Core Profile (moderno)
+    if (batchJob.active) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);  // Render por lotes: sin ventana visible
+    if (inputLog.isReplaying()) glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);  // El tamaño sale de la grabación
 
     // Crear ventana principal
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Sistema Solar v6 con UI", NULL, NULL);
@@ -1061,10 +2203,9 @@ int main() {
     }
 
     // Configurar contexto y callbacks
+    // (los de entrada se registran después de crear el contexto de ImGui: installInputCallbacks)
     glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);  // Redimensionamiento
-    glfwSetKeyCallback(window, key_callback);                           // Teclado
-    glfwSetCursorPosCallback(window, mouse_callback);                   // Mouse
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);      // Refresco pedido por el sistema
 
     // Cargar funciones de OpenGL usando GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -1074,9 +2215,36 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);  // Activar test de profundidad para 3D
 
+    // Framebuffer de la escena con profundidad flotante invertida (o convencional si no hay glClipControl)
+    int initial_w, initial_h;
+    glfwGetFramebufferSize(window, &initial_w, &initial_h);
+    if (!reversedDepth.init(initial_w, initial_h)) {
+        cout << "Profundidad invertida no disponible: se usa la convencional" << endl;
+    }
+
+    // V-Sync inicial (se puede cambiar desde el panel de rendimiento)
+    if (inputSession.benchmark) vsyncMode = FramePacer::VSYNC_OFF;  // Medir la reproducción sin esperar al monitor
+    vsyncMode = framePacer.applyVSync((FramePacer::VSyncMode)vsyncMode);
+
     // CARGA DE SHADERS
     Shader ourShader("shaders/shader.vert", "shaders/shader.frag");       // Shader para objetos 3D
     Shader orbitShader("shaders/orbit.vert", "shaders/orbit.frag");       // Shader para órbitas y efectos
+    Shader starShader("shaders/star.vert", "shaders/star.frag");          // Shader para las estrellas del fondo
+    ourShader.setUniformBlock("FrameData", FRAME_DATA_BINDING);
+    orbitShader.setUniformBlock("FrameData", FRAME_DATA_BINDING);
+    starShader.setUniformBlock("FrameData", FRAME_DATA_BINDING);
+    ourShader.setUniformBlock("DrawData", DRAW_DATA_BINDING);
+    orbitShader.setUniformBlock("DrawData", DRAW_DATA_BINDING);
+
+    // FRAMES EN VUELO Y BUFFER DE DATOS POR FRAME (una región por frame en vuelo)
+    FramesInFlight framesInFlight;
+    framesInFlight.init(FRAMES_IN_FLIGHT);
+    FrameRecorder recorder;  // Grabación de video (un PBO por frame en vuelo)
+    StreamBuffer frameStream;
+    bool persistentStream = frameStream.init(FRAME_STREAM_SIZE, framesInFlight.count());
+    cout << "Datos por frame: " << (persistentStream ? "buffer persistente (glBufferStorage)"
+                                                     : "mapeo por escritura (OpenGL 3.3)")
+         << ", " << framesInFlight.count() << " frames en vuelo" << endl;
 
     // GENERACIÓN DE GEOMETRÍA - ESFERA
     vector<float> sphereVertices;
@@ -1103,34 +2271,34 @@ int main() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float))); // UV
     glEnableVertexAttribArray(2);
 
-    // GENERACIÓN DE GEOMETRÍA - CÍRCULOS (ÓRBITAS)
-    vector<float> circleVertices;
-    const int orbitSegments = 100;
-    createCircle(circleVertices, orbitSegments);
-
-    // Configurar VAO/VBO para órbitas
-    unsigned int orbitVAO, orbitVBO;
-    glGenVertexArrays(1, &orbitVAO);
-    glGenBuffers(1, &orbitVBO);
-
-    glBindVertexArray(orbitVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
-    glBufferData(GL_ARRAY_BUFFER, circleVertices.size() * sizeof(float), &circleVertices[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
     // CONFIGURACIÓN DE METEORITOS
-    unsigned int meteoriteVAO, meteoriteVBO;
-    float pointVertex[] = { 0.0f, 0.0f, 0.0f };
-
+    // Las posiciones de los visibles se escriben en cada frame en el buffer de streaming, como las
+    // partículas, y van en un solo draw
+    unsigned int meteoriteVAO;
     glGenVertexArrays(1, &meteoriteVAO);
-    glGenBuffers(1, &meteoriteVBO);
     glBindVertexArray(meteoriteVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, meteoriteVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(pointVertex), &pointVertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
+    // CONFIGURACIÓN DE CUERPOS AGREGADOS (MODO N-CUERPOS)
+    // Las posiciones interpoladas se escriben en cada frame en el buffer de streaming; el atributo se
+    // apunta a su desplazamiento al dibujar
+    unsigned int particleVAO;
+    glGenVertexArrays(1, &particleVAO);
+    glBindVertexArray(particleVAO);
+    glEnableVertexAttribArray(0);
+
+    // CONFIGURACIÓN DE CUERPOS MENORES (CATÁLOGO IMPORTADO)
+    // Parte alta y baja de cada posición, como las órbitas; se rehace solo cuando cambia la fecha
+    unsigned int minorBodyVAO, minorBodyVBO;
+    glGenVertexArrays(1, &minorBodyVAO);
+    glGenBuffers(1, &minorBodyVBO);
+    glBindVertexArray(minorBodyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, minorBodyVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
     glBindVertexArray(0);  // Desvincular VAO
 
     // CARGA DE TEXTURAS
@@ -1142,121 +2310,293 @@ int main() {
         return -1;
     }
 
-    // CONFIGURACIÓN DE PLANETAS
-    // Crear vector con todos los planetas del sistema solar
-    std::vector<Planet> planets;
-
-    // Inicializar cada planeta con sus parámetros específicos
-    planets.push_back({ "Mercurio", 1.5f, 47.9f, 0.0f, 0.017f, 0.0f, 0.15f, textures.mercury,
-                      false, 0.0f, 0.0f, 0.0f, 0, false, 0 });
-
-    planets.push_back({ "Venus", 2.0f, 35.0f, 0.0f, 0.004f, 0.0f, 0.25f, textures.venus,
-                      false, 0.0f, 0.0f, 0.0f, 0, false, 0 });
-
-    planets.push_back({ "Tierra", 3.5f, 30.0f, 0.0f, 60.0f, 0.0f, 0.3f, textures.earth,
-                      true, 0.7f, 200.0f, 0.0f, textures.moon, false, 0 });
-
-    planets.push_back({ "Marte", 4.5f, 24.1f, 0.0f, 31.0f, 0.0f, 0.2f, textures.mars,
-                      false, 0.0f, 0.0f, 0.0f, 0, false, 0 });
-
-    planets.push_back({ "Jupiter", 6.0f, 13.1f, 0.0f, 28.0f, 0.0f, 0.5f, textures.jupiter,
-                      false, 0.0f, 0.0f, 0.0f, 0,true, textures.jupiterRing});
+    // CONFIGURACIÓN DE CUERPOS
+    // Todos los cuerpos salen del archivo de escena y viven en un BodyStore (arreglos por componente)
+    Ephemeris planetEphemeris;
+    planetEphemeris.addPlanets();  // Elementos keplerianos reales, en el orden de los índices "ephemeris" de la escena
+    SceneCatalog sceneCatalog;
+    BodyStore bodies;
+    if (!loadScene(sceneCatalog, planetEphemeris.bodyCount(), textures, bodies)) {
+        glfwTerminate();
+        return -1;
+    }
 
-    planets.push_back({ "Saturno", 7.5f, 9.7f, 0.0f, 22.0f, 0.0f, 0.45f, textures.saturn,
-                      false, 0.0f, 0.0f, 0.0f, 0, true, textures.saturnRing });
+    // CONFIGURACIÓN DE LA SIMULACIÓN
+    // Parámetros de movimiento de cada planeta e inicialización del sistema de partículas
+    std::vector<BodyMotion> bodyMotions = bodies.planetMotions();
+    // Con entrada grabada la semilla de rand() es fija y la fecha inicial es la de la grabación
+    double startJulianDate = inputLog.isReplaying() ? inputLog.header().startJulianDate : currentJulianDate();
+    if (inputSession.enabled) srand(inputLog.isReplaying() ? inputLog.header().seed : INPUT_LOG_SEED);
+    Simulation simulation;
+    simulation.init(bodyMotions, planetEphemeris, MAX_METEORITES, startJulianDate);  // La simulación empieza en la fecha actual
+    ChebyshevEphemeris precomputedEphemeris;
+    if (loadEphemerisFile(precomputedEphemeris, EPHEMERIS_FILE, bodyMotions.size())) {
+        simulation.setPrecomputedEphemeris(&precomputedEphemeris);
+    }
 
-    planets.push_back({ "Urano", 9.0f, 6.8f, 0.0f, 17.0f, 0.0f, 0.4f, textures.uranus,
-                      false, 0.0f, 0.0f, 0.0f, 0, true, textures.uranusRing });
+    // CATÁLOGO DE CUERPOS MENORES
+    // Los elementos pasan del binario proyectado a Ephemeris; el archivo se cierra después
+    Ephemeris minorBodyEphemeris;
+    {
+        MinorBodyCatalog minorBodyCatalog;
+        if (minorBodyCatalog.open(MINOR_BODY_FILE)) {
+            minorBodyCatalog.addTo(minorBodyEphemeris);
+            cout << "Cuerpos menores cargados: " << minorBodyEphemeris.bodyCount() << " (" << MINOR_BODY_FILE << ")" << endl;
+        }
+        else {
+            cout << "Catalogo de cuerpos menores no disponible (" << MINOR_BODY_FILE << "). "
+                << "Importar con --import-minor-bodies MPCORB.DAT" << endl;
+        }
+    }
+    std::vector<double> minorBodyScratch;
+    double minorBodyDate = NAN;            // Fecha y vista de los vértices subidos
+    size_t minorBodyBytes = 0;             // Bytes escritos en el VBO de cuerpos menores en este frame
+    size_t streamedBytes = 0;              // Bytes escritos en buffers mapeados en el último frame
+    bool minorBodyTrueScale = false;
+
+    // CATÁLOGO DE ESTRELLAS
+    // El VBO se llena directamente desde el archivo proyectado, sin copia intermedia;
+    // el archivo sigue abierto porque las celdas se consultan en cada frame
+    StarCatalog starCatalog;
+    unsigned int starVAO = 0, starVBO = 0;
+    if (starCatalog.open(STAR_CATALOG_FILE)) {
+        glGenVertexArrays(1, &starVAO);
+        glGenBuffers(1, &starVBO);
+        glBindVertexArray(starVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, starVBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)starCatalog.starCount() * sizeof(StarRecord), starCatalog.stars(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, direction));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, magnitude));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(StarRecord), (void*)offsetof(StarRecord, color));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        starLimitMagnitude = std::min(starLimitMagnitude, starCatalog.faintestMagnitude());
+        cout << "Catalogo de estrellas cargado: " << starCatalog.starCount() << " (" << STAR_CATALOG_FILE << ")" << endl;
+    }
+    else {
+        cout << "Catalogo de estrellas no disponible (" << STAR_CATALOG_FILE << "); se usa la textura de la galaxia. "
+            << "Generar con --build-star-catalog estrellas.csv" << endl;
+    }
+    int drawnStars = 0;                    // Estrellas del último frame (para el panel)
+    std::vector<float> bodyReach;          // Radio de cada cuerpo con sus anillos (esferas de la BVH)
+
+    // GENERACIÓN DE GEOMETRÍA - ÓRBITAS
+    // Una elipse por planeta en un único VBO; cada una se dibuja desde su desplazamiento.
+    // Primero las órbitas esquemáticas y después las de escala real
+    vector<float> orbitVertices;
+    const int orbitSegments = 256;
+    for (bool realScale : { false, true }) {
+        for (size_t i = 0; i < bodyMotions.size(); ++i) {
+            createOrbitPath(simulation, (int)i, simulation.currentState().julianDate, orbitSegments, realScale, orbitVertices);
+        }
+    }
 
-    planets.push_back({ "Neptuno", 10.5f, 5.4f, 0.0f, 16.0f, 0.0f, 0.38f, textures.neptune,
-                      false, 0.0f, 0.0f, 0.0f, 0, true, textures.neptuneRing });
+    // Configurar VAO/VBO para órbitas
+    unsigned int orbitVAO, orbitVBO;
+    glGenVertexArrays(1, &orbitVAO);
+    glGenBuffers(1, &orbitVBO);
 
-    // CONFIGURACIÓN DE METEORITOS
-    // Inicializar sistema de partículas para efectos visuales
-    std::vector<Meteorite> meteorites;
-    for (int i = 0; i < MAX_METEORITES; ++i) {
-        Meteorite m;
-        m.isVisible = false;                                            // Inicialmente invisible
-        m.initialDelay = (float)(rand() % 5000) / 1000.0f;            // Retraso aleatorio 0-5 segundos
-        float randomX = -1.2f - (float)(rand() % 100) / 200.0f;       // Posición inicial X aleatoria
-        float randomY = 1.2f + (float)(rand() % 100) / 200.0f;        // Posición inicial Y aleatoria
-        m.position = glm::vec3(randomX, randomY, 0.0f);
-        float velX = 0.4f + (float)(rand() % 40) / 100.0f;            // Velocidad X aleatoria
-        float velY = -0.4f - (float)(rand() % 40) / 100.0f;           // Velocidad Y aleatoria (hacia abajo)
-        m.velocity = glm::vec3(velX, velY, 0.0f);
-        meteorites.push_back(m);
+    glBindVertexArray(orbitVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
+    glBufferData(GL_ARRAY_BUFFER, orbitVertices.size() * sizeof(float), &orbitVertices[0], GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);                    // Parte alta
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); // Parte baja
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    // Nombres para el selector del cuerpo seguido en escala real
+    std::vector<const char*> focusNames;
+    for (const std::string& name : bodies.metadata.name) focusNames.push_back(name.c_str());
+    SimulationState renderState;            // Estado interpolado que consume el renderizado
+
+    // La simulación corre en su propio hilo y publica instantáneas en un triple buffer
+    int renderThreadId = profiler.registerThread("Render");
+    int simThreadId = profiler.registerThread("Simulacion");
+    SimulationThread simulationThread;
+    simulationThread.onUnexpectedPublish = requestRedraw;  // Saltos de fecha con la escena en reposo
+    if (batchJob.active && !startBatchJob(batchJob, simulation, simulationThread, recorder, framesInFlight.count(),
+        reversedDepth.framebuffer() != 0)) {
+        glfwTerminate();
+        return 1;
     }
+    if (inputSession.enabled) simulationThread.setFixedStep(true);  // Los pasos salen del deltaTime de cada frame
+    simulationThread.start(simulation, profiler, simThreadId);
 
     // INICIALIZACIÓN DE IMGUI
     // Configurar interfaz gráfica de usuario
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(trackedImGuiAlloc, trackedImGuiFree);  // Asignaciones de ImGui en el contador
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     ImGui::StyleColorsDark();                                         // Tema oscuro
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    if (inputSession.enabled) io.IniFilename = nullptr;              // Misma disposición al grabar y al reproducir
+    ImGui_ImplGlfw_InitForOpenGL(window, false);                      // La entrada llega por installInputCallbacks
     ImGui_ImplOpenGL3_Init("#version 330");
+    if (inputSession.enabled && !inputLog.isReplaying()) {
+        inputLog.startRecording(INPUT_LOG_SEED, startJulianDate, glfwGetTime());
+        cout << "Grabando la entrada en " << inputSession.path << endl;
+    }
+    // Aviso en el título y no en la interfaz: un texto distinto en ImGui cambiaría la disposición
+    if (inputSession.enabled) {
+        glfwSetWindowTitle(window, inputLog.isReplaying() ? "Sistema Solar v6 con UI (reproduciendo entrada)"
+                                                          : "Sistema Solar v6 con UI (grabando entrada)");
+    }
+    installInputCallbacks(window);
 
     // VARIABLES DE CONTROL DE TIEMPO Y ANIMACIÓN
     float deltaTime = 0.0f;                 // Tiempo transcurrido entre frames
     float lastFrame = 0.0f;                 // Tiempo del frame anterior
-    float totalTime = 0.0f;                 // Tiempo total transcurrido
-    float sunRotationAngle = 0.0f;          // Ángulo de rotación del Sol
-    float sunRotationSpeed = 5.0f;          // Velocidad de rotación del Sol (grados/segundo)
+    double lastSceneCheck = glfwGetTime();  // Última consulta de cambios en el archivo de escena
+    batchJob.loopStart = glfwGetTime();     // Arranque del render por lotes (contexto, texturas, catálogos)
 
     // ===========================================
     // LOOP PRINCIPAL DE RENDERIZADO
     // ===========================================
     while (!glfwWindowShouldClose(window)) {
 
+        // RECARGA EN CALIENTE DE LA ESCENA
+        // También en reposo: el timeout de la espera de eventos despierta el loop
+        if (glfwGetTime() - lastSceneCheck >= SCENE_RELOAD_INTERVAL) {
+            lastSceneCheck = glfwGetTime();
+            if (sceneCatalog.sourceChanged(SCENE_FILE) &&
+                loadScene(sceneCatalog, planetEphemeris.bodyCount(), textures, bodies)) {
+                focusNames.clear();
+                for (const std::string& name : bodies.metadata.name) focusNames.push_back(name.c_str());
+                bodyBounds.clear();  // Otra escena: la BVH se reconstruye con los cuerpos nuevos
+                hoveredBody = -1;
+                // Las órbitas de los planetas son parte de la simulación en curso
+                std::vector<BodyMotion> motions = bodies.planetMotions();
+                bool sameOrbits = motions.size() == bodyMotions.size();
+                for (size_t i = 0; sameOrbits && i < motions.size(); ++i) sameOrbits = motions[i].orbitRadius == bodyMotions[i].orbitRadius;
+                if (!sameOrbits) cout << "Los cambios de planetas y radios de orbita se aplican al reiniciar" << endl;
+                requestRedraw();
+            }
+        }
+
+        // RENDERIZADO BAJO DEMANDA
+        // Con la animación pausada, sin meteoritos y sin entrada pendiente, nada cambia en pantalla:
+        // se bloquea esperando eventos y no se dibuja nada (salvo mientras se graba).
+        bool sceneStatic = animationPaused && !showMeteorites && !recorder.isRecording() && !inputLog.isActive();
+        if (onDemandRendering && sceneStatic && pendingRedrawFrames.load() <= 0) {
+            glfwWaitEventsTimeout(IDLE_WAIT_TIMEOUT);
+            if (pendingRedrawFrames.load() <= 0) {
+                frameStats.update(glfwGetTime(), false);
+                continue;  // Timeout sin eventos: no dibujar
+            }
+            lastFrame = glfwGetTime();  // Evitar un deltaTime gigante tras el reposo
+            framePacer.reset();         // El reposo no cuenta como intervalo de frame
+        }
+        else {
+            // PROCESAR EVENTOS DE ENTRADA
+            glfwPollEvents();
+        }
+        if (pendingRedrawFrames.load() > 0) pendingRedrawFrames--;
+
+        // Trabajo del hilo de render en este frame (sin contar esperas de eventos ni del limitador)
+        Profiler::Clock::time_point renderWorkStart = Profiler::Clock::now();
+
+        // MEMORIA DEL FRAME: se descarta la arena del frame anterior y se empieza a contar
+        frameArena.reset();
+        frameAllocations.beginFrame();
+
         // CÁLCULO DE TIEMPO
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-        totalTime += deltaTime;
-
-        // Tiempo efectivo (se puede pausar la animación)
-        float effectiveDeltaTime = animationPaused ? 0.0f : deltaTime;
-
-        // ACTUALIZACIÓN DE METEORITOS
-        if (showMeteorites) {
-            for (int i = 0; i < meteoriteCount; ++i) {
-                if (!meteorites[i].isVisible) {
-                    // Verificar si es momento de hacer aparecer el meteorito
-                    if (totalTime > meteorites[i].initialDelay) {
-                        meteorites[i].isVisible = true;
-                        // Reposicionar en zona de aparición
-                        float randomX = -1.2f - (float)(rand() % 100) / 200.0f;
-                        float randomY = 1.2f + (float)(rand() % 100) / 200.0f;
-                        meteorites[i].position = glm::vec3(randomX, randomY, 0.0f);
-                        // Programar próxima aparición
-                        meteorites[i].initialDelay = totalTime + 3.0f + (float)(rand() % 3000) / 1000.0f;
-                    }
-                }
-                else {
-                    // Mover meteorito según su velocidad
-                    meteorites[i].position += meteorites[i].velocity * deltaTime;
-                    // Verificar si salió de pantalla (ocultar para reciclaje)
-                    if (meteorites[i].position.x > 1.2f || meteorites[i].position.y < -1.2f) {
-                        meteorites[i].isVisible = false;
-                    }
-                }
+        if (recorder.isRecording()) deltaTime = 1.0f / recorder.fps();  // Grabando: el tiempo es el del video
+
+        // ENTRADA GRABADA: se graba el deltaTime del frame o, al reproducir, se aplican los
+        // eventos del frame y su deltaTime
+        if (inputLog.isActive()) syncInputFrame(window, deltaTime);
+        if (inputSession.replaying && !inputLog.isReplaying()) {
+            // Terminó la reproducción: informe; con --bench-replay se sale, si no sigue en vivo
+            inputSession.replaying = false;
+            finishInputReplay();
+            if (inputSession.benchmark) {
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+                continue;
             }
+            simulationThread.setFixedStep(recorder.isRecording());
         }
-        else {
-            // Si los meteoritos están desactivados, ocultar todos
-            for (int i = 0; i < MAX_METEORITES; ++i) {
-                meteorites[i].isVisible = false;
+
+        // CONTROL CONTINUO DE CÁMARA (flechas)
+        processCameraInput(deltaTime);
+
+        // RENDER POR LOTES: la cámara del cuadro sale del guion
+        if (batchJob.active) applyBatchCamera(batchJob, bodies, batchJob.first + recorder.capturedFrames());
+
+        // SIMULACIÓN DE PASO FIJO (hilo dedicado)
+        // Se envían los controles y se interpola la última instantánea publicada, sin bloquear
+        SimulationControls simControls;
+        simControls.paused = animationPaused;
+        simControls.meteoritesEnabled = showMeteorites;
+        simControls.meteoriteCount = meteoriteCount;
+        simulationThread.setControls(simControls);
+        if (recorder.isRecording()) {
+            // Grabando: los pasos de un cuadro exactos, aunque el frame tarde más que en tiempo real
+            simulationThread.stepFixed((int)std::lround(1.0 / (recorder.fps() * Simulation::FIXED_DT)));
+        }
+        else if (inputLog.isActive()) {
+            // Entrada grabada: los pasos salen del deltaTime (grabado o reproducido), no del reloj;
+            // como en tiempo real, tras un frame muy largo no se recupera más de MAX_SUBSTEPS
+            inputSession.pendingTime += deltaTime;
+            int ticks = (int)(inputSession.pendingTime / Simulation::FIXED_DT);
+            if (ticks > (int)Simulation::MAX_SUBSTEPS) {
+                ticks = (int)Simulation::MAX_SUBSTEPS;
+                inputSession.pendingTime = 0.0;
             }
+            else {
+                inputSession.pendingTime -= ticks * Simulation::FIXED_DT;
+            }
+            simulationThread.stepFixed(ticks);
+        }
+        simulationThread.interpolate(renderState);
+        bodies.update(renderState, trueScale);  // Posiciones, rotaciones y radios de todos los cuerpos
+
+        // BVH DE LOS CUERPOS (selección con el mouse y consultas de rayo)
+        // Cada frame se reajustan las cajas; se reconstruye si cambió la escena o el árbol se degradó
+        bodyReach.resize(bodies.size());
+        for (int i = 0; i < bodies.size(); ++i) {
+            bodyReach[i] = bodies.transforms.scale[i] * std::max(1.0f, bodies.render.ringRadius[i]);  // Incluye los anillos
+        }
+        const BodyStore::TransformChunk& bodyTransforms = bodies.transforms;
+        if (bodyBounds.primitiveCount() != bodies.size() ||
+            bodyBounds.refit(bodyTransforms.x.data(), bodyTransforms.y.data(), bodyTransforms.z.data(), bodyReach.data())) {
+            bodyBounds.build(bodyTransforms.x.data(), bodyTransforms.y.data(), bodyTransforms.z.data(), bodyReach.data(), bodies.size());
         }
 
-        // PROCESAR EVENTOS DE ENTRADA
-        glfwPollEvents();
+        // SELECCIÓN CON EL MOUSE
+        // El cuerpo pulsado pasa a la comparación de la tabla y la cámara lo sigue
+        if (clickedBody >= 0 && clickedBody < bodies.size()) {
+            int row = bodies.metadata.dataIndex[clickedBody];
+            if (row >= 0) selectedPlanetForComparison = row;
+            cameraFocus = clickedBody;
+            followSelection = true;
+        }
+        clickedBody = -1;
 
         // INICIALIZAR FRAME DE IMGUI
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
+        if (inputLog.isActive()) {
+            // Entrada grabada: ImGui usa el tiempo y el tamaño de la ventana del registro
+            io.DeltaTime = std::max(deltaTime, 1e-6f);
+            io.DisplaySize = ImVec2((float)inputState.windowWidth, (float)inputState.windowHeight);
+            if (inputState.windowWidth > 0 && inputState.windowHeight > 0) {
+                io.DisplayFramebufferScale = ImVec2((float)inputState.framebufferWidth / inputState.windowWidth,
+                    (float)inputState.framebufferHeight / inputState.windowHeight);
+            }
+        }
         ImGui::NewFrame();
 
+        // Nombre del cuerpo bajo el cursor (clic para seleccionarlo)
+        if (hoveredBody >= 0 && hoveredBody < bodies.size() && !mouseControleEnabled && !ImGui::GetIO().WantCaptureMouse) {
+            ImGui::SetTooltip("%s", bodies.metadata.name[hoveredBody].c_str());
+        }
+
         // INTERFAZ DE USUARIO - PANEL DE CONTROL
         ImGui::SetNextWindowSize(ImVec2(250, 280), ImGuiCond_FirstUseEver);
         ImGui::Begin("Tablero de controles");
@@ -1266,15 +2606,32 @@ int main() {
         ImGui::Checkbox("Mostrar nombres", &showNames);
         ImGui::Checkbox("Detener animacion", &animationPaused);
         ImGui::Checkbox("Mostrar orbitas", &showOrbits);
+        if (minorBodyEphemeris.bodyCount() > 0) {
+            ImGui::Checkbox("Cuerpos menores", &showMinorBodies);
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d)", minorBodyEphemeris.bodyCount());
+        }
+        if (starCatalog.isOpen()) {
+            ImGui::SliderFloat("Magnitud limite", &starLimitMagnitude, 0.0f, starCatalog.faintestMagnitude(), "%.1f");
+            ImGui::TextDisabled("Estrellas: %d de %d", drawnStars, starCatalog.starCount());
+        }
+        ImGui::Checkbox("Reposo sin cambios", &onDemandRendering);
+        ImGui::Checkbox("Mostrar estadisticas", &showStats);
 
         // Sección de navegación y control de cámara
         ImGui::SeparatorText("Navegacion");
         ImGui::Checkbox("Habilitar mouse", &mouseControleEnabled);
+        ImGui::Checkbox("Latch tardio de la entrada", &lateLatchInput);
+        if (lateLatchInput) {
+            ImGui::SameLine();
+            ImGui::Checkbox("Prediccion", &predictCameraInput);
+        }
 
         if (ImGui::Button("Resetear Vista", ImVec2(-1, 0))) {
             cameraPitch = 0.0f;
             cameraYaw = 0.0f;
             firstMouse = true;
+            followSelection = false;  // Igual que la tecla R: la vista esquemática vuelve a mirar al Sol
         }
 
         // Botones de control manual de cámara
@@ -1282,18 +2639,41 @@ int main() {
         float buttonWidth = ImGui::GetFrameHeight();
         ImGui::SetCursorPosX((ImGui::GetWindowWidth() - (buttonWidth * 2 + spacing)) * 0.5f);
 
-        if (ImGui::ArrowButton("##up", ImGuiDir_Up)) {
-            cameraPitch += pitchIncrement;
+        // Mientras el botón esté presionado la cámara gira a pitchSpeed grados/segundo
+        ImGui::ArrowButton("##up", ImGuiDir_Up);
+        if (ImGui::IsItemActive()) {
+            cameraPitch += pitchSpeed * deltaTime;
             if (cameraPitch > maxPitch) cameraPitch = maxPitch;
         }
         ImGui::SameLine();
-        if (ImGui::ArrowButton("##down", ImGuiDir_Down)) {
-            cameraPitch -= pitchIncrement;
+        ImGui::ArrowButton("##down", ImGuiDir_Down);
+        if (ImGui::IsItemActive()) {
+            cameraPitch -= pitchSpeed * deltaTime;
             if (cameraPitch < minPitch) cameraPitch = minPitch;
         }
 
         ImGui::Text("*Usar tambien las teclas de navegacion.");
 
+        // Escala real: distancias y radios verdaderos, la cámara sigue a un cuerpo
+        ImGui::Checkbox("Escala real", &trueScale);
+        if (trueScale) {
+            ImGui::SetNextItemWidth(120);
+            ImGui::Combo("Seguir", &cameraFocus, focusNames.data(), (int)focusNames.size());
+            double focusRadius;
+            cameraFocusPosition(bodies, focusRadius);
+            double minDistance = focusRadius * 1.5;
+            ImGui::SetNextItemWidth(120);
+            ImGui::SliderScalar("Distancia (UA)", ImGuiDataType_Double, &trueScaleDistance, &minDistance,
+                &TRUE_SCALE_MAX_DISTANCE, "%.6f", ImGuiSliderFlags_Logarithmic);
+            trueScaleDistance = glm::clamp(trueScaleDistance, minDistance, TRUE_SCALE_MAX_DISTANCE);
+            ImGui::Text(reversedDepth.isReversed() ? "Profundidad invertida (32F)" : "Profundidad convencional");
+        }
+        else if (followSelection && cameraFocus < bodies.size()) {
+            ImGui::Text("Siguiendo: %s", bodies.metadata.name[cameraFocus].c_str());
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Volver al Sol")) followSelection = false;
+        }
+
         // Sección de efectos visuales
         ImGui::SeparatorText("Efectos");
         ImGui::Checkbox("Lluvia de meteoritos", &showMeteorites);
@@ -1307,142 +2687,374 @@ int main() {
             ImGui::PopItemWidth();
         }
 
+        // Sección de tiempo simulado
+        renderTimeControls(simulationThread, renderState.julianDate);
+
+        // Sección de gravitación N-cuerpos
+        renderGravityControls(simulationThread, renderState);
+
+        // Sección de grabación de video
+        renderRecordingControls(recorder, simulationThread, framesInFlight.count(), reversedDepth.framebuffer() != 0);
+
+        // Sección de rendimiento: V-Sync y limitador de frames
+        ImGui::SeparatorText("Rendimiento");
+        const char* vsyncModes[] = { "V-Sync desactivado", "V-Sync activado", "V-Sync adaptativo" };
+        ImGui::SetNextItemWidth(150);
+        if (ImGui::Combo("Sincronizacion", &vsyncMode, vsyncModes, 3)) {
+            vsyncMode = framePacer.applyVSync((FramePacer::VSyncMode)vsyncMode);  // Puede degradar a activado
+        }
+        ImGui::Checkbox("Limitar FPS", &framePacer.limitEnabled);
+        if (framePacer.limitEnabled) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100);
+            ImGui::SliderInt("FPS objetivo", &framePacer.targetFps, 15, 240);
+        }
+
         // Renderizar interfaz educativa
         renderEducationalInterface();
 
-        ImGui::End();
+        // Mientras se arrastra un control o se escribe, seguir dibujando
+        if (ImGui::IsAnyItemActive()) requestRedraw();
 
-        // CONFIGURACIÓN DE RENDERIZADO 3D
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);                    // Color de fondo oscuro
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);       // Limpiar buffers
+        ImGui::End();
 
-        ourShader.use();
+        // PANEL DE ESTADÍSTICAS
+        if (showStats) {
+            ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+            ImGui::Begin("Estadisticas", &showStats, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Text("FPS: %.1f (%.2f ms)", frameStats.fps, frameStats.frameMs);
+            ImGui::Text("CPU del proceso: %.1f%% de un nucleo", frameStats.cpuPercent);
+            ImGui::Text("Despertares sin dibujar: %d/s", frameStats.idleWakeups);
+            double target = framePacer.targetPeriod();
+            if (target > 0.0) ImGui::Text("Objetivo: %.2f ms (%.0f FPS)", target * 1000.0, 1.0 / target);
+            else ImGui::Text("Objetivo: sin limite");
+            ImGui::Text("Intervalo medio: %.2f ms", framePacer.meanIntervalMs());
+            ImGui::Text("Jitter (desv. estandar): %.3f ms", framePacer.jitterMs());
+            ImGui::Text("Error medio vs objetivo: %.3f ms", framePacer.meanErrorMs());
+            ImGui::Text("Pasos de simulacion: %d x %.2f ms por tick",
+                simulationThread.latestSnapshot().substeps, Simulation::FIXED_DT * 1000.0);
+            ImGui::Text("Datos por frame: %.1f KB mapeados (%s)", streamedBytes / 1024.0,
+                frameStream.isPersistent() ? "persistente" : "mapeo por escritura");
+            ImGui::Text("Frames en vuelo: %d (buffer de %.1f MB)", framesInFlight.count(), frameStream.size() / (1024.0 * 1024.0));
+            ImGui::Text("Espera de CPU a la GPU: %.3f ms (media %.3f, max %.3f)",
+                framesInFlight.lastWaitMs(), framesInFlight.meanWaitMs(), framesInFlight.maxWaitMs());
+            ImGui::Text("Tiempo de GPU: %.2f ms", framesInFlight.gpuMs());
+            ImGui::Text("Entrada a swap: %.2f ms (media %.2f, max %.2f)",
+                inputLatency.lastMs(), inputLatency.meanMs(), inputLatency.maxMs());
+            if (lateLatchInput) ImGui::Text("Latch a swap: %.2f ms (media)", latchLatency.meanMs());
+
+            // Asignaciones al heap del frame anterior (objetivo: ninguna en régimen estable)
+            ImGui::SeparatorText("Memoria");
+            ImGui::Text("Asignaciones por frame: %llu (%llu bytes), ImGui %llu",
+                (unsigned long long)frameAllocations.frameCount, (unsigned long long)frameAllocations.frameBytes,
+                (unsigned long long)frameAllocations.imguiCount);
+            ImGui::Text("Maximo en el ultimo segundo: %llu; todo el proceso: %llu",
+                (unsigned long long)frameAllocations.peakCount, (unsigned long long)frameAllocations.processCount);
+            ImGui::Text("Frames seguidos sin asignar: %d", frameAllocations.cleanFrames);
+            ImGui::Text("Arena del frame: %.1f de %.0f KB (max %.1f KB, %d desbordes)", frameArena.lastFrameBytes() / 1024.0,
+                frameArena.capacity() / 1024.0, frameArena.peakBytes() / 1024.0, frameArena.overflows());
+
+            // Utilización de cada hilo (tiempo ocupado / tiempo real)
+            ImGui::SeparatorText("Perfilador");
+            for (int i = 0; i < profiler.threadCount(); ++i) {
+                ImGui::Text("Hilo %s: %.1f%%", profiler.threadName(i), profiler.threadUtilization(i));
+            }
+            ImGui::End();
+        }
 
         // Obtener dimensiones actuales de la ventana
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
+        // (al reproducir, la escena se dibuja al tamaño grabado y se ajusta a la ventana real)
+        int window_w, window_h;
+        glfwGetFramebufferSize(window, &window_w, &window_h);
+        int display_w = inputLog.isReplaying() ? inputState.framebufferWidth : window_w;
+        int display_h = inputLog.isReplaying() ? inputState.framebufferHeight : window_h;
+        if (display_w == 0) display_w = 1;
         if (display_h == 0) display_h = 1;  // Evitar división por cero
 
-        // CONFIGURACIÓN DE MATRICES DE PROYECCIÓN Y VISTA
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)display_w / (float)display_h, 0.1f, 100.0f);
+        // FRAMES EN VUELO
+        // Esperar a que la GPU suelte la ranura de este frame: desde aquí se escriben sus recursos
+        int frameSlot = framesInFlight.beginFrame();
+        frameStream.beginFrame(frameSlot);
+        recorder.collect(frameSlot);  // El cuadro grabado hace N frames ya está en su PBO
+
+        // CONFIGURACIÓN DE RENDERIZADO 3D
+        // La escena va al framebuffer con profundidad invertida; se copia a la ventana antes de ImGui
+        // Color de fondo oscuro; negro detrás de las estrellas
+        // Grabando, la escena se dibuja a la resolución del video y la ventana muestra una vista previa
+        int sceneWidth = recorder.isRecording() ? recorder.width() : display_w;
+        int sceneHeight = recorder.isRecording() ? recorder.height() : display_h;
+        reversedDepth.beginScene(sceneWidth, sceneHeight, starCatalog.isOpen() ? glm::vec3(0.0f) : glm::vec3(0.1f, 0.1f, 0.1f));
+
+        ourShader.use();
+
+        // LATCH TARDÍO DE LA ENTRADA
+        // La vista usa el mouse de este instante, no el del comienzo del frame; con predicción se
+        // adelanta el giro por la latencia medida entre el latch y el swap
+        float viewPitch = cameraPitch, viewYaw = cameraYaw;
+        if (lateLatchInput) {
+            latchCameraInput(window);
+            viewPitch = cameraPitch;
+            viewYaw = cameraYaw;
+            // (la predicción usa la latencia medida con el reloj real: no con entrada grabada)
+            if (predictCameraInput && mouseControleEnabled && !inputLog.isActive()) {
+                float lead = (float)latchLatency.meanSeconds();
+                viewPitch = glm::clamp(cameraPitch + pitchRate * lead, minPitch, maxPitch);
+                viewYaw = cameraYaw + yawRate * lead;
+            }
+        }
 
         // SISTEMA DE CÁMARA CON COORDENADAS ESFÉRICAS (PITCH + YAW)
-        float cameraDistance = 22.0f;                            // Distancia fija del Sol
-        float pitchRad = glm::radians(cameraPitch);               // Convertir pitch a radianes
-        float yawRad = glm::radians(cameraYaw);                   // Convertir yaw a radianes
+        // Alrededor del Sol en la vista esquemática o del cuerpo seguido en escala real
+        double focusRadius;
+        glm::dvec3 focusPos = cameraFocusPosition(bodies, focusRadius);
+        double cameraDistance = trueScale ? glm::clamp(trueScaleDistance, focusRadius * 1.5, TRUE_SCALE_MAX_DISTANCE)
+                                          : (double)SCHEMATIC_CAMERA_DISTANCE;
+        double pitchRad = glm::radians((double)viewPitch);        // Convertir pitch a radianes
+        double yawRad = glm::radians((double)viewYaw);            // Convertir yaw a radianes
+
+        // Calcular dirección de la cámara usando trigonometría esférica
+        glm::dvec3 cameraDir;
+        cameraDir.x = cos(pitchRad) * sin(yawRad); // ahora X varia también con yaw el mov en x
+        cameraDir.y = sin(pitchRad); // Altura según el pitch
+        cameraDir.z = cos(pitchRad) * cos(yawRad); // profundidad según el pitch
+
+        // ORIGEN FLOTANTE: la cámara (en doble precisión) es el origen del frame
+        floatingOrigin.setOrigin(focusPos + cameraDir * cameraDistance);
 
-        // Calcular posición de cámara usando trigonometría esférica
-        glm::vec3 cameraPos;    
-        cameraPos.x = cameraDistance * cos(pitchRad) * sin(yawRad); // ahora X varia también con yaw el mov en x
-        cameraPos.y = cameraDistance * sin(pitchRad); // Altura según el pitch
-        cameraPos.z = cameraDistance * cos(pitchRad) * cos(yawRad); // profundidad según el pitch
+        // CONFIGURACIÓN DE MATRICES DE PROYECCIÓN Y VISTA
+        // Plano lejano en el infinito; el cercano se ajusta a la escala de la vista
+        float nearPlane = reversedDepth.nearPlane(trueScale ? TRUE_SCALE_NEAR : SCHEMATIC_NEAR,
+            nearestSurfaceDistance(bodies, floatingOrigin));
+        glm::mat4 projection = reversedDepth.projection(glm::radians(FIELD_OF_VIEW), (float)sceneWidth / (float)sceneHeight, nearPlane);
 
         // PREVENCIÓN DE GIMBAL LOCK
         glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);       // Vector Up por defecto
-        if (abs(cameraPitch) > 70.0f) {                          // ¿Ángulo peligroso?
-            float factor = (90.0f - abs(cameraPitch)) / 20.0f;   // Factor de transición suave
+        if (abs(viewPitch) > 70.0f) {                            // ¿Ángulo peligroso?
+            float factor = (90.0f - abs(viewPitch)) / 20.0f;     // Factor de transición suave
             cameraUp.y = factor;                                 // Ajustar componente Y
-            cameraUp.z = (cameraPitch > 0) ? -(1.0f - factor) : (1.0f - factor);  // Compensar en Z
+            cameraUp.z = (viewPitch > 0) ? -(1.0f - factor) : (1.0f - factor);  // Compensar en Z
             cameraUp = glm::normalize(cameraUp);                 // Normaliza el vector up, es decir se establece la longitud en 1. https://stackoverflow.com/questions/17327906/what-glmnormalize-does
         }
 
         // glm::mat4 se usa para transformaciones geometricas en gráficos 3D, rotaciones, traslaciones y escalas
         // glm::lookAt define la orientación de la camara en el espacio 3D, recibe 3 parametros (Posciion de la camara, punto objetivo, vector up)
-        glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), cameraUp);
+        // La vista no tiene traslación: la cámara ya está en el origen y mira hacia el foco
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(-cameraDir), cameraUp);
+        pickProjection = projection;  // Para los rayos del mouse hasta el próximo frame
+        pickView = view;
 
-        // Enviar matrices a shaders
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
+        // Enviar matrices a los shaders (un solo bloque para todos)
+        // El fondo está centrado en la cámara y no escribe profundidad: su radio solo debe superar el plano cercano
+        float skyRadius = std::max(50.0f, nearPlane * 4.0f);
+        bindFrameData(frameStream, projection, view, skyRadius);
 
-        // RENDERIZADO DEL FONDO (GALAXIA)
+        // RENDERIZADO DEL FONDO (ESTRELLAS, O LA GALAXIA SI NO HAY CATÁLOGO)
         glDepthMask(GL_FALSE);  // Desactivar escritura en depth buffer
-        glm::mat4 model_background = glm::mat4(1.0f);
-        model_background = glm::scale(model_background, glm::vec3(50.0f, 50.0f, 50.0f));  // Esfera gigante
-        ourShader.setMat4("model", model_background);
-        glBindTexture(GL_TEXTURE_2D, textures.galaxy);
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
+        if (starCatalog.isOpen()) {
+            drawnStars = renderStarField(starShader, starCatalog, starVAO, glm::vec3(-cameraDir),
+                (float)sceneWidth / (float)sceneHeight);
+            ourShader.use();
+        }
+        else {
+            glm::mat4 model_background = glm::mat4(1.0f);
+            model_background = glm::scale(model_background, glm::vec3(skyRadius));  // Esfera gigante
+            bindDrawData(frameStream, model_background, glm::vec3(1.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+            glBindTexture(GL_TEXTURE_2D, textures.galaxy);
+            glBindVertexArray(sphereVAO);
+            glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
+        }
         glDepthMask(GL_TRUE);   // Reactivar depth buffer
 
-        // RENDERIZADO DEL SOL
-        glm::mat4 model_sun = glm::mat4(1.0f);
-        model_sun = glm::rotate(model_sun, glm::radians(sunRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-        model_sun = glm::scale(model_sun, glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setMat4("model", model_sun);
-        glBindTexture(GL_TEXTURE_2D, textures.sun);
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
-
         // RENDERIZADO DE ÓRBITAS PLANETARIAS
         if (showOrbits) {
             orbitShader.use();
-            orbitShader.setMat4("projection", projection);
-            orbitShader.setMat4("view", view);
-            orbitShader.setVec3("orbitColor", glm::vec3(0.4f, 0.4f, 0.4f));  // Color gris
+            // Color gris; los vértices están en coordenadas del mundo: la cámara se resta en el shader
+            bindDrawData(frameStream, glm::mat4(1.0f), glm::vec3(0.4f, 0.4f, 0.4f), floatingOrigin.high(), floatingOrigin.low());
 
             glBindVertexArray(orbitVAO);
 
-            // Renderizar órbita de cada planeta
-            for (const auto& planet : planets) {
-                glm::mat4 model_orbit = glm::scale(glm::mat4(1.0f), glm::vec3(planet.orbitRadius));
-                orbitShader.setMat4("model", model_orbit);
-                glDrawArrays(GL_LINE_STRIP, 0, orbitSegments + 1);
+            // Renderizar órbita de cada planeta (todas con el mismo bloque)
+            size_t firstOrbit = trueScale ? bodyMotions.size() : 0;
+            for (size_t i = 0; i < bodyMotions.size(); ++i) {
+                glDrawArrays(GL_LINE_STRIP, (GLint)((firstOrbit + i) * (orbitSegments + 1)), orbitSegments + 1);
             }
         }
 
         // VOLVER AL SHADER PRINCIPAL PARA PLANETAS
         ourShader.use();
 
-        // ACTUALIZAR ROTACIÓN DEL SOL
-        if (!animationPaused) {
-            sunRotationAngle = std::fmod(sunRotationAngle + sunRotationSpeed * effectiveDeltaTime, 360.0f);
+        // RENDERIZADO DE TODOS LOS CUERPOS (Sol, planetas y satélites)
+        // Primero todas las matrices de modelo en el buffer de streaming, después un draw por esfera o anillo
+        labelRenderer.begin();
+        DrawDataBatch bodyDraws;
+        prepareBodyDraws(bodies, floatingOrigin, frameStream, bodyDraws);
+        int bodyDraw = 0;
+        for (int i = 0; i < bodies.size(); ++i) {
+            renderBody(bodies, i, bodyDraws, bodyDraw, sphereVAO, sphereIndices);
         }
 
-        // RENDERIZADO DE TODOS LOS PLANETAS
-        for (auto& planet : planets) {
-            renderPlanet(ourShader, planet, sphereVAO, sphereIndices, effectiveDeltaTime, view, projection);
+        // RENDERIZADO DE CUERPOS AGREGADOS (MODO N-CUERPOS)
+        // Posiciones en doble precisión relativas a la cámara, convertidas a float directamente en el buffer de streaming
+        if (!renderState.particles.empty()) {
+            const size_t particleCount = renderState.particles.size();
+            GLintptr offset;
+            glm::vec3* particleVertices = (glm::vec3*)frameStream.map((GLsizeiptr)(particleCount * sizeof(glm::vec3)), sizeof(glm::vec3), offset);
+            GLuint particleBuffer = frameStream.buffer();  // El de este map(): si el buffer crece después, sigue válido hasta el final del frame
+            for (size_t i = 0; i < particleCount; ++i) {
+                const glm::dvec3& p = renderState.particles[i];
+                particleVertices[i] = floatingOrigin.toLocal(trueScale ? p : glm::dvec3(simulation.toSceneRadial(p)));
+            }
+            frameStream.unmap();
+            orbitShader.use();
+            bindDrawData(frameStream, glm::mat4(1.0f), glm::vec3(0.9f, 0.6f, 0.4f), glm::vec3(0.0f), glm::vec3(0.0f));  // Color anaranjado
+
+            glBindVertexArray(particleVAO);
+            glBindBuffer(GL_ARRAY_BUFFER, particleBuffer);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)offset);
+            glPointSize(2.0f);
+            glDrawArrays(GL_POINTS, 0, (GLsizei)particleCount);
+            glPointSize(1.0f);
+            ourShader.use();
+        }
+
+        // RENDERIZADO DE CUERPOS MENORES (CATÁLOGO IMPORTADO)
+        // Las posiciones se recalculan solo si cambió la fecha o la escala; la cámara se resta en el shader
+        if (showMinorBodies && minorBodyEphemeris.bodyCount() > 0) {
+            glBindVertexArray(minorBodyVAO);
+            if (!(renderState.julianDate == minorBodyDate) || trueScale != minorBodyTrueScale) {
+                // Se escriben directamente en el VBO mapeado, sin copia intermedia; el buffer se huérfana
+                // antes para no esperar a que la GPU suelte el anterior
+                glBindBuffer(GL_ARRAY_BUFFER, minorBodyVBO);
+                GLsizeiptr bytes = (GLsizeiptr)(6 * (size_t)minorBodyEphemeris.bodyCount() * sizeof(float));
+                glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+                float* vertices = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+                if (vertices) {
+                    createMinorBodyVertices(minorBodyEphemeris, simulation, renderState.julianDate, trueScale,
+                        minorBodyScratch, vertices);
+                    glUnmapBuffer(GL_ARRAY_BUFFER);
+                    minorBodyBytes = (size_t)bytes;
+                    minorBodyDate = renderState.julianDate;
+                    minorBodyTrueScale = trueScale;
+                }
+            }
+            orbitShader.use();
+            bindDrawData(frameStream, glm::mat4(1.0f), glm::vec3(0.6f, 0.6f, 0.55f), floatingOrigin.high(), floatingOrigin.low());  // Gris claro
+            glDrawArrays(GL_POINTS, 0, minorBodyEphemeris.bodyCount());
+            ourShader.use();
         }
 
         // RENDERIZADO DE NOMBRES (SI ESTÁ ACTIVADO)
+        // Todas las etiquetas se proyectan juntas con una sola matriz y un solo tamaño de framebuffer
         if (showNames) {
-            renderTextIn3DSpace("Sol", glm::vec3(0.0f, 1.5f, 0.0f), view, projection);
+            labelRenderer.flush(ImGui::GetBackgroundDrawList(), projection * view, display_w, display_h);
         }
 
         // RENDERIZADO DE METEORITOS
-        if (showMeteorites) {
+        // Las posiciones de los visibles van al buffer de streaming y se dibujan en un solo draw
+        int visibleMeteorites = 0;
+        for (int i = 0; showMeteorites && i < meteoriteCount; ++i) {
+            if (renderState.meteorites[i].isVisible) ++visibleMeteorites;
+        }
+        if (visibleMeteorites > 0) {
+            GLintptr offset;
+            glm::vec3* points = (glm::vec3*)frameStream.map((GLsizeiptr)(visibleMeteorites * sizeof(glm::vec3)), sizeof(glm::vec3), offset);
+            GLuint pointBuffer = frameStream.buffer();
+            for (int i = 0, n = 0; i < meteoriteCount; ++i) {
+                if (renderState.meteorites[i].isVisible) points[n++] = renderState.meteorites[i].position;
+            }
+            frameStream.unmap();
+
             orbitShader.use();
+            glDisable(GL_DEPTH_TEST);  // Capa 2D encima de la escena: no depende de la convención de profundidad
             // Configurar proyección ortogonal para meteoritos (efecto 2D sobre 3D)
             glm::mat4 ortho_projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
-            orbitShader.setMat4("projection", ortho_projection);
-            orbitShader.setMat4("view", glm::mat4(1.0f));
-            orbitShader.setVec3("orbitColor", glm::vec3(1.0f, 1.0f, 0.8f));  // Color amarillo-blanco
+            bindFrameData(frameStream, ortho_projection, glm::mat4(1.0f), 0.0f);
+            bindDrawData(frameStream, glm::mat4(1.0f), glm::vec3(1.0f, 1.0f, 0.8f), glm::vec3(0.0f), glm::vec3(0.0f));  // Color amarillo-blanco
 
             glPointSize(5.0f);  // Tamaño de puntos
             glBindVertexArray(meteoriteVAO);
-
-            // Renderizar cada meteorito visible
-            for (int i = 0; i < meteoriteCount; ++i) {
-                if (meteorites[i].isVisible) {
-                    glm::mat4 model_meteorite = glm::translate(glm::mat4(1.0f), meteorites[i].position);
-                    orbitShader.setMat4("model", model_meteorite);
-                    glDrawArrays(GL_POINTS, 0, 1);
-                }
-            }
+            glBindBuffer(GL_ARRAY_BUFFER, pointBuffer);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)offset);
+            glDrawArrays(GL_POINTS, 0, visibleMeteorites);
             glPointSize(1.0f);  // Restaurar tamaño de punto por defecto
+            glEnable(GL_DEPTH_TEST);
         }
 
+        // Grabar el cuadro (lectura asíncrona al PBO de la ranura) y copiar la escena a la ventana
+        // (en el render por lotes no hay ventana visible: ni vista previa ni interfaz)
+        recorder.capture(reversedDepth.framebuffer(), frameSlot);
+        if (!batchJob.active) reversedDepth.endScene(window_w, window_h);
+
         // RENDERIZADO DE INTERFAZ IMGUI
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (!batchJob.active) ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        // Suma de control del frame: se graba o se compara con la grabada
+        if (inputLog.isActive()) syncInputCheck(window, frameChecksum(bodies, renderState, viewPitch, viewYaw));
+        frameStream.endFrame();
+        framesInFlight.endFrame();  // Fence de la ranura: la CPU sigue con el frame siguiente sin esperar
+        streamedBytes = frameStream.lastFrameBytes() + minorBodyBytes;
+        minorBodyBytes = 0;
 
         // INTERCAMBIAR BUFFERS Y CONTINUAR LOOP
-        glfwSwapBuffers(window);
+        if (!batchJob.active) glfwSwapBuffers(window);
+        else if (recorder.capturedFrames() >= batchJob.count) glfwSetWindowShouldClose(window, GLFW_TRUE);  // Tramo completo
+
+        // LATENCIA DE ENTRADA: desde la entrada que movió la cámara (o el latch) hasta el swap
+        double swapTime = glfwGetTime();
+        if (cameraInputTime >= 0.0) {
+            inputLatency.record(swapTime - cameraInputTime);
+            cameraInputTime = -1.0;
+        }
+        if (lateLatchInput && latchTime >= 0.0) latchLatency.record(swapTime - latchTime);
+        Profiler::Clock::duration renderWork = Profiler::Clock::now() - renderWorkStart;
+        profiler.addBusy(renderThreadId, renderWork);
+        profiler.sample();
+        frameAllocations.endFrame(swapTime);
+        if (inputSession.replaying) {
+            if (inputSession.lastSwap >= 0.0) inputSession.frameTimes.record(swapTime - inputSession.lastSwap);
+            inputSession.workTimes.record(std::chrono::duration<double>(renderWork).count());
+            inputSession.lastSwap = swapTime;
+            if (frameAllocations.frameCount > 0) {
+                inputSession.allocations += frameAllocations.frameCount;
+                inputSession.peakAllocations = std::max(inputSession.peakAllocations, frameAllocations.frameCount);
+                inputSession.allocatingFrames++;
+                inputSession.lastAllocatingFrame = (long long)inputLog.replayedFrameCount() - 1;
+            }
+        }
+        if (recorder.isRecording() || (inputSession.benchmark && inputSession.replaying)) {
+            framePacer.reset();  // Grabando o midiendo: sin limitador, cada cuadro lo antes posible
+        }
+        else framePacer.endFrame();  // Limitador híbrido sleep/spin y medición de pacing
+        frameStats.update(glfwGetTime(), true);
     }
 
     // ===========================================
     // LIMPIEZA Y FINALIZACIÓN
     // ===========================================
 
+    // Cerrar la grabación en curso (necesita el contexto para vaciar los PBO)
+    if (recorder.isRecording()) stopRecording(recorder, simulationThread);
+    int exitCode = batchJob.active ? finishBatchJob(batchJob, recorder) : 0;
+    if (inputSession.replaying) finishInputReplay();  // Ventana cerrada antes del final del registro
+    if (inputSession.benchmark) exitCode = inputSession.exitCode;
+    if (inputLog.isRecording()) {
+        string error;
+        long long events = inputLog.events();
+        uint32_t frames = inputLog.frameCount();
+        size_t bytes = inputLog.bytes();
+        if (inputLog.save(inputSession.path.c_str(), error)) {
+            cout << "Entrada grabada: " << frames << " frames, " << events << " registros, " << bytes / 1024.0
+                << " KB en " << inputSession.path << endl;
+        }
+        else {
+            cout << error << endl;
+        }
+    }
+
+    // Detener el hilo de simulación antes de liberar el estado que usa
+    simulationThread.stop();
+
     // Limpiar recursos de ImGui
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -1450,7 +3062,13 @@ int main() {
 
     // Limpiar recursos de OpenGL
     glDeleteVertexArrays(1, &meteoriteVAO);
-    glDeleteBuffers(1, &meteoriteVBO);
+    glDeleteVertexArrays(1, &particleVAO);
+    frameStream.destroy();
+    framesInFlight.destroy();
+    glDeleteVertexArrays(1, &minorBodyVAO);
+    glDeleteBuffers(1, &minorBodyVBO);
+    if (starVAO) glDeleteVertexArrays(1, &starVAO);
+    if (starVBO) glDeleteBuffers(1, &starVBO);
     glDeleteVertexArrays(1, &sphereVAO);
     glDeleteBuffers(1, &sphereVBO);
     glDeleteBuffers(1, &sphereEBO);
@@ -1458,10 +3076,12 @@ int main() {
     glDeleteBuffers(1, &orbitVBO);
     glDeleteProgram(ourShader.ID);
     glDeleteProgram(orbitShader.ID);
+    glDeleteProgram(starShader.ID);
+    reversedDepth.destroy();
 
     // Finalizar GLFW
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
 
 // ===========================================
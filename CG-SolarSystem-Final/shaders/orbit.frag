@@ -1,9 +1,15 @@
 #version 330 core
 out vec4 FragColor;
 
-uniform vec3 orbitColor;
+// Datos de cada draw, en el buffer de streaming (ver DrawData en main.cpp)
+layout (std140) uniform DrawData {
+    mat4 model;
+    vec4 color;       // Color de orbitas y puntos
+    vec4 cameraHigh;  // Camara partida en dos floats (origen flotante)
+    vec4 cameraLow;
+};
 
 void main()
 {
-    FragColor = vec4(orbitColor, 1.0);
+    FragColor = vec4(color.rgb, 1.0);
 }
\ No newline at end of file
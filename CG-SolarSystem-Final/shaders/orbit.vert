@@ -1,11 +1,25 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec3 aPos;     // Parte alta de la posicion (o la posicion completa)
+layout (location = 1) in vec3 aPosLow;  // Parte baja (0 si el atributo no esta activo)
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Bloque compartido por todos los shaders, escrito una vez por frame (ver FrameData en main.cpp)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 sky;      // Radio del cielo, magnitud limite y tamano de las estrellas (solo star.vert)
+};
+
+// Datos de cada draw, en el buffer de streaming (ver DrawData en main.cpp)
+layout (std140) uniform DrawData {
+    mat4 model;
+    vec4 color;       // Color de orbitas y puntos
+    vec4 cameraHigh;  // Camara partida en dos floats (origen flotante)
+    vec4 cameraLow;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    // Restar cada mitad por separado conserva la precision cerca de la camara
+    vec3 relative = (aPos - cameraHigh.xyz) + (aPosLow - cameraLow.xyz);
+    gl_Position = projection * view * model * vec4(relative, 1.0);
+}
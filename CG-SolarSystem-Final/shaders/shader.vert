@@ -6,9 +6,20 @@ layout (location = 2) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
-uniform mat4 model;       
-uniform mat4 view;        
-uniform mat4 projection;  
+// Bloque compartido por todos los shaders, escrito una vez por frame (ver FrameData en main.cpp)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 sky;      // Radio del cielo, magnitud limite y tamano de las estrellas (solo star.vert)
+};
+
+// Datos de cada draw, en el buffer de streaming (ver DrawData en main.cpp)
+layout (std140) uniform DrawData {
+    mat4 model;
+    vec4 color;       // Color de orbitas y puntos
+    vec4 cameraHigh;  // Camara partida en dos floats (origen flotante)
+    vec4 cameraLow;
+};
 
 void main()
 {
@@ -0,0 +1,12 @@
+#version 330 core
+in vec4 starColor;
+out vec4 FragColor;
+
+void main()
+{
+    // Disco con caida gaussiana dentro del punto
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(d, d);
+    if (r2 > 1.0) discard;
+    FragColor = vec4(starColor.rgb, starColor.a * exp(-3.0 * r2));
+}
@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aDirection;  // Direccion unitaria hacia la estrella
+layout (location = 1) in float aMagnitude; // Magnitud aparente
+layout (location = 2) in vec4 aColor;      // Color segun el indice B-V
+
+// Bloque compartido por todos los shaders, escrito una vez por frame (ver FrameData en main.cpp)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;     // Sin traslacion: la camara esta en el origen
+    vec4 sky;      // x: radio de la esfera del cielo, y: magnitud limite, z: tamano en pixeles de una estrella en el limite
+};
+
+out vec4 starColor;
+
+void main()
+{
+    gl_Position = projection * view * vec4(aDirection * sky.x, 1.0);
+
+    // Flujo relativo al limite: 5 magnitudes menos = 100 veces mas brillante.
+    // El tamano crece con la raiz cuarta del flujo y el brillo satura en las estrellas grandes
+    float flux = pow(10.0, 0.4 * (sky.y - aMagnitude));
+    gl_PointSize = clamp(sky.z * pow(flux, 0.25), 1.0, 10.0);
+    starColor = vec4(aColor.rgb, clamp(0.35 * sqrt(flux), 0.25, 1.0));
+}